@@ -0,0 +1,521 @@
+
+#define SOA_SIMD_RUNTIME_DISPATCH
+#include "../soa_simd.hpp"
+#include "../soa_query.hpp"
+#include "../soa_indexed.hpp"
+#include "../soa_snapshot.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Benchmarks of soa::vector compared to std::vector (array of structures).
+// Usage : benchmarks [--format=text|csv|json] [--max-rows=N]
+// The rows counts go from 1e3 to 'max-rows' (1e8 by default). The results are written to the
+// standard output, one per benchmark, type, container and rows count, with the best time of the runs.
+
+// Utility functions.
+
+// Returns the best time in milliseconds of 'runs' calls to 'f'.
+template <class F>
+double measure(int runs, F && f) {
+    using clock = std::chrono::steady_clock;
+    auto best = std::chrono::duration<double, std::milli>::max();
+    for (int i = 0; i < runs; ++i) {
+        auto const start = clock::now();
+        f();
+        auto const time = std::chrono::duration<double, std::milli>{ clock::now() - start };
+        if (time < best) best = time;
+    }
+    return best.count();
+}
+
+// Returns the best time in milliseconds of 'runs' calls to 'f(state)', with the state
+// created by 'setup()' before each call and destroyed after, outside of the measure.
+template <class Setup, class F>
+double measure_with(int runs, Setup && setup, F && f) {
+    using clock = std::chrono::steady_clock;
+    auto best = std::chrono::duration<double, std::milli>::max();
+    for (int i = 0; i < runs; ++i) {
+        auto state = setup();
+        auto const start = clock::now();
+        f(state);
+        auto const time = std::chrono::duration<double, std::milli>{ clock::now() - start };
+        if (time < best) best = time;
+    }
+    return best.count();
+}
+
+// Prevents the compiler from optimizing away a computed value.
+template <class T>
+void keep(T const& value) {
+    auto volatile sink = static_cast<unsigned char const*>(static_cast<void const*>(&value))[0];
+    (void) sink;
+}
+
+// Less runs for the large tables.
+int runs_for(int nb) {
+    return nb <= 100'000 ? 10 : nb <= 10'000'000 ? 3 : 1;
+}
+
+// Wraps a value with non-trivial special members,
+// to force the element-wise code path of soa::vector.
+template <class T>
+struct non_trivial {
+    T value;
+
+    non_trivial() noexcept : value{} {}
+    non_trivial(T v) noexcept : value{ v } {}
+    non_trivial(non_trivial const& rhs) noexcept : value{ rhs.value } {}
+    non_trivial& operator=(non_trivial const& rhs) noexcept { value = rhs.value; return *this; }
+    ~non_trivial() {}
+};
+
+// Results
+
+struct result {
+    std::string benchmark;
+    std::string type;
+    std::string container;
+    int rows;
+    double ms;
+};
+std::vector<result> results;
+
+void record(char const* benchmark, char const* type, char const* container, int rows, double ms) {
+    results.push_back({ benchmark, type, container, rows, ms });
+}
+
+char const* compiler_name() {
+#if defined(__clang__)
+    return "clang " __clang_version__;
+#elif defined(__GNUC__)
+    return "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+    return "msvc";
+#else
+    return "unknown";
+#endif
+}
+
+// The names written in JSON only need the quotes and backslashes to be escaped.
+std::string json_string(std::string const& str) {
+    auto escaped = std::string{ "\"" };
+    for (auto c : str) {
+        if (c == '"' || c == '\\') escaped += '\\';
+        escaped += c;
+    }
+    return escaped += '"';
+}
+
+void write_text() {
+    for (auto const& r : results) {
+        std::printf("%-16s %-14s %-16s %10d rows : %10.3f ms\n",
+            r.benchmark.c_str(), r.type.c_str(), r.container.c_str(), r.rows, r.ms);
+    }
+}
+
+void write_csv() {
+    std::printf("benchmark,type,container,rows,ms\n");
+    for (auto const& r : results) {
+        std::printf("%s,%s,%s,%d,%.6f\n", r.benchmark.c_str(), r.type.c_str(), r.container.c_str(), r.rows, r.ms);
+    }
+}
+
+void write_json() {
+    std::printf("{\n  \"compiler\": %s,\n  \"results\": [", json_string(compiler_name()).c_str());
+    for (size_t i = 0; i < results.size(); ++i) {
+        auto const& r = results[i];
+        std::printf("%s\n    { \"benchmark\": %s, \"type\": %s, \"container\": %s, \"rows\": %d, \"ms\": %.6f }",
+            i == 0 ? "" : ",", json_string(r.benchmark).c_str(), json_string(r.type).c_str(),
+            json_string(r.container).c_str(), r.rows, r.ms);
+    }
+    std::printf("\n  ]\n}\n");
+}
+
+// Benchmark data
+
+namespace user {
+    struct physics {
+        float pos;
+        float speed;
+        float acc;
+        int   id;
+    };
+    struct slow_physics {
+        non_trivial<float> pos;
+        non_trivial<float> speed;
+        non_trivial<float> acc;
+        non_trivial<int>   id;
+    };
+}
+SOA_DEFINE_TYPE(user::physics, pos, speed, acc, id);
+SOA_DEFINE_TYPE(user::slow_physics, pos, speed, acc, id);
+
+struct person {
+    std::string name;
+    int age;
+    bool likes_cpp;
+};
+SOA_DEFINE_TYPE(person, name, age, likes_cpp);
+
+namespace user {
+    struct flags {
+        bool alive;
+        bool packed_alive;
+    };
+}
+SOA_DEFINE_TYPE(user::flags, alive, (packed_alive, soa::packed<>));
+
+long long to_number(int value) { return value; }
+template <class T>
+long long to_number(non_trivial<T> const& value) { return static_cast<long long>(value.value); }
+
+// For each type : how to create a row, update all it's members and read the scanned member.
+template <class T>
+struct bench_traits;
+
+template <>
+struct bench_traits<user::physics> {
+    static constexpr char const* name = "physics";
+    static user::physics make(int i) { return { 1.f * i, 2.f, 3.f, i }; }
+
+    template <class Row>
+    static void update(Row&& row) { row.pos += row.speed * row.acc; row.id += 1; }
+    template <class Vector>
+    static void update_spans(Vector& vec) {
+        for (int i = 0; i < vec.size(); ++i) {
+            vec.pos[i] += vec.speed[i] * vec.acc[i];
+            vec.id[i] += 1;
+        }
+    }
+    template <class Row>
+    static auto const& key(Row const& row) { return row.id; }
+    template <class Vector>
+    static auto const& key_column(Vector const& vec) { return vec.id; }
+};
+
+template <>
+struct bench_traits<user::slow_physics> {
+    static constexpr char const* name = "slow_physics";
+    static user::slow_physics make(int i) { return { 1.f * i, 2.f, 3.f, i }; }
+
+    template <class Row>
+    static void update(Row&& row) { row.pos.value += row.speed.value * row.acc.value; row.id.value += 1; }
+    template <class Vector>
+    static void update_spans(Vector& vec) {
+        for (int i = 0; i < vec.size(); ++i) {
+            vec.pos[i].value += vec.speed[i].value * vec.acc[i].value;
+            vec.id[i].value += 1;
+        }
+    }
+    template <class Row>
+    static auto const& key(Row const& row) { return row.id; }
+    template <class Vector>
+    static auto const& key_column(Vector const& vec) { return vec.id; }
+};
+
+template <>
+struct bench_traits<person> {
+    static constexpr char const* name = "person";
+    // The names fit in the small string buffer.
+    static person make(int i) { return { std::to_string(i % 1000), i % 100, i % 2 == 0 }; }
+
+    template <class Row>
+    static void update(Row&& row) { row.age += static_cast<int>(row.name.size()); row.likes_cpp = !row.likes_cpp; }
+    template <class Vector>
+    static void update_spans(Vector& vec) {
+        for (int i = 0; i < vec.size(); ++i) {
+            vec.age[i] += static_cast<int>(vec.name[i].size());
+            vec.likes_cpp[i] = !vec.likes_cpp[i];
+        }
+    }
+    template <class Row>
+    static auto const& key(Row const& row) { return row.age; }
+    template <class Vector>
+    static auto const& key_column(Vector const& vec) { return vec.age; }
+};
+
+template <class Vector>
+constexpr bool is_soa_v = false;
+template <class T>
+constexpr bool is_soa_v<soa::vector<T>> = true;
+
+// Benchmarks
+
+// The operations common to soa::vector<T> and std::vector<T>.
+template <class Vector>
+void bench_container(char const* container, int nb) {
+    using T = typename Vector::value_type;
+    using traits = bench_traits<T>;
+    auto const runs = runs_for(nb);
+    auto const type = traits::name;
+
+    record("push_back", type, container, nb, measure(runs, [nb] {
+        auto vec = Vector{};
+        for (int i = 0; i < nb; ++i) vec.push_back(traits::make(i));
+        keep(vec.size());
+    }));
+    record("emplace_back", type, container, nb, measure(runs, [nb] {
+        auto vec = Vector{};
+        for (int i = 0; i < nb; ++i) vec.emplace_back();
+        keep(vec.size());
+    }));
+    record("reserve", type, container, nb, measure(runs, [nb] {
+        auto vec = Vector{};
+        vec.reserve(nb);
+        for (int i = 0; i < nb; ++i) vec.push_back(traits::make(i));
+        keep(vec.size());
+    }));
+    record("resize_value", type, container, nb, measure(runs, [nb] {
+        auto vec = Vector{};
+        vec.resize(nb, traits::make(1));
+        keep(vec.size());
+    }));
+
+    auto filled = Vector{};
+    filled.reserve(nb);
+    for (int i = 0; i < nb; ++i) filled.push_back(traits::make(i));
+
+    record("copy", type, container, nb, measure(runs, [&filled] {
+        auto const vec = filled;
+        keep(vec.size());
+    }));
+    record("move", type, container, nb, measure_with(runs, [&filled] { return filled; }, [] (Vector& vec) {
+        auto const moved = std::move(vec);
+        keep(moved.size());
+    }));
+
+    // Full rows : with proxies for soa::vector.
+    record("iterate_rows", type, container, nb, measure(runs, [&filled] {
+        for (auto&& row : filled) traits::update(row);
+        keep(filled.size());
+    }));
+    if constexpr (is_soa_v<Vector>) {
+        record("iterate_spans", type, container, nb, measure(runs, [&filled] {
+            traits::update_spans(filled);
+            keep(filled.size());
+        }));
+    }
+
+    // A single member : with it's span for soa::vector.
+    record("scan_column", type, container, nb, measure(runs, [&filled] {
+        long long sum = 0;
+        if constexpr (is_soa_v<Vector>) {
+            for (auto const& value : traits::key_column(filled)) sum += to_number(value);
+        }
+        else {
+            for (auto const& row : filled) sum += to_number(traits::key(row));
+        }
+        keep(sum);
+    }));
+}
+
+template <class T>
+void bench_type(int nb) {
+    bench_container<soa::vector<T>>("soa::vector", nb);
+    bench_container<std::vector<T>>("std::vector", nb);
+}
+
+// Physics update 'pos += speed * dt' with a loop on the spans and with soa::simd_transform.
+void bench_simd(int nb) {
+    auto const runs = runs_for(nb);
+    auto const dt = 0.01f;
+    auto vec = soa::vector<user::physics, std::allocator<user::physics>, soa::simd_layout<64>>{};
+    vec.resize(nb);
+
+    record("physics_update", "physics", "span_loop", nb, measure(runs, [&vec, nb, dt] {
+        for (int i = 0; i < nb; ++i) vec.pos[i] += vec.speed[i] * dt;
+        keep(vec.pos[0]);
+    }));
+    auto const container = soa::simd::active_isa() == soa::simd::isa::scalar
+        ? "simd_scalar" : "simd_transform";
+    record("physics_update", "physics", container, nb, measure(runs, [&vec, dt] {
+        soa::simd_transform(vec.pos, [dt] (auto pos, auto speed) { return pos + speed * dt; }, vec.pos, vec.speed);
+        keep(vec.pos[0]);
+    }));
+}
+
+// Sorts rows by a key column with soa::sort_by, compared to std::sort on an array of structures.
+void bench_sort(int nb) {
+    auto const runs = std::min(3, runs_for(nb));
+    auto keys = std::vector<int>(nb);
+    auto seed = 12345u;
+    for (auto& key : keys) key = static_cast<int>((seed = seed * 1664525u + 1013904223u) >> 8);
+
+    record("sort_by_key", "physics", "std::vector", nb, measure(runs, [&keys, nb] {
+        auto vec = std::vector<user::physics>(nb);
+        for (int i = 0; i < nb; ++i) vec[i].id = keys[i];
+        std::sort(vec.begin(), vec.end(), [] (auto const& lhs, auto const& rhs) { return lhs.id < rhs.id; });
+        keep(vec[0]);
+    }));
+    record("sort_by_key", "physics", "soa::vector", nb, measure(runs, [&keys, nb] {
+        auto vec = soa::vector<user::physics>{};
+        vec.resize(nb);
+        std::copy(keys.begin(), keys.end(), vec.id.begin());
+        soa::sort_by<3>(vec);
+        keep(vec.id[0]);
+    }));
+}
+
+// Converts an array of structures to columns and back, row by row and with the blocked conversions.
+void bench_aos(int nb) {
+    auto const runs = std::min(3, runs_for(nb));
+    auto rows = std::vector<user::physics>(nb);
+    for (int i = 0; i < nb; ++i) rows[i] = { 1.f * i, 2.f * i, 3.f * i, i };
+
+    record("aos_round_trip", "physics", "row_by_row", nb, measure(runs, [&rows, nb] {
+        auto vec = soa::vector<user::physics>{};
+        vec.reserve(nb);
+        for (auto const& row : rows) vec.push_back(row);
+        for (int i = 0; i < nb; ++i) rows[i] = vec[i];
+        keep(rows[0]);
+    }));
+    record("aos_round_trip", "physics", "from_aos_to_aos", nb, measure(runs, [&rows] {
+        auto const vec = soa::from_aos(rows);
+        soa::to_aos(vec, rows.begin());
+        keep(rows[0]);
+    }));
+}
+
+// Selects the rows of a filter on two columns, with a branch per row and with soa::select,
+// then sums a third column on the selected rows.
+void bench_select(int nb) {
+    auto const runs = runs_for(nb);
+    auto vec = soa::vector<user::physics>{};
+    vec.reserve(nb);
+    auto seed = 12345u;
+    for (int i = 0; i < nb; ++i) {
+        seed = seed * 1664525u + 1013904223u;
+        vec.push_back({ static_cast<float>(seed >> 16 & 1023), 1.f, 2.f, static_cast<int>(seed >> 8 & 3) });
+    }
+    auto const pred = [] (float pos, int id) { return pos < 512.f && id != 0; };
+
+    record("select_sum", "physics", "branch_loop", nb, measure(runs, [&vec, &pred, nb] {
+        auto rows = soa::selection{};
+        for (int i = 0; i < nb; ++i) {
+            if (pred(vec.pos[i], vec.id[i])) rows.push_back(i);
+        }
+        auto sum = 0.f;
+        for (auto const i : rows) sum += vec.speed[i];
+        keep(sum);
+    }));
+    record("select_sum", "physics", "soa::select", nb, measure(runs, [&vec, &pred] {
+        auto const rows = soa::select(pred, vec.pos, vec.id);
+        keep(soa::reduce_selected(rows, 0.f, std::plus<>{}, [] (float speed) { return speed; }, vec.speed));
+    }));
+}
+
+// Looks up every row by a shuffled id : with a std::unordered_map beside the vector, and with soa::indexed_vector.
+void bench_lookup(int nb) {
+    auto const runs = std::min(3, runs_for(nb));
+    auto rows = soa::vector<user::physics>{};
+    rows.resize(nb);
+    for (int i = 0; i < nb; ++i) rows.id[i] = i * 7;
+    auto keys = std::vector<int>(rows.id.begin(), rows.id.end());
+    auto seed = 12345u;
+    for (int i = nb - 1; i > 0; --i) std::swap(keys[i], keys[(seed = seed * 1664525u + 1013904223u) % static_cast<unsigned>(i + 1)]);
+
+    auto map = std::unordered_map<int, int>{};
+    record("build_index", "physics", "unordered_map", nb, measure(runs, [&map, &rows, nb] {
+        map = {};
+        map.reserve(static_cast<size_t>(nb));
+        for (int i = 0; i < nb; ++i) map.emplace(rows.id[i], i);
+        keep(map.size());
+    }));
+    auto indexed = soa::indexed_vector<user::physics, &user::physics::id>{};
+    record("build_index", "physics", "indexed_vector", nb, measure_with(runs, [&rows] { return rows; }, [&indexed] (auto& copy) {
+        indexed = soa::indexed_vector<user::physics, &user::physics::id>{ std::move(copy) };
+        keep(indexed.size());
+    }));
+
+    record("lookup_key", "physics", "unordered_map", nb, measure(runs, [&map, &rows, &keys] {
+        auto sum = 0.f;
+        for (auto const key : keys) sum += rows.pos[map.find(key)->second];
+        keep(sum);
+    }));
+    record("lookup_key", "physics", "indexed_vector", nb, measure(runs, [&indexed, &keys] {
+        auto sum = 0.f;
+        for (auto const key : keys) sum += indexed.rows().pos[indexed.find(key)];
+        keep(sum);
+    }));
+}
+
+// Takes a snapshot of the rows then updates one column : with a copy of the soa::vector,
+// and with a soa::cow_vector which copies only the pages of the updated column.
+void bench_snapshot(int nb) {
+    auto const runs = std::min(3, runs_for(nb));
+    auto vec = soa::vector<user::physics>{};
+    vec.resize(nb);
+    auto cow = soa::cow_vector<user::physics>{};
+    for (int i = 0; i < nb; ++i) cow.emplace_back();
+
+    record("snapshot_update", "physics", "vector_copy", nb, measure(runs, [&vec] {
+        auto const snapshot = vec;
+        for (auto& pos : vec.pos) pos += 1.f;
+        keep(snapshot.pos[0]);
+    }));
+    record("snapshot_update", "physics", "cow_vector", nb, measure(runs, [&cow] {
+        auto const snapshot = cow.snapshot();
+        for (soa::size_type p = 0; p < cow.pages_count(); ++p) {
+            for (auto& pos : cow.mutable_page<0>(p)) pos += 1.f;
+        }
+        keep(snapshot.get<0>(0));
+    }));
+}
+
+// Counts the true flags of a bool column, and of a packed column which reads 8 times less memory.
+void bench_flags(int nb) {
+    auto const runs = runs_for(nb);
+    auto vec = soa::vector<user::flags>{};
+    vec.reserve(nb);
+    for (int i = 0; i < nb; ++i) vec.push_back({ i % 3 == 0, i % 3 == 0 });
+
+    record("count_flags", "flags", "bool_column", nb, measure(runs, [&vec] {
+        keep(std::count(vec.alive.begin(), vec.alive.end(), true));
+    }));
+    record("count_flags", "flags", "packed_column", nb, measure(runs, [&vec] {
+        keep(vec.packed_alive.count());
+    }));
+}
+
+int main(int argc, char** argv) {
+    auto format = std::string{ "text" };
+    auto max_rows = 100'000'000LL;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strncmp(argv[i], "--format=", 9) == 0) format = argv[i] + 9;
+        else if (std::strncmp(argv[i], "--max-rows=", 11) == 0) max_rows = std::atoll(argv[i] + 11);
+        else {
+            std::fprintf(stderr, "usage : %s [--format=text|csv|json] [--max-rows=N]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (format != "text" && format != "csv" && format != "json") {
+        std::fprintf(stderr, "unknown format '%s'\n", format.c_str());
+        return 1;
+    }
+
+    for (long long nb = 1'000; nb <= max_rows; nb *= 10) {
+        auto const rows = static_cast<int>(nb);
+        bench_type<user::physics>(rows);
+        bench_type<user::slow_physics>(rows);
+        bench_type<person>(rows);
+        bench_simd(rows);
+        bench_sort(rows);
+        bench_aos(rows);
+        bench_select(rows);
+        bench_lookup(rows);
+        bench_snapshot(rows);
+        bench_flags(rows);
+    }
+
+    if (format == "csv") write_csv();
+    else if (format == "json") write_json();
+    else write_text();
+}
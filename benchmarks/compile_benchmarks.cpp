@@ -0,0 +1,131 @@
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Compile-time benchmarks of SOA_DEFINE_TYPE and soa::vector instantiations.
+// Usage : compile_benchmarks [--format=text|csv] [--max-types=N]
+// For 10, 100 and 500 types (up to 'max-types'), a translation unit defining the types and using
+// a soa::vector of each is generated, then preprocessed and compiled with the compiler which built
+// this program. The instantiation count is the number of inline and template functions (weak symbols)
+// of the object which belong to, or are instantiated with, the soa namespace.
+
+#ifndef SOA_CXX_COMPILER
+#define SOA_CXX_COMPILER "c++"
+#endif
+#ifndef SOA_SOURCE_DIR
+#define SOA_SOURCE_DIR "."
+#endif
+#ifndef SOA_BINARY_DIR
+#define SOA_BINARY_DIR "."
+#endif
+
+// Utility functions.
+
+// Returns the best time in milliseconds of 'runs' runs of the command, or a negative time if it fails.
+double measure_command(int runs, std::string const& command) {
+    using clock = std::chrono::steady_clock;
+    auto best = std::chrono::duration<double, std::milli>::max();
+    for (int i = 0; i < runs; ++i) {
+        auto const start = clock::now();
+        if (std::system(command.c_str()) != 0) return -1.;
+        auto const time = std::chrono::duration<double, std::milli>{ clock::now() - start };
+        if (time < best) best = time;
+    }
+    return best.count();
+}
+
+// Returns the first line written by the command, or an empty string.
+std::string command_output(std::string const& command) {
+    auto const path = std::string{ SOA_BINARY_DIR "/compile_benchmarks.out" };
+    if (std::system((command + " > " + path).c_str()) != 0) return {};
+    auto file = std::ifstream{ path };
+    auto line = std::string{};
+    std::getline(file, line);
+    return line;
+}
+
+// Writes a translation unit with 'nb' types of 2 to 9 members, which uses the main functions of soa::vector.
+void write_source(std::string const& path, int nb) {
+    static char const* const types[] = { "float", "int", "double", "char", "long", "short", "unsigned", "std::string" };
+    auto file = std::ofstream{ path };
+    file << "#include \"" SOA_SOURCE_DIR "/soa_vector.hpp\"\n#include <string>\n\n";
+    for (int t = 0; t < nb; ++t) {
+        auto const members = 2 + t % 8;
+        file << "namespace bench { struct type_" << t << " {";
+        for (int m = 0; m < members; ++m) file << ' ' << types[(t + m) % 8] << " m" << m << ';';
+        file << " }; }\nSOA_DEFINE_TYPE(bench::type_" << t;
+        for (int m = 0; m < members; ++m) file << ", m" << m;
+        file << ");\n";
+        file << "void use_" << t << "(soa::vector<bench::type_" << t << ">& v) {"
+                " v.push_back(v[0]); v.emplace_back(); v.pop_back(); v.erase(v.begin()); auto copy = v; v.shrink_to_fit(); }\n\n";
+    }
+}
+
+// Results
+
+struct result {
+    int types;
+    double preprocess_ms;
+    double compile_ms;
+    int instantiations;
+};
+std::vector<result> results;
+
+void write_text() {
+    std::printf("compiler : %s\n", SOA_CXX_COMPILER);
+    for (auto const& r : results) {
+        std::printf("%5d types : preprocess %10.1f ms, compile %10.1f ms, %7d instantiations\n",
+            r.types, r.preprocess_ms, r.compile_ms, r.instantiations);
+    }
+}
+
+void write_csv() {
+    std::printf("types,preprocess_ms,compile_ms,instantiations\n");
+    for (auto const& r : results) {
+        std::printf("%d,%.3f,%.3f,%d\n", r.types, r.preprocess_ms, r.compile_ms, r.instantiations);
+    }
+}
+
+int main(int argc, char** argv) {
+    auto format = std::string{ "text" };
+    auto max_types = 500;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strncmp(argv[i], "--format=", 9) == 0) format = argv[i] + 9;
+        else if (std::strncmp(argv[i], "--max-types=", 12) == 0) max_types = std::atoi(argv[i] + 12);
+        else {
+            std::fprintf(stderr, "usage : %s [--format=text|csv] [--max-types=N]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (format != "text" && format != "csv") {
+        std::fprintf(stderr, "unknown format '%s'\n", format.c_str());
+        return 1;
+    }
+
+    auto const source = std::string{ SOA_BINARY_DIR "/compile_benchmarks_types.cpp" };
+    auto const object = std::string{ SOA_BINARY_DIR "/compile_benchmarks_types.o" };
+    auto const compiler = std::string{ SOA_CXX_COMPILER " -std=c++17 " };
+    for (auto const nb : { 10, 100, 500 }) {
+        if (nb > max_types) break;
+        write_source(source, nb);
+        auto const runs = nb <= 100 ? 3 : 1;
+
+        auto r = result{ nb, 0., 0., 0 };
+        r.preprocess_ms = measure_command(runs, compiler + "-E " + source + " -o " + object);
+        r.compile_ms    = measure_command(runs, compiler + "-c " + source + " -o " + object);
+        if (r.preprocess_ms < 0 || r.compile_ms < 0) {
+            std::fprintf(stderr, "failed to compile '%s'\n", source.c_str());
+            return 1;
+        }
+        r.instantiations = std::atoi(command_output("nm -C --defined-only " + object + " | grep ' W ' | grep -c 'soa::'").c_str());
+        results.push_back(r);
+    }
+
+    if (format == "csv") write_csv();
+    else write_text();
+}
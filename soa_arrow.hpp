@@ -0,0 +1,395 @@
+/*
+    soa_arrow.hpp
+    MIT license (2018)
+    Header repository : https://github.com/Dwarfobserver/soa_vector
+    You can contact me at sidney.congard@gmail.com
+ */
+
+#pragma once
+
+#include "soa_vector.hpp"
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Exchange of soa::vector columns with the Apache Arrow C data interface, without copies.
+// A vector is exported as a struct array whose children are it's columns : the buffers point to the
+// columns of the vector, which are kept alive until the consumer releases the arrays. The fields are
+// named as the members given to SOA_DEFINE_TYPE.
+// The members must be arithmetic types or enums, with the native byte order, and the bools must be
+// stored in soa::packed<> columns, whose words have the bit layout of the Arrow boolean buffers.
+// Struct arrays are imported in a soa::arrow_view, which uses their buffers in place.
+
+// Structures of the Arrow C data interface, as given by it's specification.
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+extern "C" {
+
+struct ArrowSchema {
+    // Array type description
+    const char* format;
+    const char* name;
+    const char* metadata;
+    int64_t flags;
+    int64_t n_children;
+    struct ArrowSchema** children;
+    struct ArrowSchema* dictionary;
+
+    // Release callback
+    void (*release)(struct ArrowSchema*);
+    // Opaque producer-specific data
+    void* private_data;
+};
+
+struct ArrowArray {
+    // Array data description
+    int64_t length;
+    int64_t null_count;
+    int64_t offset;
+    int64_t n_buffers;
+    int64_t n_children;
+    const void** buffers;
+    struct ArrowArray** children;
+    struct ArrowArray* dictionary;
+
+    // Release callback
+    void (*release)(struct ArrowArray*);
+    // Opaque producer-specific data
+    void* private_data;
+};
+
+} // extern "C"
+
+#endif // ARROW_C_DATA_INTERFACE
+
+namespace soa {
+
+namespace detail {
+
+    // Arrow format of the elements of type M, or nullptr if they don't have an Arrow layout.
+    template <class M>
+    constexpr char const* arrow_format() noexcept {
+        if constexpr (std::is_enum_v<M>) {
+            return arrow_format<std::underlying_type_t<M>>();
+        }
+        else if constexpr (std::is_integral_v<M> && !std::is_same_v<M, bool> && sizeof(M) <= 8) {
+            constexpr char const* formats[2][4] = { { "C", "S", "I", "L" }, { "c", "s", "i", "l" } };
+            constexpr auto size_index = sizeof(M) == 1 ? 0 : sizeof(M) == 2 ? 1 : sizeof(M) == 4 ? 2 : 3;
+            return formats[std::is_signed_v<M>][size_index];
+        }
+        else if constexpr (std::is_same_v<M, float> && sizeof(float) == 4) return "f";
+        else if constexpr (std::is_same_v<M, double> && sizeof(double) == 8) return "g";
+        else return nullptr;
+    }
+
+    // Arrow format of the I-th column of T : the soa::packed<1> bools are Arrow booleans.
+    template <class T, size_t I>
+    constexpr char const* arrow_column_format() noexcept {
+        if constexpr (is_packed_column_v<T, I>) {
+            return std::is_same_v<member_type_t<T, I>, bool> && column_options_t<T, I>::packed_bits == 1
+                ? "b" : nullptr;
+        }
+        else return arrow_format<member_type_t<T, I>>();
+    }
+
+    template <class T, size_t...Is>
+    constexpr bool arrow_columns(std::index_sequence<Is...>) noexcept {
+        return ((arrow_column_format<T, Is>() != nullptr) && ...);
+    }
+    template <class T>
+    constexpr bool has_arrow_columns_v = arrow_columns<T>(std::make_index_sequence<arity_v<members<T>>>{});
+
+    // Private data of the exported arrays. Each array holds a reference on the vector, so it's children
+    // can be moved by the consumer and released after the struct array.
+    struct arrow_array_data {
+        std::shared_ptr<void const> owner;
+        void const* buffers[2] = {};
+        std::vector<ArrowArray> children;
+        std::vector<ArrowArray*> children_pointers;
+    };
+
+    // Private data of the exported struct schema : the schemas of the children have none.
+    struct arrow_schema_data {
+        std::vector<ArrowSchema> children;
+        std::vector<ArrowSchema*> children_pointers;
+    };
+
+    // Release callbacks : the children which have not been moved are released with their parent.
+    inline void release_arrow_array(ArrowArray* array) noexcept {
+        auto const data = static_cast<arrow_array_data*>(array->private_data);
+        for (auto const child : data->children_pointers) {
+            if (child->release) child->release(child);
+        }
+        delete data;
+        array->release = nullptr;
+    }
+    inline void release_arrow_schema(ArrowSchema* schema) noexcept {
+        if (auto const data = static_cast<arrow_schema_data*>(schema->private_data)) {
+            for (auto const child : data->children_pointers) {
+                if (child->release) child->release(child);
+            }
+            delete data;
+        }
+        schema->release = nullptr;
+    }
+
+    // Given to the consumers instead of the null data of empty columns.
+    alignas(64) inline constexpr std::byte arrow_empty_buffer[64] = {};
+
+    inline ArrowArray make_arrow_array(int64_t length, int64_t n_buffers, std::unique_ptr<arrow_array_data> data) noexcept {
+        auto const ptr = data.release();
+        return { length, 0, 0, n_buffers, static_cast<int64_t>(ptr->children.size()), ptr->buffers,
+            ptr->children_pointers.data(), nullptr, &release_arrow_array, ptr };
+    }
+
+    // Buffer of the I-th column of 'vec', which holds the elements or the words of packed columns.
+    template <size_t I, class Vector>
+    void const* arrow_buffer(Vector const& vec) noexcept {
+        void const* data;
+        if constexpr (is_packed_column_v<typename Vector::value_type, I>) data = vec.template get_span<I>().words();
+        else data = vec.template get_span<I>().data();
+        return data ? data : arrow_empty_buffer;
+    }
+
+    template <class Vector, size_t...Is>
+    void export_arrow(std::shared_ptr<Vector const> vec, ArrowArray* array, ArrowSchema* schema, std::index_sequence<Is...>) {
+        using T = typename Vector::value_type;
+        constexpr auto n = sizeof...(Is);
+        auto const length = static_cast<int64_t>(vec->size());
+
+        // Everything is allocated before the structures are given to the consumer.
+        auto schema_data = std::make_unique<arrow_schema_data>();
+        schema_data->children = { ArrowSchema{ arrow_column_format<T, Is>(), member_name_v<T, Is>, nullptr, 0, 0,
+            nullptr, nullptr, &release_arrow_schema, nullptr }... };
+        for (auto& child : schema_data->children) schema_data->children_pointers.push_back(&child);
+
+        std::unique_ptr<arrow_array_data> columns_data[n];
+        for (auto& data : columns_data) {
+            data = std::make_unique<arrow_array_data>();
+            data->owner = vec;
+        }
+        auto array_data = std::make_unique<arrow_array_data>();
+        array_data->owner = vec;
+        array_data->children.reserve(n);
+        array_data->children_pointers.resize(n);
+        ((columns_data[Is]->buffers[1] = arrow_buffer<Is>(*vec)), ...);
+
+        for (size_t i = 0; i < n; ++i) {
+            array_data->children.push_back(make_arrow_array(length, 2, std::move(columns_data[i])));
+            array_data->children_pointers[i] = &array_data->children[i];
+        }
+
+        auto const schema_ptr = schema_data.release();
+        *schema = { "+s", "", nullptr, 0, static_cast<int64_t>(n), schema_ptr->children_pointers.data(),
+            nullptr, &release_arrow_schema, schema_ptr };
+        *array = make_arrow_array(length, 1, std::move(array_data));
+    }
+
+} // ::detail
+
+// Exports the rows of the shared vector to 'array' and 'schema', which are released by the consumer.
+// The buffers point to the columns of the vector, which must not be modified until the arrays are released.
+// Throws std::bad_alloc if the structures can't be allocated, in which case 'array' and 'schema' are unchanged.
+template <class T, class Allocator, class Layout, size_t InlineRows, class Growth>
+void export_arrow(std::shared_ptr<vector<T, Allocator, Layout, InlineRows, Growth> const> vec,
+    ArrowArray* array, ArrowSchema* schema)
+{
+    static_assert(detail::has_arrow_columns_v<T>,
+        "soa::export_arrow requires members of arithmetic or enum types, with the bools in soa::packed<> columns");
+    using sequence = std::make_index_sequence<detail::arity_v<members<T>>>;
+    detail::export_arrow(std::move(vec), array, schema, sequence{});
+}
+
+// Exports the rows of the vector, which is moved (without copying it's columns) and kept alive by the arrays.
+template <class T, class Allocator, class Layout, size_t InlineRows, class Growth>
+void export_arrow(vector<T, Allocator, Layout, InlineRows, Growth> && vec, ArrowArray* array, ArrowSchema* schema) {
+    using vector_type = vector<T, Allocator, Layout, InlineRows, Growth>;
+    export_arrow(std::shared_ptr<vector_type const>{ std::make_shared<vector_type>(std::move(vec)) }, array, schema);
+}
+
+// Read-only columns of a struct array given through the Arrow C data interface, used in place without copies.
+// The children are matched to the members of T by their name, and must have the format of the member type,
+// no nulls and buffers aligned for their type. The view owns the array, and releases it when it is destroyed.
+// The columns are accessed with 'view.columns().name' or 'view->name', as const vector_spans.
+template <class T>
+class arrow_view : private detail::members_with_size<T> {
+public:
+    static_assert(detail::has_arrow_columns_v<T>,
+        "soa::arrow_view requires members of arithmetic or enum types");
+    static_assert(!detail::has_packed_columns_v<T>, "soa::arrow_view doesn't support soa::packed columns");
+
+    // The rows are read-only.
+    using value_type           = T;
+    using reference_type       = cref_proxy<T>;
+    using const_reference_type = cref_proxy<T>;
+    using const_iterator       = detail::proxy_iterator<arrow_view, true>;
+
+    // The number of T members.
+    static constexpr int components_count = detail::arity_v<members<T>>;
+
+    // An empty view.
+    arrow_view() noexcept;
+    // Takes the ownership of 'array' (it's release callback is then null), described by 'schema'.
+    // Throws std::invalid_argument if the array doesn't match T, in which case 'array' is unchanged.
+    arrow_view(ArrowArray* array, ArrowSchema const* schema);
+    arrow_view(arrow_view && rhs) noexcept;
+    arrow_view& operator=(arrow_view && rhs) noexcept;
+    arrow_view(arrow_view const&) = delete;
+    arrow_view& operator=(arrow_view const&) = delete;
+    ~arrow_view();
+
+    // Informations.
+    size_type size()  const noexcept { return this->size_; }
+    bool empty() const noexcept { return size() == 0; }
+
+    // Accessors.
+    const_reference_type operator[](size_type i) const noexcept { return *(begin() + i); }
+    const_reference_type at(size_type i) const { check_at(i); return *(begin() + i); }
+
+    // Iterators.
+    const_iterator begin()  const noexcept { return { this, 0 }; }
+    const_iterator cbegin() const noexcept { return begin(); }
+    const_iterator end()    const noexcept { return { this, size() }; }
+    const_iterator cend()   const noexcept { return end(); }
+
+    // Components accessors.
+    members<T> const& columns()    const noexcept { return *this; }
+    members<T> const* operator->() const noexcept { return this; }
+    template <size_t I>
+    auto const& get_span() const noexcept { return std::get<I>(detail::as_tuple(columns())); }
+private:
+    friend const_iterator;
+
+    using sequence_type = std::make_index_sequence<components_count>;
+
+    template <size_t...Is>
+    void import_columns(ArrowArray const& array, ArrowSchema const& schema, std::index_sequence<Is...>);
+    // Data of the I-th column, in the child of 'array' named as the I-th member.
+    template <size_t I>
+    static std::byte* column_data(ArrowArray const& array, ArrowSchema const& schema);
+
+    [[noreturn]] static void throw_invalid_array(std::string_view reason);
+    static bool has_nulls(ArrowArray const& array) noexcept {
+        return array.n_buffers > 0 && array.buffers[0] != nullptr && array.null_count != 0;
+    }
+    void check_at(size_type i) const {
+        if (i < 0 || i >= size()) detail::throw_out_of_range<arrow_view>(i, size());
+    }
+    void release() noexcept;
+
+    ArrowArray array_;
+};
+
+// Returns a view on the columns of 'array', described by 'schema'. The view takes the ownership of the array.
+template <class T>
+arrow_view<T> import_arrow(ArrowArray* array, ArrowSchema const* schema) {
+    return arrow_view<T>{ array, schema };
+}
+
+// soa::arrow_view implementation.
+
+template <class T>
+arrow_view<T>::arrow_view() noexcept :
+    detail::members_with_size<T>{},
+    array_{}
+{}
+
+template <class T>
+arrow_view<T>::arrow_view(ArrowArray* array, ArrowSchema const* schema) :
+    detail::members_with_size<T>{},
+    array_{}
+{
+    if (!array || !array->release || !schema || !schema->release) throw_invalid_array("released array");
+    import_columns(*array, *schema, sequence_type{});
+    array_ = *array;
+    array->release = nullptr;
+}
+
+template <class T>
+template <size_t...Is>
+void arrow_view<T>::import_columns(ArrowArray const& array, ArrowSchema const& schema, std::index_sequence<Is...>) {
+    if (std::strcmp(schema.format, "+s") != 0) throw_invalid_array("not a struct array");
+    if (array.n_children != schema.n_children) throw_invalid_array("children count mismatch");
+    if (array.length < 0 || array.offset < 0 || array.length > std::numeric_limits<size_type>::max())
+        throw_invalid_array("invalid length");
+    if (has_nulls(array)) throw_invalid_array("null rows");
+
+    auto const columns = members<T>{ column_data<Is>(array, schema)... };
+    static_cast<members<T>&>(*this) = columns;
+    this->set_size(static_cast<size_type>(array.length));
+}
+
+template <class T>
+template <size_t I>
+std::byte* arrow_view<T>::column_data(ArrowArray const& array, ArrowSchema const& schema) {
+    using namespace std::literals;
+    using type = detail::member_type_t<T, I>;
+    auto const name = detail::member_name_v<T, I>;
+    for (int64_t c = 0; c < schema.n_children; ++c) {
+        auto const& field = *schema.children[c];
+        if (!field.name || std::strcmp(field.name, name) != 0) continue;
+
+        auto const& child = *array.children[c];
+        if (std::strcmp(field.format, detail::arrow_column_format<T, I>()) != 0)
+            throw_invalid_array(detail::concatene("format mismatch for the column "sv, std::string_view{ name }));
+        if (child.n_buffers != 2 || has_nulls(child) || child.offset < 0 || child.length < array.offset + array.length)
+            throw_invalid_array(detail::concatene("invalid column "sv, std::string_view{ name }));
+
+        auto const data = static_cast<type const*>(child.buffers[1]) + (child.offset + array.offset);
+        if (reinterpret_cast<std::uintptr_t>(data) % alignof(type) != 0)
+            throw_invalid_array(detail::concatene("unaligned column "sv, std::string_view{ name }));
+        // The columns are only exposed as const.
+        return reinterpret_cast<std::byte*>(const_cast<type*>(data));
+    }
+    throw_invalid_array(detail::concatene("no column "sv, std::string_view{ name }));
+}
+
+template <class T>
+void arrow_view<T>::throw_invalid_array(std::string_view reason) {
+    using namespace std::literals;
+    throw std::invalid_argument{ detail::concatene(
+        detail::type_name<arrow_view>(), " can't import the Arrow array : "sv, reason) };
+}
+
+template <class T>
+arrow_view<T>::arrow_view(arrow_view && rhs) noexcept :
+    detail::members_with_size<T>{ static_cast<detail::members_with_size<T> const&>(rhs) },
+    array_{ rhs.array_ }
+{
+    static_cast<detail::members_with_size<T>&>(rhs) = {};
+    rhs.array_.release = nullptr;
+}
+
+template <class T>
+arrow_view<T>& arrow_view<T>::operator=(arrow_view && rhs) noexcept {
+    if (this == &rhs) return *this;
+    release();
+    static_cast<detail::members_with_size<T>&>(*this) = static_cast<detail::members_with_size<T> const&>(rhs);
+    array_ = rhs.array_;
+    static_cast<detail::members_with_size<T>&>(rhs) = {};
+    rhs.array_.release = nullptr;
+    return *this;
+}
+
+template <class T>
+arrow_view<T>::~arrow_view() {
+    release();
+}
+
+template <class T>
+void arrow_view<T>::release() noexcept {
+    if (array_.release) array_.release(&array_);
+    static_cast<detail::members_with_size<T>&>(*this) = {};
+    array_ = {};
+}
+
+} // namespace soa
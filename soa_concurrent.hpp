@@ -0,0 +1,371 @@
+/*
+    soa_concurrent.hpp
+    MIT license (2018)
+    Header repository : https://github.com/Dwarfobserver/soa_vector
+    You can contact me at sidney.congard@gmail.com
+ */
+
+#pragma once
+
+#include "soa_vector.hpp"
+#include <atomic>
+#include <exception>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+// Concurrent appends from several producers : the rows are reserved in ranges with an atomic
+// compare and swap, then each producer constructs it's rows directly in the columns of fixed-size
+// pages, which are never moved. The readers see the committed rows, which are fully constructed.
+
+namespace soa {
+
+namespace detail {
+
+    // Columns of the committed rows of a soa::concurrent_vector page.
+    template <class T>
+    class committed_page : public members_with_size<T> {
+    public:
+        committed_page(members<T> const& columns, size_type size) noexcept {
+            static_cast<members<T>&>(*this) = columns;
+            this->set_size(size);
+        }
+        size_type size() const noexcept { return this->size_; }
+    };
+
+} // ::detail
+
+// Stores up to 'max_rows' rows of T, appended concurrently by several threads.
+// The rows are stored in pages of 'PageRows' rows, each page having the columns layout of
+// a soa::vector<T, Allocator, Layout> of capacity 'PageRows'. The pages are allocated when
+// the rows are reserved, so the rows and their columns never move.
+// The producers reserve ranges of rows with 'reserve_slots(n)', construct them, then commit them :
+// the committed size advances in the order of the reservations, when all the previous ranges are
+// committed. The rows below size() can be read while the producers append the next ones.
+// The allocator is used concurrently by the producers.
+template <class T, size_t PageRows = 4096, class Allocator = std::allocator<T>, class Layout = layout<>>
+class concurrent_vector {
+public:
+    // The storage of each page.
+    using page_type = vector<T, Allocator, Layout>;
+
+    static_assert(PageRows > 0 && PageRows <= static_cast<size_t>(page_type::max_size()),
+        "soa::concurrent_vector pages must have between 1 and soa::vector<T>::max_size() rows");
+    // The producers construct the rows of their ranges concurrently, which can share the words of packed columns.
+    static_assert(!detail::has_packed_columns_v<T>, "soa::concurrent_vector doesn't support soa::packed columns");
+
+    using allocator_type = Allocator;
+    using layout_type    = Layout;
+
+    using value_type           = T;
+    using reference_type       = ref_proxy<T>;
+    using const_reference_type = cref_proxy<T>;
+
+    // The number of T members.
+    static constexpr int components_count = page_type::components_count;
+
+    // The number of rows of each page.
+    static constexpr size_type page_rows = static_cast<size_type>(PageRows);
+
+    // A range of reserved rows, constructed in order by a single producer.
+    class slots {
+        friend concurrent_vector;
+        slots(concurrent_vector& owner, size_type first, size_type last) noexcept :
+            owner_{ &owner }, first_{ first }, next_{ first }, last_{ last } {}
+    public:
+        slots(slots && rhs) noexcept;
+        slots(slots const&) = delete;
+        slots& operator=(slots const&) = delete;
+        slots& operator=(slots &&) = delete;
+        // Commits the rows if it wasn't done.
+        ~slots();
+
+        // The rows [first, last) of the vector.
+        size_type first() const noexcept { return first_; }
+        size_type last()  const noexcept { return last_; }
+        size_type size()  const noexcept { return last_ - first_; }
+        // The number of rows constructed.
+        size_type constructed() const noexcept { return next_ - first_; }
+
+        // Constructs the next row of the range, from it's components or default-constructed ones.
+        // It must be called at most size() times.
+        template <class...Ts>
+        void emplace_back(Ts &&...components);
+        void push_back(T const& value);
+        void push_back(T && value);
+
+        // Publishes the rows, after the ones reserved before. The rows which weren't constructed
+        // are value-initialized. It waits for the previous ranges to be committed.
+        void commit() noexcept;
+    private:
+        concurrent_vector* owner_;
+        size_type first_;
+        size_type next_;
+        size_type last_;
+    };
+
+    // Constructors.
+    // Throws std::length_error if 'max_rows' is greater than max_size().
+    explicit concurrent_vector(size_type max_rows, Allocator const& allocator = Allocator{});
+    concurrent_vector(concurrent_vector const&) = delete;
+    concurrent_vector& operator=(concurrent_vector const&) = delete;
+    // All the slots must have been committed.
+    ~concurrent_vector();
+
+    // Producers : these functions can be called concurrently.
+
+    // Reserves 'n' rows, and allocates their pages. Throws std::length_error if the
+    // reserved rows would exceed max_rows().
+    slots reserve_slots(size_type n);
+    // Appends a row and returns it's index : it's committed before returning.
+    // If the row construction throws, a value-initialized row is committed instead.
+    template <class...Ts>
+    size_type emplace_back(Ts &&...components);
+    size_type push_back(T const& value);
+    size_type push_back(T && value);
+
+    // Readers : the committed rows can be read concurrently with the producers.
+
+    // The number of committed rows.
+    size_type size() const noexcept { return committed_.load(std::memory_order_acquire); }
+    bool empty() const noexcept { return size() == 0; }
+    // The number of reserved rows, which can be greater than size().
+    size_type reserved_size() const noexcept { return reserved_.load(std::memory_order_relaxed); }
+    size_type max_rows() const noexcept { return max_rows_; }
+    // The maximum value of max_rows, for which the indices fit in size_type.
+    static constexpr size_type max_size() noexcept {
+        return std::numeric_limits<size_type>::max() / page_rows * page_rows;
+    }
+
+    allocator_type get_allocator() const noexcept { return allocator_; }
+
+    // Accessors, for the rows below size().
+    reference_type       operator[](size_type i)       noexcept { return make_proxy<reference_type>(page_of(i), i % page_rows); }
+    const_reference_type operator[](size_type i) const noexcept { return make_proxy<const_reference_type>(page_of(i), i % page_rows); }
+    reference_type       at(size_type i)       { check_at(i); return (*this)[i]; }
+    const_reference_type at(size_type i) const { check_at(i); return (*this)[i]; }
+
+    // Pages accessors : the columns of the page 'i' hold it's committed rows, from i * page_rows.
+    size_type pages_count() const noexcept { return (size() + page_rows - 1) / page_rows; }
+    detail::committed_page<T> page(size_type i) const noexcept;
+private:
+    using page_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<page_type>;
+    using page_traits    = std::allocator_traits<page_allocator>;
+
+    members<T> &      page_of(size_type i)       noexcept { return *pages_[static_cast<size_t>(i / page_rows)].load(std::memory_order_acquire); }
+    members<T> const& page_of(size_type i) const noexcept { return *pages_[static_cast<size_t>(i / page_rows)].load(std::memory_order_acquire); }
+
+    void check_at(size_type index) const;
+
+    // Allocates the page 'i' if no other producer did it.
+    void ensure_page(size_type i);
+    void delete_page(page_type* page) noexcept;
+
+    template <class Proxy, class Columns>
+    static Proxy make_proxy(Columns& columns, size_type offset) noexcept {
+        return std::apply([offset] (auto&...spans) { return Proxy{ spans.data()[offset]... }; },
+            detail::as_tuple(columns));
+    }
+
+    // Constructs the columns of the row 'i' : if a column throws, the previous ones are destroyed.
+    template <class...Ts>
+    void construct_row(size_type i, Ts &&...components);
+
+    // Waits for the rows before 'first' to be committed, then commits the rows up to 'last'.
+    void commit(size_type first, size_type last) noexcept;
+
+    Allocator allocator_;
+    page_allocator page_allocator_;
+    size_type max_rows_;
+    std::unique_ptr<std::atomic<page_type*>[]> pages_;
+    std::atomic<size_type> reserved_;
+    std::atomic<size_type> committed_;
+};
+
+// soa::concurrent_vector::slots implementation.
+
+template <class T, size_t PageRows, class Allocator, class Layout>
+concurrent_vector<T, PageRows, Allocator, Layout>::slots::slots(slots && rhs) noexcept :
+    owner_{ rhs.owner_ }, first_{ rhs.first_ }, next_{ rhs.next_ }, last_{ rhs.last_ }
+{
+    rhs.owner_ = nullptr;
+}
+
+template <class T, size_t PageRows, class Allocator, class Layout>
+concurrent_vector<T, PageRows, Allocator, Layout>::slots::~slots() {
+    commit();
+}
+
+template <class T, size_t PageRows, class Allocator, class Layout>
+template <class...Ts>
+void concurrent_vector<T, PageRows, Allocator, Layout>::slots::emplace_back(Ts &&...components) {
+    owner_->construct_row(next_, std::forward<Ts>(components)...);
+    ++next_;
+}
+
+template <class T, size_t PageRows, class Allocator, class Layout>
+void concurrent_vector<T, PageRows, Allocator, Layout>::slots::push_back(T const& value) {
+    std::apply([this] (auto const&...components) { emplace_back(components...); },
+        detail::as_tuple<components_count>(value));
+}
+
+template <class T, size_t PageRows, class Allocator, class Layout>
+void concurrent_vector<T, PageRows, Allocator, Layout>::slots::push_back(T && value) {
+    auto tuple = detail::as_tuple<components_count>(value);
+    std::apply([this] (auto&...components) { emplace_back(std::move(components)...); }, tuple);
+}
+
+template <class T, size_t PageRows, class Allocator, class Layout>
+void concurrent_vector<T, PageRows, Allocator, Layout>::slots::commit() noexcept {
+    if (!owner_) return;
+    if constexpr (std::is_default_constructible_v<T>) {
+        // A throwing default constructor terminates : the next ranges can't be committed without these rows.
+        while (next_ < last_) emplace_back();
+    }
+    else {
+        if (next_ < last_) std::terminate();
+    }
+    owner_->commit(first_, last_);
+    owner_ = nullptr;
+}
+
+// soa::concurrent_vector implementation.
+
+template <class T, size_t PageRows, class Allocator, class Layout>
+concurrent_vector<T, PageRows, Allocator, Layout>::concurrent_vector(size_type max_rows, Allocator const& allocator) :
+    allocator_     { allocator },
+    page_allocator_{ allocator },
+    max_rows_      { max_rows },
+    pages_         {},
+    reserved_      { 0 },
+    committed_     { 0 }
+{
+    using namespace std::literals;
+    if (max_rows < 0 || max_rows > max_size()) throw std::length_error{ detail::concatene(
+        detail::type_name<concurrent_vector>(), "::concurrent_vector : max_rows "sv, std::to_string(max_rows),
+        " exceeds max_size() = "sv, std::to_string(max_size())
+    )};
+    pages_ = std::make_unique<std::atomic<page_type*>[]>(static_cast<size_t>((max_rows + page_rows - 1) / page_rows));
+}
+
+template <class T, size_t PageRows, class Allocator, class Layout>
+concurrent_vector<T, PageRows, Allocator, Layout>::~concurrent_vector() {
+    auto const size = this->size();
+    auto const count = (max_rows_ + page_rows - 1) / page_rows;
+    for (size_type p = 0; p < count; ++p) {
+        auto const page = pages_[static_cast<size_t>(p)].load(std::memory_order_acquire);
+        if (!page) continue;
+        auto const rows = std::clamp(size - p * page_rows, size_type{ 0 }, page_rows);
+        detail::for_each(detail::as_tuple(static_cast<members<T>&>(*page)), [rows] (auto& span, auto) {
+            detail::destroy(span.data(), span.data() + rows);
+        });
+        delete_page(page);
+    }
+}
+
+template <class T, size_t PageRows, class Allocator, class Layout>
+typename concurrent_vector<T, PageRows, Allocator, Layout>::slots
+concurrent_vector<T, PageRows, Allocator, Layout>::reserve_slots(size_type n) {
+    using namespace std::literals;
+    auto first = reserved_.load(std::memory_order_relaxed);
+    do {
+        if (n < 0 || n > max_rows_ - first) throw std::length_error{ detail::concatene(
+            detail::type_name<concurrent_vector>(), "::reserve_slots : "sv, std::to_string(n),
+            " rows exceed max_rows() = "sv, std::to_string(max_rows_)
+        )};
+        // The pages are allocated before the rows are reserved, because the reserved rows must be committed.
+        // If another producer reserves them first, the pages are used by the next rows.
+        if (n > 0) {
+            for (auto p = first / page_rows; p <= (first + n - 1) / page_rows; ++p) ensure_page(p);
+        }
+    } while (!reserved_.compare_exchange_weak(first, first + n, std::memory_order_relaxed));
+    return { *this, first, first + n };
+}
+
+template <class T, size_t PageRows, class Allocator, class Layout>
+template <class...Ts>
+size_type concurrent_vector<T, PageRows, Allocator, Layout>::emplace_back(Ts &&...components) {
+    auto row = reserve_slots(1);
+    row.emplace_back(std::forward<Ts>(components)...);
+    row.commit();
+    return row.first();
+}
+
+template <class T, size_t PageRows, class Allocator, class Layout>
+size_type concurrent_vector<T, PageRows, Allocator, Layout>::push_back(T const& value) {
+    auto row = reserve_slots(1);
+    row.push_back(value);
+    row.commit();
+    return row.first();
+}
+
+template <class T, size_t PageRows, class Allocator, class Layout>
+size_type concurrent_vector<T, PageRows, Allocator, Layout>::push_back(T && value) {
+    auto row = reserve_slots(1);
+    row.push_back(std::move(value));
+    row.commit();
+    return row.first();
+}
+
+template <class T, size_t PageRows, class Allocator, class Layout>
+detail::committed_page<T> concurrent_vector<T, PageRows, Allocator, Layout>::page(size_type i) const noexcept {
+    auto const rows = std::min(size() - i * page_rows, page_rows);
+    return { page_of(i * page_rows), rows };
+}
+
+template <class T, size_t PageRows, class Allocator, class Layout>
+void concurrent_vector<T, PageRows, Allocator, Layout>::check_at(size_type i) const {
+    if (i < 0 || i >= size()) detail::throw_out_of_range<concurrent_vector>(i, size());
+}
+
+template <class T, size_t PageRows, class Allocator, class Layout>
+void concurrent_vector<T, PageRows, Allocator, Layout>::ensure_page(size_type i) {
+    auto& slot = pages_[static_cast<size_t>(i)];
+    if (slot.load(std::memory_order_acquire)) return;
+
+    auto const page = page_traits::allocate(page_allocator_, 1);
+    try {
+        page_traits::construct(page_allocator_, page, allocator_);
+        try {
+            page->reserve(page_rows);
+        }
+        catch (...) {
+            page_traits::destroy(page_allocator_, page);
+            throw;
+        }
+    }
+    catch (...) {
+        page_traits::deallocate(page_allocator_, page, 1);
+        throw;
+    }
+    // Another producer may have allocated the page meanwhile.
+    auto expected = static_cast<page_type*>(nullptr);
+    if (!slot.compare_exchange_strong(expected, page, std::memory_order_acq_rel)) delete_page(page);
+}
+
+template <class T, size_t PageRows, class Allocator, class Layout>
+void concurrent_vector<T, PageRows, Allocator, Layout>::delete_page(page_type* page) noexcept {
+    page_traits::destroy(page_allocator_, page);
+    page_traits::deallocate(page_allocator_, page, 1);
+}
+
+template <class T, size_t PageRows, class Allocator, class Layout>
+template <class...Ts>
+void concurrent_vector<T, PageRows, Allocator, Layout>::construct_row(size_type i, Ts &&...components) {
+    auto& page = page_of(i);
+    auto const offset = i % page_rows;
+    detail::construct_columns<components_count>([&page, offset] (auto index) {
+        return (page.*detail::span_pointer_v<T, decltype(index)::value>).data() + offset;
+    }, std::forward<Ts>(components)...);
+}
+
+template <class T, size_t PageRows, class Allocator, class Layout>
+void concurrent_vector<T, PageRows, Allocator, Layout>::commit(size_type first, size_type last) noexcept {
+    if (first == last) return;
+    // The rows of the previous ranges are published by the release of their producers.
+    while (committed_.load(std::memory_order_acquire) != first) std::this_thread::yield();
+    committed_.store(last, std::memory_order_release);
+}
+
+} // namespace soa
@@ -0,0 +1,561 @@
+/*
+    soa_indexed.hpp
+    MIT license (2018)
+    Header repository : https://github.com/Dwarfobserver/soa_vector
+    You can contact me at sidney.congard@gmail.com
+ */
+
+#pragma once
+
+#include "soa_vector.hpp"
+#include "soa_parallel.hpp"
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// Hash index on the key column of a soa::vector, kept in sync by the modifiers of soa::indexed_vector.
+// The index is an open addressing table with linear probing, whose slots hold the hash of a key and
+// it's row : the probes compare the hashes in the table, and only read the key column when they match.
+
+namespace soa {
+
+namespace detail {
+
+    template <class Pointer>
+    struct member_pointer_traits;
+    template <class M, class T>
+    struct member_pointer_traits<M T::*> {
+        using aggregate_type = T;
+        using member_type    = M;
+    };
+
+    // Column of the T member given by a pointer, or the number of columns if it isn't one.
+    template <class T, auto Member, size_t...Is>
+    constexpr size_t member_column(std::index_sequence<Is...>) noexcept {
+        using M = std::remove_const_t<typename member_pointer_traits<decltype(Member)>::member_type>;
+        auto result = sizeof...(Is);
+        auto const check = [&result] (auto index) {
+            if constexpr (std::is_same_v<member_type_t<T, decltype(index)::value>, M>) {
+                if (members<T>::member_pointer(index) == Member) result = decltype(index)::value;
+            }
+        };
+        (check(std::integral_constant<size_t, Is>{}), ...);
+        return result;
+    }
+
+    template <auto Member>
+    using key_type_t = std::remove_const_t<typename member_pointer_traits<decltype(Member)>::member_type>;
+
+    // Highest bits of the mixed hashes, as wide as the rows so a slot fits in 8 bytes with 32 bits sizes.
+    using index_hash = std::conditional_t<sizeof(size_type) <= 4, std::uint32_t, std::uint64_t>;
+    constexpr int index_hash_bits = static_cast<int>(sizeof(index_hash) * 8);
+
+    // Slot of the hash index, which is empty when 'row' is negative.
+    struct index_slot {
+        index_hash hash;
+        size_type row;
+    };
+    constexpr size_type empty_slot = -1;
+
+    // The slots are at most 3/4 full, and there are at least 16 of them.
+    constexpr size_t min_index_slots = 16;
+    constexpr size_t max_index_rows(size_t slots) noexcept { return slots / 4 * 3; }
+
+    // Highest power of two, after which the number of slots is no longer doubled.
+    constexpr size_t max_index_slots = std::numeric_limits<size_t>::max() / 2 + 1;
+
+    // Number of rows ahead of the inserted one whose slot is prefetched when all the rows are indexed.
+    constexpr size_type index_prefetch_rows = 8;
+
+} // ::detail
+
+// soa::vector of T with a hash index on the key member 'Key' (eg. '&T::id'), which must be unique.
+// The index is updated by the modifiers, and the rows are accessed as const proxies : the columns
+// are changed with get_span<I>(), except the key column which is only changed with set_key.
+// The soa::sort_by, soa::stable_sort_by, soa::permute and soa::erase_if algorithms reindex the rows.
+template <class T, auto Key,
+    class Hash = std::hash<detail::key_type_t<Key>>,
+    class KeyEqual = std::equal_to<detail::key_type_t<Key>>,
+    class Allocator = std::allocator<T>>
+class indexed_vector {
+public:
+    // The storage of the rows.
+    using vector_type = vector<T, Allocator>;
+
+    static_assert(std::is_same_v<typename detail::member_pointer_traits<decltype(Key)>::aggregate_type, T>,
+        "soa::indexed_vector<T, Key> requires a pointer to a member of T");
+
+    // The number of T members.
+    static constexpr int components_count = vector_type::components_count;
+
+    // The column of the key member.
+    static constexpr size_t key_index = detail::member_column<T, Key>(std::make_index_sequence<components_count>{});
+
+    static_assert(key_index < static_cast<size_t>(components_count),
+        "soa::indexed_vector<T, Key> key must be a member given to SOA_DEFINE_TYPE");
+    static_assert(!detail::is_packed_column_v<T, key_index>, "soa::indexed_vector doesn't support soa::packed keys");
+
+    using key_type       = detail::key_type_t<Key>;
+    using hasher         = Hash;
+    using key_equal      = KeyEqual;
+    using allocator_type = Allocator;
+
+    using value_type           = T;
+    using const_reference_type = cref_proxy<T>;
+
+    using iterator       = typename vector_type::const_iterator;
+    using const_iterator = typename vector_type::const_iterator;
+
+    // Constructors.
+    explicit indexed_vector(Hash const& hash = Hash{}, KeyEqual const& equal = KeyEqual{},
+        Allocator const& allocator = Allocator{});
+    // Indexes the rows, in a single pass with a table of the final size.
+    // Throws std::invalid_argument if two rows have the same key.
+    explicit indexed_vector(vector_type rows, Hash const& hash = Hash{}, KeyEqual const& equal = KeyEqual{});
+    // Same, with the hashes of the keys computed in parallel, eg. to load snapshots.
+    template <class Policy, class = detail::enable_if_policy_t<Policy>>
+    indexed_vector(Policy&& policy, vector_type rows, Hash const& hash = Hash{}, KeyEqual const& equal = KeyEqual{});
+    indexed_vector(indexed_vector && rhs) noexcept;
+    indexed_vector(indexed_vector const& rhs) = default;
+
+    // Assignments.
+    indexed_vector& operator=(indexed_vector && rhs) noexcept;
+    indexed_vector& operator=(indexed_vector const& rhs) = default;
+
+    // Size or capacity modifiers.
+    void clear() noexcept;
+    // Reserves the rows and the index slots, so 'capacity' rows are added without reallocations.
+    void reserve(size_type capacity);
+
+    // Add and remove elements.
+    // When the key of the added row is already indexed, they throw std::invalid_argument and the rows are unchanged.
+    template <class...Ts>
+    void emplace_back(Ts &&...components);
+    void push_back(T const& value);
+    void push_back(T && value);
+    void pop_back();
+    // Removes the row at 'pos' in O(1) by moving the last row in it's place, which is reindexed.
+    // Returns an iterator on 'pos'.
+    iterator swap_erase(const_iterator pos);
+    // Removes the row of the key with swap_erase. Returns false if there is none.
+    bool erase(key_type const& key);
+    // Removes the rows i for which 'keep[i]' is false (used by soa::erase_if), and reindexes the others.
+    // Returns the number of removed rows.
+    template <class Mask>
+    size_type compact(Mask const& keep);
+    // Calls 'f(rows)' with the vector of the rows, which must only be reordered (eg. sorted), then reindexes them.
+    // If the keys are not unique anymore, the rows are cleared and std::invalid_argument is thrown.
+    template <class F>
+    void reorder(F && f);
+
+    // Changes the key of the row i. Throws std::invalid_argument if the key is indexed for another row.
+    void set_key(size_type i, key_type key);
+
+    // Returns the rows, and leaves the vector empty.
+    vector_type extract() noexcept;
+
+    // Lookups.
+    // Returns the row of the key, or size() if there is none.
+    size_type find(key_type const& key) const;
+    bool contains(key_type const& key) const { return find(key) != size(); }
+
+    // Informations.
+    size_type size()     const noexcept { return rows_.size(); }
+    size_type capacity() const noexcept { return rows_.capacity(); }
+    bool empty() const noexcept { return rows_.empty(); }
+    static constexpr size_type max_size() noexcept { return vector_type::max_size(); }
+    // The number of slots of the index, a power of 2.
+    size_type slots_count() const noexcept { return static_cast<size_type>(slots_.size()); }
+
+    allocator_type get_allocator() const noexcept { return allocator_type{ rows_.get_allocator() }; }
+    hasher hash_function() const { return hash_; }
+    key_equal key_eq() const { return equal_; }
+
+    // Accessors.
+    const_reference_type operator[](size_type i) const noexcept { return rows_[i]; }
+    const_reference_type at(size_type i) const { return rows_.at(i); }
+    const_reference_type front() const noexcept { return rows_.front(); }
+    const_reference_type back()  const noexcept { return rows_.back(); }
+
+    // Iterators.
+    const_iterator begin()  const noexcept { return rows_.begin(); }
+    const_iterator cbegin() const noexcept { return rows_.begin(); }
+    const_iterator end()  const noexcept { return rows_.end(); }
+    const_iterator cend() const noexcept { return rows_.end(); }
+
+    // The rows, whose columns can be read with their name (eg. 'vec.rows().pos').
+    vector_type const& rows() const noexcept { return rows_; }
+
+    // Components accessors : the key column is const.
+    template <size_t I>
+    decltype(auto) get_span() noexcept {
+        if constexpr (I == key_index) return std::as_const(rows_).template get_span<I>();
+        else return rows_.template get_span<I>();
+    }
+    template <size_t I>
+    auto const& get_span() const noexcept { return rows_.template get_span<I>(); }
+private:
+    using slot_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<detail::index_slot>;
+    using slots_type = std::vector<detail::index_slot, slot_allocator>;
+
+    key_type const* keys() const noexcept { return rows_.template get_span<key_index>().data(); }
+    // The hashes are mixed by a multiplication and their highest bits are kept, which give their first slot.
+    detail::index_hash hash_of(key_type const& key) const {
+        auto const mixed = static_cast<std::uint64_t>(hash_(key)) * 0x9E3779B97F4A7C15u;
+        return static_cast<detail::index_hash>(mixed >> (64 - detail::index_hash_bits));
+    }
+    size_t home(detail::index_hash hash) const noexcept { return static_cast<size_t>(hash >> shift_); }
+    size_t mask() const noexcept { return slots_.size() - 1; }
+
+    // Returns the slot of the key, or slots_.size() if it isn't indexed.
+    size_t find_slot(key_type const& key, detail::index_hash hash) const;
+    // Returns the slot of the row i, which is indexed.
+    size_t slot_of(size_type i) const;
+    void insert_slot(detail::index_hash hash, size_type row) noexcept;
+    // Removes the slot by moving back the next slots of the same probe sequence, so no tombstone is needed.
+    void erase_slot(size_t slot) noexcept;
+    // Reallocates the index if it can't hold 'rows' rows.
+    void reserve_slots(size_type rows);
+    void resize_slots(slots_type& slots, size_t rows);
+
+    // Indexes all the rows.
+    template <class Policy>
+    void index_rows(Policy const& policy);
+    // Checks that a new row doesn't have an indexed key, and returns it's hash.
+    detail::index_hash check_new_key(key_type const& key) const;
+
+    vector_type rows_;
+    slots_type slots_;
+    int shift_ = detail::index_hash_bits;
+    Hash hash_;
+    KeyEqual equal_;
+};
+
+// Sorting and permutation overloads, which reindex the rows.
+template <size_t I, class T, auto Key, class Hash, class KeyEqual, class Allocator, class Compare = std::less<>>
+void sort_by(indexed_vector<T, Key, Hash, KeyEqual, Allocator>& vec, Compare cmp = {}) {
+    vec.reorder([&cmp] (auto& rows) { soa::sort_by<I>(rows, cmp); });
+}
+template <size_t I, class T, auto Key, class Hash, class KeyEqual, class Allocator, class Compare = std::less<>>
+void stable_sort_by(indexed_vector<T, Key, Hash, KeyEqual, Allocator>& vec, Compare cmp = {}) {
+    vec.reorder([&cmp] (auto& rows) { soa::stable_sort_by<I>(rows, cmp); });
+}
+template <class T, auto Key, class Hash, class KeyEqual, class Allocator, class M, class Compare = std::less<>>
+void sort_by(indexed_vector<T, Key, Hash, KeyEqual, Allocator>& vec, M T::* member, Compare cmp = {}) {
+    vec.reorder([member, &cmp] (auto& rows) { soa::sort_by(rows, member, cmp); });
+}
+template <class T, auto Key, class Hash, class KeyEqual, class Allocator, class M, class Compare = std::less<>>
+void stable_sort_by(indexed_vector<T, Key, Hash, KeyEqual, Allocator>& vec, M T::* member, Compare cmp = {}) {
+    vec.reorder([member, &cmp] (auto& rows) { soa::stable_sort_by(rows, member, cmp); });
+}
+template <class T, auto Key, class Hash, class KeyEqual, class Allocator, class Order>
+void permute(indexed_vector<T, Key, Hash, KeyEqual, Allocator>& vec, Order const& order) {
+    vec.reorder([&order] (auto& rows) { soa::permute(rows, order); });
+}
+
+// Implementation.
+
+template <class T, auto Key, class Hash, class KeyEqual, class Allocator>
+indexed_vector<T, Key, Hash, KeyEqual, Allocator>::indexed_vector(Hash const& hash, KeyEqual const& equal, Allocator const& allocator) :
+    rows_{ allocator },
+    slots_{ slot_allocator{ allocator } },
+    hash_{ hash },
+    equal_{ equal }
+{}
+
+template <class T, auto Key, class Hash, class KeyEqual, class Allocator>
+indexed_vector<T, Key, Hash, KeyEqual, Allocator>::indexed_vector(vector_type rows, Hash const& hash, KeyEqual const& equal) :
+    indexed_vector{ execution::seq, std::move(rows), hash, equal }
+{}
+
+template <class T, auto Key, class Hash, class KeyEqual, class Allocator>
+template <class Policy, class>
+indexed_vector<T, Key, Hash, KeyEqual, Allocator>::indexed_vector(Policy&& policy, vector_type rows, Hash const& hash, KeyEqual const& equal) :
+    rows_{ std::move(rows) },
+    slots_{ slot_allocator{ rows_.get_allocator() } },
+    hash_{ hash },
+    equal_{ equal }
+{
+    index_rows(execution::detail::to_policy(policy));
+}
+
+template <class T, auto Key, class Hash, class KeyEqual, class Allocator>
+indexed_vector<T, Key, Hash, KeyEqual, Allocator>::indexed_vector(indexed_vector && rhs) noexcept :
+    rows_{ std::move(rhs.rows_) },
+    slots_{ std::move(rhs.slots_) },
+    shift_{ rhs.shift_ },
+    hash_{ rhs.hash_ },
+    equal_{ rhs.equal_ }
+{
+    rhs.clear();
+}
+
+template <class T, auto Key, class Hash, class KeyEqual, class Allocator>
+indexed_vector<T, Key, Hash, KeyEqual, Allocator>& indexed_vector<T, Key, Hash, KeyEqual, Allocator>::operator=(indexed_vector && rhs) noexcept {
+    if (this == &rhs) return *this;
+    rows_ = std::move(rhs.rows_);
+    slots_ = std::move(rhs.slots_);
+    shift_ = rhs.shift_;
+    hash_ = rhs.hash_;
+    equal_ = rhs.equal_;
+    rhs.clear();
+    return *this;
+}
+
+template <class T, auto Key, class Hash, class KeyEqual, class Allocator>
+void indexed_vector<T, Key, Hash, KeyEqual, Allocator>::clear() noexcept {
+    rows_.clear();
+    for (auto& slot : slots_) slot.row = detail::empty_slot;
+}
+
+template <class T, auto Key, class Hash, class KeyEqual, class Allocator>
+void indexed_vector<T, Key, Hash, KeyEqual, Allocator>::reserve(size_type capacity) {
+    if (capacity <= this->capacity()) return;
+    if (capacity > max_size()) {
+        using namespace std::literals;
+        throw std::length_error{ detail::concatene(
+            "Capacity of "sv, std::to_string(capacity), " given to soa::indexed_vector<"sv,
+            detail::type_name<T>(), ">::reserve exceeds max_size() = "sv, std::to_string(max_size())
+        )};
+    }
+    reserve_slots(capacity);
+    rows_.reserve(capacity);
+}
+
+template <class T, auto Key, class Hash, class KeyEqual, class Allocator>
+template <class...Ts>
+void indexed_vector<T, Key, Hash, KeyEqual, Allocator>::emplace_back(Ts &&...components) {
+    reserve_slots(size() + 1);
+    rows_.emplace_back(std::forward<Ts>(components)...);
+    auto hash = detail::index_hash{};
+    try {
+        hash = check_new_key(keys()[size() - 1]);
+    }
+    catch (...) {
+        rows_.pop_back();
+        throw;
+    }
+    insert_slot(hash, size() - 1);
+}
+
+template <class T, auto Key, class Hash, class KeyEqual, class Allocator>
+void indexed_vector<T, Key, Hash, KeyEqual, Allocator>::push_back(T const& value) {
+    auto const hash = check_new_key(value.*Key);
+    reserve_slots(size() + 1);
+    rows_.push_back(value);
+    insert_slot(hash, size() - 1);
+}
+
+template <class T, auto Key, class Hash, class KeyEqual, class Allocator>
+void indexed_vector<T, Key, Hash, KeyEqual, Allocator>::push_back(T && value) {
+    auto const hash = check_new_key(value.*Key);
+    reserve_slots(size() + 1);
+    rows_.push_back(std::move(value));
+    insert_slot(hash, size() - 1);
+}
+
+template <class T, auto Key, class Hash, class KeyEqual, class Allocator>
+void indexed_vector<T, Key, Hash, KeyEqual, Allocator>::pop_back() {
+    erase_slot(slot_of(size() - 1));
+    rows_.pop_back();
+}
+
+template <class T, auto Key, class Hash, class KeyEqual, class Allocator>
+typename indexed_vector<T, Key, Hash, KeyEqual, Allocator>::iterator
+indexed_vector<T, Key, Hash, KeyEqual, Allocator>::swap_erase(const_iterator pos) {
+    auto const i = static_cast<size_type>(pos - begin());
+    auto const last = size() - 1;
+    auto const slot = slot_of(i);
+    // The last row takes the place of the erased one.
+    if (i != last) slots_[slot_of(last)].row = i;
+    erase_slot(slot);
+    rows_.swap_erase(rows_.begin() + i);
+    return begin() + i;
+}
+
+template <class T, auto Key, class Hash, class KeyEqual, class Allocator>
+bool indexed_vector<T, Key, Hash, KeyEqual, Allocator>::erase(key_type const& key) {
+    auto const i = find(key);
+    if (i == size()) return false;
+    swap_erase(begin() + i);
+    return true;
+}
+
+template <class T, auto Key, class Hash, class KeyEqual, class Allocator>
+template <class Mask>
+size_type indexed_vector<T, Key, Hash, KeyEqual, Allocator>::compact(Mask const& keep) {
+    size_type removed = 0;
+    reorder([&keep, &removed] (vector_type& rows) { removed = rows.compact(keep); });
+    return removed;
+}
+
+template <class T, auto Key, class Hash, class KeyEqual, class Allocator>
+template <class F>
+void indexed_vector<T, Key, Hash, KeyEqual, Allocator>::reorder(F && f) {
+    try {
+        f(rows_);
+        index_rows(execution::seq);
+    }
+    catch (...) {
+        clear();
+        throw;
+    }
+}
+
+template <class T, auto Key, class Hash, class KeyEqual, class Allocator>
+void indexed_vector<T, Key, Hash, KeyEqual, Allocator>::set_key(size_type i, key_type key) {
+    auto const hash = hash_of(key);
+    auto const slot = find_slot(key, hash);
+    if (slot != slots_.size()) {
+        if (slots_[slot].row == i) return;
+        using namespace std::literals;
+        throw std::invalid_argument{ detail::concatene(
+            "Key of another row given to soa::indexed_vector<"sv, detail::type_name<T>(), ">::set_key"sv
+        )};
+    }
+    erase_slot(slot_of(i));
+    insert_slot(hash, i);
+    rows_.template get_span<key_index>()[i] = std::move(key);
+}
+
+template <class T, auto Key, class Hash, class KeyEqual, class Allocator>
+typename indexed_vector<T, Key, Hash, KeyEqual, Allocator>::vector_type
+indexed_vector<T, Key, Hash, KeyEqual, Allocator>::extract() noexcept {
+    auto result = std::move(rows_);
+    clear();
+    return result;
+}
+
+template <class T, auto Key, class Hash, class KeyEqual, class Allocator>
+size_type indexed_vector<T, Key, Hash, KeyEqual, Allocator>::find(key_type const& key) const {
+    if (empty()) return 0;
+    auto const slot = find_slot(key, hash_of(key));
+    return slot == slots_.size() ? size() : slots_[slot].row;
+}
+
+template <class T, auto Key, class Hash, class KeyEqual, class Allocator>
+size_t indexed_vector<T, Key, Hash, KeyEqual, Allocator>::find_slot(key_type const& key, detail::index_hash hash) const {
+    if (slots_.empty()) return 0;
+    auto const keys = this->keys();
+    for (auto slot = home(hash);; slot = (slot + 1) & mask()) {
+        auto const& s = slots_[slot];
+        if (s.row == detail::empty_slot) return slots_.size();
+        if (s.hash == hash && equal_(keys[s.row], key)) return slot;
+    }
+}
+
+template <class T, auto Key, class Hash, class KeyEqual, class Allocator>
+size_t indexed_vector<T, Key, Hash, KeyEqual, Allocator>::slot_of(size_type i) const {
+    auto slot = home(hash_of(keys()[i]));
+    while (slots_[slot].row != i) slot = (slot + 1) & mask();
+    return slot;
+}
+
+template <class T, auto Key, class Hash, class KeyEqual, class Allocator>
+void indexed_vector<T, Key, Hash, KeyEqual, Allocator>::insert_slot(detail::index_hash hash, size_type row) noexcept {
+    auto slot = home(hash);
+    while (slots_[slot].row != detail::empty_slot) slot = (slot + 1) & mask();
+    slots_[slot] = { hash, row };
+}
+
+template <class T, auto Key, class Hash, class KeyEqual, class Allocator>
+void indexed_vector<T, Key, Hash, KeyEqual, Allocator>::erase_slot(size_t slot) noexcept {
+    auto hole = slot;
+    for (auto next = (slot + 1) & mask(); slots_[next].row != detail::empty_slot; next = (next + 1) & mask()) {
+        // The next slot can fill the hole if it's first slot is not between the hole and itself.
+        if (((next - home(slots_[next].hash)) & mask()) >= ((next - hole) & mask())) {
+            slots_[hole] = slots_[next];
+            hole = next;
+        }
+    }
+    slots_[hole].row = detail::empty_slot;
+}
+
+template <class T, auto Key, class Hash, class KeyEqual, class Allocator>
+void indexed_vector<T, Key, Hash, KeyEqual, Allocator>::reserve_slots(size_type rows) {
+    if (rows <= 0 || static_cast<size_t>(rows) <= detail::max_index_rows(slots_.size())) return;
+    if (rows > max_size()) {
+        using namespace std::literals;
+        throw std::length_error{ detail::concatene(
+            "soa::indexed_vector<"sv, detail::type_name<T>(), "> exceeds max_size() = "sv, std::to_string(max_size())
+        )};
+    }
+    auto slots = slots_type{ slots_.get_allocator() };
+    // The number of slots is at least doubled.
+    resize_slots(slots, std::max(static_cast<size_t>(rows), slots_.size()));
+    // The rehash reuses the hashes of the slots.
+    std::swap(slots, slots_);
+    for (auto const& slot : slots) {
+        if (slot.row != detail::empty_slot) insert_slot(slot.hash, slot.row);
+    }
+}
+
+template <class T, auto Key, class Hash, class KeyEqual, class Allocator>
+void indexed_vector<T, Key, Hash, KeyEqual, Allocator>::resize_slots(slots_type& slots, size_t rows) {
+    auto count = detail::min_index_slots;
+    auto bits = 4;
+    while (detail::max_index_rows(count) < rows && count < detail::max_index_slots) {
+        count *= 2;
+        ++bits;
+    }
+    slots.assign(count, { 0, detail::empty_slot });
+    shift_ = detail::index_hash_bits - bits;
+}
+
+template <class T, auto Key, class Hash, class KeyEqual, class Allocator>
+template <class Policy>
+void indexed_vector<T, Key, Hash, KeyEqual, Allocator>::index_rows(Policy const& policy) {
+    auto const n = size();
+    auto hashes = std::vector<detail::index_hash>(static_cast<size_t>(n));
+    auto const columns = std::array<detail::column_bytes, 1>{ detail::make_column_bytes(hashes.data()) };
+    auto const chunks = detail::plan_chunks(policy, n, columns);
+    auto body = [this, &hashes] (int, size_type first, size_type last) {
+        auto const keys = this->keys();
+        for (auto i = first; i < last; ++i) hashes[static_cast<size_t>(i)] = hash_of(keys[i]);
+    };
+    detail::run_chunks(policy, chunks, body);
+
+    // The table is allocated for the capacity, so the next rows don't rehash it.
+    auto slots = slots_type{ slots_.get_allocator() };
+    auto const shift = shift_;
+    resize_slots(slots, static_cast<size_t>(std::max(n, capacity())));
+    std::swap(slots, slots_);
+    try {
+        for (size_type i = 0; i < n; ++i) {
+            auto const hash = hashes[static_cast<size_t>(i)];
+        #if defined(__GNUC__) || defined(__clang__)
+            if (i + detail::index_prefetch_rows < n)
+                __builtin_prefetch(slots_.data() + home(hashes[static_cast<size_t>(i + detail::index_prefetch_rows)]));
+        #endif
+            if (find_slot(keys()[i], hash) != slots_.size()) {
+                using namespace std::literals;
+                throw std::invalid_argument{ detail::concatene(
+                    "Rows with the same key given to soa::indexed_vector<"sv, detail::type_name<T>(), ">"sv
+                )};
+            }
+            insert_slot(hash, i);
+        }
+    }
+    catch (...) {
+        std::swap(slots, slots_);
+        shift_ = shift;
+        throw;
+    }
+}
+
+template <class T, auto Key, class Hash, class KeyEqual, class Allocator>
+detail::index_hash indexed_vector<T, Key, Hash, KeyEqual, Allocator>::check_new_key(key_type const& key) const {
+    auto const hash = hash_of(key);
+    if (find_slot(key, hash) != slots_.size()) {
+        using namespace std::literals;
+        throw std::invalid_argument{ detail::concatene(
+            "Row with an indexed key added to soa::indexed_vector<"sv, detail::type_name<T>(), ">"sv
+        )};
+    }
+    return hash;
+}
+
+} // namespace soa
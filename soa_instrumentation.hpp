@@ -0,0 +1,136 @@
+/*
+    soa_instrumentation.hpp
+    MIT license (2018)
+    Header repository : https://github.com/Dwarfobserver/soa_vector
+    You can contact me at sidney.congard@gmail.com
+ */
+
+#pragma once
+
+#include "soa_vector.hpp"
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <iostream>
+
+// Aggregation of the soa::vector instrumentation events (see soa::instrumentation).
+// The events are only emitted when SOA_INSTRUMENTATION is defined.
+
+namespace soa::instrumentation {
+
+// Counters of the events of all the vectors of a type.
+struct type_stats {
+    long long allocations       = 0;
+    long long deallocations     = 0;
+    long long allocated_bytes   = 0;
+    long long deallocated_bytes = 0;
+
+    // Reallocations by cause.
+    long long reserves       = 0;
+    long long grows          = 0;
+    long long shrinks        = 0;
+    long long moved_rows     = 0;
+    long long moved_bytes    = 0;
+    // Bytes moved by the reallocations, per column.
+    std::vector<long long> moved_column_bytes;
+
+    long long copies       = 0;
+    long long copied_rows  = 0;
+    long long copied_bytes = 0;
+
+    // The greatest capacity reached.
+    size_type max_capacity = 0;
+};
+
+// Sink aggregating the events per type, which can be shared by several threads.
+class stats {
+public:
+    using map_type = std::map<std::string, type_stats, std::less<>>;
+
+    void record(event const& e) {
+        std::lock_guard<std::mutex> lock{ mutex_ };
+        auto it = stats_.find(e.type);
+        if (it == stats_.end()) it = stats_.emplace(std::string{ e.type }, type_stats{}).first;
+        auto& s = it->second;
+        s.max_capacity = std::max({ s.max_capacity, e.old_capacity, e.new_capacity });
+
+        auto const bytes = static_cast<long long>(e.bytes);
+        switch (e.kind) {
+        case event_kind::allocate:
+            ++s.allocations;
+            s.allocated_bytes += bytes;
+            return;
+        case event_kind::deallocate:
+            ++s.deallocations;
+            s.deallocated_bytes += bytes;
+            return;
+        case event_kind::copy_construct:
+        case event_kind::copy_assign:
+            ++s.copies;
+            s.copied_rows  += e.rows;
+            s.copied_bytes += bytes;
+            return;
+        case event_kind::reserve:       ++s.reserves; break;
+        case event_kind::grow:          ++s.grows;    break;
+        case event_kind::shrink_to_fit: ++s.shrinks;  break;
+        }
+        s.moved_rows  += e.rows;
+        s.moved_bytes += bytes;
+        s.moved_column_bytes.resize(std::max(s.moved_column_bytes.size(), e.columns_count));
+        for (size_t i = 0; i < e.columns_count; ++i) {
+            s.moved_column_bytes[i] += static_cast<long long>(e.column_bytes[i]);
+        }
+    }
+
+    map_type snapshot() const {
+        std::lock_guard<std::mutex> lock{ mutex_ };
+        return stats_;
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock{ mutex_ };
+        stats_.clear();
+    }
+
+    // Writes a line per type.
+    void dump(std::ostream& os) const {
+        for (auto const& [type, s] : snapshot()) {
+            os << type << " : " << s.allocations << " allocations (" << s.allocated_bytes << " bytes), "
+                << s.deallocations << " deallocations (" << s.deallocated_bytes << " bytes), "
+                << s.reserves << " reserves, " << s.grows << " grows, " << s.shrinks << " shrinks ("
+                << s.moved_rows << " rows, " << s.moved_bytes << " bytes moved";
+            if (!s.moved_column_bytes.empty()) {
+                os << " :";
+                for (auto const bytes : s.moved_column_bytes) os << ' ' << bytes;
+            }
+            os << "), " << s.copies << " copies (" << s.copied_rows << " rows, " << s.copied_bytes
+                << " bytes), max capacity " << s.max_capacity << '\n';
+        }
+    }
+private:
+    mutable std::mutex mutex_;
+    map_type stats_;
+};
+
+// Stats used by 'global_sink'.
+inline stats& global_stats() {
+    static stats instance;
+    return instance;
+}
+
+inline void global_sink(event const& e) noexcept {
+    // The events are lost if the stats can't allocate.
+    try {
+        global_stats().record(e);
+    }
+    catch (...) {}
+}
+
+// Sets 'global_sink' as the sink, and dumps the global stats to std::cerr at exit.
+inline void dump_at_exit() {
+    global_stats();
+    set_sink(global_sink);
+    std::atexit([] { global_stats().dump(std::cerr); });
+}
+
+} // namespace soa::instrumentation
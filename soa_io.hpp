@@ -0,0 +1,757 @@
+/*
+    soa_io.hpp
+    MIT license (2018)
+    Header repository : https://github.com/Dwarfobserver/soa_vector
+    You can contact me at sidney.congard@gmail.com
+ */
+
+#pragma once
+
+#include "soa_vector.hpp"
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <limits>
+#include <optional>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#if __has_include(<sys/mman.h>)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define SOA_IO_HAS_MMAP
+#endif
+
+// Columnar file format for soa::vector of trivially copyable members.
+// The file starts with a header giving the schema hash, the rows count and the position of each column,
+// followed by the columns data. Each column starts on an aligned offset, so the file can be mapped
+// in memory and it's columns used in place by soa::mapped_view.
+// The data is written with the native byte order and types representation.
+//
+// Tables can also be streamed to std::ostream or file descriptors with soa::stream_encoder, and read
+// back with soa::stream_decoder. The rows are sent in chunks, each chunk holding the columns one after
+// the other : trivially copyable columns are written from and read to their arrays directly, the other
+// columns use a soa::codec.
+
+namespace soa {
+
+namespace io {
+
+// Alignment in bytes of the columns offsets in the file, at least the column alignment.
+inline constexpr size_t file_alignment = 64;
+
+inline constexpr char     magic[8] = { 'S', 'O', 'A', 'V', 'E', 'C', '\0', '\0' };
+inline constexpr uint32_t version = 1;
+// Written as it is, to detect files from machines with a different byte order.
+inline constexpr uint32_t byte_order_mark = 0x01020304;
+
+struct file_header {
+    char     magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t schema_hash;
+    uint64_t rows_count;
+    uint32_t columns_count;
+    uint32_t reserved;
+};
+
+struct column_header {
+    uint64_t offset;
+    uint64_t nb_bytes;
+    uint32_t alignment;
+    uint32_t element_size;
+};
+
+} // ::io
+
+namespace detail {
+
+    // FNV-1a hash.
+    constexpr uint64_t fnv_offset = 14695981039346656037ull;
+    inline uint64_t fnv_hash(void const* data, size_t size, uint64_t hash = fnv_offset) noexcept {
+        auto const bytes = static_cast<unsigned char const*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+        return hash;
+    }
+    template <class T>
+    uint64_t fnv_hash_value(T const& value, uint64_t hash) noexcept {
+        return detail::fnv_hash(&value, sizeof(T), hash);
+    }
+
+    template <class T, size_t...Is>
+    uint64_t schema_hash(std::index_sequence<Is...>) {
+        auto const name = detail::type_name<T>();
+        auto hash = detail::fnv_hash(name.data(), name.size());
+        auto const add_column = [&hash] (auto tag, size_t alignment) {
+            using type = typename decltype(tag)::type;
+            auto const type_name = detail::type_name<type>();
+            hash = detail::fnv_hash(type_name.data(), type_name.size(), hash);
+            hash = detail::fnv_hash_value(static_cast<uint64_t>(sizeof(type)), hash);
+            hash = detail::fnv_hash_value(static_cast<uint64_t>(alignment), hash);
+        };
+        (add_column(type_tag<member_type_t<T, Is>>{}, column_alignment_v<T, layout<>, Is>), ...);
+        return hash;
+    }
+
+    // Alignment of the I-th column in the file.
+    template <class T, size_t I>
+    constexpr size_t file_column_alignment_v = std::max(io::file_alignment, column_alignment_v<T, layout<>, I>);
+
+    template <class T, size_t...Is>
+    constexpr bool trivially_copyable_members(std::index_sequence<Is...>) noexcept {
+        return (std::is_trivially_copyable_v<member_type_t<T, Is>> && ...);
+    }
+    template <class T>
+    constexpr bool has_trivially_copyable_members_v =
+        detail::trivially_copyable_members<T>(std::make_index_sequence<arity_v<members<T>>>{});
+
+    // Header and columns headers of a file holding 'rows' rows of T.
+    template <size_t N>
+    struct file_headers {
+        io::file_header header;
+        io::column_header columns[N];
+    };
+    template <class T, size_t...Is>
+    auto make_file_headers(size_type rows, std::index_sequence<Is...>) {
+        constexpr auto count = sizeof...(Is);
+        auto headers = file_headers<count>{};
+        std::memcpy(headers.header.magic, io::magic, sizeof(io::magic));
+        headers.header.version       = io::version;
+        headers.header.byte_order    = io::byte_order_mark;
+        headers.header.schema_hash   = detail::schema_hash<T>(std::index_sequence<Is...>{});
+        headers.header.rows_count    = static_cast<uint64_t>(rows);
+        headers.header.columns_count = static_cast<uint32_t>(count);
+
+        auto offset = static_cast<uint64_t>(sizeof(headers));
+        auto const add_column = [&offset, rows] (io::column_header& column, size_t alignment, size_t size) {
+            offset = detail::align_up(offset, alignment);
+            column.offset       = offset;
+            column.nb_bytes     = static_cast<uint64_t>(rows) * size;
+            column.alignment    = static_cast<uint32_t>(alignment);
+            column.element_size = static_cast<uint32_t>(size);
+            offset += column.nb_bytes;
+        };
+        (add_column(headers.columns[Is], file_column_alignment_v<T, Is>, sizeof(member_type_t<T, Is>)), ...);
+        return headers;
+    }
+
+    template <class T>
+    [[noreturn]]
+    void throw_invalid_file(std::string const& path, std::string_view reason) {
+        using namespace std::literals;
+        throw std::runtime_error{ detail::concatene(
+            "Invalid file '"sv, path, "' given to "sv, detail::type_name<T>(), " : "sv, reason
+        )};
+    }
+
+    template <class T, class Vector, size_t...Is>
+    void save(Vector const& vec, std::string const& path, std::index_sequence<Is...> seq) {
+        using namespace std::literals;
+        auto const headers = detail::make_file_headers<T>(vec.size(), seq);
+
+        auto file = std::ofstream{ path, std::ios::binary | std::ios::trunc };
+        if (!file) throw std::system_error{ errno, std::generic_category(), detail::concatene(
+            "soa::save can't open '"sv, path, "'"sv) };
+
+        // The columns are written from their arrays, with zeros between them.
+        static constexpr char padding[io::file_alignment] = {};
+        auto position = static_cast<uint64_t>(sizeof(headers));
+        file.write(reinterpret_cast<char const*>(&headers), sizeof(headers));
+        auto const write_column = [&] (io::column_header const& column, void const* data) {
+            while (position < column.offset) {
+                auto const n = std::min<uint64_t>(column.offset - position, sizeof(padding));
+                file.write(padding, static_cast<std::streamsize>(n));
+                position += n;
+            }
+            file.write(static_cast<char const*>(data), static_cast<std::streamsize>(column.nb_bytes));
+            position += column.nb_bytes;
+        };
+        (write_column(headers.columns[Is], vec.template get_span<Is>().data()), ...);
+
+        file.flush();
+        if (!file) throw std::system_error{ errno, std::generic_category(), detail::concatene(
+            "soa::save failed to write '"sv, path, "'"sv) };
+    }
+
+} // ::detail
+
+// Writes the vector in a file at 'path', which can be loaded with soa::mapped_view<T>.
+// The members of T must be trivially copyable. Throws std::system_error if the file can't be written.
+template <class T, class Allocator, class Layout, size_t InlineRows, class Growth>
+void save(vector<T, Allocator, Layout, InlineRows, Growth> const& vec, std::string const& path) {
+    static_assert(detail::has_trivially_copyable_members_v<T>,
+        "soa::save requires the members of T to be trivially copyable");
+    static_assert(!detail::has_packed_columns_v<T>, "soa::save doesn't support soa::packed columns");
+    using sequence = std::make_index_sequence<detail::arity_v<members<T>>>;
+    detail::save<T>(vec, path, sequence{});
+}
+
+#if defined(SOA_IO_HAS_MMAP)
+
+// Read-only view on a file written by soa::save, mapped in memory : the columns are used in place
+// without copies, and the pages are shared between the processes mapping the same file.
+// The columns are accessed with 'view.columns().name' or 'view->name', as const vector_spans.
+template <class T>
+class mapped_view : private detail::members_with_size<T> {
+public:
+    static_assert(detail::has_trivially_copyable_members_v<T>,
+        "soa::mapped_view requires the members of T to be trivially copyable");
+    static_assert(!detail::has_packed_columns_v<T>, "soa::mapped_view doesn't support soa::packed columns");
+
+    // The rows are read-only.
+    using value_type           = T;
+    using reference_type       = cref_proxy<T>;
+    using const_reference_type = cref_proxy<T>;
+    using const_iterator       = detail::proxy_iterator<mapped_view, true>;
+
+    // The number of T members.
+    static constexpr int components_count = detail::arity_v<members<T>>;
+
+    // Maps the file at 'path'. Throws std::system_error if the file can't be mapped,
+    // or std::runtime_error if it's header doesn't match T.
+    explicit mapped_view(std::string const& path);
+    mapped_view(mapped_view && rhs) noexcept;
+    mapped_view& operator=(mapped_view && rhs) noexcept;
+    mapped_view(mapped_view const&) = delete;
+    mapped_view& operator=(mapped_view const&) = delete;
+    ~mapped_view();
+
+    // Informations.
+    size_type size()  const noexcept { return this->size_; }
+    bool empty() const noexcept { return size() == 0; }
+
+    // Accessors.
+    const_reference_type operator[](size_type i) const noexcept { return *(begin() + i); }
+    const_reference_type at(size_type i) const { check_at(i); return *(begin() + i); }
+
+    // Iterators.
+    const_iterator begin()  const noexcept { return { this, 0 }; }
+    const_iterator cbegin() const noexcept { return begin(); }
+    const_iterator end()    const noexcept { return { this, size() }; }
+    const_iterator cend()   const noexcept { return end(); }
+
+    // Components accessors.
+    members<T> const& columns()    const noexcept { return *this; }
+    members<T> const* operator->() const noexcept { return this; }
+    template <size_t I>
+    auto const& get_span() const noexcept { return std::get<I>(detail::as_tuple(columns())); }
+private:
+    friend const_iterator;
+
+    using sequence_type = std::make_index_sequence<components_count>;
+
+    template <size_t...Is>
+    void map_columns(std::string const& path, std::index_sequence<Is...>);
+
+    void check_at(size_type i) const {
+        if (i < 0 || i >= size()) detail::throw_out_of_range<mapped_view>(i, size());
+    }
+    void unmap() noexcept;
+
+    void*  data_;
+    size_t nb_bytes_;
+};
+
+template <class T>
+mapped_view<T>::mapped_view(std::string const& path) :
+    detail::members_with_size<T>{},
+    data_    { nullptr },
+    nb_bytes_{ 0 }
+{
+    using namespace std::literals;
+    auto const fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw std::system_error{ errno, std::generic_category(), detail::concatene(
+        "soa::mapped_view can't open '"sv, path, "'"sv) };
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        auto const error = errno;
+        ::close(fd);
+        throw std::system_error{ error, std::generic_category(), "soa::mapped_view can't stat the file" };
+    }
+    nb_bytes_ = static_cast<size_t>(info.st_size);
+    if (nb_bytes_ < sizeof(io::file_header)) {
+        ::close(fd);
+        detail::throw_invalid_file<mapped_view>(path, "file too small"sv);
+    }
+    data_ = ::mmap(nullptr, nb_bytes_, PROT_READ, MAP_SHARED, fd, 0);
+    auto const error = errno;
+    // The mapping holds it's own reference on the file.
+    ::close(fd);
+    if (data_ == MAP_FAILED) {
+        data_ = nullptr;
+        throw std::system_error{ error, std::generic_category(), "soa::mapped_view can't map the file" };
+    }
+    try {
+        map_columns(path, sequence_type{});
+    }
+    catch (...) {
+        unmap();
+        throw;
+    }
+}
+
+template <class T>
+template <size_t...Is>
+void mapped_view<T>::map_columns(std::string const& path, std::index_sequence<Is...> seq) {
+    using namespace std::literals;
+    auto const bytes = static_cast<std::byte const*>(data_);
+    auto const expected = detail::make_file_headers<T>(0, seq);
+
+    auto header = io::file_header{};
+    std::memcpy(&header, bytes, sizeof(header));
+    if (std::memcmp(header.magic, io::magic, sizeof(io::magic)) != 0)
+        detail::throw_invalid_file<mapped_view>(path, "not a soa::save file"sv);
+    if (header.version != io::version)
+        detail::throw_invalid_file<mapped_view>(path, "unsupported version"sv);
+    if (header.byte_order != io::byte_order_mark)
+        detail::throw_invalid_file<mapped_view>(path, "different byte order"sv);
+    if (header.schema_hash != expected.header.schema_hash || header.columns_count != components_count)
+        detail::throw_invalid_file<mapped_view>(path, "schema mismatch"sv);
+    if (header.rows_count > static_cast<uint64_t>(std::numeric_limits<size_type>::max()))
+        detail::throw_invalid_file<mapped_view>(path, "too many rows"sv);
+    if (nb_bytes_ < sizeof(expected))
+        detail::throw_invalid_file<mapped_view>(path, "truncated header"sv);
+
+    auto headers = expected;
+    std::memcpy(&headers, bytes, sizeof(headers));
+    auto const rows = header.rows_count;
+    for (size_t i = 0; i < sizeof...(Is); ++i) {
+        auto const& column = headers.columns[i];
+        // The rows are bounded by the file size before the multiplication, which could wrap otherwise.
+        if (column.element_size != expected.columns[i].element_size ||
+            column.alignment < expected.columns[i].alignment ||
+            column.offset % expected.columns[i].alignment != 0 ||
+            column.offset > nb_bytes_ || column.element_size == 0 ||
+            rows > (nb_bytes_ - column.offset) / column.element_size ||
+            column.nb_bytes != rows * column.element_size)
+            detail::throw_invalid_file<mapped_view>(path, "invalid column"sv);
+    }
+    // The mapping only allows reads : the spans are only exposed as const.
+    auto const data = const_cast<std::byte*>(bytes);
+    static_cast<members<T>&>(*this) = members<T>{ (data + headers.columns[Is].offset)... };
+    this->set_size(static_cast<size_type>(rows));
+}
+
+template <class T>
+mapped_view<T>::mapped_view(mapped_view && rhs) noexcept :
+    detail::members_with_size<T>{ static_cast<detail::members_with_size<T> const&>(rhs) },
+    data_    { rhs.data_ },
+    nb_bytes_{ rhs.nb_bytes_ }
+{
+    static_cast<detail::members_with_size<T>&>(rhs) = {};
+    rhs.data_     = nullptr;
+    rhs.nb_bytes_ = 0;
+}
+
+template <class T>
+mapped_view<T>& mapped_view<T>::operator=(mapped_view && rhs) noexcept {
+    if (this == &rhs) return *this;
+    unmap();
+    static_cast<detail::members_with_size<T>&>(*this) = static_cast<detail::members_with_size<T> const&>(rhs);
+    data_     = rhs.data_;
+    nb_bytes_ = rhs.nb_bytes_;
+    static_cast<detail::members_with_size<T>&>(rhs) = {};
+    rhs.data_     = nullptr;
+    rhs.nb_bytes_ = 0;
+    return *this;
+}
+
+template <class T>
+mapped_view<T>::~mapped_view() {
+    unmap();
+}
+
+template <class T>
+void mapped_view<T>::unmap() noexcept {
+    if (data_) ::munmap(data_, nb_bytes_);
+    static_cast<detail::members_with_size<T>&>(*this) = {};
+    data_     = nullptr;
+    nb_bytes_ = 0;
+}
+
+#endif // SOA_IO_HAS_MMAP
+
+// Streams.
+
+namespace io {
+
+inline constexpr char stream_magic[8] = { 'S', 'O', 'A', 'S', 'T', 'R', 'M', '\0' };
+
+// Default size in bytes of the rows of a stream chunk.
+inline constexpr size_t default_chunk_bytes = 1 << 20;
+
+// Rows count of the streams which don't know their size when they start.
+inline constexpr uint64_t unknown_rows = std::numeric_limits<uint64_t>::max();
+
+struct stream_header {
+    char     magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t schema_hash;
+    uint64_t rows_count;
+    uint32_t columns_count;
+    uint32_t chunk_rows;
+};
+
+// Sinks have a method 'write(data, size)' and sources a method 'read(data, size)',
+// which throw if all the bytes can't be written or read.
+
+class ostream_sink {
+public:
+    explicit ostream_sink(std::ostream& os) noexcept : os_{ os } {}
+    void write(void const* data, size_t size) {
+        os_.write(static_cast<char const*>(data), static_cast<std::streamsize>(size));
+        if (!os_) throw std::runtime_error{ "soa::io::ostream_sink failed to write" };
+    }
+private:
+    std::ostream& os_;
+};
+
+class istream_source {
+public:
+    explicit istream_source(std::istream& is) noexcept : is_{ is } {}
+    void read(void* data, size_t size) {
+        is_.read(static_cast<char*>(data), static_cast<std::streamsize>(size));
+        if (!is_) throw std::runtime_error{ "soa::io::istream_source reached the end of the stream" };
+    }
+private:
+    std::istream& is_;
+};
+
+#if defined(SOA_IO_HAS_MMAP)
+
+// Writes to a file descriptor, eg. a pipe or a socket. The descriptor isn't closed.
+class fd_sink {
+public:
+    explicit fd_sink(int fd) noexcept : fd_{ fd } {}
+    void write(void const* data, size_t size) {
+        auto bytes = static_cast<char const*>(data);
+        while (size > 0) {
+            auto const n = ::write(fd_, bytes, size);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                throw std::system_error{ errno, std::generic_category(), "soa::io::fd_sink failed to write" };
+            }
+            bytes += n;
+            size  -= static_cast<size_t>(n);
+        }
+    }
+private:
+    int fd_;
+};
+
+// Reads from a file descriptor, eg. a pipe or a socket. The descriptor isn't closed.
+class fd_source {
+public:
+    explicit fd_source(int fd) noexcept : fd_{ fd } {}
+    void read(void* data, size_t size) {
+        auto bytes = static_cast<char*>(data);
+        while (size > 0) {
+            auto const n = ::read(fd_, bytes, size);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                throw std::system_error{ errno, std::generic_category(), "soa::io::fd_source failed to read" };
+            }
+            if (n == 0) throw std::runtime_error{ "soa::io::fd_source reached the end of the stream" };
+            bytes += n;
+            size  -= static_cast<size_t>(n);
+        }
+    }
+private:
+    int fd_;
+};
+
+#endif // SOA_IO_HAS_MMAP
+
+} // ::io
+
+// Encodes 'n' objects of a column to a sink, and decodes them from a source.
+// 'decode' constructs the objects in the uninitialized array : if it throws, it must destroy them.
+// Trivially copyable types are copied as bytes. It can be specialized for other types.
+template <class T, class = void>
+struct codec {
+    static_assert(std::is_trivially_copyable_v<T>,
+        "soa::codec<T> must be specialized for the types which aren't trivially copyable");
+
+    template <class Sink>
+    static void encode(Sink& sink, T const* data, size_type n) {
+        sink.write(data, static_cast<size_t>(n) * sizeof(T));
+    }
+    template <class Source>
+    static void decode(Source& source, T* data, size_type n) {
+        source.read(data, static_cast<size_t>(n) * sizeof(T));
+    }
+};
+
+// Strings are encoded as their lengths, followed by their characters.
+template <class Char, class Traits, class Allocator>
+struct codec<std::basic_string<Char, Traits, Allocator>> {
+    using string = std::basic_string<Char, Traits, Allocator>;
+
+    template <class Sink>
+    static void encode(Sink& sink, string const* data, size_type n) {
+        auto lengths = std::vector<uint64_t>(static_cast<size_t>(n));
+        auto chars = string{};
+        for (size_type i = 0; i < n; ++i) {
+            lengths[static_cast<size_t>(i)] = data[i].size();
+            chars += data[i];
+        }
+        sink.write(lengths.data(), lengths.size() * sizeof(uint64_t));
+        sink.write(chars.data(), chars.size() * sizeof(Char));
+    }
+    template <class Source>
+    static void decode(Source& source, string* data, size_type n) {
+        auto lengths = std::vector<uint64_t>(static_cast<size_t>(n));
+        source.read(lengths.data(), lengths.size() * sizeof(uint64_t));
+        auto chars = string(std::accumulate(lengths.begin(), lengths.end(), size_t{ 0 }), Char{});
+        source.read(chars.data(), chars.size() * sizeof(Char));
+
+        size_t position = 0;
+        size_type i = 0;
+        try {
+            for (; i < n; ++i) {
+                auto const length = static_cast<size_t>(lengths[static_cast<size_t>(i)]);
+                new (data + i) string(chars, position, length);
+                position += length;
+            }
+        }
+        catch (...) {
+            detail::destroy(data, data + i);
+            throw;
+        }
+    }
+};
+
+// Codec used for the I-th column of T, soa::codec<member type> by default.
+// It can be specialized to encode a column differently.
+template <class T, size_t I>
+struct column_codec : codec<detail::member_type_t<T, I>> {};
+
+namespace detail {
+    template <class T>
+    io::stream_header make_stream_header(uint64_t rows_count, int chunk_rows) {
+        constexpr auto count = arity_v<members<T>>;
+        auto header = io::stream_header{};
+        std::memcpy(header.magic, io::stream_magic, sizeof(io::stream_magic));
+        header.version       = io::version;
+        header.byte_order    = io::byte_order_mark;
+        header.schema_hash   = detail::schema_hash<T>(std::make_index_sequence<count>{});
+        header.rows_count    = rows_count;
+        header.columns_count = static_cast<uint32_t>(count);
+        header.chunk_rows    = static_cast<uint32_t>(chunk_rows);
+        return header;
+    }
+
+    template <class T>
+    constexpr int default_chunk_rows() noexcept {
+        constexpr auto rows = io::default_chunk_bytes / sizeof(T);
+        return rows > 0 ? static_cast<int>(rows) : 1;
+    }
+
+    // Standard streams are wrapped in soa::io::ostream_sink and soa::io::istream_source.
+    template <class S>
+    using enable_if_not_stream_t = std::enable_if_t<!std::is_base_of_v<std::ios_base, S>>;
+
+    [[noreturn]]
+    inline void throw_invalid_stream(std::string_view reason) {
+        using namespace std::literals;
+        throw std::runtime_error{ detail::concatene("Invalid stream given to soa::stream_decoder : "sv, reason) };
+    }
+}
+
+// Writes rows of T to a sink, in chunks of at most 'chunk_rows' rows.
+// Each column of a chunk is encoded directly from the vector arrays.
+template <class T, class Sink>
+class stream_encoder {
+    static_assert(!detail::has_packed_columns_v<T>, "soa::stream_encoder doesn't support soa::packed columns");
+public:
+    // Writes the stream header. The total rows count can be given so the decoder reserves it at once.
+    explicit stream_encoder(Sink& sink, uint64_t rows_count = io::unknown_rows,
+        int chunk_rows = detail::default_chunk_rows<T>());
+
+    // Writes the rows [first, last) of the vector, which can be a soa::vector or a soa::mapped_view.
+    template <class Vector>
+    void write(Vector const& vec, size_type first, size_type last);
+    template <class Vector>
+    void write(Vector const& vec) { write(vec, 0, vec.size()); }
+
+    // Writes the end of the stream. No rows can be written after.
+    void finish();
+
+    int chunk_rows() const noexcept { return chunk_rows_; }
+private:
+    template <class Vector, size_t...Is>
+    void write_chunk(Vector const& vec, size_type first, size_type n, std::index_sequence<Is...>);
+
+    Sink& sink_;
+    int   chunk_rows_;
+    bool  finished_;
+};
+
+template <class T, class Sink>
+stream_encoder<T, Sink>::stream_encoder(Sink& sink, uint64_t rows_count, int chunk_rows) :
+    sink_      { sink },
+    chunk_rows_{ chunk_rows },
+    finished_  { false }
+{
+    if (chunk_rows <= 0) throw std::invalid_argument{ "soa::stream_encoder chunk rows must be positive" };
+    auto const header = detail::make_stream_header<T>(rows_count, chunk_rows);
+    sink_.write(&header, sizeof(header));
+}
+
+template <class T, class Sink>
+template <class Vector>
+void stream_encoder<T, Sink>::write(Vector const& vec, size_type first, size_type last) {
+    if (finished_) throw std::logic_error{ "soa::stream_encoder::write called after finish" };
+    using sequence = std::make_index_sequence<detail::arity_v<members<T>>>;
+    for (auto i = first; i < last; i += chunk_rows_) {
+        write_chunk(vec, i, std::min<size_type>(chunk_rows_, last - i), sequence{});
+    }
+}
+
+template <class T, class Sink>
+template <class Vector, size_t...Is>
+void stream_encoder<T, Sink>::write_chunk(Vector const& vec, size_type first, size_type n, std::index_sequence<Is...>) {
+    auto const rows = static_cast<uint32_t>(n);
+    sink_.write(&rows, sizeof(rows));
+    (column_codec<T, Is>::encode(sink_, vec.template get_span<Is>().data() + first, n), ...);
+}
+
+template <class T, class Sink>
+void stream_encoder<T, Sink>::finish() {
+    if (finished_) return;
+    auto const end = uint32_t{ 0 };
+    sink_.write(&end, sizeof(end));
+    finished_ = true;
+}
+
+// Reads the rows written by soa::stream_encoder from a source, chunk by chunk.
+// Each column of a chunk is decoded directly in the vector arrays.
+// If an exception is raised while reading a chunk, the decoder can't be used anymore.
+template <class T, class Source>
+class stream_decoder {
+    static_assert(!detail::has_packed_columns_v<T>, "soa::stream_decoder doesn't support soa::packed columns");
+public:
+    // Reads the stream header. Throws std::runtime_error if it doesn't match T.
+    explicit stream_decoder(Source& source);
+
+    // Total rows count given to the encoder, if any.
+    std::optional<uint64_t> rows_count() const noexcept;
+    int  chunk_rows() const noexcept { return static_cast<int>(header_.chunk_rows); }
+    bool finished()   const noexcept { return finished_; }
+
+    // Appends the next chunk to the vector. Returns the number of rows read, 0 at the end of the stream.
+    template <class Vector>
+    size_type read_chunk(Vector& vec);
+    // Appends all the remaining chunks. As the header isn't trusted, the vector is reserved
+    // for the first chunk only, then grows with the chunks read.
+    template <class Vector>
+    void read_all(Vector& vec);
+private:
+    Source& source_;
+    io::stream_header header_;
+    uint64_t rows_read_;
+    bool finished_;
+};
+
+template <class T, class Source>
+stream_decoder<T, Source>::stream_decoder(Source& source) :
+    source_  { source },
+    header_   {},
+    rows_read_{ 0 },
+    finished_ { false }
+{
+    using namespace std::literals;
+    source_.read(&header_, sizeof(header_));
+    auto const expected = detail::make_stream_header<T>(0, 1);
+    if (std::memcmp(header_.magic, io::stream_magic, sizeof(io::stream_magic)) != 0)
+        detail::throw_invalid_stream("not a soa::stream_encoder stream"sv);
+    if (header_.version != io::version)
+        detail::throw_invalid_stream("unsupported version"sv);
+    if (header_.byte_order != io::byte_order_mark)
+        detail::throw_invalid_stream("different byte order"sv);
+    if (header_.schema_hash != expected.schema_hash || header_.columns_count != expected.columns_count)
+        detail::throw_invalid_stream("schema mismatch"sv);
+    if (header_.chunk_rows == 0 || header_.chunk_rows > static_cast<uint32_t>(std::numeric_limits<int>::max()))
+        detail::throw_invalid_stream("invalid chunk rows"sv);
+}
+
+template <class T, class Source>
+std::optional<uint64_t> stream_decoder<T, Source>::rows_count() const noexcept {
+    if (header_.rows_count == io::unknown_rows) return std::nullopt;
+    return header_.rows_count;
+}
+
+template <class T, class Source>
+template <class Vector>
+size_type stream_decoder<T, Source>::read_chunk(Vector& vec) {
+    using namespace std::literals;
+    if (finished_) return 0;
+    auto rows = uint32_t{};
+    source_.read(&rows, sizeof(rows));
+    auto const expected = rows_count();
+    if (rows == 0) {
+        if (expected && rows_read_ != *expected) detail::throw_invalid_stream("fewer rows than announced"sv);
+        finished_ = true;
+        return 0;
+    }
+    if (rows > header_.chunk_rows) detail::throw_invalid_stream("chunk larger than announced"sv);
+    if (expected && rows > *expected - rows_read_) detail::throw_invalid_stream("more rows than announced"sv);
+
+    auto const n = static_cast<size_type>(rows);
+    vec.append_rows(n, [this, n] (auto* data, auto, auto index) {
+        column_codec<T, decltype(index)::value>::decode(source_, data, n);
+    });
+    rows_read_ += rows;
+    return n;
+}
+
+template <class T, class Source>
+template <class Vector>
+void stream_decoder<T, Source>::read_all(Vector& vec) {
+    if (auto const rows = rows_count()) {
+        if (*rows > static_cast<uint64_t>(std::numeric_limits<size_type>::max() - vec.size()))
+            throw std::length_error{ "soa::stream_decoder rows count exceeds the vector capacity" };
+        auto const remaining = *rows - rows_read_;
+        vec.reserve(vec.size() + static_cast<size_type>(std::min<uint64_t>(remaining, header_.chunk_rows)));
+    }
+    while (read_chunk(vec) > 0) {}
+}
+
+// Writes the vector to a sink (eg. soa::io::ostream_sink or soa::io::fd_sink) as a single stream.
+template <class Sink, class T, class Allocator, class Layout, size_t InlineRows, class Growth,
+    class = detail::enable_if_not_stream_t<Sink>>
+void encode(Sink& sink, vector<T, Allocator, Layout, InlineRows, Growth> const& vec) {
+    auto encoder = stream_encoder<T, Sink>{ sink, static_cast<uint64_t>(vec.size()) };
+    encoder.write(vec);
+    encoder.finish();
+}
+template <class T, class Allocator, class Layout, size_t InlineRows, class Growth>
+void encode(std::ostream& os, vector<T, Allocator, Layout, InlineRows, Growth> const& vec) {
+    auto sink = io::ostream_sink{ os };
+    soa::encode(sink, vec);
+}
+
+// Reads a whole stream from a source (eg. soa::io::istream_source or soa::io::fd_source).
+template <class T, class Source, class = detail::enable_if_not_stream_t<Source>>
+vector<T> decode(Source& source) {
+    auto vec = vector<T>{};
+    auto decoder = stream_decoder<T, Source>{ source };
+    decoder.read_all(vec);
+    return vec;
+}
+template <class T>
+vector<T> decode(std::istream& is) {
+    auto source = io::istream_source{ is };
+    return soa::decode<T>(source);
+}
+
+} // namespace soa
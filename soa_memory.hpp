@@ -0,0 +1,99 @@
+/*
+    soa_memory.hpp
+    MIT license (2018)
+    Header repository : https://github.com/Dwarfobserver/soa_vector
+    You can contact me at sidney.congard@gmail.com
+ */
+
+#pragma once
+
+#include "soa_vector.hpp"
+#include <cstddef>
+#include <limits>
+#include <new>
+#if __has_include(<sys/mman.h>)
+#include <sys/mman.h>
+#endif
+
+// Allocators for large soa::vectors.
+
+namespace soa {
+
+// Size in bytes of the huge pages (2 MiB on x86-64 and most AArch64 configurations).
+inline constexpr size_t huge_page_size = size_t{ 2 } << 20;
+
+// Storage of a huge page, in which 'Base' allocators are rebound by soa::huge_page_allocator.
+struct alignas(huge_page_size) huge_page {
+    std::byte bytes[huge_page_size];
+};
+
+// Allocator adaptor : the allocations of at least 'Threshold' bytes are aligned and rounded on huge pages,
+// and advised as such to the kernel when it's possible (Linux transparent huge pages).
+// All the allocations are made by the 'Base' allocator, rebound to soa::huge_page for the large ones.
+// It's meant to be used with soa::growth::huge_pages, so the vector capacity fills the rounded allocations.
+template <class T, class Base = std::allocator<T>, size_t Threshold = huge_page_size>
+class huge_page_allocator {
+    using base_traits = std::allocator_traits<Base>;
+    using pages_allocator = typename base_traits::template rebind_alloc<huge_page>;
+    using pages_traits = typename base_traits::template rebind_traits<huge_page>;
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = typename base_traits::propagate_on_container_copy_assignment;
+    using propagate_on_container_move_assignment = typename base_traits::propagate_on_container_move_assignment;
+    using propagate_on_container_swap            = typename base_traits::propagate_on_container_swap;
+    using is_always_equal                        = typename base_traits::is_always_equal;
+
+    template <class U>
+    struct rebind {
+        using other = huge_page_allocator<U, typename base_traits::template rebind_alloc<U>, Threshold>;
+    };
+
+    huge_page_allocator() = default;
+    explicit huge_page_allocator(Base const& base) noexcept : base_{ base } {}
+    template <class U, class B>
+    huge_page_allocator(huge_page_allocator<U, B, Threshold> const& rhs) noexcept : base_{ rhs.base() } {}
+
+    T* allocate(size_t n);
+    void deallocate(T* ptr, size_t n) noexcept;
+
+    Base const& base() const noexcept { return base_; }
+
+    template <class U, class B>
+    bool operator==(huge_page_allocator<U, B, Threshold> const& rhs) const noexcept { return base_ == rhs.base(); }
+    template <class U, class B>
+    bool operator!=(huge_page_allocator<U, B, Threshold> const& rhs) const noexcept { return !(*this == rhs); }
+
+    // True if an allocation of 'n' objects is done on huge pages.
+    static constexpr bool uses_huge_pages(size_t n) noexcept { return n >= (Threshold + sizeof(T) - 1) / sizeof(T); }
+private:
+    // Number of huge pages holding 'n' objects, for the sizes checked by allocate.
+    static constexpr size_t huge_pages(size_t n) noexcept {
+        return detail::align_up(n * sizeof(T), huge_page_size) / huge_page_size;
+    }
+
+    Base base_;
+};
+
+template <class T, class Base, size_t Threshold>
+T* huge_page_allocator<T, Base, Threshold>::allocate(size_t n) {
+    if (n > (std::numeric_limits<size_t>::max() - huge_page_size) / sizeof(T)) throw std::bad_array_new_length{};
+    if (!uses_huge_pages(n)) return base_traits::allocate(base_, n);
+
+    auto pages = pages_allocator{ base_ };
+    auto const count = huge_pages(n);
+    auto const ptr = pages_traits::allocate(pages, count);
+#if defined(MADV_HUGEPAGE)
+    // It's only an hint : the allocation is valid even if the kernel refuses it.
+    ::madvise(ptr, count * huge_page_size, MADV_HUGEPAGE);
+#endif
+    return reinterpret_cast<T*>(ptr);
+}
+
+template <class T, class Base, size_t Threshold>
+void huge_page_allocator<T, Base, Threshold>::deallocate(T* ptr, size_t n) noexcept {
+    if (!uses_huge_pages(n)) return base_traits::deallocate(base_, ptr, n);
+    auto pages = pages_allocator{ base_ };
+    pages_traits::deallocate(pages, reinterpret_cast<huge_page*>(ptr), huge_pages(n));
+}
+
+} // namespace soa
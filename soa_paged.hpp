@@ -0,0 +1,309 @@
+/*
+    soa_paged.hpp
+    MIT license (2018)
+    Header repository : https://github.com/Dwarfobserver/soa_vector
+    You can contact me at sidney.congard@gmail.com
+ */
+
+#pragma once
+
+#include "soa_vector.hpp"
+#include "soa_parallel.hpp"
+#include <deque>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+
+// Paged storage for very large tables : the rows are stored in pages of a fixed number of rows,
+// each page being an allocation of a soa::vector. Appending rows never moves the existing ones,
+// and the columns of each page are contiguous arrays which can be given to the SIMD kernels.
+
+namespace soa {
+
+// Stores the rows of T in pages of 'PageRows' rows. Each page has the columns layout of
+// a soa::vector<T, Allocator, Layout> of capacity 'PageRows', and is never reallocated :
+// the rows and the pointers to their columns stay valid until their page is released.
+// All the pages are full, except the last one.
+// The first pages can be released for sliding windows, and the last released page is kept
+// to be reused by the next appended page.
+template <class T, size_t PageRows = 4096, class Allocator = std::allocator<T>, class Layout = layout<>>
+class paged_vector {
+public:
+    // The storage of each page.
+    using page_type = vector<T, Allocator, Layout>;
+
+    static_assert(PageRows > 0 && PageRows <= static_cast<size_t>(page_type::max_size()),
+        "soa::paged_vector pages must have between 1 and soa::vector<T>::max_size() rows");
+
+    using allocator_type = Allocator;
+    using layout_type    = Layout;
+
+    using value_type           = T;
+    using reference_type       = ref_proxy<T>;
+    using const_reference_type = cref_proxy<T>;
+
+    using iterator       = detail::index_iterator<paged_vector, false>;
+    using const_iterator = detail::index_iterator<paged_vector, true>;
+
+    // The number of T members.
+    static constexpr int components_count = page_type::components_count;
+
+    // The number of rows of each page.
+    static constexpr size_type page_rows = static_cast<size_type>(PageRows);
+
+    // Constructors.
+    explicit paged_vector(Allocator const& allocator = Allocator{});
+    paged_vector(paged_vector && rhs) = default;
+    // The pages are copied with the full page capacity.
+    paged_vector(paged_vector const& rhs);
+
+    // Assignments.
+    paged_vector& operator=(paged_vector && rhs) = default;
+    paged_vector& operator=(paged_vector const& rhs);
+
+    // Size modifiers.
+    // Removes all the rows. One of the pages is kept for the next rows.
+    void clear() noexcept;
+    // Releases the page kept after clear() or pop_front_page().
+    void shrink_to_fit() noexcept;
+
+    // Add and remove an element.
+    template <class...Ts>
+    void emplace_back(Ts &&...components);
+    void push_back(T const& value);
+    void push_back(T && value);
+    void pop_back() noexcept;
+    // Appends the aggregates of the range [first, last), with one bulk append per page.
+    template <class InputIt>
+    void append(InputIt first, InputIt last);
+
+    // Removes the 'page_rows' first rows (or all of them if there is only one page).
+    // The rows which follow are moved to the index 0, but their storage is unchanged.
+    void pop_front_page() noexcept;
+
+    // Informations.
+    size_type size() const noexcept;
+    // The maximum number of rows, for which the indices fit in size_type.
+    static constexpr size_type max_size() noexcept {
+        return std::numeric_limits<size_type>::max() / page_rows * page_rows;
+    }
+    // The rows stored in the allocated pages, without the page kept for reuse.
+    size_type capacity() const noexcept { return pages_count() * page_rows; }
+    bool empty() const noexcept { return pages_.empty(); }
+
+    allocator_type get_allocator() const noexcept { return allocator_; }
+
+    // Accessors.
+    reference_type       operator[](size_type i)       noexcept { return page_of(i)[i % page_rows]; }
+    const_reference_type operator[](size_type i) const noexcept { return page_of(i)[i % page_rows]; }
+    reference_type       at(size_type i)       { check_at(i); return (*this)[i]; }
+    const_reference_type at(size_type i) const { check_at(i); return (*this)[i]; }
+
+    reference_type       front()       noexcept { return pages_.front().front(); }
+    const_reference_type front() const noexcept { return pages_.front().front(); }
+    reference_type       back()       noexcept { return pages_.back().back(); }
+    const_reference_type back() const noexcept { return pages_.back().back(); }
+
+    // Iterators.
+    iterator       begin()        noexcept { return { this, 0 }; }
+    const_iterator begin()  const noexcept { return { this, 0 }; }
+    const_iterator cbegin() const noexcept { return begin(); }
+    iterator       end()        noexcept { return { this, size() }; }
+    const_iterator end()  const noexcept { return { this, size() }; }
+    const_iterator cend() const noexcept { return end(); }
+
+    // Pages accessors : the columns of the page 'i' hold the rows [i * page_rows, i * page_rows + size).
+    size_type pages_count() const noexcept { return static_cast<size_type>(pages_.size()); }
+    members<T>&       page(size_type i)       noexcept { return pages_[static_cast<size_t>(i)]; }
+    members<T> const& page(size_type i) const noexcept { return pages_[static_cast<size_t>(i)]; }
+private:
+    using pages_type = std::deque<page_type,
+        typename std::allocator_traits<Allocator>::template rebind_alloc<page_type>>;
+
+    page_type &      page_of(size_type i)       noexcept { return pages_[static_cast<size_t>(i / page_rows)]; }
+    page_type const& page_of(size_type i) const noexcept { return pages_[static_cast<size_t>(i / page_rows)]; }
+
+    void check_at(size_type index) const;
+
+    // Calls 'f(page)' to append rows to the last page, after adding a page if it is full.
+    template <class F>
+    void append_back(F&& f);
+    // Appends an empty page with a capacity of 'page_rows', reusing the spare page if possible.
+    void add_page();
+    // Removes the last page after a failed append, if it is empty.
+    void release_empty_back() noexcept;
+    // Removes the given page, which is the first or the last one, and keeps it's allocation if possible.
+    template <class Erase>
+    void release_page(page_type& page, Erase erase) noexcept;
+
+    Allocator allocator_;
+    pages_type pages_;
+    page_type spare_;
+};
+
+// soa::paged_vector implementation.
+
+template <class T, size_t PageRows, class Allocator, class Layout>
+paged_vector<T, PageRows, Allocator, Layout>::paged_vector(Allocator const& allocator) :
+    allocator_{ allocator },
+    pages_    { typename pages_type::allocator_type{ allocator } },
+    spare_    { allocator }
+{}
+
+template <class T, size_t PageRows, class Allocator, class Layout>
+paged_vector<T, PageRows, Allocator, Layout>::paged_vector(paged_vector const& rhs) :
+    paged_vector{ std::allocator_traits<Allocator>::select_on_container_copy_construction(rhs.allocator_) }
+{
+    for (auto const& src : rhs.pages_) {
+        append_back([&src] (page_type& page) {
+            std::apply([&page] (auto const&...columns) {
+                page.append_columns(columns...);
+            }, detail::as_tuple(static_cast<members<T> const&>(src)));
+        });
+    }
+}
+
+template <class T, size_t PageRows, class Allocator, class Layout>
+paged_vector<T, PageRows, Allocator, Layout>& paged_vector<T, PageRows, Allocator, Layout>::operator=(paged_vector const& rhs) {
+    if (this != &rhs) {
+        auto copy = rhs;
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+template <class T, size_t PageRows, class Allocator, class Layout>
+void paged_vector<T, PageRows, Allocator, Layout>::clear() noexcept {
+    while (!pages_.empty())
+        release_page(pages_.back(), [this] { pages_.pop_back(); });
+}
+
+template <class T, size_t PageRows, class Allocator, class Layout>
+void paged_vector<T, PageRows, Allocator, Layout>::shrink_to_fit() noexcept {
+    spare_ = page_type{ allocator_ };
+}
+
+template <class T, size_t PageRows, class Allocator, class Layout>
+template <class...Ts>
+void paged_vector<T, PageRows, Allocator, Layout>::emplace_back(Ts &&...components) {
+    append_back([&components...] (page_type& page) { page.emplace_back(std::forward<Ts>(components)...); });
+}
+
+template <class T, size_t PageRows, class Allocator, class Layout>
+void paged_vector<T, PageRows, Allocator, Layout>::push_back(T const& value) {
+    append_back([&value] (page_type& page) { page.push_back(value); });
+}
+
+template <class T, size_t PageRows, class Allocator, class Layout>
+void paged_vector<T, PageRows, Allocator, Layout>::push_back(T && value) {
+    append_back([&value] (page_type& page) { page.push_back(std::move(value)); });
+}
+
+template <class T, size_t PageRows, class Allocator, class Layout>
+void paged_vector<T, PageRows, Allocator, Layout>::pop_back() noexcept {
+    auto& page = pages_.back();
+    page.pop_back();
+    if (page.empty()) release_page(page, [this] { pages_.pop_back(); });
+}
+
+template <class T, size_t PageRows, class Allocator, class Layout>
+template <class InputIt>
+void paged_vector<T, PageRows, Allocator, Layout>::append(InputIt first, InputIt last) {
+    using category = typename std::iterator_traits<InputIt>::iterator_category;
+    if constexpr (!std::is_base_of_v<std::forward_iterator_tag, category>) {
+        for (; first != last; ++first) push_back(*first);
+    }
+    else {
+        auto remaining = static_cast<size_type>(std::distance(first, last));
+        if (remaining > max_size() - size()) {
+            throw std::length_error{ detail::concatene(
+                detail::type_name<paged_vector>(), std::string_view{ "::append : too many rows" }
+            )};
+        }
+        while (remaining > 0) {
+            append_back([&first, &remaining] (page_type& page) {
+                auto const n = std::min(remaining, page_rows - page.size());
+                auto const next = std::next(first, n);
+                page.append(first, next);
+                first = next;
+                remaining -= n;
+            });
+        }
+    }
+}
+
+template <class T, size_t PageRows, class Allocator, class Layout>
+void paged_vector<T, PageRows, Allocator, Layout>::pop_front_page() noexcept {
+    release_page(pages_.front(), [this] { pages_.pop_front(); });
+}
+
+template <class T, size_t PageRows, class Allocator, class Layout>
+size_type paged_vector<T, PageRows, Allocator, Layout>::size() const noexcept {
+    return pages_.empty() ? 0 : (pages_count() - 1) * page_rows + pages_.back().size();
+}
+
+template <class T, size_t PageRows, class Allocator, class Layout>
+void paged_vector<T, PageRows, Allocator, Layout>::check_at(size_type i) const {
+    if (i < 0 || i >= size()) detail::throw_out_of_range<paged_vector>(i, size());
+}
+
+template <class T, size_t PageRows, class Allocator, class Layout>
+template <class F>
+void paged_vector<T, PageRows, Allocator, Layout>::append_back(F&& f) {
+    if (pages_.empty() || pages_.back().size() == page_rows) add_page();
+    try {
+        f(pages_.back());
+    }
+    catch (...) {
+        release_empty_back();
+        throw;
+    }
+}
+
+template <class T, size_t PageRows, class Allocator, class Layout>
+void paged_vector<T, PageRows, Allocator, Layout>::add_page() {
+    using namespace std::literals;
+    if (size() > max_size() - page_rows) throw std::length_error{ detail::concatene(
+        detail::type_name<paged_vector>(), "::add_page : the size exceeds max_size() = "sv, std::to_string(max_size())
+    )};
+    if (spare_.capacity() == page_rows) {
+        pages_.push_back(std::move(spare_));
+        spare_ = page_type{ allocator_ };
+        return;
+    }
+    auto page = page_type{ allocator_ };
+    page.reserve(page_rows);
+    pages_.push_back(std::move(page));
+}
+
+template <class T, size_t PageRows, class Allocator, class Layout>
+void paged_vector<T, PageRows, Allocator, Layout>::release_empty_back() noexcept {
+    if (!pages_.empty() && pages_.back().empty())
+        release_page(pages_.back(), [this] { pages_.pop_back(); });
+}
+
+template <class T, size_t PageRows, class Allocator, class Layout>
+template <class Erase>
+void paged_vector<T, PageRows, Allocator, Layout>::release_page(page_type& page, Erase erase) noexcept {
+    page.clear();
+    if (spare_.capacity() != page_rows) spare_.swap(page);
+    erase();
+}
+
+// Calls 'f(columns, first_row)' for each page of the paged_vector, where 'columns' are the page members<T>
+// and 'first_row' is the index of the first row of the page. With a parallel policy, the pages are
+// distributed between the workers.
+template <class Policy, class Paged, class F, class = detail::enable_if_policy_t<Policy>>
+void for_each_page(Policy&& policy, Paged& paged, F f) {
+    using paged_type = std::remove_const_t<Paged>;
+    auto const& native = execution::detail::to_policy(policy);
+    auto const chunks = detail::chunking{
+        paged.size(), 0, paged_type::page_rows, static_cast<int>(paged.pages_count())
+    };
+    auto body = [&paged, &f] (int page, size_type first, size_type) {
+        f(paged.page(page), first);
+    };
+    detail::run_chunks(native, chunks, body);
+}
+
+} // namespace soa
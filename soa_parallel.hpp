@@ -0,0 +1,563 @@
+
+/*
+    soa_parallel.hpp
+    MIT license (2018)
+    Header repository : https://github.com/Dwarfobserver/soa_vector
+    You can contact me at sidney.congard@gmail.com
+ */
+
+#pragma once
+
+#include "soa_vector.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#if defined(SOA_STD_EXECUTION)
+#include <execution>
+#endif
+
+// Parallel algorithms over soa::vector rows, vector_span and zip_view columns.
+// The rows are split in chunks whose boundaries are aligned on the cache lines of the written columns,
+// so two threads never write the same line (for all the columns with a layout aligned on cache lines).
+//
+// The standard policies (std::execution::seq, par and par_unseq) are accepted if SOA_STD_EXECUTION is defined
+// before including this header. It is opt-in because <execution> requires to link TBB with libstdc++.
+
+namespace soa::execution {
+
+// Size in bytes of the cache lines on which the chunk boundaries are aligned.
+inline constexpr size_t cache_line_size = 64;
+
+namespace detail {
+    // Threads shared by the algorithms run with soa::execution::par, created at their first use and joined at exit.
+    // The calling thread is the first worker of the algorithms, so there is one thread less than the cores.
+    class shared_pool {
+        std::vector<std::thread> threads_;
+        std::deque<std::function<void()>> tasks_;
+        std::mutex mutex_;
+        std::condition_variable ready_;
+        bool stopped_ = false;
+
+        explicit shared_pool(int nb) {
+            for (int i = 0; i < nb; ++i) {
+                try {
+                    threads_.emplace_back([this] { run(); });
+                }
+                catch (std::system_error const&) {
+                    // The tasks are run by the threads created so far.
+                    break;
+                }
+            }
+        }
+        void run() {
+            for (;;) {
+                auto lock = std::unique_lock<std::mutex>{ mutex_ };
+                ready_.wait(lock, [this] { return stopped_ || !tasks_.empty(); });
+                if (tasks_.empty()) return;
+                auto task = std::move(tasks_.front());
+                tasks_.pop_front();
+                lock.unlock();
+                task();
+            }
+        }
+    public:
+        shared_pool(shared_pool const&) = delete;
+        shared_pool& operator=(shared_pool const&) = delete;
+        ~shared_pool() {
+            {
+                std::lock_guard<std::mutex> lock{ mutex_ };
+                stopped_ = true;
+            }
+            ready_.notify_all();
+            for (auto& thread : threads_) thread.join();
+        }
+
+        static shared_pool& instance() {
+            static shared_pool pool{ static_cast<int>(std::thread::hardware_concurrency()) - 1 };
+            return pool;
+        }
+
+        void execute(std::function<void()> task) {
+            // Without threads, the tasks are dropped : they stay pending, so their chunks are stolen.
+            if (threads_.empty()) return;
+            {
+                std::lock_guard<std::mutex> lock{ mutex_ };
+                tasks_.emplace_back(std::move(task));
+            }
+            ready_.notify_one();
+        }
+    };
+}
+
+// Executor running the tasks on threads shared by all the calls, used by soa::execution::par.
+// Thread pools can be used instead with 'par.on(pool)' : they must have a method 'execute(task)'
+// taking a copyable callable, and can have a method 'concurrency()' returning their number of threads.
+struct thread_executor {
+    template <class Task>
+    void execute(Task task) const { detail::shared_pool::instance().execute(std::move(task)); }
+
+    int concurrency() const noexcept {
+        return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+};
+
+// Runs the algorithms on the calling thread.
+struct sequenced_policy {};
+inline constexpr sequenced_policy seq{};
+
+// Runs the algorithms on the calling thread and on tasks given to the executor.
+// The chunks are distributed between the workers, and stolen by the idle ones.
+template <class Executor>
+struct parallel_policy {
+    Executor executor;
+    int workers    = 0; // 0 to use the executor concurrency.
+    size_type chunk_rows = 0; // 0 to split the rows in a few chunks per worker.
+
+    template <class Pool>
+    parallel_policy<Pool&> on(Pool& pool) const noexcept { return { pool, workers, chunk_rows }; }
+
+    parallel_policy with_workers(int nb) const noexcept { auto copy = *this; copy.workers = nb; return copy; }
+    parallel_policy with_chunk_rows(size_type nb) const noexcept { auto copy = *this; copy.chunk_rows = nb; return copy; }
+};
+inline constexpr parallel_policy<thread_executor> par{};
+
+// Policies accepted by the parallel algorithms : the soa ones and the standard ones.
+template <class T>
+struct is_execution_policy : std::false_type {};
+template <>
+struct is_execution_policy<sequenced_policy> : std::true_type {};
+template <class Executor>
+struct is_execution_policy<parallel_policy<Executor>> : std::true_type {};
+#if defined(SOA_STD_EXECUTION)
+template <>
+struct is_execution_policy<std::execution::sequenced_policy> : std::true_type {};
+template <>
+struct is_execution_policy<std::execution::parallel_policy> : std::true_type {};
+template <>
+struct is_execution_policy<std::execution::parallel_unsequenced_policy> : std::true_type {};
+#endif
+
+template <class T>
+constexpr bool is_execution_policy_v = is_execution_policy<std::remove_cv_t<std::remove_reference_t<T>>>::value;
+
+namespace detail {
+    // Converts the standard policies to the soa ones.
+    template <class Policy>
+    Policy const& to_policy(Policy const& policy) noexcept {
+        return policy;
+    }
+#if defined(SOA_STD_EXECUTION)
+    inline sequenced_policy const& to_policy(std::execution::sequenced_policy const&) noexcept {
+        return seq;
+    }
+    inline parallel_policy<thread_executor> const& to_policy(std::execution::parallel_policy const&) noexcept {
+        return par;
+    }
+    inline parallel_policy<thread_executor> const& to_policy(std::execution::parallel_unsequenced_policy const&) noexcept {
+        return par;
+    }
+#endif
+
+    template <class Executor, class = void>
+    struct has_concurrency : std::false_type {};
+    template <class Executor>
+    struct has_concurrency<Executor, std::void_t<decltype(std::declval<Executor const&>().concurrency())>> :
+        std::true_type {};
+
+    template <class Executor>
+    int worker_count(parallel_policy<Executor> const& policy) noexcept {
+        if (policy.workers > 0) return policy.workers;
+        if constexpr (has_concurrency<std::remove_reference_t<Executor>>::value)
+            return std::max(1, static_cast<int>(policy.executor.concurrency()));
+        else
+            return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+}
+
+} // namespace soa::execution
+
+namespace soa::detail {
+
+    // Address and element size of a column written by a parallel algorithm.
+    // The elements of soa::packed columns are accessed by words of 'size' bytes, holding 'rows' rows.
+    struct column_bytes {
+        std::uintptr_t address;
+        size_t size;
+        size_t rows = 1;
+    };
+
+    template <class T>
+    column_bytes make_column_bytes(T const* ptr) noexcept {
+        return { reinterpret_cast<std::uintptr_t>(ptr), sizeof(T) };
+    }
+    template <class T, size_t Bits, bool IsConst>
+    column_bytes make_column_bytes(packed_pointer<T, Bits, IsConst> ptr) noexcept {
+        return { reinterpret_cast<std::uintptr_t>(ptr.word()), sizeof(packed_word), packed_traits<Bits>::per_word };
+    }
+
+    // Split of the rows in 'count' chunks : the first one ends at 'offset + chunk_rows',
+    // and the others have 'chunk_rows' rows (except the last one).
+    struct chunking {
+        size_type rows;
+        size_type offset;
+        size_type chunk_rows;
+        int count;
+
+        size_type first(int chunk) const noexcept {
+            return chunk == 0 ? 0 : static_cast<size_type>(std::min<long long>(rows,
+                offset + static_cast<long long>(chunk) * chunk_rows));
+        }
+        size_type last(int chunk) const noexcept { return first(chunk + 1); }
+    };
+
+    // Number of chunks per worker, so the load can be balanced by stealing.
+    constexpr int chunks_per_worker = 8;
+    // Minimum number of rows per chunk when it is not given by the policy.
+    constexpr size_type min_chunk_rows = 1024;
+
+    // Chunks whose boundaries fall on cache lines of all the columns if possible,
+    // or at least of the first one (which can't fail with a layout aligned on cache lines).
+    // The boundaries always fall on the words of the packed columns, so the chunks don't share them.
+    template <size_t N>
+    chunking make_chunking(size_type rows, int workers, size_type chunk_rows, std::array<column_bytes, N> const& columns) noexcept {
+        constexpr auto line = execution::cache_line_size;
+        size_t granularity = 1;
+        for (auto const& column : columns)
+            granularity = std::lcm(granularity, column.rows * (line / std::gcd(line, column.size)));
+
+        auto const aligned = [&columns] (size_t offset, size_t nb) {
+            for (auto const& column : columns) {
+                if (offset % column.rows != 0) return false;
+            }
+            for (size_t i = 0; i < nb; ++i) {
+                if ((columns[i].address + offset / columns[i].rows * columns[i].size) % line != 0) return false;
+            }
+            return true;
+        };
+        auto const find_offset = [&aligned, granularity] (size_t nb) {
+            for (size_t offset = 0; offset < granularity; ++offset) {
+                if (aligned(offset, nb)) return static_cast<size_type>(offset);
+            }
+            return size_type{ -1 };
+        };
+        auto offset = N == 0 ? 0 : find_offset(N);
+        if (offset < 0) offset = std::max(size_type{ 0 }, find_offset(1));
+
+        auto const g = static_cast<size_type>(granularity);
+        if (chunk_rows <= 0) {
+            auto const nb_chunks = static_cast<size_type>(std::max(1, workers) * chunks_per_worker);
+            chunk_rows = std::max(min_chunk_rows, (rows + nb_chunks - 1) / nb_chunks);
+        }
+        chunk_rows = std::max(g, (chunk_rows + g - 1) / g * g);
+
+        auto const count = rows == 0 ? 0 : rows <= offset ? 1 : (rows - offset + chunk_rows - 1) / chunk_rows;
+        return { rows, offset, chunk_rows, static_cast<int>(count) };
+    }
+
+    // Range of chunk indices, popped from the front by it's worker and stolen from the back by the idle ones.
+    class chunk_deque {
+        std::atomic<std::uint64_t> range_{ 0 };
+
+        static constexpr std::uint64_t pack(std::uint64_t first, std::uint64_t last) noexcept {
+            return (first << 32) | last;
+        }
+    public:
+        void assign(std::uint32_t first, std::uint32_t last) noexcept {
+            range_.store(pack(first, last), std::memory_order_release);
+        }
+
+        bool pop(std::uint32_t& chunk) noexcept {
+            auto range = range_.load(std::memory_order_acquire);
+            for (;;) {
+                auto const first = range >> 32;
+                auto const last = range & 0xFFFFFFFF;
+                if (first >= last) return false;
+                if (range_.compare_exchange_weak(range, pack(first + 1, last),
+                    std::memory_order_acq_rel, std::memory_order_acquire)) {
+                    chunk = static_cast<std::uint32_t>(first);
+                    return true;
+                }
+            }
+        }
+
+        // Steals the last half of the chunks.
+        bool steal(std::uint32_t& first, std::uint32_t& last) noexcept {
+            auto range = range_.load(std::memory_order_acquire);
+            for (;;) {
+                auto const begin = range >> 32;
+                auto const end = range & 0xFFFFFFFF;
+                if (begin >= end) return false;
+                auto const split = end - (end - begin + 1) / 2;
+                if (range_.compare_exchange_weak(range, pack(begin, split),
+                    std::memory_order_acq_rel, std::memory_order_acquire)) {
+                    first = static_cast<std::uint32_t>(split);
+                    last = static_cast<std::uint32_t>(end);
+                    return true;
+                }
+            }
+        }
+    };
+
+    // Shared between the calling thread and the executor tasks, which can outlive the call
+    // when they are cancelled before they started.
+    struct parallel_job {
+        enum task_state : int { pending, running, done, cancelled };
+
+        struct alignas(execution::cache_line_size) worker_slot {
+            chunk_deque chunks;
+            std::atomic<int> state{ pending };
+        };
+
+        using body_type = void (*)(void* context, int chunk, size_type first, size_type last);
+
+        body_type body;
+        void* context;
+        chunking chunks;
+        int workers;
+        std::unique_ptr<worker_slot[]> slots;
+
+        std::atomic<bool> failed{ false };
+        std::mutex mutex;
+        std::condition_variable finished;
+        std::exception_ptr error;
+
+        parallel_job(body_type body, void* context, chunking const& chunks, int workers) :
+            body{ body }, context{ context }, chunks{ chunks }, workers{ workers },
+            slots{ std::make_unique<worker_slot[]>(static_cast<size_t>(workers)) }
+        {
+            for (int i = 0; i < workers; ++i) {
+                slots[i].chunks.assign(
+                    static_cast<std::uint32_t>(static_cast<long long>(chunks.count) * i / workers),
+                    static_cast<std::uint32_t>(static_cast<long long>(chunks.count) * (i + 1) / workers));
+            }
+        }
+
+        void run_chunk(std::uint32_t chunk) noexcept {
+            auto const c = static_cast<int>(chunk);
+            try {
+                body(context, c, chunks.first(c), chunks.last(c));
+            }
+            catch (...) {
+                std::lock_guard<std::mutex> lock{ mutex };
+                if (!error) error = std::current_exception();
+                failed.store(true, std::memory_order_relaxed);
+            }
+        }
+
+        // Processes the worker chunks, then steals chunks from the others until there is none.
+        void work(int id) noexcept {
+            auto& own = slots[id].chunks;
+            for (;;) {
+                std::uint32_t chunk;
+                while (!failed.load(std::memory_order_relaxed) && own.pop(chunk))
+                    run_chunk(chunk);
+                if (failed.load(std::memory_order_relaxed)) return;
+
+                auto stolen = false;
+                for (int i = 1; i < workers && !stolen; ++i) {
+                    std::uint32_t first, last;
+                    if (slots[(id + i) % workers].chunks.steal(first, last)) {
+                        own.assign(first, last);
+                        stolen = true;
+                    }
+                }
+                if (!stolen) return;
+            }
+        }
+    };
+
+    // Calls 'body(chunk, first_row, last_row)' for each chunk.
+    template <class Body>
+    void run_chunks(execution::sequenced_policy, chunking const& chunks, Body& body) {
+        for (int c = 0; c < chunks.count; ++c)
+            body(c, chunks.first(c), chunks.last(c));
+    }
+
+    template <class Executor, class Body>
+    void run_chunks(execution::parallel_policy<Executor> const& policy, chunking const& chunks, Body& body) {
+        auto const workers = std::min(chunks.count, execution::detail::worker_count(policy));
+        if (workers <= 1) {
+            run_chunks(execution::seq, chunks, body);
+            return;
+        }
+        auto const thunk = [] (void* context, int chunk, size_type first, size_type last) {
+            (*static_cast<Body*>(context))(chunk, first, last);
+        };
+        auto const job = std::make_shared<parallel_job>(thunk, &body, chunks, workers);
+
+        for (int id = 1; id < workers; ++id) {
+            try {
+                policy.executor.execute([job, id] {
+                    auto& state = job->slots[id].state;
+                    int expected = parallel_job::pending;
+                    if (!state.compare_exchange_strong(expected, parallel_job::running)) return;
+                    job->work(id);
+                    {
+                        std::lock_guard<std::mutex> lock{ job->mutex };
+                        state.store(parallel_job::done);
+                    }
+                    job->finished.notify_all();
+                });
+            }
+            catch (...) {
+                // The chunks of the worker will be stolen.
+                job->slots[id].state.store(parallel_job::cancelled);
+            }
+        }
+        job->work(0);
+
+        // Tasks which didn't start yet have no chunk left to process.
+        for (int id = 1; id < workers; ++id) {
+            int expected = parallel_job::pending;
+            job->slots[id].state.compare_exchange_strong(expected, parallel_job::cancelled);
+        }
+        {
+            std::unique_lock<std::mutex> lock{ job->mutex };
+            job->finished.wait(lock, [&job, workers] {
+                for (int id = 1; id < workers; ++id) {
+                    if (job->slots[id].state.load() == parallel_job::running) return false;
+                }
+                return true;
+            });
+        }
+        if (job->error) std::rethrow_exception(job->error);
+    }
+
+    template <size_t N>
+    chunking plan_chunks(execution::sequenced_policy, size_type rows, std::array<column_bytes, N> const&) noexcept {
+        return { rows, 0, rows, rows == 0 ? 0 : 1 };
+    }
+
+    template <class Executor, size_t N>
+    chunking plan_chunks(execution::parallel_policy<Executor> const& policy, size_type rows,
+        std::array<column_bytes, N> const& columns) noexcept
+    {
+        return make_chunking(rows, execution::detail::worker_count(policy), policy.chunk_rows, columns);
+    }
+
+    // Ranges processed by the parallel algorithms : rows of soa::vector (given as proxies),
+    // vector_span elements and zip_view elements (given as references to each component).
+    template <class Range>
+    struct parallel_range;
+
+    template <class T, class Allocator, class Layout, size_t InlineRows, class Growth>
+    struct parallel_range<vector<T, Allocator, Layout, InlineRows, Growth>> {
+        template <class Vector, size_t...Is>
+        static auto columns(Vector& vec, std::index_sequence<Is...>) noexcept {
+            return std::array<column_bytes, sizeof...(Is)>{ make_column_bytes(vec.template get_span<Is>().data())... };
+        }
+        template <class Vector>
+        static auto columns(Vector& vec) noexcept {
+            return columns(vec, std::make_index_sequence<vector<T, Allocator, Layout, InlineRows, Growth>::components_count>{});
+        }
+        template <class Vector, class F>
+        static decltype(auto) apply(Vector& vec, F& f, size_type i) { return f(vec[i]); }
+    };
+
+    template <size_t Pos, class Aggregate, class T>
+    struct parallel_range<vector_span<Pos, Aggregate, T>> {
+        template <class Span>
+        static auto columns(Span& span) noexcept {
+            return std::array<column_bytes, 1>{ make_column_bytes(span.data()) };
+        }
+        template <class Span, class F>
+        static decltype(auto) apply(Span& span, F& f, size_type i) { return f(span.data()[i]); }
+    };
+
+    // Packed elements are given as detail::packed_reference (or values for const spans).
+    template <size_t Pos, class Aggregate, class T, size_t Bits>
+    struct parallel_range<packed_span<Pos, Aggregate, T, Bits>> :
+        parallel_range<vector_span<Pos, Aggregate, T>> {};
+
+    template <class...Ts>
+    struct parallel_range<zip_view<Ts...>> {
+        template <size_t...Is>
+        static auto columns(zip_view<Ts...> const& view, std::index_sequence<Is...>) noexcept {
+            return std::array<column_bytes, sizeof...(Ts)>{ make_column_bytes(std::get<Is>(view.begin().pointers()))... };
+        }
+        static auto columns(zip_view<Ts...> const& view) noexcept {
+            return columns(view, std::index_sequence_for<Ts...>{});
+        }
+        template <class F>
+        static decltype(auto) apply(zip_view<Ts...> const& view, F& f, size_type i) { return std::apply(f, view[i]); }
+    };
+
+    template <class Range>
+    using parallel_range_t = parallel_range<std::remove_cv_t<std::remove_reference_t<Range>>>;
+
+    template <class Policy>
+    using enable_if_policy_t = std::enable_if_t<execution::is_execution_policy_v<Policy>>;
+
+} // namespace soa::detail
+
+namespace soa {
+
+// Calls 'f' on each row of a soa::vector (with a proxy), or on each element of
+// a vector_span or a zip_view (with references to the components).
+template <class Policy, class Range, class F, class = detail::enable_if_policy_t<Policy>>
+void for_each(Policy&& policy, Range&& range, F f) {
+    using traits = detail::parallel_range_t<Range>;
+    auto const& native = execution::detail::to_policy(policy);
+    auto const chunks = detail::plan_chunks(native, static_cast<size_type>(range.size()), traits::columns(range));
+    auto body = [&range, &f] (int, size_type first, size_type last) {
+        for (auto i = first; i < last; ++i) traits::apply(range, f, i);
+    };
+    detail::run_chunks(native, chunks, body);
+}
+
+// Computes 'out[i] = f(in[i]...)' for each element of the spans, 'out' being possibly one of the inputs.
+template <class Policy, class Out, class F, class...Spans, class = detail::enable_if_policy_t<Policy>>
+void transform(Policy&& policy, Out& out, F f, Spans const&...in) {
+    auto const n = static_cast<size_type>(std::size(out));
+    if (((static_cast<size_type>(std::size(in)) != n) || ...)) {
+        using namespace std::literals;
+        throw std::invalid_argument{ "Spans of different sizes given to soa::transform"s };
+    }
+    auto const& native = execution::detail::to_policy(policy);
+    auto const columns = std::array<detail::column_bytes, 1>{ detail::make_column_bytes(std::data(out)) };
+    auto const chunks = detail::plan_chunks(native, n, columns);
+
+    auto const dst = std::data(out);
+    auto const src = std::make_tuple(std::data(in)...);
+    auto body = [dst, &src, &f] (int, size_type first, size_type last) {
+        std::apply([dst, &f, first, last] (auto const*...ptrs) {
+            for (auto i = first; i < last; ++i) dst[i] = f(ptrs[i]...);
+        }, src);
+    };
+    detail::run_chunks(native, chunks, body);
+}
+
+// Reduces 'f(element)' for each row or element of the range with 'op', starting from 'init'.
+// Each chunk is reduced separately, then the chunk results are reduced in order :
+// 'op' must be associative, but the result doesn't depend on the threads scheduling.
+template <class Policy, class Range, class R, class Op, class F, class = detail::enable_if_policy_t<Policy>>
+R reduce(Policy&& policy, Range&& range, R init, Op op, F f) {
+    using traits = detail::parallel_range_t<Range>;
+    auto const& native = execution::detail::to_policy(policy);
+    auto const chunks = detail::plan_chunks(native, static_cast<size_type>(range.size()), std::array<detail::column_bytes, 0>{});
+
+    auto partials = std::vector<std::optional<R>>(static_cast<size_t>(chunks.count));
+    auto body = [&range, &op, &f, &partials] (int chunk, size_type first, size_type last) {
+        auto result = static_cast<R>(traits::apply(range, f, first));
+        for (auto i = first + 1; i < last; ++i)
+            result = op(std::move(result), traits::apply(range, f, i));
+        partials[static_cast<size_t>(chunk)] = std::move(result);
+    };
+    detail::run_chunks(native, chunks, body);
+
+    for (auto& partial : partials)
+        init = op(std::move(init), std::move(*partial));
+    return init;
+}
+
+} // namespace soa
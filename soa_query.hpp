@@ -0,0 +1,311 @@
+/*
+    soa_query.hpp
+    MIT license (2018)
+    Header repository : https://github.com/Dwarfobserver/soa_vector
+    You can contact me at sidney.congard@gmail.com
+ */
+
+#pragma once
+
+#include "soa_simd.hpp"
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Selections of rows for query-style scans over soa::vector columns (or any contiguous spans).
+// The predicates are evaluated on blocks of 64 rows, in a loop the compiler vectorizes, and give
+// a word of bits per block, which is then compressed to the indices of the selected rows.
+// The predicates are called with the values of each row, so they can combine several columns
+// without creating proxies : 'soa::select([] (float pos, int id) { return pos > 0 && id != 0; }, v.pos, v.id)'.
+
+namespace soa {
+
+// Indices of selected rows, in increasing order.
+using selection = std::vector<size_type>;
+
+// One bit per row, set for the selected rows.
+class row_mask {
+public:
+    // Rows per word.
+    static constexpr size_type word_rows = 64;
+
+    row_mask() noexcept = default;
+    explicit row_mask(size_type size, bool value = false);
+
+    size_type size() const noexcept { return size_; }
+    // Number of selected rows.
+    size_type count() const noexcept;
+
+    bool operator[](size_type i) const noexcept {
+        return (words_[static_cast<size_t>(i / word_rows)] >> (i % word_rows)) & 1;
+    }
+    void set(size_type i, bool value = true) noexcept;
+
+    // The bits after the last row are not set.
+    detail::packed_word const* words() const noexcept { return words_.data(); }
+    size_type words_count() const noexcept { return static_cast<size_type>(words_.size()); }
+
+    // Combines masks of the same size, or throws std::invalid_argument.
+    row_mask& operator&=(row_mask const& rhs);
+    row_mask& operator|=(row_mask const& rhs);
+    friend row_mask operator&(row_mask lhs, row_mask const& rhs) { return lhs &= rhs; }
+    friend row_mask operator|(row_mask lhs, row_mask const& rhs) { return lhs |= rhs; }
+    // Selects the other rows.
+    row_mask operator~() const;
+
+    // Indices of the selected rows.
+    selection indices() const;
+private:
+    template <class Pred, class...Spans>
+    friend row_mask select_mask(Pred&& pred, Spans const&...columns);
+
+    template <class F>
+    void combine(row_mask const& rhs, F&& f);
+    void clear_tail() noexcept;
+
+    std::vector<detail::packed_word> words_;
+    size_type size_ = 0;
+};
+
+namespace detail {
+
+    // Bits of 'flags' of 0 or 1, the first flag being the lowest bit.
+    // The flags are read by 8, and their bytes are gathered in the highest byte by a multiplication.
+    SOA_SIMD_INLINE packed_word pack_flags(unsigned char const* flags) noexcept {
+        auto word = packed_word{ 0 };
+        for (int i = 0; i < 64; i += 8) {
+            auto bytes = packed_word{ 0 };
+            for (int j = 0; j < 8; ++j) bytes |= static_cast<packed_word>(flags[i + j]) << (8 * j);
+            word |= ((bytes * 0x0102040810204080u) >> 56) << i;
+        }
+        return word;
+    }
+
+    // Calls 'out(first_row, word)' with the word of each block of 64 rows, for the rows satisfying 'pred'.
+    // The flags of a block are computed in a loop without branches, then packed in the word.
+    template <class Pred, class Out, class...Ps>
+    SOA_SIMD_INLINE void select_words(Pred& pred, Out& out, size_type n, Ps...in) {
+        constexpr auto rows = row_mask::word_rows;
+        unsigned char flags[rows];
+        size_type first = 0;
+        for (; first + rows <= n; first += rows) {
+            for (int i = 0; i < rows; ++i)
+                flags[i] = static_cast<bool>(pred(in[first + i]...));
+            out(first, pack_flags(flags));
+        }
+        if (first < n) {
+            auto const last = static_cast<int>(n - first);
+            for (int i = 0; i < rows; ++i)
+                flags[i] = i < last && static_cast<bool>(pred(in[first + i]...));
+            out(first, pack_flags(flags));
+        }
+    }
+
+#if SOA_SIMD_DISPATCH
+    template <class Pred, class Out, class...Ps>
+    __attribute__((target("avx2"))) void select_words_avx2(Pred& pred, Out& out, size_type n, Ps...in) {
+        select_words(pred, out, n, in...);
+    }
+    template <class Pred, class Out, class...Ps>
+    __attribute__((target("avx512f"))) void select_words_avx512(Pred& pred, Out& out, size_type n, Ps...in) {
+        select_words(pred, out, n, in...);
+    }
+#endif
+
+    template <class Pred, class Out, class...Ps>
+    void select_words_dispatch(Pred& pred, Out& out, size_type n, Ps...in) {
+#if SOA_SIMD_DISPATCH
+        switch (simd::active_isa()) {
+            case simd::isa::avx512: return select_words_avx512(pred, out, n, in...);
+            case simd::isa::avx2:   return select_words_avx2(pred, out, n, in...);
+            default:                return select_words(pred, out, n, in...);
+        }
+#else
+        select_words(pred, out, n, in...);
+#endif
+    }
+
+    // Appends 'first + i' to the selection for each bit i of the word.
+    inline void append_indices(selection& result, size_type first, packed_word word) {
+        auto const size = result.size();
+        result.resize(size + static_cast<size_t>(popcount(word)));
+        for (auto out = result.data() + size; word != 0; word &= word - 1)
+            *out++ = first + countr_zero(word);
+    }
+
+    // Calls 'f(i)' for each row i of the mask.
+    template <class F>
+    void for_each_selected(row_mask const& mask, F&& f) {
+        for (size_type w = 0; w < mask.words_count(); ++w) {
+            for (auto word = mask.words()[w]; word != 0; word &= word - 1)
+                f(w * row_mask::word_rows + countr_zero(word));
+        }
+    }
+
+    // Size of the spans, which must all have the same size.
+    template <class Span, class...Spans>
+    size_type query_size(char const* function, Span const& first, Spans const&...others) {
+        simd::detail::check_sizes(function, first, others...);
+        return static_cast<size_type>(std::size(first));
+    }
+
+} // namespace detail
+
+// Returns the mask of the rows for which 'pred(columns[i]...)' is true.
+template <class Pred, class...Spans>
+row_mask select_mask(Pred&& pred, Spans const&...columns) {
+    static_assert(sizeof...(Spans) > 0, "soa::select_mask requires at least one span");
+    auto const n = detail::query_size("select_mask", columns...);
+    auto result = row_mask{ n };
+    auto out = [words = result.words_.data()] (size_type first, detail::packed_word word) noexcept {
+        words[first / row_mask::word_rows] = word;
+    };
+    detail::select_words_dispatch(pred, out, n, std::data(columns)...);
+    return result;
+}
+
+// Returns the indices of the rows for which 'pred(columns[i]...)' is true.
+template <class Pred, class...Spans>
+selection select(Pred&& pred, Spans const&...columns) {
+    static_assert(sizeof...(Spans) > 0, "soa::select requires at least one span");
+    auto const n = detail::query_size("select", columns...);
+    auto result = selection{};
+    auto out = [&result] (size_type first, detail::packed_word word) {
+        detail::append_indices(result, first, word);
+    };
+    detail::select_words_dispatch(pred, out, n, std::data(columns)...);
+    return result;
+}
+
+// Keeps the rows of the selection for which 'pred(columns[i]...)' is true.
+// Only the selected rows are read, so it is faster than a new selection on the columns
+// when few rows are selected. The selection indices must be lower than the spans sizes.
+template <class Pred, class...Spans>
+selection refine(selection const& rows, Pred&& pred, Spans const&...columns) {
+    static_assert(sizeof...(Spans) > 0, "soa::refine requires at least one span");
+    detail::query_size("refine", columns...);
+    auto result = selection(rows.size());
+    auto const out = result.data();
+    size_t n = 0;
+    for (auto const i : rows) {
+        out[n] = i;
+        n += static_cast<bool>(pred(std::data(columns)[i]...));
+    }
+    result.resize(n);
+    return result;
+}
+
+// Writes the elements of the selected rows of a column to 'out', and returns the end of the output.
+template <class Span, class OutputIt>
+OutputIt gather(Span const& column, selection const& rows, OutputIt out) {
+    auto const data = std::data(column);
+    for (auto const i : rows) *out++ = data[i];
+    return out;
+}
+template <class Span, class OutputIt>
+OutputIt gather(Span const& column, row_mask const& rows, OutputIt out) {
+    auto const data = std::data(column);
+    detail::for_each_selected(rows, [&] (size_type i) { *out++ = data[i]; });
+    return out;
+}
+
+// Returns the elements of the selected rows of a column.
+template <class Span>
+std::vector<typename Span::value_type> gather(Span const& column, selection const& rows) {
+    auto result = std::vector<typename Span::value_type>{};
+    result.reserve(rows.size());
+    gather(column, rows, std::back_inserter(result));
+    return result;
+}
+template <class Span>
+std::vector<typename Span::value_type> gather(Span const& column, row_mask const& rows) {
+    auto result = std::vector<typename Span::value_type>{};
+    result.reserve(static_cast<size_t>(rows.count()));
+    gather(column, rows, std::back_inserter(result));
+    return result;
+}
+
+// Reduces 'f(columns[i]...)' for each selected row i with 'op', starting from 'init'
+// (eg. 'soa::reduce_selected(rows, 0.f, std::plus<>{}, [] (float mass) { return mass; }, v.mass)').
+// The rows are reduced in increasing order.
+template <class R, class Op, class F, class...Spans>
+R reduce_selected(selection const& rows, R init, Op&& op, F&& f, Spans const&...columns) {
+    static_assert(sizeof...(Spans) > 0, "soa::reduce_selected requires at least one span");
+    detail::query_size("reduce_selected", columns...);
+    for (auto const i : rows) init = op(init, f(std::data(columns)[i]...));
+    return init;
+}
+template <class R, class Op, class F, class...Spans>
+R reduce_selected(row_mask const& rows, R init, Op&& op, F&& f, Spans const&...columns) {
+    static_assert(sizeof...(Spans) > 0, "soa::reduce_selected requires at least one span");
+    detail::query_size("reduce_selected", columns...);
+    detail::for_each_selected(rows, [&] (size_type i) { init = op(init, f(std::data(columns)[i]...)); });
+    return init;
+}
+
+// row_mask implementation.
+
+inline row_mask::row_mask(size_type size, bool value) :
+    words_(static_cast<size_t>((size + word_rows - 1) / word_rows), value ? ~detail::packed_word{ 0 } : 0),
+    size_{ size }
+{
+    clear_tail();
+}
+
+inline size_type row_mask::count() const noexcept {
+    size_type n = 0;
+    for (auto const word : words_) n += detail::popcount(word);
+    return n;
+}
+
+inline void row_mask::set(size_type i, bool value) noexcept {
+    auto& word = words_[static_cast<size_t>(i / word_rows)];
+    auto const bit = detail::packed_word{ 1 } << (i % word_rows);
+    word = value ? word | bit : word & ~bit;
+}
+
+template <class F>
+void row_mask::combine(row_mask const& rhs, F&& f) {
+    if (size_ != rhs.size_) {
+        using namespace std::literals;
+        throw std::invalid_argument{ detail::concatene(
+            "soa::row_mask of size "sv, std::to_string(rhs.size_),
+            " combined with a mask of size "sv, std::to_string(size_)
+        )};
+    }
+    for (size_t w = 0; w < words_.size(); ++w) words_[w] = f(words_[w], rhs.words_[w]);
+}
+
+inline row_mask& row_mask::operator&=(row_mask const& rhs) {
+    combine(rhs, [] (detail::packed_word lhs, detail::packed_word rhs) { return lhs & rhs; });
+    return *this;
+}
+
+inline row_mask& row_mask::operator|=(row_mask const& rhs) {
+    combine(rhs, [] (detail::packed_word lhs, detail::packed_word rhs) { return lhs | rhs; });
+    return *this;
+}
+
+inline row_mask row_mask::operator~() const {
+    auto result = *this;
+    for (auto& word : result.words_) word = ~word;
+    result.clear_tail();
+    return result;
+}
+
+inline selection row_mask::indices() const {
+    auto result = selection{};
+    result.reserve(static_cast<size_t>(count()));
+    for (size_type w = 0; w < words_count(); ++w)
+        detail::append_indices(result, w * word_rows, words_[static_cast<size_t>(w)]);
+    return result;
+}
+
+inline void row_mask::clear_tail() noexcept {
+    auto const rows = size_ % word_rows;
+    if (rows != 0) words_.back() &= (detail::packed_word{ 1 } << rows) - 1;
+}
+
+} // namespace soa
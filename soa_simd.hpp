@@ -0,0 +1,396 @@
+
+/*
+    soa_simd.hpp
+    MIT license (2018)
+    Header repository : https://github.com/Dwarfobserver/soa_vector
+    You can contact me at sidney.congard@gmail.com
+ */
+
+#pragma once
+
+#include "soa_vector.hpp"
+#include <cstdint>
+#include <type_traits>
+
+// Explicit SIMD kernels over soa::vector columns.
+// Defining SOA_SIMD_USE_STD uses std::experimental::simd batches when available, instead of the built-in one.
+// Defining SOA_SIMD_RUNTIME_DISPATCH selects the instruction set at runtime (GCC and Clang on x86),
+// instead of using the one the translation unit is compiled for.
+
+#if defined(SOA_SIMD_USE_STD) && __has_include(<experimental/simd>)
+#include <experimental/simd>
+#define SOA_SIMD_STD 1
+#else
+#define SOA_SIMD_STD 0
+#endif
+
+#if defined(SOA_SIMD_RUNTIME_DISPATCH) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SOA_SIMD_DISPATCH 1
+#else
+#define SOA_SIMD_DISPATCH 0
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#define SOA_SIMD_INLINE __forceinline
+#else
+#define SOA_SIMD_INLINE inline __attribute__((always_inline))
+#endif
+
+namespace soa::simd {
+
+// Instruction sets the kernels can be compiled for.
+enum class isa { scalar, sse2, avx2, avx512, neon };
+
+// Width in bytes of the registers of an instruction set (0 for scalar code).
+constexpr size_t register_bytes(isa set) noexcept {
+    switch (set) {
+        case isa::sse2:   return 16;
+        case isa::neon:   return 16;
+        case isa::avx2:   return 32;
+        case isa::avx512: return 64;
+        default:          return 0;
+    }
+}
+
+// Instruction set the translation unit is compiled for.
+constexpr isa compiled_isa =
+#if defined(__AVX512F__)
+    isa::avx512;
+#elif defined(__AVX2__)
+    isa::avx2;
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    isa::sse2;
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+    isa::neon;
+#else
+    isa::scalar;
+#endif
+
+// Best instruction set supported by the CPU when SOA_SIMD_RUNTIME_DISPATCH is defined,
+// or the compiled one otherwise.
+inline isa detect_isa() noexcept {
+#if SOA_SIMD_DISPATCH
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return isa::avx512;
+    if (__builtin_cpu_supports("avx2"))    return isa::avx2;
+    if (__builtin_cpu_supports("sse2"))    return isa::sse2;
+    return isa::scalar;
+#else
+    return compiled_isa;
+#endif
+}
+
+namespace detail {
+    inline isa& active_isa() noexcept {
+        static isa set = detect_isa();
+        return set;
+    }
+}
+
+// Instruction set used by the kernels, detected at the first call.
+inline isa active_isa() noexcept { return detail::active_isa(); }
+
+// Forces the instruction set used by the kernels (eg. to compare them in benchmarks).
+// With SOA_SIMD_RUNTIME_DISPATCH, it must be supported by the CPU.
+inline void set_isa(isa set) noexcept { detail::active_isa() = set; }
+
+#if SOA_SIMD_STD
+
+template <class T, int N>
+using batch = std::experimental::fixed_size_simd<T, N>;
+
+template <class T, int N>
+SOA_SIMD_INLINE batch<T, N> min(batch<T, N> const& lhs, batch<T, N> const& rhs) noexcept {
+    return std::experimental::min(lhs, rhs);
+}
+template <class T, int N>
+SOA_SIMD_INLINE batch<T, N> max(batch<T, N> const& lhs, batch<T, N> const& rhs) noexcept {
+    return std::experimental::max(lhs, rhs);
+}
+
+// Converts the lanes of a batch to another type.
+template <class U, class T, int N>
+SOA_SIMD_INLINE batch<U, N> cast(batch<T, N> const& value) noexcept {
+    return std::experimental::static_simd_cast<batch<U, N>>(value);
+}
+
+#else
+
+// Pack of N values with element-wise operations, that the optimizer maps to SIMD registers.
+// Scalars are implicitly broadcasted, so 'pos + speed * dt' works for batches and scalars alike.
+template <class T, int N>
+struct batch {
+    static_assert(std::is_arithmetic_v<T>, "soa::simd::batch only holds arithmetic types");
+
+    T values[N];
+
+    batch() noexcept = default;
+    batch(T value) noexcept {
+        for (int i = 0; i < N; ++i) values[i] = value;
+    }
+
+    static constexpr int size() noexcept { return N; }
+
+    T &      operator[](int i)       noexcept { return values[i]; }
+    T const& operator[](int i) const noexcept { return values[i]; }
+
+    SOA_SIMD_INLINE batch operator-() const noexcept {
+        batch result;
+        for (int i = 0; i < N; ++i) result.values[i] = -values[i];
+        return result;
+    }
+
+#define SOA_SIMD_BATCH_OPERATOR(op) \
+    SOA_SIMD_INLINE batch& operator op##=(batch const& rhs) noexcept { \
+        for (int i = 0; i < N; ++i) values[i] op##= rhs.values[i]; \
+        return *this; \
+    } \
+    SOA_SIMD_INLINE friend batch operator op(batch lhs, batch const& rhs) noexcept { \
+        return lhs op##= rhs; \
+    }
+
+    SOA_SIMD_BATCH_OPERATOR(+)
+    SOA_SIMD_BATCH_OPERATOR(-)
+    SOA_SIMD_BATCH_OPERATOR(*)
+    SOA_SIMD_BATCH_OPERATOR(/)
+
+#undef SOA_SIMD_BATCH_OPERATOR
+};
+
+template <class T, int N>
+SOA_SIMD_INLINE batch<T, N> min(batch<T, N> lhs, batch<T, N> const& rhs) noexcept {
+    for (int i = 0; i < N; ++i) lhs.values[i] = rhs.values[i] < lhs.values[i] ? rhs.values[i] : lhs.values[i];
+    return lhs;
+}
+template <class T, int N>
+SOA_SIMD_INLINE batch<T, N> max(batch<T, N> lhs, batch<T, N> const& rhs) noexcept {
+    for (int i = 0; i < N; ++i) lhs.values[i] = lhs.values[i] < rhs.values[i] ? rhs.values[i] : lhs.values[i];
+    return lhs;
+}
+
+// Converts the lanes of a batch to another type.
+template <class U, class T, int N>
+SOA_SIMD_INLINE batch<U, N> cast(batch<T, N> const& value) noexcept {
+    batch<U, N> result;
+    for (int i = 0; i < N; ++i) result.values[i] = static_cast<U>(value.values[i]);
+    return result;
+}
+
+#endif
+
+// Scalar overloads, used by the kernels for the elements which don't fill a batch.
+template <class T, class = std::enable_if_t<std::is_arithmetic_v<T>>>
+SOA_SIMD_INLINE T min(T lhs, T rhs) noexcept { return rhs < lhs ? rhs : lhs; }
+template <class T, class = std::enable_if_t<std::is_arithmetic_v<T>>>
+SOA_SIMD_INLINE T max(T lhs, T rhs) noexcept { return lhs < rhs ? rhs : lhs; }
+template <class U, class T, class = std::enable_if_t<std::is_arithmetic_v<T>>>
+SOA_SIMD_INLINE U cast(T value) noexcept { return static_cast<U>(value); }
+
+// Number of lanes of the batches used for the types Ts with registers of 'Bytes' bytes.
+// The widest type fills a register, so all the batches have the same number of lanes.
+template <size_t Bytes, class...Ts>
+constexpr int lanes_v = static_cast<int>(std::max<size_t>(1, Bytes / std::max({ sizeof(Ts)... })));
+
+namespace detail {
+
+    template <size_t Alignment, class T>
+    SOA_SIMD_INLINE T* assume_aligned(T* ptr) noexcept {
+#if defined(__GNUC__)
+        if constexpr (Alignment > alignof(T))
+            return static_cast<T*>(__builtin_assume_aligned(ptr, Alignment));
+        else
+            return ptr;
+#else
+        return ptr;
+#endif
+    }
+
+    // Loads and stores batches, aligned on 'Alignment' bytes if it is not 0.
+    template <int N, size_t Alignment, class T>
+    SOA_SIMD_INLINE batch<T, N> load(T const* ptr) noexcept {
+#if SOA_SIMD_STD
+        if constexpr (Alignment > 0)
+            return batch<T, N>{ ptr, std::experimental::overaligned<Alignment> };
+        else
+            return batch<T, N>{ ptr, std::experimental::element_aligned };
+#else
+        ptr = assume_aligned<Alignment>(ptr);
+        batch<T, N> result;
+        for (int i = 0; i < N; ++i) result.values[i] = ptr[i];
+        return result;
+#endif
+    }
+
+    template <int N, size_t Alignment, class T, class Batch>
+    SOA_SIMD_INLINE void store(T* ptr, Batch const& value) noexcept {
+#if SOA_SIMD_STD
+        auto const converted = std::experimental::static_simd_cast<batch<T, N>>(value);
+        if constexpr (Alignment > 0)
+            converted.copy_to(ptr, std::experimental::overaligned<Alignment>);
+        else
+            converted.copy_to(ptr, std::experimental::element_aligned);
+#else
+        ptr = assume_aligned<Alignment>(ptr);
+        for (int i = 0; i < N; ++i) ptr[i] = static_cast<T>(value[i]);
+#endif
+    }
+
+    template <int N, class T>
+    bool is_batch_aligned(T const* ptr) noexcept {
+        return reinterpret_cast<std::uintptr_t>(ptr) % (N * sizeof(T)) == 0;
+    }
+
+    // Number of scalar iterations after which all the pointers are aligned on their batch size,
+    // or -1 if they can't be aligned together.
+    template <int N, class T, class...Ts>
+    int aligned_head(T const* first, Ts const*...others) noexcept {
+        constexpr auto alignment = N * sizeof(T);
+        auto const misalignment = reinterpret_cast<std::uintptr_t>(first) % alignment;
+        auto const head = static_cast<int>(((alignment - misalignment) % alignment) / sizeof(T));
+        return (is_batch_aligned<N>(others + head) && ...) ? head : -1;
+    }
+
+    // Kernels for registers of 'Bytes' bytes.
+
+    template <size_t Bytes, class F, class O, class...Ts>
+    SOA_SIMD_INLINE void transform(F& f, size_type n, O* out, Ts const*...in) {
+        constexpr int N = lanes_v<Bytes, O, Ts...>;
+        size_type i = 0;
+        if constexpr (N > 1) {
+            auto const head = aligned_head<N>(static_cast<O const*>(out), in...);
+            if (head >= 0) {
+                for (auto const end = std::min<size_type>(head, n); i < end; ++i)
+                    out[i] = static_cast<O>(f(in[i]...));
+                for (; i + N <= n; i += N)
+                    store<N, N * sizeof(O)>(out + i, f(load<N, N * sizeof(Ts)>(in + i)...));
+            }
+            else {
+                for (; i + N <= n; i += N)
+                    store<N, 0>(out + i, f(load<N, 0>(in + i)...));
+            }
+        }
+        for (; i < n; ++i)
+            out[i] = static_cast<O>(f(in[i]...));
+    }
+
+    template <int N, bool Aligned, class R, class Op, class F, class...Ts>
+    SOA_SIMD_INLINE R reduce_batches(size_type& i, R result, Op& op, F& f, size_type n, Ts const*...in) {
+        auto acc = f(load<N, Aligned ? N * sizeof(Ts) : 0>(in + i)...);
+        for (i += N; i + N <= n; i += N)
+            acc = op(acc, f(load<N, Aligned ? N * sizeof(Ts) : 0>(in + i)...));
+        for (int lane = 0; lane < N; ++lane)
+            result = op(result, acc[lane]);
+        return result;
+    }
+
+    template <size_t Bytes, class R, class Op, class F, class...Ts>
+    SOA_SIMD_INLINE R reduce(R result, Op& op, F& f, size_type n, Ts const*...in) {
+        constexpr int N = lanes_v<Bytes, Ts...>;
+        size_type i = 0;
+        if constexpr (N > 1) {
+            auto const head = aligned_head<N>(in...);
+            if (head >= 0) {
+                for (auto const end = std::min<size_type>(head, n); i < end; ++i)
+                    result = op(result, f(in[i]...));
+                if (i + N <= n) result = reduce_batches<N, true>(i, result, op, f, n, in...);
+            }
+            else if (n >= N) result = reduce_batches<N, false>(i, result, op, f, n, in...);
+        }
+        for (; i < n; ++i)
+            result = op(result, f(in[i]...));
+        return result;
+    }
+
+#if SOA_SIMD_DISPATCH
+    // Kernels compiled for instruction sets which may not be enabled in the translation unit.
+    // The batch operations and the user functions are inlined in them.
+
+    template <class F, class O, class...Ts>
+    __attribute__((target("avx2"))) void transform_avx2(F& f, size_type n, O* out, Ts const*...in) {
+        transform<32>(f, n, out, in...);
+    }
+    template <class F, class O, class...Ts>
+    __attribute__((target("avx512f"))) void transform_avx512(F& f, size_type n, O* out, Ts const*...in) {
+        transform<64>(f, n, out, in...);
+    }
+    template <class R, class Op, class F, class...Ts>
+    __attribute__((target("avx2"))) R reduce_avx2(R result, Op& op, F& f, size_type n, Ts const*...in) {
+        return reduce<32>(result, op, f, n, in...);
+    }
+    template <class R, class Op, class F, class...Ts>
+    __attribute__((target("avx512f"))) R reduce_avx512(R result, Op& op, F& f, size_type n, Ts const*...in) {
+        return reduce<64>(result, op, f, n, in...);
+    }
+#endif
+
+    template <class F, class O, class...Ts>
+    void transform_dispatch(F& f, size_type n, O* out, Ts const*...in) {
+        switch (active_isa()) {
+#if SOA_SIMD_DISPATCH
+            case isa::avx512: return transform_avx512(f, n, out, in...);
+            case isa::avx2:   return transform_avx2(f, n, out, in...);
+#else
+            case isa::avx512: return transform<64>(f, n, out, in...);
+            case isa::avx2:   return transform<32>(f, n, out, in...);
+#endif
+            case isa::sse2:
+            case isa::neon:   return transform<16>(f, n, out, in...);
+            default:          return transform<0>(f, n, out, in...);
+        }
+    }
+
+    template <class R, class Op, class F, class...Ts>
+    R reduce_dispatch(R result, Op& op, F& f, size_type n, Ts const*...in) {
+        switch (active_isa()) {
+#if SOA_SIMD_DISPATCH
+            case isa::avx512: return reduce_avx512(result, op, f, n, in...);
+            case isa::avx2:   return reduce_avx2(result, op, f, n, in...);
+#else
+            case isa::avx512: return reduce<64>(result, op, f, n, in...);
+            case isa::avx2:   return reduce<32>(result, op, f, n, in...);
+#endif
+            case isa::sse2:
+            case isa::neon:   return reduce<16>(result, op, f, n, in...);
+            default:          return reduce<0>(result, op, f, n, in...);
+        }
+    }
+
+    template <class Span, class...Spans>
+    void check_sizes(char const* function, Span const& first, Spans const&...others) {
+        auto const n = static_cast<size_type>(std::size(first));
+        if (((static_cast<size_type>(std::size(others)) != n) || ...)) {
+            using namespace std::literals;
+            throw std::invalid_argument{ soa::detail::concatene(
+                "Spans of different sizes given to soa::"sv, std::string_view{ function }
+            )};
+        }
+    }
+
+} // namespace detail
+} // namespace soa::simd
+
+namespace soa {
+
+// Computes 'out[i] = f(in[i]...)' for each element of the spans, 'out' being possibly one of the inputs
+// (eg. 'soa::simd_transform(v.pos, [dt] (auto p, auto s) { return p + s * dt; }, v.pos, v.speed)').
+// 'f' is called with simd::batch values, or with scalars for the first and last elements which
+// can't be processed with aligned batches. Columns of a simd_layout don't have scalar head.
+template <class Out, class F, class...Spans>
+void simd_transform(Out& out, F&& f, Spans const&...in) {
+    simd::detail::check_sizes("simd_transform", out, in...);
+    simd::detail::transform_dispatch(f, static_cast<size_type>(std::size(out)), std::data(out), std::data(in)...);
+}
+
+// Reduces 'f(in[i]...)' for each element of the spans with 'op', starting from 'init'
+// (eg. 'soa::simd_reduce(0.f, std::plus<>{}, [] (auto p) { return p * p; }, v.pos)').
+// 'op' is applied on batches then on their lanes, so it must be associative and commutative :
+// floating point results may differ slightly from a sequential loop.
+template <class R, class Op, class F, class...Spans>
+R simd_reduce(R init, Op&& op, F&& f, Spans const&...in) {
+    static_assert(sizeof...(Spans) > 0, "soa::simd_reduce requires at least one span");
+    simd::detail::check_sizes("simd_reduce", in...);
+    auto const n = static_cast<size_type>(std::size(std::get<0>(std::forward_as_tuple(in...))));
+    return simd::detail::reduce_dispatch(init, op, f, n, std::data(in)...);
+}
+
+} // namespace soa
@@ -0,0 +1,462 @@
+/*
+    soa_snapshot.hpp
+    MIT license (2018)
+    Header repository : https://github.com/Dwarfobserver/soa_vector
+    You can contact me at sidney.congard@gmail.com
+ */
+
+#pragma once
+
+#include "soa_vector.hpp"
+#include <atomic>
+#include <limits>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+// Copy-on-write columns, for point-in-time reads of rows updated continually by a writer thread.
+// Each column is split in pages of a fixed number of rows, which are reference-counted and shared
+// between the vector and it's snapshots. Taking a snapshot only shares the pages of each column,
+// and the writer copies a page of a column when it modifies it while a snapshot still holds it :
+// the readers scanning a column never pay for copying the others.
+
+namespace soa {
+
+// Contiguous elements of a column page.
+template <class M>
+class column_page {
+public:
+    column_page(M* data, size_type size) noexcept : data_{ data }, size_{ size } {}
+
+    M* data() const noexcept { return data_; }
+    size_type size() const noexcept { return size_; }
+    bool empty() const noexcept { return size_ == 0; }
+
+    M& operator[](size_type i) const noexcept { return data_[i]; }
+    M* begin() const noexcept { return data_; }
+    M* end() const noexcept { return data_ + size_; }
+private:
+    M* data_;
+    size_type size_;
+};
+
+namespace detail {
+
+    // Page of 'PageRows' elements of a column : the first 'size' elements are constructed.
+    template <class M, size_t PageRows>
+    struct cow_page {
+        std::atomic<int> refs{ 1 };
+        size_type size = 0;
+        alignas(M) std::byte bytes[PageRows * sizeof(M)];
+
+        M* data() noexcept { return reinterpret_cast<M*>(bytes); }
+    };
+
+    // Pages of a column. The table is shared as the pages, so a snapshot takes a reference per column.
+    template <class Page, class Allocator>
+    struct cow_table {
+        using allocator_type = Allocator;
+
+        explicit cow_table(Allocator const& allocator) noexcept : pages{ allocator } {}
+
+        std::atomic<int> refs{ 1 };
+        std::vector<Page*, Allocator> pages;
+    };
+
+    // Column of a soa::cow_vector, which holds a reference on it's table.
+    // The table and the pages are modified in place only when the column holds the single reference,
+    // which is loaded with an acquire ordering so the reads of the released owners are finished.
+    // The allocator is copied with the column : the pages are deallocated by their last owner.
+    template <class M, size_t PageRows, class Allocator>
+    class cow_column {
+        using page_type = cow_page<M, PageRows>;
+        using page_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<page_type>;
+        using table_type = cow_table<page_type,
+            typename std::allocator_traits<Allocator>::template rebind_alloc<page_type*>>;
+        using table_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<table_type>;
+
+        static constexpr size_type page_rows = static_cast<size_type>(PageRows);
+    public:
+        explicit cow_column(Allocator const& allocator) noexcept : allocator_{ allocator }, table_{ nullptr } {}
+        cow_column(cow_column const& rhs) noexcept;
+        cow_column(cow_column && rhs) noexcept :
+            allocator_{ rhs.allocator_ }, table_{ std::exchange(rhs.table_, nullptr) } {}
+        cow_column& operator=(cow_column rhs) noexcept { swap(rhs); return *this; }
+        ~cow_column() { release(table_); }
+
+        void swap(cow_column& rhs) noexcept;
+        friend void swap(cow_column& lhs, cow_column& rhs) noexcept { lhs.swap(rhs); }
+
+        Allocator get_allocator() const noexcept { return Allocator{ allocator_ }; }
+
+        M const* page(size_type p) const noexcept { return table_->pages[static_cast<size_t>(p)]->data(); }
+
+        // Pointers to the elements of a page, which is copied first if it is shared.
+        M* mutable_page(size_type p) { return own_page(p)->data(); }
+        M* mutable_element(size_type row) { return mutable_page(row / page_rows) + row % page_rows; }
+
+        // Storage of the element 'row' after the 'row' elements of the column, whose page is allocated
+        // or copied first. Once constructed, the element is added to it's page with 'commit_back(row)'.
+        M* back_slot(size_type row);
+        void commit_back(size_type row) noexcept { ++table_->pages[static_cast<size_t>(row / page_rows)]->size; }
+        // Destroys the last element 'row', whose page is not shared.
+        void destroy_back(size_type row) noexcept;
+
+        void clear() noexcept { release(std::exchange(table_, nullptr)); }
+    private:
+        static bool is_unique(std::atomic<int> const& refs) noexcept {
+            return refs.load(std::memory_order_acquire) == 1;
+        }
+        size_type pages_count() const noexcept {
+            return table_ ? static_cast<size_type>(table_->pages.size()) : 0;
+        }
+
+        // Copies the table or the page 'p' if they are shared.
+        void own_table();
+        page_type* own_page(size_type p);
+
+        page_type* new_page();
+        void release(page_type* page) noexcept;
+        void release(table_type* table) noexcept;
+
+        page_allocator allocator_;
+        table_type* table_;
+    };
+
+    // Rows of a soa::cow_vector, read through proxies or by column pages.
+    template <class T, size_t PageRows, class Allocator, class Sequence = std::make_index_sequence<arity_v<members<T>>>>
+    class cow_rows;
+
+    template <class T, size_t PageRows, class Allocator, size_t...Is>
+    class cow_rows<T, PageRows, Allocator, std::index_sequence<Is...>> {
+        static_assert(is_defined_v<T>,
+            "soa::cow_vector<T> can't be instancied because the required types 'soa::members<T>', "
+            "'soa::ref_proxy<T>' or 'soa::cref_proxy<T>' haven't been defined. "
+            "Did you forget to call the macro SOA_DEFINE_TYPE(T, members...) ?");
+        static_assert(PageRows > 0, "soa::cow_vector pages must have at least one row");
+        // The writer would modify the words shared with the rows of the snapshots.
+        static_assert(!has_packed_columns_v<T>, "soa::cow_vector doesn't support soa::packed columns");
+    public:
+        using value_type           = T;
+        using reference_type       = cref_proxy<T>;
+        using const_reference_type = cref_proxy<T>;
+
+        using iterator       = index_iterator<cow_rows, true>;
+        using const_iterator = index_iterator<cow_rows, true>;
+
+        // The number of T members.
+        static constexpr int components_count = sizeof...(Is);
+
+        // The number of rows of each page.
+        static constexpr size_type page_rows = static_cast<size_type>(PageRows);
+
+        // Informations.
+        size_type size() const noexcept { return size_; }
+        bool empty() const noexcept { return size_ == 0; }
+        size_type pages_count() const noexcept { return (size_ + page_rows - 1) / page_rows; }
+
+        // Accessors.
+        template <size_t I>
+        member_type_t<T, I> const& get(size_type i) const noexcept {
+            return std::get<I>(columns_).page(i / page_rows)[i % page_rows];
+        }
+        const_reference_type operator[](size_type i) const noexcept { return { get<Is>(i)... }; }
+
+        const_reference_type front() const noexcept { return (*this)[0]; }
+        const_reference_type back() const noexcept { return (*this)[size_ - 1]; }
+
+        // Iterators.
+        const_iterator begin()  const noexcept { return { this, 0 }; }
+        const_iterator cbegin() const noexcept { return begin(); }
+        const_iterator end()  const noexcept { return { this, size_ }; }
+        const_iterator cend() const noexcept { return end(); }
+
+        // Elements of the I-th column in the page 'p', which holds the rows [p * page_rows, p * page_rows + size).
+        template <size_t I>
+        column_page<member_type_t<T, I> const> page(size_type p) const noexcept {
+            return { std::get<I>(columns_).page(p), rows_of(p) };
+        }
+
+        cow_rows(cow_rows const& rhs) noexcept = default;
+        cow_rows(cow_rows && rhs) noexcept :
+            columns_{ std::move(rhs.columns_) }, size_{ std::exchange(rhs.size_, 0) } {}
+        cow_rows& operator=(cow_rows rhs) noexcept { swap(rhs); return *this; }
+    protected:
+        explicit cow_rows(Allocator const& allocator) noexcept :
+            columns_{ cow_column<member_type_t<T, Is>, PageRows, Allocator>{ allocator }... },
+            size_{ 0 }
+        {}
+
+        void swap(cow_rows& rhs) noexcept {
+            std::swap(columns_, rhs.columns_);
+            std::swap(size_, rhs.size_);
+        }
+
+        size_type rows_of(size_type p) const noexcept { return std::min(page_rows, size_ - p * page_rows); }
+
+        template <class Container>
+        void check_at(size_type i) const {
+            if (i < 0 || i >= size_) throw_out_of_range<Container>(i, size_);
+        }
+
+        std::tuple<cow_column<member_type_t<T, Is>, PageRows, Allocator>...> columns_;
+        size_type size_;
+    };
+
+} // ::detail
+
+template <class T, size_t PageRows, class Allocator>
+class cow_vector;
+
+// Immutable rows of a soa::cow_vector at the time of the snapshot. It holds the pages of it's columns,
+// which are never modified : the snapshots are read from any thread without synchronization.
+// The copies share the pages, and the last owner of a page (vector or snapshot) deallocates it.
+template <class T, size_t PageRows = 4096, class Allocator = std::allocator<T>>
+class cow_snapshot : public detail::cow_rows<T, PageRows, Allocator> {
+    using base = detail::cow_rows<T, PageRows, Allocator>;
+    friend class cow_vector<T, PageRows, Allocator>;
+
+    explicit cow_snapshot(base const& rows) noexcept : base{ rows } {}
+public:
+    // An empty snapshot.
+    cow_snapshot(Allocator const& allocator = Allocator{}) noexcept : base{ allocator } {}
+
+    void swap(cow_snapshot& rhs) noexcept { base::swap(rhs); }
+    friend void swap(cow_snapshot& lhs, cow_snapshot& rhs) noexcept { lhs.swap(rhs); }
+
+    typename base::const_reference_type at(size_type i) const {
+        this->template check_at<cow_snapshot>(i);
+        return (*this)[i];
+    }
+};
+
+// Stores the rows of T in copy-on-write column pages of 'PageRows' rows, for a writer thread
+// which gives consistent snapshots of the rows to reader threads (eg. through an atomic or a mutex
+// held only to exchange them). snapshot() only takes a reference on the table of each column.
+// While a snapshot holds a page, the writer modifies a copy of it : the first modification of each page
+// of each column after a snapshot copies the page, and the pages of the columns not modified stay shared.
+// A vector is used by one thread at a time, and it's copies share the pages as the snapshots.
+// The allocator is copied with the pages, and it is used by the thread which releases them last.
+template <class T, size_t PageRows = 4096, class Allocator = std::allocator<T>>
+class cow_vector : public detail::cow_rows<T, PageRows, Allocator> {
+    using base = detail::cow_rows<T, PageRows, Allocator>;
+public:
+    using allocator_type = Allocator;
+    using snapshot_type  = cow_snapshot<T, PageRows, Allocator>;
+
+    using typename base::const_reference_type;
+    using base::components_count;
+
+    // Constructors, assignments and destructor : the copies share the pages.
+    cow_vector(Allocator const& allocator = Allocator{}) noexcept : base{ allocator } {}
+
+    void swap(cow_vector& rhs) noexcept { base::swap(rhs); }
+    friend void swap(cow_vector& lhs, cow_vector& rhs) noexcept { lhs.swap(rhs); }
+
+    // Consistent rows for the readers, in constant time.
+    snapshot_type snapshot() const noexcept { return snapshot_type{ *this }; }
+
+    // Size modifiers : the pages shared by snapshots are released without being modified.
+    void clear() noexcept;
+
+    // Add and remove an element : the last page of each column is copied if it is shared.
+    // If an exception is thrown, the vector is unchanged.
+    template <class...Ts>
+    void emplace_back(Ts &&...components);
+    void push_back(T const& value);
+    void push_back(T && value);
+    void pop_back();
+
+    // Informations.
+    static constexpr size_type max_size() noexcept { return std::numeric_limits<size_type>::max(); }
+
+    allocator_type get_allocator() const noexcept { return std::get<0>(this->columns_).get_allocator(); }
+
+    // Accessors.
+    const_reference_type at(size_type i) const {
+        this->template check_at<cow_vector>(i);
+        return (*this)[i];
+    }
+
+    // Modifiers accessors : the page of the column is copied first if it is shared, so the elements
+    // are modified in place until the next snapshot or copy, which invalidates the references.
+    template <size_t I>
+    detail::member_type_t<T, I>& get_mutable(size_type i) {
+        return *std::get<I>(this->columns_).mutable_element(i);
+    }
+    // Same as get_mutable<I>, for the column of the given T member.
+    template <class M>
+    M& get_mutable(size_type i, M T::* member);
+
+    template <size_t I>
+    column_page<detail::member_type_t<T, I>> mutable_page(size_type p) {
+        return { std::get<I>(this->columns_).mutable_page(p), this->rows_of(p) };
+    }
+private:
+    using sequence_type = std::make_index_sequence<components_count>;
+};
+
+// detail::cow_column implementation.
+
+namespace detail {
+
+    template <class M, size_t PageRows, class Allocator>
+    cow_column<M, PageRows, Allocator>::cow_column(cow_column const& rhs) noexcept :
+        allocator_{ rhs.allocator_ },
+        table_{ rhs.table_ }
+    {
+        if (table_) table_->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    template <class M, size_t PageRows, class Allocator>
+    void cow_column<M, PageRows, Allocator>::swap(cow_column& rhs) noexcept {
+        using std::swap;
+        swap(allocator_, rhs.allocator_);
+        swap(table_, rhs.table_);
+    }
+
+    template <class M, size_t PageRows, class Allocator>
+    M* cow_column<M, PageRows, Allocator>::back_slot(size_type row) {
+        auto const p = row / page_rows;
+        page_type* page;
+        if (p == pages_count()) {
+            own_table();
+            auto& pages = table_->pages;
+            pages.push_back(nullptr);
+            try {
+                page = pages.back() = new_page();
+            }
+            catch (...) {
+                pages.pop_back();
+                throw;
+            }
+        }
+        else page = own_page(p);
+        return page->data() + row % page_rows;
+    }
+
+    template <class M, size_t PageRows, class Allocator>
+    void cow_column<M, PageRows, Allocator>::destroy_back(size_type row) noexcept {
+        auto const page = table_->pages[static_cast<size_t>(row / page_rows)];
+        detail::destroy_at(page->data() + row % page_rows);
+        --page->size;
+    }
+
+    template <class M, size_t PageRows, class Allocator>
+    void cow_column<M, PageRows, Allocator>::own_table() {
+        if (table_ && is_unique(table_->refs)) return;
+
+        auto allocator = table_allocator{ allocator_ };
+        auto const table = std::allocator_traits<table_allocator>::allocate(allocator, 1);
+        new (table) table_type{ typename table_type::allocator_type{ allocator_ } };
+        if (!table_) {
+            table_ = table;
+            return;
+        }
+        try {
+            table->pages = table_->pages;
+        }
+        catch (...) {
+            release(table);
+            throw;
+        }
+        for (auto const page : table->pages) page->refs.fetch_add(1, std::memory_order_relaxed);
+        release(std::exchange(table_, table));
+    }
+
+    template <class M, size_t PageRows, class Allocator>
+    typename cow_column<M, PageRows, Allocator>::page_type* cow_column<M, PageRows, Allocator>::own_page(size_type p) {
+        own_table();
+        auto& page = table_->pages[static_cast<size_t>(p)];
+        if (is_unique(page->refs)) return page;
+
+        auto const copy = new_page();
+        try {
+            detail::construct_copy(page->data(), copy->data(), page->size);
+        }
+        catch (...) {
+            release(copy);
+            throw;
+        }
+        copy->size = page->size;
+        release(std::exchange(page, copy));
+        return page;
+    }
+
+    template <class M, size_t PageRows, class Allocator>
+    typename cow_column<M, PageRows, Allocator>::page_type* cow_column<M, PageRows, Allocator>::new_page() {
+        auto const page = std::allocator_traits<page_allocator>::allocate(allocator_, 1);
+        // The elements are not initialized.
+        return new (page) page_type;
+    }
+
+    template <class M, size_t PageRows, class Allocator>
+    void cow_column<M, PageRows, Allocator>::release(page_type* page) noexcept {
+        if (page->refs.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+        detail::destroy(page->data(), page->data() + page->size);
+        page->~page_type();
+        std::allocator_traits<page_allocator>::deallocate(allocator_, page, 1);
+    }
+
+    template <class M, size_t PageRows, class Allocator>
+    void cow_column<M, PageRows, Allocator>::release(table_type* table) noexcept {
+        if (!table || table->refs.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+        for (auto const page : table->pages) release(page);
+        table->~table_type();
+        auto allocator = table_allocator{ allocator_ };
+        std::allocator_traits<table_allocator>::deallocate(allocator, table, 1);
+    }
+
+} // ::detail
+
+// soa::cow_vector implementation.
+
+template <class T, size_t PageRows, class Allocator>
+void cow_vector<T, PageRows, Allocator>::clear() noexcept {
+    std::apply([] (auto&...columns) { (columns.clear(), ...); }, this->columns_);
+    this->size_ = 0;
+}
+
+template <class T, size_t PageRows, class Allocator>
+template <class...Ts>
+void cow_vector<T, PageRows, Allocator>::emplace_back(Ts &&...components) {
+    auto const row = this->size_;
+    detail::construct_columns<components_count>([this, row] (auto index) {
+        return std::get<decltype(index)::value>(this->columns_).back_slot(row);
+    }, std::forward<Ts>(components)...);
+    std::apply([row] (auto&...columns) { (columns.commit_back(row), ...); }, this->columns_);
+    ++this->size_;
+}
+
+template <class T, size_t PageRows, class Allocator>
+void cow_vector<T, PageRows, Allocator>::push_back(T const& value) {
+    std::apply([this] (auto const&...components) { emplace_back(components...); },
+        detail::as_tuple<components_count>(value));
+}
+
+template <class T, size_t PageRows, class Allocator>
+void cow_vector<T, PageRows, Allocator>::push_back(T && value) {
+    auto tuple = detail::as_tuple<components_count>(value);
+    std::apply([this] (auto&...components) { emplace_back(std::move(components)...); }, tuple);
+}
+
+template <class T, size_t PageRows, class Allocator>
+void cow_vector<T, PageRows, Allocator>::pop_back() {
+    auto const row = this->size_ - 1;
+    // The pages are copied before destroying the elements, so the vector is unchanged if a copy throws.
+    std::apply([row] (auto&...columns) { (columns.mutable_element(row), ...); }, this->columns_);
+    std::apply([row] (auto&...columns) { (columns.destroy_back(row), ...); }, this->columns_);
+    this->size_ = row;
+}
+
+template <class T, size_t PageRows, class Allocator>
+template <class M>
+M& cow_vector<T, PageRows, Allocator>::get_mutable(size_type i, M T::* member) {
+    M* result = nullptr;
+    detail::dispatch_column(member, sequence_type{}, [this, i, &result] (auto index) {
+        result = &get_mutable<decltype(index)::value>(i);
+    });
+    return *result;
+}
+
+} // namespace soa
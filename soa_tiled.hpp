@@ -0,0 +1,591 @@
+/*
+    soa_tiled.hpp
+    MIT license (2018)
+    Header repository : https://github.com/Dwarfobserver/soa_vector
+    You can contact me at sidney.congard@gmail.com
+ */
+
+#pragma once
+
+#include "soa_vector.hpp"
+#include "soa_parallel.hpp"
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+// Array of structures of arrays (AoSoA) : the rows are stored in blocks of a fixed number of rows,
+// in which each member has a tile of contiguous elements. The members of a row stay in the same block,
+// and the tiles are aligned on their size (up to a cache line) so the kernels load them as SIMD batches.
+
+namespace soa {
+
+namespace detail {
+
+    // Strictest alignment given to the tiles, in bytes.
+    constexpr size_t max_tile_alignment = 64;
+
+    // Alignment in bytes of the I-th column tile in the blocks of soa::tiled_vector<T, Lanes>.
+    // The column options alignment is kept, but not the column groups.
+    template <class T, size_t Lanes, size_t I>
+    constexpr size_t tile_alignment_v = std::max({
+        alignof(member_type_t<T, I>),
+        std::gcd(Lanes * sizeof(member_type_t<T, I>), max_tile_alignment),
+        column_options_t<T, I>::alignment
+    });
+
+    // Offset in bytes of each column tile in a block, and size in bytes of the blocks.
+    template <class T>
+    struct tile_shifts {
+        std::array<size_t, arity_v<members<T>>> columns;
+        size_t alignment;
+        size_t block_bytes;
+    };
+
+    template <class T, size_t Lanes, size_t...Is>
+    constexpr tile_shifts<T> make_tile_shifts(std::index_sequence<Is...>) noexcept {
+        auto shifts = tile_shifts<T>{};
+        size_t bytes = 0;
+        ((shifts.columns[Is] = bytes = align_up(bytes, tile_alignment_v<T, Lanes, Is>),
+            bytes += Lanes * sizeof(member_type_t<T, Is>)), ...);
+        shifts.alignment   = std::max({ tile_alignment_v<T, Lanes, Is>... });
+        shifts.block_bytes = align_up(bytes, shifts.alignment);
+        return shifts;
+    }
+    template <class T, size_t Lanes>
+    constexpr tile_shifts<T> tile_shifts_v = make_tile_shifts<T, Lanes>(std::make_index_sequence<arity_v<members<T>>>{});
+
+    // Columns of a soa::tiled_vector block, which hold it's rows in the tiles.
+    template <class T>
+    class tile : public members_with_size<T> {
+    public:
+        tile(members<T> const& columns, size_type size) noexcept {
+            static_cast<members<T>&>(*this) = columns;
+            this->set_size(size);
+        }
+        size_type size() const noexcept { return this->size_; }
+    };
+
+    // Columns filters used to construct the tiles.
+    template <class T>
+    struct any_column : std::true_type {};
+    template <class T>
+    struct column_relocated_by_copy : std::bool_constant<relocate_by_copy_v<T>> {};
+
+} // ::detail
+
+// Stores the rows of T in blocks of 'Lanes' rows, each member having a tile of 'Lanes' contiguous
+// elements in the block. The rows are close in memory as in an array of aggregates, and the tiles
+// are SIMD-width columns given to the kernels by tile(b) : 'Lanes' is usually the number of lanes
+// of the batches (eg. 'soa::simd::lanes_v<32, float>' for AVX2 registers).
+// The blocks are stored in a single allocation which grows as soa::vector, and all the blocks are full
+// except the last one. The allocator is rebound to a type aligned on the strictest tile alignment.
+template <class T, size_t Lanes, class Allocator = std::allocator<T>>
+class tiled_vector {
+    static_assert(is_defined_v<T>,
+        "soa::tiled_vector<T> can't be instancied because the required types 'soa::members<T>', "
+        "'soa::ref_proxy<T>' or 'soa::cref_proxy<T>' haven't been defined. "
+        "Did you forget to call the macro SOA_DEFINE_TYPE(T, members...) ?");
+    static_assert(Lanes > 0, "soa::tiled_vector blocks must have at least one row");
+    // The tiles would share the words of packed columns.
+    static_assert(!detail::has_packed_columns_v<T>, "soa::tiled_vector doesn't support soa::packed columns");
+
+    static constexpr auto shifts = detail::tile_shifts_v<T, Lanes>;
+
+    friend struct detail::parallel_range<tiled_vector>;
+public:
+    // The alignment in bytes of the blocks, which is the strictest tile alignment.
+    static constexpr size_t alignment = shifts.alignment;
+
+    using allocator_type = typename std::allocator_traits<Allocator>::template
+        rebind_alloc<detail::aligned_bytes<alignment>>;
+
+    using value_type           = T;
+    using reference_type       = ref_proxy<T>;
+    using const_reference_type = cref_proxy<T>;
+
+    using iterator       = detail::index_iterator<tiled_vector, false>;
+    using const_iterator = detail::index_iterator<tiled_vector, true>;
+
+    // The columns of a block.
+    using tile_type = detail::tile<T>;
+
+    // The number of T members.
+    static constexpr int components_count = detail::arity_v<members<T>>;
+
+    // The number of rows of each block.
+    static constexpr size_type lanes = static_cast<size_type>(Lanes);
+
+    // The size in bytes of each block.
+    static constexpr size_t block_bytes = shifts.block_bytes;
+
+    // Constructors.
+    tiled_vector(Allocator const& allocator = Allocator{}) noexcept;
+    tiled_vector(tiled_vector && rhs) noexcept;
+    tiled_vector(tiled_vector const& rhs);
+
+    // Assignments.
+    // Allocators are propagated according to std::allocator_traits. When they are not propagated
+    // on move and compare unequal, the elements are moved one by one.
+    tiled_vector& operator=(tiled_vector && rhs) noexcept(
+        std::allocator_traits<allocator_type>::propagate_on_container_move_assignment::value ||
+        std::allocator_traits<allocator_type>::is_always_equal::value);
+    tiled_vector& operator=(tiled_vector const& rhs);
+
+    // Swaps the allocators only if they propagate on swap, otherwise they must compare equal.
+    void swap(tiled_vector& rhs) noexcept;
+    friend void swap(tiled_vector& lhs, tiled_vector& rhs) noexcept { lhs.swap(rhs); }
+
+    // Destructor.
+    ~tiled_vector();
+
+    // Size or capacity modifiers.
+    void clear() noexcept;
+    void reserve(size_type capacity);
+    void resize(size_type size);
+    void shrink_to_fit();
+
+    // Add and remove an element.
+    template <class...Ts>
+    void emplace_back(Ts &&...components);
+    void push_back(T const& value);
+    void push_back(T && value);
+    void pop_back() noexcept;
+
+    // Informations.
+    size_type size() const noexcept { return size_; }
+    // The capacity is a multiple of 'lanes'.
+    size_type capacity() const noexcept { return capacity_; }
+    bool empty() const noexcept { return size_ == 0; }
+    // The maximum number of rows, for which the size in bytes of the blocks fits in size_type.
+    static constexpr size_type max_size() noexcept {
+        return std::numeric_limits<size_type>::max() / static_cast<size_type>(block_bytes) * lanes;
+    }
+
+    allocator_type get_allocator() const noexcept { return allocator_; }
+
+    // Accessors.
+    reference_type       operator[](size_type i)       noexcept { return make_proxy<reference_type>(block(i / lanes), i % lanes, sequence_type{}); }
+    const_reference_type operator[](size_type i) const noexcept { return make_proxy<const_reference_type>(block(i / lanes), i % lanes, sequence_type{}); }
+    reference_type       at(size_type i)       { check_at(i); return (*this)[i]; }
+    const_reference_type at(size_type i) const { check_at(i); return (*this)[i]; }
+
+    reference_type       front()       noexcept { return (*this)[0]; }
+    const_reference_type front() const noexcept { return (*this)[0]; }
+    reference_type       back()       noexcept { return (*this)[size_ - 1]; }
+    const_reference_type back() const noexcept { return (*this)[size_ - 1]; }
+
+    // Iterators.
+    iterator       begin()        noexcept { return { this, 0 }; }
+    const_iterator begin()  const noexcept { return { this, 0 }; }
+    const_iterator cbegin() const noexcept { return begin(); }
+    iterator       end()        noexcept { return { this, size_ }; }
+    const_iterator end()  const noexcept { return { this, size_ }; }
+    const_iterator cend() const noexcept { return end(); }
+
+    // Blocks accessors : the columns of the block 'b' hold the rows [b * lanes, b * lanes + size).
+    // Each column is a tile of contiguous elements, aligned on it's size in bytes up to a cache line.
+    size_type blocks_count() const noexcept { return (size_ + lanes - 1) / lanes; }
+    tile_type       tile(size_type b)       noexcept { return { make_columns(block(b), sequence_type{}), rows_of(b) }; }
+    tile_type const tile(size_type b) const noexcept { return { make_columns(const_cast<std::byte*>(block(b)), sequence_type{}), rows_of(b) }; }
+private:
+    using allocator_traits = std::allocator_traits<allocator_type>;
+    using sequence_type = std::make_index_sequence<components_count>;
+
+    std::byte *      block(size_type b)       noexcept { return data_ + static_cast<size_t>(b) * block_bytes; }
+    std::byte const* block(size_type b) const noexcept { return data_ + static_cast<size_t>(b) * block_bytes; }
+    size_type rows_of(size_type b) const noexcept { return std::min(lanes, size_ - b * lanes); }
+    static size_type blocks_for(size_type rows) noexcept { return (rows + lanes - 1) / lanes; }
+
+    void check_at(size_type index) const;
+    void check_capacity(size_type capacity, std::string_view function) const;
+
+    // Pointer to the tile of the I-th column in the given block.
+    template <size_t I, class Byte>
+    static auto tile_data(Byte* block) noexcept {
+        using type = detail::member_type_t<T, I>;
+        return reinterpret_cast<std::conditional_t<std::is_const_v<Byte>, type const*, type*>>(block + shifts.columns[I]);
+    }
+
+    template <size_t...Is>
+    members<T> make_columns(std::byte* block, std::index_sequence<Is...>) const noexcept {
+        return { (block + shifts.columns[Is])... };
+    }
+
+    template <class Proxy, class Byte, size_t...Is>
+    static Proxy make_proxy(Byte* block, size_type lane, std::index_sequence<Is...>) noexcept {
+        return { tile_data<Is>(block)[lane]... };
+    }
+
+    template <class F, size_t...Is>
+    static void for_each_column(F&& f, std::index_sequence<Is...>) {
+        (f(std::integral_constant<size_t, Is>{}), ...);
+    }
+
+    // Calls 'f(src_tile, dst_tile, n)' for the tiles of each column in the blocks holding 'rows' rows,
+    // the blocks of 'src' and 'dst' being visited together.
+    template <class Src, class Dst, class F>
+    static void visit_tiles(Src* src, Dst* dst, size_type rows, F&& f);
+
+    // Constructs the tiles of 'rows' rows in 'dst' with 'construct(src_tile, dst_tile, n)', for the columns
+    // whose type satisfies Filter. If it throws, the tiles already constructed are destroyed.
+    template <template <class> class Filter, class Src, class Construct>
+    static void construct_tiles(Src* src, std::byte* dst, size_type rows, Construct construct);
+
+    // Moves 'rows' rows from the blocks of 'src' into the uninitialized blocks 'dst', then destroys them in 'src'.
+    // The columns which can't be relocated without throwing are copied first, so 'src' is unchanged if it throws.
+    static void relocate_rows(std::byte* src, std::byte* dst, size_type rows);
+
+    std::byte* allocate(size_type blocks);
+    void deallocate() noexcept;
+    // Moves the rows to a new allocation of 'blocks' blocks.
+    void reallocate(size_type blocks);
+    // Grows the capacity when the vector is full.
+    void grow();
+    // Takes the allocation of 'rhs', which must be allocated with an equal allocator.
+    void steal(tiled_vector& rhs) noexcept;
+    void destroy() noexcept;
+
+    allocator_type allocator_;
+    std::byte* data_;
+    size_type size_;
+    size_type capacity_;
+};
+
+// soa::tiled_vector implementation.
+
+template <class T, size_t Lanes, class Allocator>
+tiled_vector<T, Lanes, Allocator>::tiled_vector(Allocator const& allocator) noexcept :
+    allocator_{ allocator },
+    data_     { nullptr },
+    size_     { 0 },
+    capacity_ { 0 }
+{}
+
+template <class T, size_t Lanes, class Allocator>
+tiled_vector<T, Lanes, Allocator>::tiled_vector(tiled_vector && rhs) noexcept :
+    allocator_{ std::move(rhs.allocator_) },
+    data_     { nullptr },
+    size_     { 0 },
+    capacity_ { 0 }
+{
+    steal(rhs);
+}
+
+template <class T, size_t Lanes, class Allocator>
+tiled_vector<T, Lanes, Allocator>::tiled_vector(tiled_vector const& rhs) :
+    allocator_{ allocator_traits::select_on_container_copy_construction(rhs.allocator_) },
+    data_     { nullptr },
+    size_     { 0 },
+    capacity_ { 0 }
+{
+    reserve(rhs.size_);
+    try {
+        construct_tiles<detail::any_column>(static_cast<std::byte const*>(rhs.data_), data_, rhs.size_,
+            [] (auto src, auto dst, size_type n) { detail::construct_copy(src, dst, n); });
+    }
+    catch (...) {
+        deallocate();
+        throw;
+    }
+    size_ = rhs.size_;
+}
+
+template <class T, size_t Lanes, class Allocator>
+tiled_vector<T, Lanes, Allocator>& tiled_vector<T, Lanes, Allocator>::operator=(tiled_vector && rhs) noexcept(
+    std::allocator_traits<allocator_type>::propagate_on_container_move_assignment::value ||
+    std::allocator_traits<allocator_type>::is_always_equal::value)
+{
+    if (this == &rhs) return *this;
+    clear();
+    if constexpr (allocator_traits::propagate_on_container_move_assignment::value) {
+        deallocate();
+        allocator_ = std::move(rhs.allocator_);
+        steal(rhs);
+    }
+    else {
+        if (allocator_ == rhs.allocator_) {
+            deallocate();
+            steal(rhs);
+        }
+        else {
+            reserve(rhs.size_);
+            construct_tiles<detail::any_column>(rhs.data_, data_, rhs.size_, [] (auto src, auto dst, size_type n) {
+                detail::construct_move(src, dst, n);
+            });
+            size_ = rhs.size_;
+        }
+    }
+    return *this;
+}
+
+template <class T, size_t Lanes, class Allocator>
+tiled_vector<T, Lanes, Allocator>& tiled_vector<T, Lanes, Allocator>::operator=(tiled_vector const& rhs) {
+    if (this == &rhs) return *this;
+    clear();
+    if constexpr (allocator_traits::propagate_on_container_copy_assignment::value) {
+        // The memory must be released by the allocator which allocated it.
+        if (allocator_ != rhs.allocator_) deallocate();
+        allocator_ = rhs.allocator_;
+    }
+    reserve(rhs.size_);
+    construct_tiles<detail::any_column>(static_cast<std::byte const*>(rhs.data_), data_, rhs.size_,
+        [] (auto src, auto dst, size_type n) { detail::construct_copy(src, dst, n); });
+    size_ = rhs.size_;
+    return *this;
+}
+
+template <class T, size_t Lanes, class Allocator>
+void tiled_vector<T, Lanes, Allocator>::swap(tiled_vector& rhs) noexcept {
+    using std::swap;
+    swap(data_, rhs.data_);
+    swap(size_, rhs.size_);
+    swap(capacity_, rhs.capacity_);
+    if constexpr (allocator_traits::propagate_on_container_swap::value) {
+        swap(allocator_, rhs.allocator_);
+    }
+}
+
+template <class T, size_t Lanes, class Allocator>
+tiled_vector<T, Lanes, Allocator>::~tiled_vector() {
+    destroy();
+    deallocate();
+}
+
+template <class T, size_t Lanes, class Allocator>
+void tiled_vector<T, Lanes, Allocator>::clear() noexcept {
+    destroy();
+    size_ = 0;
+}
+
+template <class T, size_t Lanes, class Allocator>
+void tiled_vector<T, Lanes, Allocator>::reserve(size_type capacity) {
+    using namespace std::literals;
+    if (capacity <= capacity_) return;
+    check_capacity(capacity, "reserve"sv);
+    reallocate(blocks_for(capacity));
+}
+
+template <class T, size_t Lanes, class Allocator>
+void tiled_vector<T, Lanes, Allocator>::resize(size_type size) {
+    using namespace std::literals;
+    while (size_ > size) pop_back();
+    if (size_ == size) return;
+    check_capacity(size, "resize"sv);
+    reserve(size);
+    auto const old_size = size_;
+    try {
+        while (size_ < size) emplace_back();
+    }
+    catch (...) {
+        while (size_ > old_size) pop_back();
+        throw;
+    }
+}
+
+template <class T, size_t Lanes, class Allocator>
+void tiled_vector<T, Lanes, Allocator>::shrink_to_fit() {
+    auto const blocks = blocks_for(size_);
+    if (blocks * lanes == capacity_) return;
+    if (blocks == 0) deallocate();
+    else reallocate(blocks);
+}
+
+template <class T, size_t Lanes, class Allocator>
+template <class...Ts>
+void tiled_vector<T, Lanes, Allocator>::emplace_back(Ts &&...components) {
+    if (size_ == capacity_) grow();
+    auto const data = block(size_ / lanes);
+    auto const lane = size_ % lanes;
+    detail::construct_columns<components_count>([data, lane] (auto index) {
+        return tile_data<decltype(index)::value>(data) + lane;
+    }, std::forward<Ts>(components)...);
+    ++size_;
+}
+
+template <class T, size_t Lanes, class Allocator>
+void tiled_vector<T, Lanes, Allocator>::push_back(T const& value) {
+    std::apply([this] (auto const&...components) { emplace_back(components...); },
+        detail::as_tuple<components_count>(value));
+}
+
+template <class T, size_t Lanes, class Allocator>
+void tiled_vector<T, Lanes, Allocator>::push_back(T && value) {
+    auto tuple = detail::as_tuple<components_count>(value);
+    std::apply([this] (auto&...components) { emplace_back(std::move(components)...); }, tuple);
+}
+
+template <class T, size_t Lanes, class Allocator>
+void tiled_vector<T, Lanes, Allocator>::pop_back() noexcept {
+    --size_;
+    auto const b = block(size_ / lanes);
+    auto const lane = size_ % lanes;
+    for_each_column([b, lane] (auto column) {
+        detail::destroy_at(tile_data<decltype(column)::value>(b) + lane);
+    }, sequence_type{});
+}
+
+template <class T, size_t Lanes, class Allocator>
+void tiled_vector<T, Lanes, Allocator>::check_at(size_type i) const {
+    if (i < 0 || i >= size_) detail::throw_out_of_range<tiled_vector>(i, size_);
+}
+
+template <class T, size_t Lanes, class Allocator>
+void tiled_vector<T, Lanes, Allocator>::check_capacity(size_type capacity, std::string_view function) const {
+    using namespace std::literals;
+    if (capacity < 0 || capacity > max_size()) throw std::length_error{ detail::concatene(
+        detail::type_name<tiled_vector>(), "::"sv, function, " : capacity "sv, std::to_string(capacity),
+        " exceeds max_size() = "sv, std::to_string(max_size())
+    )};
+}
+
+template <class T, size_t Lanes, class Allocator>
+template <class Src, class Dst, class F>
+void tiled_vector<T, Lanes, Allocator>::visit_tiles(Src* src, Dst* dst, size_type rows, F&& f) {
+    for (size_type first = 0; first < rows; first += lanes) {
+        auto const n = std::min(lanes, rows - first);
+        for_each_column([src, dst, n, &f] (auto column) {
+            constexpr auto I = decltype(column)::value;
+            f(tile_data<I>(src), tile_data<I>(dst), n);
+        }, sequence_type{});
+        src += block_bytes;
+        dst += block_bytes;
+    }
+}
+
+template <class T, size_t Lanes, class Allocator>
+template <template <class> class Filter, class Src, class Construct>
+void tiled_vector<T, Lanes, Allocator>::construct_tiles(Src* src, std::byte* dst, size_type rows, Construct construct) {
+    size_type constructed = 0;
+    try {
+        visit_tiles(src, dst, rows, [&construct, &constructed] (auto src_tile, auto dst_tile, size_type n) {
+            if constexpr (Filter<std::remove_pointer_t<decltype(dst_tile)>>::value) {
+                construct(src_tile, dst_tile, n);
+                ++constructed;
+            }
+        });
+    }
+    catch (...) {
+        visit_tiles(dst, dst, rows, [&constructed] (auto tile, auto, size_type n) {
+            if constexpr (Filter<std::remove_pointer_t<decltype(tile)>>::value) {
+                if (constructed > 0) {
+                    --constructed;
+                    detail::destroy(tile, tile + n);
+                }
+            }
+        });
+        throw;
+    }
+}
+
+template <class T, size_t Lanes, class Allocator>
+void tiled_vector<T, Lanes, Allocator>::relocate_rows(std::byte* src, std::byte* dst, size_type rows) {
+    if constexpr (!detail::is_nothrow_relocatable_members_v<T>) {
+        construct_tiles<detail::column_relocated_by_copy>(static_cast<std::byte const*>(src), dst, rows,
+            [] (auto src_tile, auto dst_tile, size_type n) { detail::construct_copy(src_tile, dst_tile, n); });
+    }
+    visit_tiles(src, dst, rows, [] (auto src_tile, auto dst_tile, size_type n) {
+        if constexpr (detail::relocate_by_copy_v<std::remove_pointer_t<decltype(src_tile)>>)
+            detail::destroy(src_tile, src_tile + n);
+        else
+            detail::relocate(src_tile, dst_tile, n);
+    });
+}
+
+template <class T, size_t Lanes, class Allocator>
+std::byte* tiled_vector<T, Lanes, Allocator>::allocate(size_type blocks) {
+    using unit_type = typename allocator_traits::value_type;
+    auto const units = static_cast<size_t>(blocks) * (block_bytes / alignment);
+    auto const ptr = allocator_traits::allocate(allocator_, units);
+    return reinterpret_cast<std::byte*>(static_cast<unit_type*>(ptr));
+}
+
+template <class T, size_t Lanes, class Allocator>
+void tiled_vector<T, Lanes, Allocator>::deallocate() noexcept {
+    using unit_type = typename allocator_traits::value_type;
+    if (!data_) return;
+    auto const units = static_cast<size_t>(capacity_ / lanes) * (block_bytes / alignment);
+    allocator_traits::deallocate(allocator_, reinterpret_cast<unit_type*>(data_), units);
+    data_ = nullptr;
+    capacity_ = 0;
+}
+
+template <class T, size_t Lanes, class Allocator>
+void tiled_vector<T, Lanes, Allocator>::reallocate(size_type blocks) {
+    auto const data = allocate(blocks);
+    try {
+        relocate_rows(data_, data, size_);
+    }
+    catch (...) {
+        using unit_type = typename allocator_traits::value_type;
+        allocator_traits::deallocate(allocator_, reinterpret_cast<unit_type*>(data),
+            static_cast<size_t>(blocks) * (block_bytes / alignment));
+        throw;
+    }
+    deallocate();
+    data_ = data;
+    capacity_ = blocks * lanes;
+}
+
+template <class T, size_t Lanes, class Allocator>
+void tiled_vector<T, Lanes, Allocator>::grow() {
+    using namespace std::literals;
+    if (capacity_ == max_size()) check_capacity(capacity_ + 1, "grow"sv);
+    auto const capacity = capacity_ == 0 ? lanes
+        : capacity_ > max_size() / 2 ? max_size()
+        : 2 * capacity_;
+    reallocate(capacity / lanes);
+}
+
+template <class T, size_t Lanes, class Allocator>
+void tiled_vector<T, Lanes, Allocator>::steal(tiled_vector& rhs) noexcept {
+    data_     = rhs.data_;
+    size_     = rhs.size_;
+    capacity_ = rhs.capacity_;
+    rhs.data_     = nullptr;
+    rhs.size_     = 0;
+    rhs.capacity_ = 0;
+}
+
+template <class T, size_t Lanes, class Allocator>
+void tiled_vector<T, Lanes, Allocator>::destroy() noexcept {
+    visit_tiles(data_, data_, size_, [] (auto tile, auto, size_type n) {
+        detail::destroy(tile, tile + n);
+    });
+}
+
+namespace detail {
+
+    // The rows are given as proxies : the chunks boundaries fall on the blocks.
+    template <class T, size_t Lanes, class Allocator>
+    struct parallel_range<tiled_vector<T, Lanes, Allocator>> {
+        template <class Tiled>
+        static auto columns(Tiled& tiled) noexcept {
+            return std::array<column_bytes, 1>{ column_bytes{
+                reinterpret_cast<std::uintptr_t>(tiled.data_), tiled.block_bytes, Lanes
+            }};
+        }
+        template <class Tiled, class F>
+        static decltype(auto) apply(Tiled& tiled, F& f, size_type i) { return f(tiled[i]); }
+    };
+
+} // ::detail
+
+// Calls 'f(tile, first_row)' for each block of the tiled_vector, where 'tile' holds the block columns
+// and 'first_row' is the index of it's first row. With a parallel policy, the blocks are distributed
+// between the workers.
+template <class Policy, class Tiled, class F, class = detail::enable_if_policy_t<Policy>>
+void for_each_tile(Policy&& policy, Tiled& tiled, F f) {
+    using traits = detail::parallel_range_t<Tiled>;
+    constexpr auto lanes = std::remove_const_t<Tiled>::lanes;
+    auto const& native = execution::detail::to_policy(policy);
+    auto const chunks = detail::plan_chunks(native, tiled.size(), traits::columns(tiled));
+    auto body = [&tiled, &f] (int, size_type first, size_type last) {
+        for (auto row = first; row < last; row += lanes) {
+            decltype(auto) tile = tiled.tile(row / lanes);
+            f(tile, row);
+        }
+    };
+    detail::run_chunks(native, chunks, body);
+}
+
+} // namespace soa
@@ -10,11 +10,23 @@
 
 #include <cstring>
 #include <cstddef>
+#include <cstdint>
+#include <algorithm>
 #include <utility>
 #include <memory>
+#if __has_include(<memory_resource>)
+#include <memory_resource>
+#endif
 #include <tuple>
+#include <array>
+#include <atomic>
+#include <iterator>
+#include <limits>
+#include <numeric>
+#include <vector>
 #include <string>
 #include <string_view>
+#include <stdexcept>
 #include <typeinfo>
 #if __has_include(<cxxabi.h>)
 #include <cxxabi.h>
@@ -22,15 +34,193 @@
 
 namespace soa {
 
+// Layout policy of soa::vector : each column starts at an address multiple of 'Alignment'
+// (or of the member type alignment if greater), and the column size in bytes is padded
+// to a multiple of 'Padding', so SIMD loops can process the last elements with full-width loads.
+// Alignment and Padding must be powers of two.
+template <size_t Alignment = 1, size_t Padding = 1>
+struct layout {
+    static_assert(Alignment > 0 && (Alignment & (Alignment - 1)) == 0,
+        "soa::layout alignment must be a power of two");
+    static_assert(Padding > 0 && (Padding & (Padding - 1)) == 0,
+        "soa::layout padding must be a power of two");
+
+    static constexpr size_t alignment = Alignment;
+    static constexpr size_t padding   = Padding;
+};
+
+// Layout for SIMD registers of 'Width' bytes (eg. 32 for AVX2, 64 for AVX-512) :
+// columns are aligned and padded on the register width.
+template <size_t Width>
+using simd_layout = layout<Width, Width>;
+
+// Type of the sizes, indices and bytes counts of soa::vector and of the other containers.
+// It's int by default. Defining SOA_64_BIT_SIZE (in every translation unit) makes it std::ptrdiff_t,
+// for vectors with allocations greater than 2 GiB.
+#if defined(SOA_64_BIT_SIZE)
+using size_type = std::ptrdiff_t;
+#else
+using size_type = int;
+#endif
+
+// Growth policies of soa::vector. They define :
+//  - 'next_capacity(capacity, min_capacity)', the capacity (at least 'min_capacity') used when the vector grows.
+//  - 'round_bytes(nb_bytes)', the size really allocated for an allocation of 'nb_bytes'.
+//    The vector capacity is raised to use the rounded size.
+namespace growth {
+    // Multiplies the capacity by 'Num / Den', which must be greater than 1.
+    template <int Num, int Den>
+    struct factor {
+        static_assert(Num > Den && Den > 0, "soa::growth::factor must be greater than 1");
+
+        static constexpr size_type next_capacity(size_type capacity, size_type min_capacity) noexcept {
+            constexpr auto max = std::numeric_limits<size_type>::max();
+            auto const next = capacity > max / Num ? max : std::max(capacity * Num / Den, capacity + 1);
+            return std::max(min_capacity, next);
+        }
+        static constexpr size_t round_bytes(size_t nb_bytes) noexcept { return nb_bytes; }
+    };
+    using doubling     = factor<2, 1>;
+    using one_and_half = factor<3, 2>;
+
+    // Rounds the allocations up to pages of 'PageSize' bytes (a power of two), so the rows which fit
+    // in the end of the last page are used. The capacity grows with the 'Base' policy.
+    template <size_t PageSize, class Base = doubling>
+    struct pages : Base {
+        static_assert(PageSize > 0 && (PageSize & (PageSize - 1)) == 0,
+            "soa::growth::pages page size must be a power of two");
+
+        static constexpr size_t page_size = PageSize;
+        static constexpr size_t round_bytes(size_t nb_bytes) noexcept {
+            return (Base::round_bytes(nb_bytes) + PageSize - 1) & ~(PageSize - 1);
+        }
+    };
+    using pages_4k   = pages<size_t{ 4 } << 10>;
+    using huge_pages = pages<size_t{ 2 } << 20>;
+}
+
+// Hooks on the allocations and data movements of soa::vector. They are compiled only when
+// SOA_INSTRUMENTATION is defined (in every translation unit) : otherwise, no event is created.
+// 'soa_instrumentation.hpp' provides a sink aggregating the events per type.
+namespace instrumentation {
+#if defined(SOA_INSTRUMENTATION)
+    inline constexpr bool enabled = true;
+#else
+    inline constexpr bool enabled = false;
+#endif
+
+    enum class event_kind {
+        allocate,       // A column group allocation.
+        deallocate,     // A column group deallocation.
+        reserve,        // The rows are moved to a larger capacity given to reserve (or resize).
+        grow,           // The rows are moved to a larger capacity given by the growth policy.
+        shrink_to_fit,  // The rows are moved to a smaller capacity.
+        copy_construct, // The rows of another vector are copied in a new vector.
+        copy_assign     // The rows of another vector are copied in an existing vector.
+    };
+
+    struct event {
+        event_kind kind;
+        // detail::type_name<T>() of the vector value type T.
+        std::string_view type;
+        // Address of the vector, to tell the tables of the same type apart.
+        void const* vector;
+        // Capacities before and after the event.
+        size_type old_capacity;
+        size_type new_capacity;
+        // Group of the allocation, for allocation events.
+        size_t group;
+        // Rows moved or copied.
+        size_type rows;
+        // Bytes allocated or deallocated, or the sum of the bytes moved or copied in each column.
+        size_t bytes;
+        // Bytes moved or copied in each column, or nullptr for allocation events.
+        // The columns expanded in place are not moved.
+        size_t const* column_bytes;
+        size_t columns_count;
+    };
+
+    // The sink is called synchronously by the vector which emits the event. It must not throw
+    // and must be thread-safe when vectors are used by several threads.
+    using sink_type = void (*)(event const&) noexcept;
+
+    namespace detail {
+        inline std::atomic<sink_type> sink{ nullptr };
+    }
+    // Sets the function receiving the events (nullptr to ignore them) and returns the previous one.
+    inline sink_type set_sink(sink_type sink) noexcept {
+        return detail::sink.exchange(sink);
+    }
+    inline void emit(event const& e) noexcept {
+        if (auto const sink = detail::sink.load(std::memory_order_acquire)) sink(e);
+    }
+}
+
 // Holds arrays for each T component in a single allocation.
-// The allocator will be rebound to 'std::byte'.
-template <class T, class Allocator = std::allocator<T>>
+// The allocator will be rebound to a type aligned on the strictest column alignment.
+template <class T, class Allocator = std::allocator<T>, class Layout = layout<>, size_t InlineRows = 0,
+    class Growth = growth::doubling>
 class vector;
 
+// soa::vector storing the first N rows of each column inside the object : it only allocates beyond N rows.
+template <class T, size_t N, class Allocator = std::allocator<T>, class Layout = layout<>,
+    class Growth = growth::doubling>
+using small_vector = vector<T, Allocator, Layout, N, Growth>;
+
+#if defined(__cpp_lib_memory_resource)
+namespace pmr {
+    // soa::vector using a std::pmr::memory_resource, eg. a std::pmr::monotonic_buffer_resource.
+    template <class T, class Layout = layout<>>
+    using vector = soa::vector<T, std::pmr::polymorphic_allocator<T>, Layout>;
+}
+#endif
+
+// Column option given in SOA_DEFINE_TYPE with the syntax '(member, options...)'.
+// Sets the minimum alignment in bytes of the member column, which must be a power of two.
+template <size_t Alignment>
+struct align {
+    static_assert(Alignment > 0 && (Alignment & (Alignment - 1)) == 0,
+        "soa::align alignment must be a power of two");
+};
+
+// Column option : puts the member column in the allocation group 'Group' (0 by default).
+// Each group of columns has it's own allocation and allocator, so rarely accessed (cold) columns
+// don't share the memory of frequently accessed (hot) ones. Groups must be numbered from 0.
+template <size_t Group>
+struct group {};
+
+// Column option : stores a bool or small enum column as a bitset of 'Bits' bits per element,
+// packed in 64 bits words (an element never straddles two words). The member must be a bool,
+// or an integral or enum type whose values fit in [0, 2^Bits). The column is then a soa::packed_span.
+template <size_t Bits = 1>
+struct packed {
+    static_assert(Bits > 0 && Bits <= 16, "soa::packed elements must have between 1 and 16 bits");
+};
+
 // Iterable object accessed in soa::vector<Aggregate> through soa::member<Aggregate>.
 template <size_t Pos, class Aggregate, class T>
 class vector_span;
 
+// Span of a soa::packed column, with references to the bits of the elements.
+template <size_t Pos, class Aggregate, class T, size_t Bits>
+class packed_span;
+
+// Iterable object on a subset of the soa::vector columns, created with soa::view.
+template <class...Ts>
+class zip_view;
+
+// Read-only columns of a file written by soa::save, defined in soa_io.hpp.
+template <class T>
+class mapped_view;
+
+// Vector storing it's rows in blocks of 'Lanes' rows with a tile per column, defined in soa_tiled.hpp.
+template <class T, size_t Lanes, class Allocator>
+class tiled_vector;
+
+// Read-only columns of an Apache Arrow struct array, defined in soa_arrow.hpp.
+template <class T>
+class arrow_view;
+
 // Specialized for aggregates so soa::vector<T> can be istanciated.
 // Specialization of non-template types can be done with the macro
 // 'SOA_DEFINE_TYPE(type, members...);' in the global namespace.
@@ -44,6 +234,29 @@ struct ref_proxy {};
 template <class Aggregate>
 struct cref_proxy {};
 
+// Columns of soa::array<Aggregate, N>, defined with the macro : a std::array<T, N> per member,
+// with the same name as the aggregate member.
+template <class Aggregate, size_t N>
+struct array_members {};
+
+// Fixed-size structure of arrays, usable in constant expressions and from static storage.
+template <class T, size_t N>
+struct array;
+
+// Tells if a T object can be moved to another address with a memcpy, the source object being
+// then considered as destroyed. It is true for trivially copyable types and can be specialized
+// for other types (eg. most std::unique_ptr, std::vector or std::string implementations).
+// It allows soa::vector to grow with a single memmove per array.
+template <class T>
+struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+template <class T>
+constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
+// std::unique_ptr with the default deleter only holds a pointer in every implementation.
+template <class T>
+struct is_trivially_relocatable<std::unique_ptr<T>> : std::true_type {};
+
 // A trait allows to check if the three class above have been defined for the given type.
 template <class Aggregate>
 constexpr bool is_defined_v =
@@ -70,16 +283,24 @@ namespace detail {
     using repeat_tuple_t = typename impl::repeat_tuple<T, std::make_index_sequence<N>>::type;
 
     namespace impl {
-        template <size_t I, class...Ts>
-        struct get {};
-        template <size_t I, class T, class...Ts>
-        struct get<I, T, Ts...> {
-            using type = typename get<I - 1, Ts...>::type;
-        };
-        template <class T, class...Ts>
-        struct get<0, T, Ts...> {
+        // The I-th type is found by deduction against flat bases, instead of a recursion on the types.
+        template <size_t I, class T>
+        struct indexed_type {
             using type = T;
         };
+        template <class Seq, class...Ts>
+        struct indexed_types {};
+        template <size_t...Is, class...Ts>
+        struct indexed_types<std::index_sequence<Is...>, Ts...> : indexed_type<Is, Ts>... {};
+
+        template <size_t I, class T>
+        indexed_type<I, T> select_type(indexed_type<I, T> const&);
+
+        template <size_t I, class...Ts>
+        struct get {
+            using type = typename decltype(impl::select_type<I>(
+                std::declval<indexed_types<std::index_sequence_for<Ts...>, Ts...> const&>()))::type;
+        };
     }
     // An empty type used to pass types.
     template <class...Ts>
@@ -101,14 +322,16 @@ namespace detail {
     template <class Tuple>
     using tuple_tag = typename impl::tuple_tag<Tuple>::type;
 
-    // Base class of soa::vector<T>.
-    // Used to retrieve the size by soa::vector_span<Offset, T, MemberT> from members<T>.
+    // Base class of soa::vector<T>, which stores the size of the columns.
+    // The end of each soa::vector_span is updated with the size, so the spans know their length
+    // from their own pointers.
     template <class T>
     class members_with_size : public members<T> {
-        template <size_t, class, class>
-        friend class ::soa::vector_span;
     protected:
-        int size_;
+        // Sets the size and the end of each span, which must point to the columns.
+        void set_size(size_type size) noexcept;
+
+        size_type size_;
     };
 
     template <class T>
@@ -124,7 +347,7 @@ namespace detail {
         };
         return errc
             ? std::string{ name }
-            : std::string(demangled_name.get(), size);
+            : std::string{ demangled_name.get() };
     #else
         return std::string_view{ name };
     #endif
@@ -138,7 +361,7 @@ namespace detail {
     }
     template <class T>
     [[noreturn]]
-    void throw_out_of_range(int index, int size) {
+    void throw_out_of_range(size_type index, size_type size) {
         using namespace std::literals;
         
         throw std::out_of_range{detail::concatene(
@@ -151,36 +374,46 @@ namespace detail {
 
 template <size_t Pos, class Aggregate, class T>
 class vector_span {
-    template <class, class>
+    template <class, class, class, size_t, class>
     friend class vector;
     template <class>
+    friend class mapped_view;
+    template <class, size_t, class>
+    friend class tiled_vector;
+    template <class>
+    friend class arrow_view;
+    template <class>
     friend struct members;
+    template <class>
+    friend class detail::members_with_size;
 public:
-    using value_type = T;
+    using value_type      = T;
+    using reference       = T &;
+    using const_reference = T const&;
 
     // Informations
     T *      data()       noexcept { return ptr_; }
     T const* data() const noexcept { return ptr_; }
-    int size() const noexcept;
+    size_type size() const noexcept;
 
     // Accessors
-    T &      operator[](int i)       noexcept { return ptr_[i]; }
-    T const& operator[](int i) const noexcept { return ptr_[i]; }
-    T &      at(int i)       { check_at(i); return ptr_[i]; }
-    T const& at(int i) const { check_at(i); return ptr_[i]; }
+    T &      operator[](size_type i)       noexcept { return ptr_[i]; }
+    T const& operator[](size_type i) const noexcept { return ptr_[i]; }
+    T &      at(size_type i)       { check_at(i); return ptr_[i]; }
+    T const& at(size_type i) const { check_at(i); return ptr_[i]; }
 
     T &      front()       noexcept { return ptr_[0]; }
     T const& front() const noexcept { return ptr_[0]; }
-    T &      back()       noexcept { return ptr_[size() - 1]; }
-    T const& back() const noexcept { return ptr_[size() - 1]; }
+    T &      back()       noexcept { return end_[-1]; }
+    T const& back() const noexcept { return end_[-1]; }
 
     // Iterators
     T *      begin()       noexcept { return ptr_; }
     T const* begin() const noexcept { return ptr_; }
-    T *      end()       noexcept { return ptr_ + size(); }
-    T const* end() const noexcept { return ptr_ + size(); }
+    T *      end()       noexcept { return end_; }
+    T const* end() const noexcept { return end_; }
 private:
-    void check_at(int i) const {
+    void check_at(size_type i) const {
         if (i >= size()) detail::throw_out_of_range<vector_span<Pos, Aggregate, T>>(i, size());
     }
 
@@ -188,148 +421,647 @@ private:
     vector_span(vector_span const&) = default;
     vector_span& operator=(vector_span const&) = default;
     
+    // The span is empty until it's end is set by detail::members_with_size.
     vector_span(std::byte * ptr) noexcept :
-        ptr_{ reinterpret_cast<T *>(ptr) }
+        ptr_{ reinterpret_cast<T *>(ptr) },
+        end_{ ptr_ }
     {}
 
+    void set_size(size_type size) noexcept { end_ = ptr_ + size; }
+
     T * ptr_;
+    T * end_;
 };
 
-// Template arguments are used to retrieve the size from detail::members_with_size<Aggregate>.
 template <size_t Pos, class Aggregate, class T>
-int vector_span<Pos, Aggregate, T>::size() const noexcept {
-    auto const mem_ptr = reinterpret_cast<members<Aggregate> const*>(this - Pos);
-    auto const mws_ptr = static_cast<detail::members_with_size<Aggregate> const*>(mem_ptr);
-    return mws_ptr->size_;
+size_type vector_span<Pos, Aggregate, T>::size() const noexcept {
+    return static_cast<size_type>(end_ - ptr_);
 }
 
 namespace detail {
-    // Aggregate to tuple implementation, only for soa::member<T>.
+    // Words of the soa::packed columns.
+    using packed_word = std::uint64_t;
+    constexpr size_t packed_word_bits = 64;
 
-    template <class T>
-    auto as_tuple(T & agg, std::integral_constant<int, 1>) {
-        auto & [v1] = agg;
-        return std::forward_as_tuple(v1);
+    inline int popcount(packed_word x) noexcept {
+    #if defined(__GNUC__) || defined(__clang__)
+        return __builtin_popcountll(x);
+    #else
+        x = x - ((x >> 1) & 0x5555555555555555u);
+        x = (x & 0x3333333333333333u) + ((x >> 2) & 0x3333333333333333u);
+        x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0Fu;
+        return static_cast<int>((x * 0x0101010101010101u) >> 56);
+    #endif
     }
-    template <class T>
-    auto as_tuple(T & agg, std::integral_constant<int, 2>) {
-        auto & [v1, v2] = agg;
-        return std::forward_as_tuple(v1, v2);
+    // Index of the lowest set bit, 'x' must not be zero.
+    inline int countr_zero(packed_word x) noexcept {
+    #if defined(__GNUC__) || defined(__clang__)
+        return __builtin_ctzll(x);
+    #else
+        int n = 0;
+        for (; (x & 1) == 0; x >>= 1) ++n;
+        return n;
+    #endif
     }
-    template <class T>
-    auto as_tuple(T & agg, std::integral_constant<int, 3>) {
-        auto & [v1, v2, v3] = agg;
-        return std::forward_as_tuple(v1, v2, v3);
+
+    // Layout of the elements of 'Bits' bits in the words of a soa::packed column.
+    template <size_t Bits>
+    struct packed_traits {
+        static constexpr size_t per_word = packed_word_bits / Bits;
+        static constexpr packed_word mask = (packed_word{ 1 } << Bits) - 1;
+        // Lowest and highest bit of each element of a word.
+        static constexpr packed_word lows = [] {
+            auto word = packed_word{ 0 };
+            for (size_t i = 0; i < per_word; ++i) word |= packed_word{ 1 } << (i * Bits);
+            return word;
+        }();
+        static constexpr packed_word highs = lows << (Bits - 1);
+
+        static constexpr size_type words(size_type nb) noexcept {
+            return (nb + static_cast<size_type>(per_word) - 1) / static_cast<size_type>(per_word);
+        }
+        // The highest bit of each element of 'word' which is zero, and zero elsewhere.
+        static constexpr packed_word zero_elements(packed_word word) noexcept {
+            constexpr auto low_bits = highs - lows;
+            return ~(((word & low_bits) + low_bits) | word | low_bits) & highs;
+        }
+        // Bits of the elements of the word 'word' which are among the first 'nb' elements.
+        static constexpr packed_word elements_mask(size_type nb, size_type word) noexcept {
+            auto const first = static_cast<size_t>(word) * per_word;
+            auto const n = static_cast<size_t>(nb) - first;
+            return n >= per_word ? highs | (highs - lows) | lows : (packed_word{ 1 } << (n * Bits)) - 1;
+        }
+    };
+
+    // Reference on an element of a soa::packed column.
+    template <class T, size_t Bits>
+    class packed_reference {
+        using traits = packed_traits<Bits>;
+
+        packed_word* word_;
+        unsigned shift_;
+    public:
+        packed_reference(packed_word* word, unsigned shift) noexcept : word_{ word }, shift_{ shift } {}
+
+        operator T() const noexcept { return static_cast<T>((*word_ >> shift_) & traits::mask); }
+
+        packed_reference const& operator=(T value) const noexcept {
+            auto const bits = static_cast<packed_word>(value) & traits::mask;
+            *word_ = (*word_ & ~(traits::mask << shift_)) | (bits << shift_);
+            return *this;
+        }
+        packed_reference const& operator=(packed_reference const& rhs) const noexcept {
+            return *this = static_cast<T>(rhs);
+        }
+
+        friend void swap(packed_reference lhs, packed_reference rhs) noexcept {
+            T const tmp = lhs;
+            lhs = static_cast<T>(rhs);
+            rhs = tmp;
+        }
+    };
+
+    // Random access iterator on the elements of a soa::packed column, dereferenced to a
+    // detail::packed_reference (or to a value for const columns).
+    // It holds the words of the column and the index of the element.
+    template <class T, size_t Bits, bool IsConst>
+    class packed_pointer {
+        using traits = packed_traits<Bits>;
+        using word_pointer = std::conditional_t<IsConst, packed_word const*, packed_word *>;
+
+        word_pointer words_;
+        std::ptrdiff_t index_;
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type        = T;
+        using reference         = std::conditional_t<IsConst, T, packed_reference<T, Bits>>;
+        using pointer           = void;
+        using difference_type   = std::ptrdiff_t;
+
+        packed_pointer() noexcept : words_{ nullptr }, index_{ 0 } {}
+        packed_pointer(word_pointer words, std::ptrdiff_t index) noexcept : words_{ words }, index_{ index } {}
+
+        // Conversion from the pointer on mutable elements.
+        template <bool C = IsConst, class = std::enable_if_t<C>>
+        packed_pointer(packed_pointer<T, Bits, false> const& ptr) noexcept :
+            words_{ ptr.words() }, index_{ ptr.index() } {}
+
+        // Words of the column, and index of the element from the first one.
+        word_pointer words() const noexcept { return words_; }
+        std::ptrdiff_t index() const noexcept { return index_; }
+        // Word holding the element.
+        word_pointer word() const noexcept { return words_ + index_ / static_cast<std::ptrdiff_t>(traits::per_word); }
+
+        reference operator*() const noexcept { return (*this)[0]; }
+        reference operator[](difference_type i) const noexcept {
+            auto const index = static_cast<size_t>(index_ + i);
+            auto const word = words_ + index / traits::per_word;
+            auto const shift = static_cast<unsigned>(index % traits::per_word * Bits);
+            if constexpr (IsConst) return static_cast<T>((*word >> shift) & traits::mask);
+            else return { word, shift };
+        }
+
+        bool operator==(packed_pointer const& rhs) const noexcept { return index_ == rhs.index_; }
+        bool operator!=(packed_pointer const& rhs) const noexcept { return index_ != rhs.index_; }
+        bool operator<(packed_pointer const& rhs) const noexcept { return index_ < rhs.index_; }
+        bool operator>(packed_pointer const& rhs) const noexcept { return index_ > rhs.index_; }
+        bool operator<=(packed_pointer const& rhs) const noexcept { return index_ <= rhs.index_; }
+        bool operator>=(packed_pointer const& rhs) const noexcept { return index_ >= rhs.index_; }
+
+        packed_pointer & operator++() noexcept { ++index_; return *this; }
+        packed_pointer & operator--() noexcept { --index_; return *this; }
+        packed_pointer operator++(int) noexcept { auto const old = *this; ++index_; return old; }
+        packed_pointer operator--(int) noexcept { auto const old = *this; --index_; return old; }
+
+        packed_pointer & operator+=(difference_type shift) noexcept { index_ += shift; return *this; }
+        packed_pointer & operator-=(difference_type shift) noexcept { index_ -= shift; return *this; }
+
+        packed_pointer operator+(difference_type shift) const noexcept { return { words_, index_ + shift }; }
+        packed_pointer operator-(difference_type shift) const noexcept { return { words_, index_ - shift }; }
+        friend packed_pointer operator+(difference_type shift, packed_pointer const& ptr) noexcept { return ptr + shift; }
+
+        difference_type operator-(packed_pointer const& rhs) const noexcept { return index_ - rhs.index_; }
+    };
+}
+
+template <size_t Pos, class Aggregate, class T, size_t Bits>
+class packed_span {
+    static_assert(std::is_integral_v<T> || std::is_enum_v<T>,
+        "soa::packed columns must hold bools, integral or enum types");
+    static_assert(!std::is_same_v<T, bool> || Bits == 1, "soa::packed bool columns must have 1 bit per element");
+    static_assert(Bits <= sizeof(T) * 8, "soa::packed elements can't have more bits than their type");
+
+    template <class, class, class, size_t, class>
+    friend class vector;
+    template <class>
+    friend struct members;
+    template <class>
+    friend class detail::members_with_size;
+    template <size_t, class, class, size_t>
+    friend class packed_span;
+
+    using traits = detail::packed_traits<Bits>;
+public:
+    using value_type      = T;
+    using reference       = detail::packed_reference<T, Bits>;
+    using const_reference = T;
+    using pointer         = detail::packed_pointer<T, Bits, false>;
+    using const_pointer   = detail::packed_pointer<T, Bits, true>;
+
+    // The number of bits of each element, and of elements in each word.
+    static constexpr size_t bits     = Bits;
+    static constexpr size_t per_word = traits::per_word;
+
+    // Informations
+    pointer       data()       noexcept { return { ptr_, 0 }; }
+    const_pointer data() const noexcept { return { ptr_, 0 }; }
+    size_type size() const noexcept { return size_; }
+
+    // The words holding the elements. The bits after the last element are unspecified.
+    detail::packed_word *      words()       noexcept { return ptr_; }
+    detail::packed_word const* words() const noexcept { return ptr_; }
+    size_type words_count() const noexcept { return traits::words(size_); }
+
+    // Accessors
+    reference       operator[](size_type i)       noexcept { return data()[i]; }
+    const_reference operator[](size_type i) const noexcept { return data()[i]; }
+    reference       at(size_type i)       { check_at(i); return data()[i]; }
+    const_reference at(size_type i) const { check_at(i); return data()[i]; }
+
+    reference       front()       noexcept { return data()[0]; }
+    const_reference front() const noexcept { return data()[0]; }
+    reference       back()       noexcept { return data()[size_ - 1]; }
+    const_reference back() const noexcept { return data()[size_ - 1]; }
+
+    // Iterators
+    pointer       begin()       noexcept { return data(); }
+    const_pointer begin() const noexcept { return data(); }
+    pointer       end()       noexcept { return data() + size_; }
+    const_pointer end() const noexcept { return data() + size_; }
+
+    // Bulk operations, a word at a time.
+
+    // Number of elements different from zero (eg. the true flags).
+    size_type count() const noexcept;
+    // Number of elements equal to 'value'.
+    size_type count(T value) const noexcept;
+    // Index of the first element from 'first' which is equal to 'value', or size() if there is none.
+    size_type find_first(T value, size_type first = 0) const noexcept;
+    // Sets all the elements to 'value'.
+    void fill(T value) noexcept;
+
+    // Bitwise operations with the elements of a column of the same size, eg. 'v.alive &= v.visible'.
+    template <size_t P, class A>
+    packed_span& operator&=(packed_span<P, A, T, Bits> const& rhs) noexcept;
+    template <size_t P, class A>
+    packed_span& operator|=(packed_span<P, A, T, Bits> const& rhs) noexcept;
+    template <size_t P, class A>
+    packed_span& operator^=(packed_span<P, A, T, Bits> const& rhs) noexcept;
+    // Complements the bits of each element.
+    void flip() noexcept;
+private:
+    void check_at(size_type i) const {
+        if (i >= size()) detail::throw_out_of_range<packed_span>(i, size());
     }
-    template <class T>
-    auto as_tuple(T & agg, std::integral_constant<int, 4>) {
-        auto & [v1, v2, v3, v4] = agg;
-        return std::forward_as_tuple(v1, v2, v3, v4);
+
+    packed_span() = default;
+    packed_span(packed_span const&) = default;
+    packed_span& operator=(packed_span const&) = default;
+
+    // The span is empty until it's size is set by detail::members_with_size.
+    packed_span(std::byte * ptr) noexcept :
+        ptr_{ reinterpret_cast<detail::packed_word *>(ptr) },
+        size_{ 0 }
+    {}
+
+    void set_size(size_type size) noexcept { size_ = size; }
+
+    template <class F>
+    void transform_words(detail::packed_word const* rhs, F f) noexcept {
+        for (size_type w = 0; w < words_count(); ++w) ptr_[w] = f(ptr_[w], rhs[w]);
     }
-    template <class T>
-    auto as_tuple(T & agg, std::integral_constant<int, 5>) {
-        auto & [v1, v2, v3, v4, v5] = agg;
-        return std::forward_as_tuple(v1, v2, v3, v4, v5);
+
+    // It has the size of a vector_span, so the arity of soa::members<T> is kept.
+    detail::packed_word * ptr_;
+    size_type size_;
+};
+
+template <size_t Pos, class Aggregate, class T, size_t Bits>
+size_type packed_span<Pos, Aggregate, T, Bits>::count() const noexcept {
+    if constexpr (Bits == 1) {
+        size_type n = 0;
+        for (size_type w = 0; w < words_count(); ++w) {
+            n += detail::popcount(ptr_[w] & traits::elements_mask(size_, w));
+        }
+        return n;
     }
-    template <class T>
-    auto as_tuple(T & agg, std::integral_constant<int, 6>) {
-        auto & [v1, v2, v3, v4, v5, v6] = agg;
-        return std::forward_as_tuple(v1, v2, v3, v4, v5, v6);
+    else return size_ - count(T{});
+}
+
+template <size_t Pos, class Aggregate, class T, size_t Bits>
+size_type packed_span<Pos, Aggregate, T, Bits>::count(T value) const noexcept {
+    auto const pattern = traits::lows * (static_cast<detail::packed_word>(value) & traits::mask);
+    size_type n = 0;
+    for (size_type w = 0; w < words_count(); ++w) {
+        auto const zeros = traits::zero_elements(ptr_[w] ^ pattern);
+        n += detail::popcount(zeros & traits::elements_mask(size_, w));
     }
-    template <class T>
-    auto as_tuple(T & agg, std::integral_constant<int, 7>) {
-        auto & [v1, v2, v3, v4, v5, v6, v7] = agg;
-        return std::forward_as_tuple(v1, v2, v3, v4, v5, v6, v7);
+    return n;
+}
+
+template <size_t Pos, class Aggregate, class T, size_t Bits>
+size_type packed_span<Pos, Aggregate, T, Bits>::find_first(T value, size_type first) const noexcept {
+    if (first >= size_) return size_;
+    auto const pattern = traits::lows * (static_cast<detail::packed_word>(value) & traits::mask);
+    auto w = first / static_cast<size_type>(per_word);
+    // The elements of the first word before 'first' are skipped.
+    auto skipped = ~((detail::packed_word{ 1 } << (static_cast<size_t>(first) % per_word * Bits)) - 1);
+    for (; w < words_count(); ++w) {
+        auto const zeros = traits::zero_elements(ptr_[w] ^ pattern) & traits::elements_mask(size_, w) & skipped;
+        if (zeros != 0) {
+            return w * static_cast<size_type>(per_word) + detail::countr_zero(zeros) / static_cast<int>(Bits);
+        }
+        skipped = ~detail::packed_word{ 0 };
     }
-    template <class T>
-    auto as_tuple(T & agg, std::integral_constant<int, 8>) {
-        auto & [v1, v2, v3, v4, v5, v6, v7, v8] = agg;
-        return std::forward_as_tuple(v1, v2, v3, v4, v5, v6, v7, v8);
+    return size_;
+}
+
+template <size_t Pos, class Aggregate, class T, size_t Bits>
+void packed_span<Pos, Aggregate, T, Bits>::fill(T value) noexcept {
+    auto const pattern = traits::lows * (static_cast<detail::packed_word>(value) & traits::mask);
+    std::fill_n(ptr_, words_count(), pattern);
+}
+
+template <size_t Pos, class Aggregate, class T, size_t Bits>
+template <size_t P, class A>
+packed_span<Pos, Aggregate, T, Bits>& packed_span<Pos, Aggregate, T, Bits>::operator&=(packed_span<P, A, T, Bits> const& rhs) noexcept {
+    transform_words(rhs.ptr_, [] (auto lhs, auto rhs) { return lhs & rhs; });
+    return *this;
+}
+
+template <size_t Pos, class Aggregate, class T, size_t Bits>
+template <size_t P, class A>
+packed_span<Pos, Aggregate, T, Bits>& packed_span<Pos, Aggregate, T, Bits>::operator|=(packed_span<P, A, T, Bits> const& rhs) noexcept {
+    transform_words(rhs.ptr_, [] (auto lhs, auto rhs) { return lhs | rhs; });
+    return *this;
+}
+
+template <size_t Pos, class Aggregate, class T, size_t Bits>
+template <size_t P, class A>
+packed_span<Pos, Aggregate, T, Bits>& packed_span<Pos, Aggregate, T, Bits>::operator^=(packed_span<P, A, T, Bits> const& rhs) noexcept {
+    transform_words(rhs.ptr_, [] (auto lhs, auto rhs) { return lhs ^ rhs; });
+    return *this;
+}
+
+template <size_t Pos, class Aggregate, class T, size_t Bits>
+void packed_span<Pos, Aggregate, T, Bits>::flip() noexcept {
+    for (size_type w = 0; w < words_count(); ++w) ptr_[w] = ~ptr_[w];
+}
+
+namespace detail {
+    // The arity is the number of members of a well-formed soa::member<T>.
+    template <class Members>
+    constexpr int arity_v = sizeof(Members) / sizeof(vector_span<0, vector<char>, char>);
+
+    // Aggregate to tuple implementation : the members are given by the pointers of SOA_DEFINE_TYPE,
+    // so there is no limit on the arity and a single function is instantiated per aggregate.
+    // The pointers are constants, so the functions giving them are not emitted in the binaries.
+    template <class T, size_t I>
+    constexpr auto span_pointer_v = members<T>::span_pointer(std::integral_constant<size_t, I>{});
+    template <class T, size_t I>
+    constexpr auto member_pointer_v = members<T>::member_pointer(std::integral_constant<size_t, I>{});
+
+    template <class T, class Members, size_t...Is>
+    auto as_tuple(Members & agg, std::index_sequence<Is...>) {
+        return std::forward_as_tuple(agg.*span_pointer_v<T, Is>...);
     }
     template <class T>
-    auto as_tuple(T & agg, std::integral_constant<int, 9>) {
-        auto & [v1, v2, v3, v4, v5, v6, v7, v8, v9] = agg;
-        return std::forward_as_tuple(v1, v2, v3, v4, v5, v6, v7, v8, v9);
-    }
+    constexpr bool is_proxy_v = false;
     template <class T>
-    auto as_tuple(T & agg, std::integral_constant<int, 10>) {
-        auto & [v1, v2, v3, v4, v5, v6, v7, v8, v9, v10] = agg;
-        return std::forward_as_tuple(v1, v2, v3, v4, v5, v6, v7, v8, v9, v10);
-    }
+    constexpr bool is_proxy_v<ref_proxy<T>> = true;
     template <class T>
-    auto as_tuple(T & agg, std::integral_constant<int, 11>) {
-        auto & [v1, v2, v3, v4, v5, v6, v7, v8, v9, v10, v11] = agg;
-        return std::forward_as_tuple(v1, v2, v3, v4, v5, v6, v7, v8, v9, v10, v11);
+    constexpr bool is_proxy_v<cref_proxy<T>> = true;
+
+    template <class T, size_t...Is>
+    auto as_tuple_values(T & agg, std::index_sequence<Is...>) {
+        using type = std::remove_const_t<T>;
+        if constexpr (is_proxy_v<type>) {
+            return std::forward_as_tuple(agg.member_ref(std::integral_constant<size_t, Is>{})...);
+        }
+        else {
+            return std::forward_as_tuple(agg.*member_pointer_v<type, Is>...);
+        }
     }
+
+    // Converts a well-formed soa::member<T> to a tuple with references on each member of the class.
     template <class T>
-    auto as_tuple(T & agg, std::integral_constant<int, 12>) {
-        auto & [v1, v2, v3, v4, v5, v6, v7, v8, v9, v10, v11, v12] = agg;
-        return std::forward_as_tuple(v1, v2, v3, v4, v5, v6, v7, v8, v9, v10, v11, v12);
+    auto as_tuple(members<T> const& agg) {
+        return as_tuple<T>(agg, std::make_index_sequence<arity_v<members<T>>>{});
     }
     template <class T>
-    auto as_tuple(T & agg, std::integral_constant<int, 13>) {
-        auto & [v1, v2, v3, v4, v5, v6, v7, v8, v9, v10, v11, v12, v13] = agg;
-        return std::forward_as_tuple(v1, v2, v3, v4, v5, v6, v7, v8, v9, v10, v11, v12, v13);
+    auto as_tuple(members<T> & agg) {
+        return as_tuple<T>(agg, std::make_index_sequence<arity_v<members<T>>>{});
     }
-    template <class T>
-    auto as_tuple(T & agg, std::integral_constant<int, 14>) {
-        auto & [v1, v2, v3, v4, v5, v6, v7, v8, v9, v10, v11, v12, v13, v14] = agg;
-        return std::forward_as_tuple(v1, v2, v3, v4, v5, v6, v7, v8, v9, v10, v11, v12, v13, v14);
+
+    // Converts an aggregate defined with SOA_DEFINE_TYPE, or one of it's proxies, to a tuple given it's arity.
+    template <size_t Arity, class T>
+    auto as_tuple(T && agg) {
+        return as_tuple_values(agg, std::make_index_sequence<Arity>{});
     }
-    template <class T>
-    auto as_tuple(T & agg, std::integral_constant<int, 15>) {
-        auto & [v1, v2, v3, v4, v5, v6, v7, v8, v9, v10, v11, v12, v13, v14, v15] = agg;
-        return std::forward_as_tuple(v1, v2, v3, v4, v5, v6, v7, v8, v9, v10, v11, v12, v13, v14, v15);
+
+    // Type of the I-th member of the aggregate T, given by soa::members<T>.
+    namespace impl {
+        template <class Pointer>
+        struct pointed_member {};
+        template <class Class, class Member>
+        struct pointed_member<Member Class::*> {
+            using type = Member;
+        };
     }
-    template <class T>
-    auto as_tuple(T & agg, std::integral_constant<int, 16>) {
-        auto & [v1, v2, v3, v4, v5, v6, v7, v8, v9, v10, v11, v12, v13, v14, v15, v16] = agg;
-        return std::forward_as_tuple(v1, v2, v3, v4, v5, v6, v7, v8, v9, v10, v11, v12, v13, v14, v15, v16);
+    template <class T, size_t I>
+    using member_type_t = typename impl::pointed_member<std::remove_const_t<decltype(span_pointer_v<T, I>)>>::type::value_type;
+
+    // Name of the I-th member of the aggregate T, as given to SOA_DEFINE_TYPE.
+    template <class T, size_t I>
+    constexpr char const* member_name_v = members<T>::member_name(std::integral_constant<size_t, I>{});
+
+    namespace impl {
+        template <class Option>
+        constexpr size_t option_alignment = 1;
+        template <size_t Alignment>
+        constexpr size_t option_alignment<align<Alignment>> = Alignment;
+
+        template <class Option>
+        constexpr size_t option_group = 0;
+        template <size_t Group>
+        constexpr size_t option_group<group<Group>> = Group;
+
+        template <class Option>
+        constexpr size_t option_packed_bits = 0;
+        template <size_t Bits>
+        constexpr size_t option_packed_bits<packed<Bits>> = Bits;
     }
-    template <class T>
-    auto as_tuple(T & agg, std::integral_constant<int, 17>) {
-        auto & [v1, v2, v3, v4, v5, v6, v7, v8, v9, v10, v11, v12, v13, v14, v15, v16, v17] = agg;
-        return std::forward_as_tuple(v1, v2, v3, v4, v5, v6, v7, v8, v9, v10, v11, v12, v13, v14, v15, v16, v17);
+    // Options of a column, given in SOA_DEFINE_TYPE.
+    template <class...Options>
+    struct column_options {
+        static constexpr size_t alignment   = std::max({ size_t{ 1 }, impl::option_alignment<Options>... });
+        static constexpr size_t group       = std::max({ size_t{ 0 }, impl::option_group<Options>... });
+        // Bits per element of soa::packed columns, 0 for the others.
+        static constexpr size_t packed_bits = std::max({ size_t{ 0 }, impl::option_packed_bits<Options>... });
+    };
+
+    // Span of the column 'Pos' of the member type T with the given options, used by SOA_DEFINE_TYPE.
+    template <size_t Pos, class Aggregate, class T, class Options>
+    using column_span_t = std::conditional_t<(Options::packed_bits > 0),
+        packed_span<Pos, Aggregate, T, Options::packed_bits>,
+        vector_span<Pos, Aggregate, T>>;
+
+    namespace impl {
+        template <class T, size_t I, class = void>
+        struct column_options_of {
+            using type = column_options<>;
+        };
+        template <class T, size_t I>
+        struct column_options_of<T, I, std::void_t<decltype(
+            members<T>::column_options(std::integral_constant<size_t, I>{})
+        )>> {
+            using type = decltype(members<T>::column_options(std::integral_constant<size_t, I>{}));
+        };
     }
-    template <class T>
-    auto as_tuple(T & agg, std::integral_constant<int, 18>) {
-        auto & [v1, v2, v3, v4, v5, v6, v7, v8, v9, v10, v11, v12, v13, v14, v15, v16, v17, v18] = agg;
-        return std::forward_as_tuple(v1, v2, v3, v4, v5, v6, v7, v8, v9, v10, v11, v12, v13, v14, v15, v16, v17, v18);
+    // Options of the I-th column of soa::members<T>. Columns without options use column_options<>.
+    template <class T, size_t I>
+    using column_options_t = typename impl::column_options_of<T, I>::type;
+
+    // Allocation group of the I-th column of soa::members<T>.
+    template <class T, size_t I>
+    constexpr size_t column_group_v = column_options_t<T, I>::group;
+
+    // True if the I-th column of soa::members<T> is a soa::packed column.
+    template <class T, size_t I>
+    constexpr bool is_packed_column_v = column_options_t<T, I>::packed_bits > 0;
+
+    // Type of the objects stored in the I-th column : the member type, or the words of packed columns.
+    template <class T, size_t I>
+    using column_storage_t = std::conditional_t<is_packed_column_v<T, I>, packed_word, member_type_t<T, I>>;
+
+    // Size in bytes of 'nb' elements of the I-th column, without padding.
+    template <class T, size_t I>
+    constexpr size_type column_array_bytes(size_type nb) noexcept {
+        if constexpr (is_packed_column_v<T, I>) {
+            constexpr auto bits = column_options_t<T, I>::packed_bits;
+            return packed_traits<bits>::words(nb) * static_cast<size_type>(sizeof(packed_word));
+        }
+        else return nb * static_cast<size_type>(sizeof(member_type_t<T, I>));
+    }
+
+    // Size in bits of an element of the I-th column. Packed columns can use a few more bits
+    // per element, as the elements don't straddle words.
+    template <class T, size_t I>
+    constexpr size_t column_element_bits_v = is_packed_column_v<T, I>
+        ? column_options_t<T, I>::packed_bits
+        : sizeof(member_type_t<T, I>) * 8;
+
+    namespace impl {
+        template <class T, size_t...Is>
+        constexpr bool has_packed_columns(std::index_sequence<Is...>) noexcept {
+            return (false || ... || is_packed_column_v<T, Is>);
+        }
     }
+    // True if soa::members<T> has soa::packed columns.
     template <class T>
-    auto as_tuple(T & agg, std::integral_constant<int, 19>) {
-        auto & [v1, v2, v3, v4, v5, v6, v7, v8, v9, v10, v11, v12, v13, v14, v15, v16, v17, v18, v19] = agg;
-        return std::forward_as_tuple(v1, v2, v3, v4, v5, v6, v7, v8, v9, v10, v11, v12, v13, v14, v15, v16, v17, v18, v19);
+    constexpr bool has_packed_columns_v = impl::has_packed_columns<T>(std::make_index_sequence<arity_v<members<T>>>{});
+
+    namespace impl {
+        template <class T, size_t...Is>
+        constexpr size_t groups_count(std::index_sequence<Is...>) noexcept {
+            return std::max({ column_group_v<T, Is>... }) + 1;
+        }
+        template <class T, size_t...Is>
+        constexpr bool has_contiguous_groups(std::index_sequence<Is...>) noexcept {
+            constexpr auto count = impl::groups_count<T>(std::index_sequence<Is...>{});
+            for (size_t g = 0; g < count; ++g) {
+                if (((column_group_v<T, Is> != g) && ...)) return false;
+            }
+            return true;
+        }
+    }
+    template <class T, size_t...Is>
+    constexpr std::array<size_t, sizeof...(Is)> column_groups(std::index_sequence<Is...>) noexcept {
+        return {{ column_group_v<T, Is>... }};
     }
+
+    // Number of allocation groups of soa::members<T>.
+    template <class T>
+    constexpr size_t groups_count_v = impl::groups_count<T>(std::make_index_sequence<arity_v<members<T>>>{});
+
+    // True if every group from 0 to groups_count_v<T> holds at least one column.
     template <class T>
-    auto as_tuple(T & agg, std::integral_constant<int, 20>) {
-        auto & [v1, v2, v3, v4, v5, v6, v7, v8, v9, v10, v11, v12, v13, v14, v15, v16, v17, v18, v19, v20] = agg;
-        return std::forward_as_tuple(v1, v2, v3, v4, v5, v6, v7, v8, v9, v10, v11, v12, v13, v14, v15, v16, v17, v18, v19, v20);
+    constexpr bool has_contiguous_groups_v = impl::has_contiguous_groups<T>(std::make_index_sequence<arity_v<members<T>>>{});
+
+    // Returns an array of N copies of 'value'.
+    template <size_t N, class T, size_t...Is>
+    std::array<T, N> repeat_array(T const& value, std::index_sequence<Is...>) {
+        return {{ (static_cast<void>(Is), value)... }};
+    }
+    template <size_t N, class T>
+    std::array<T, N> repeat_array(T const& value) {
+        return detail::repeat_array<N>(value, std::make_index_sequence<N>{});
     }
 
-    // The arity is the number of members of a well-formed soa::member<T>.
-    template <class Members>
-    constexpr int arity_v = sizeof(Members) / sizeof(vector_span<0, vector<char>, char>);
+    // Returns the array of 'f(array[i])'.
+    template <class T, size_t N, class F, size_t...Is>
+    auto transform_array(std::array<T, N> const& array, F&& f, std::index_sequence<Is...>) {
+        return std::array<decltype(f(array[0])), N>{{ f(array[Is])... }};
+    }
+    template <class T, size_t N, class F>
+    auto transform_array(std::array<T, N> const& array, F&& f) {
+        return detail::transform_array(array, f, std::make_index_sequence<N>{});
+    }
 
-    // Continue the overloads above to increase the max_arity.
-    constexpr int max_arity = 10;
+    // Alignment in bytes of the I-th column of a soa::vector<T> using the given layout.
+    template <class T, class Layout, size_t I>
+    constexpr size_t column_alignment_v = std::max({
+        alignof(column_storage_t<T, I>),
+        Layout::alignment,
+        column_options_t<T, I>::alignment
+    });
 
-    // Converts a well-formed soa::member<T> to a tuple with references on each member of the class.
-    template <class T>
-    auto as_tuple(members<T> const& agg) {
-        return as_tuple(agg, std::integral_constant<int, arity_v<members<T>>>{});
+    namespace impl {
+        template <class T, class Layout, size_t...Is>
+        constexpr size_t block_alignment(std::index_sequence<Is...>) noexcept {
+            return std::max({ column_alignment_v<T, Layout, Is>... });
+        }
     }
+    // Alignment in bytes of the allocation of a soa::vector<T> using the given layout.
+    template <class T, class Layout>
+    constexpr size_t block_alignment_v = impl::block_alignment<T, Layout>(
+        std::make_index_sequence<arity_v<members<T>>>{});
+
+    // Allocation unit of soa::vector, so the allocator returns memory aligned for every column.
+    template <size_t Alignment>
+    struct alignas(Alignment) aligned_bytes {
+        std::byte bytes[Alignment];
+    };
+
+    // Rounds up 'value' to a multiple of 'alignment', which is a power of two.
+    template <class Int>
+    constexpr Int align_up(Int value, size_t alignment) noexcept {
+        auto const mask = static_cast<Int>(alignment - 1);
+        return (value + mask) & ~mask;
+    }
+
+    // Offset in bytes of each column in the allocation of it's group, and size in bytes of each allocation,
+    // for 'nb' rows of a soa::vector<T> using the given layout.
     template <class T>
-    auto as_tuple(members<T> & agg) {
-        return as_tuple(agg, std::integral_constant<int, arity_v<members<T>>>{});
+    struct shifts {
+        std::array<size_type, arity_v<members<T>>> columns;
+        std::array<size_type, groups_count_v<T>> nb_bytes;
+    };
+    template <class T, class Layout, size_t...Is>
+    constexpr shifts<T> compute_shifts(size_type nb, std::index_sequence<Is...>) noexcept {
+        auto shift = shifts<T>{};
+        auto const update = [&shift] (size_t column, size_t group, size_t alignment, size_type bytes) {
+            auto& nb_bytes = shift.nb_bytes[group];
+            nb_bytes = detail::align_up(nb_bytes, alignment);
+            shift.columns[column] = nb_bytes;
+            nb_bytes += detail::align_up(bytes, Layout::padding);
+        };
+        (update(Is, column_group_v<T, Is>, column_alignment_v<T, Layout, Is>, column_array_bytes<T, Is>(nb)), ...);
+        // Allocation sizes are multiples of the block alignment.
+        for (auto& bytes : shift.nb_bytes) bytes = detail::align_up(bytes, block_alignment_v<T, Layout>);
+        return shift;
+    }
+    template <class T, class Layout>
+    constexpr shifts<T> compute_shifts(size_type nb) noexcept {
+        return detail::compute_shifts<T, Layout>(nb, std::make_index_sequence<arity_v<members<T>>>{});
     }
 
-    // Allows to converts any aggregate to a tuple given it's arity.
-    template <size_t Arity, class T>
-    auto as_tuple(T && agg) {
-        return as_tuple(agg, std::integral_constant<int, Arity>{});
+    // Maximum rows of a soa::vector<T>, so the allocations sizes in bytes fit in size_type.
+    // The padding and alignment of each column are counted in the worst case, and packed
+    // columns are counted with a byte per 8 bits of their elements, and their last word.
+    template <class T, class Layout, size_t...Is>
+    constexpr size_type max_rows(std::index_sequence<Is...>) noexcept {
+        constexpr auto slack = static_cast<size_type>(
+            ((Layout::padding + column_alignment_v<T, Layout, Is> + (is_packed_column_v<T, Is> ? sizeof(packed_word) : 0)) + ...) +
+            block_alignment_v<T, Layout>);
+        constexpr auto row_bytes = static_cast<size_type>((((column_element_bits_v<T, Is> + 7) / 8) + ...));
+        return (std::numeric_limits<size_type>::max() - slack) / row_bytes;
+    }
+
+    // Sum of the sizes in bits of the members of T in each group.
+    template <class T, size_t...Is>
+    constexpr std::array<size_t, groups_count_v<T>> group_row_bits(std::index_sequence<Is...>) noexcept {
+        auto bits = std::array<size_t, groups_count_v<T>>{};
+        ((bits[column_group_v<T, Is>] += column_element_bits_v<T, Is>), ...);
+        return bits;
     }
 
+    // Size in bytes of the storage of 'InlineRows' rows inside a soa::small_vector<T>.
+    template <class T, class Layout, size_t InlineRows>
+    constexpr size_t inline_bytes() noexcept {
+        if constexpr (InlineRows == 0) return 0;
+        else {
+            auto const shift = detail::compute_shifts<T, Layout>(static_cast<size_type>(InlineRows));
+            size_t sum = 0;
+            for (auto bytes : shift.nb_bytes) sum += static_cast<size_t>(bytes);
+            return sum;
+        }
+    }
+
+    // Inline storage of soa::small_vector. The groups allocations follow each other.
+    template <size_t Bytes, size_t Alignment>
+    struct inline_storage {
+        std::byte*       inline_data()       noexcept { return bytes_; }
+        std::byte const* inline_data() const noexcept { return bytes_; }
+    private:
+        alignas(Alignment) std::byte bytes_[Bytes];
+    };
+    template <size_t Alignment>
+    struct inline_storage<0, Alignment> {
+        std::byte*       inline_data()       noexcept { return nullptr; }
+        std::byte const* inline_data() const noexcept { return nullptr; }
+    };
+
     // for_each loops takes a function object to operate on one or two tuples of references.
     // Note : C++20 template lambdas would be cleaner to retrieve the type.
 
@@ -343,6 +1075,17 @@ namespace detail {
         detail::for_each(tuple, f, seq{});
     }
 
+    // Also gives the index of the element, as std::integral_constant<size_t, I>.
+    template <class F, size_t...Is, class...Ts>
+    constexpr void for_each_indexed(std::tuple<Ts &...> const& tuple, F && f, std::index_sequence<Is...>) {
+        (f(std::get<Is>(tuple), type_tag<typename Ts::value_type>{}, std::integral_constant<size_t, Is>{}), ...);
+    }
+    template <class F, class...Ts>
+    constexpr void for_each_indexed(std::tuple<Ts &...> const& tuple, F && f) {
+        using seq = std::make_index_sequence<sizeof...(Ts)>;
+        detail::for_each_indexed(tuple, f, seq{});
+    }
+
     template <class F, size_t...Is, class...Ts1, class...Ts2>
     constexpr void for_each(std::tuple<Ts1 &...> const& t1, std::tuple<Ts2 &...> const& t2, F && f, std::index_sequence<Is...>) {
         (f(std::get<Is>(t1), std::get<Is>(t2), type_tag<typename Ts1::value_type>{}), ...);
@@ -354,37 +1097,357 @@ namespace detail {
         detail::for_each(t1, t2, f, seq{});
     }
 
-    // Apply a function for every object in two ranges.
-    // Used for soa::vector copy/move assignments and constructors.
-    template <class T, class SizeT, class F>
-    constexpr void apply_two_arrays(T const* __restrict src, T * dst, SizeT size, F&& f) {
-        for (SizeT i = 0; i < size; ++i) {
-            f(src[i], dst[i]);
-        }
+    template <class F, size_t...Is, class...Ts1, class...Ts2>
+    constexpr void for_each_reversed(std::tuple<Ts1 &...> const& t1, std::tuple<Ts2 &...> const& t2, F && f, std::index_sequence<Is...>) {
+        constexpr auto last = sizeof...(Is) - 1;
+        (f(std::get<last - Is>(t1), std::get<last - Is>(t2),
+            type_tag<typename impl::get<last - Is, Ts1...>::type::value_type>{}), ...);
     }
-    template <class T, class SizeT, class F>
-    constexpr void apply_two_arrays(T * __restrict src, T * dst, SizeT size, F&& f) {
-        for (SizeT i = 0; i < size; ++i) {
-            f(src[i], dst[i]);
-        }
+    template <class F, class...Ts1, class...Ts2>
+    constexpr void for_each_reversed(std::tuple<Ts1 &...> const& t1, std::tuple<Ts2 &...> const& t2, F && f) {
+        static_assert(sizeof...(Ts1) == sizeof...(Ts2));
+        using seq = std::make_index_sequence<sizeof...(Ts1)>;
+        detail::for_each_reversed(t1, t2, f, seq{});
     }
 
-    // Iterator used by soa::vector to return new proxies with references to the elements.
-    template <class Vector, bool IsConst>
-    class proxy_iterator {
-        friend Vector;
+    // The same loops on the columns of soa::members<T>. They access the columns with the member pointers
+    // of SOA_DEFINE_TYPE instead of tuples of references, which are costly to instantiate for many members.
 
-        using vector_pointer_type = std::conditional_t<IsConst,
-            Vector const*,
-            Vector *>;
+    template <class T, class Members, class F, size_t...Is>
+    constexpr void for_each_column(Members & mem, F && f, std::index_sequence<Is...>) {
+        (f(mem.*span_pointer_v<T, Is>, type_tag<member_type_t<T, Is>>{}), ...);
+    }
+    template <class T, class F>
+    constexpr void for_each_column(members<T> & mem, F && f) {
+        detail::for_each_column<T>(mem, f, std::make_index_sequence<arity_v<members<T>>>{});
+    }
+    template <class T, class F>
+    constexpr void for_each_column(members<T> const& mem, F && f) {
+        detail::for_each_column<T>(mem, f, std::make_index_sequence<arity_v<members<T>>>{});
+    }
 
-        vector_pointer_type vec_;
-        int index_;
+    template <class T, class Members, class F, size_t...Is>
+    constexpr void for_each_column_indexed(Members & mem, F && f, std::index_sequence<Is...>) {
+        (f(mem.*span_pointer_v<T, Is>, type_tag<member_type_t<T, Is>>{}, std::integral_constant<size_t, Is>{}), ...);
+    }
+    template <class T, class F>
+    constexpr void for_each_column_indexed(members<T> & mem, F && f) {
+        detail::for_each_column_indexed<T>(mem, f, std::make_index_sequence<arity_v<members<T>>>{});
+    }
 
-        proxy_iterator(vector_pointer_type vec, int index) noexcept :
-            vec_{vec}, index_{index} {}
-    public:
-        using iterator_category = std::random_access_iterator_tag;
+    template <class T, class Members, class F, size_t...Is>
+    constexpr void for_each_column(Members & src, members<T> & dst, F && f, std::index_sequence<Is...>) {
+        (f(src.*span_pointer_v<T, Is>, dst.*span_pointer_v<T, Is>, type_tag<member_type_t<T, Is>>{}), ...);
+    }
+    template <class T, class F>
+    constexpr void for_each_column(members<T> const& src, members<T> & dst, F && f) {
+        detail::for_each_column<T>(src, dst, f, std::make_index_sequence<arity_v<members<T>>>{});
+    }
+    template <class T, class F>
+    constexpr void for_each_column(members<T> & src, members<T> & dst, F && f) {
+        detail::for_each_column<T>(src, dst, f, std::make_index_sequence<arity_v<members<T>>>{});
+    }
+
+    template <class T, class F, size_t...Is>
+    constexpr void for_each_column_reversed(members<T> & src, members<T> & dst, F && f, std::index_sequence<Is...>) {
+        constexpr auto last = sizeof...(Is) - 1;
+        (f(src.*span_pointer_v<T, last - Is>, dst.*span_pointer_v<T, last - Is>, type_tag<member_type_t<T, last - Is>>{}), ...);
+    }
+    template <class T, class F>
+    constexpr void for_each_column_reversed(members<T> & src, members<T> & dst, F && f) {
+        detail::for_each_column_reversed(src, dst, f, std::make_index_sequence<arity_v<members<T>>>{});
+    }
+
+    template <class T>
+    void members_with_size<T>::set_size(size_type size) noexcept {
+        size_ = size;
+        detail::for_each_column(static_cast<members<T>&>(*this), [size] (auto& span, auto) {
+            span.set_size(size);
+        });
+    }
+
+    // Array operations used for soa::vector copy/move assignments, constructors and growth.
+    // They are dispatched at compile-time to a single memcpy/memmove per array when possible.
+    // They are overloaded below for the packed_pointer of soa::packed columns.
+
+    // Constructs an object in the uninitialized storage 'ptr'.
+    template <class T, class...Args>
+    void construct_at(T * ptr, Args &&...args) {
+        new (ptr) T(std::forward<Args>(args)...);
+    }
+
+    // Destroys the object at 'ptr'.
+    template <class T>
+    void destroy_at(T * ptr) noexcept {
+        ptr->~T();
+    }
+
+    // Destroys the objects in [first, last).
+    template <class T>
+    void destroy(T * first, T * last) noexcept {
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            for (; first < last; ++first) first->~T();
+        }
+    }
+
+    // Copy-constructs 'size' objects from 'src' into the uninitialized array 'dst'.
+    // If a constructor throws, the objects already constructed are destroyed.
+    template <class T, class SizeT>
+    void construct_copy(T const* __restrict src, T * dst, SizeT size) {
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            if (size > 0) std::memcpy(static_cast<void*>(dst), static_cast<void const*>(src), size * sizeof(T));
+        }
+        else {
+            SizeT i = 0;
+            try {
+                for (; i < size; ++i) {
+                    new (dst + i) T(src[i]);
+                }
+            }
+            catch (...) {
+                detail::destroy(dst, dst + i);
+                throw;
+            }
+        }
+    }
+
+    // Move-constructs 'size' objects from 'src' into the uninitialized array 'dst'.
+    // If a constructor throws, the objects already constructed are destroyed.
+    template <class T, class SizeT>
+    void construct_move(T * __restrict src, T * dst, SizeT size) {
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            if (size > 0) std::memcpy(static_cast<void*>(dst), static_cast<void const*>(src), size * sizeof(T));
+        }
+        else {
+            SizeT i = 0;
+            try {
+                for (; i < size; ++i) {
+                    new (dst + i) T(std::move(src[i]));
+                }
+            }
+            catch (...) {
+                detail::destroy(dst, dst + i);
+                throw;
+            }
+        }
+    }
+
+    // True if objects can be moved to another array without throwing.
+    template <class T>
+    constexpr bool is_nothrow_relocatable_v =
+        is_trivially_relocatable_v<T> || std::is_nothrow_move_constructible_v<T>;
+
+    // True if objects must be copied to another array to keep the strong exception guarantee.
+    template <class T>
+    constexpr bool relocate_by_copy_v =
+        !is_nothrow_relocatable_v<T> && std::is_copy_constructible_v<T>;
+
+    // True if every column of soa::vector<T> can be relocated without throwing.
+    template <class T, class = std::make_index_sequence<arity_v<members<T>>>>
+    constexpr bool is_nothrow_relocatable_members_v = false;
+    template <class T, size_t...Is>
+    constexpr bool is_nothrow_relocatable_members_v<T, std::index_sequence<Is...>> =
+        (is_nothrow_relocatable_v<member_type_t<T, Is>> && ...);
+
+    // True if every column of soa::vector<T> can be copied without throwing.
+    template <class T, class = std::make_index_sequence<arity_v<members<T>>>>
+    constexpr bool is_nothrow_copyable_members_v = false;
+    template <class T, size_t...Is>
+    constexpr bool is_nothrow_copyable_members_v<T, std::index_sequence<Is...>> =
+        (std::is_nothrow_copy_constructible_v<member_type_t<T, Is>> && ...);
+
+    // Size in bytes of the blocks of aggregates transposed by soa::vector::append, soa::from_aos and soa::to_aos :
+    // a block stays in the L1 cache while each of it's members is copied to or from it's column.
+    constexpr size_t transpose_block_bytes = 16 * 1024;
+
+    template <class T>
+    constexpr size_type transpose_block_rows = static_cast<size_type>(std::max<size_t>(1, transpose_block_bytes / sizeof(T)));
+
+    // Allocators can optionally define 'bool expand(pointer p, size_type n, size_type new_n)'
+    // to try to grow the allocation 'p' of 'n' elements in place, to 'new_n' elements.
+    template <class Allocator, class = void>
+    struct has_expand : std::false_type {};
+    template <class Allocator>
+    struct has_expand<Allocator, std::void_t<decltype(std::declval<Allocator&>().expand(
+        std::declval<typename std::allocator_traits<Allocator>::pointer>(),
+        std::declval<typename std::allocator_traits<Allocator>::size_type>(),
+        std::declval<typename std::allocator_traits<Allocator>::size_type>()
+    ))>> : std::true_type {};
+
+    template <class Allocator>
+    constexpr bool has_expand_v = has_expand<Allocator>::value;
+
+    template <class...Ts>
+    constexpr bool all_trivially_relocatable(type_tag<Ts...>) noexcept {
+        return (is_trivially_relocatable_v<Ts> && ...);
+    }
+
+    // Moves 'size' objects from 'src' into the uninitialized array 'dst', then destroys them in 'src'.
+    // Trivially relocatable types are moved with a memmove, so the arrays can overlap.
+    template <class T, class SizeT>
+    void relocate(T * src, T * dst, SizeT size) {
+        if constexpr (is_trivially_relocatable_v<T>) {
+            if (size > 0) std::memmove(static_cast<void*>(dst), static_cast<void const*>(src), size * sizeof(T));
+        }
+        else {
+            construct_move(src, dst, size);
+            detail::destroy(src, src + size);
+        }
+    }
+
+    // Uninitialized algorithms of the standard library, overloaded for the packed columns.
+    template <class InputIt, class SizeT, class T>
+    void uninitialized_copy_n(InputIt src, SizeT n, T * dst) {
+        std::uninitialized_copy_n(src, n, dst);
+    }
+    template <class T, class SizeT, class U>
+    void uninitialized_fill_n(T * dst, SizeT n, U const& value) {
+        std::uninitialized_fill_n(dst, n, value);
+    }
+    template <class T, class SizeT>
+    void uninitialized_value_construct_n(T * dst, SizeT n) {
+        std::uninitialized_value_construct_n(dst, n);
+    }
+
+    // The elements of soa::packed columns are bits of their words : they are constructed by
+    // setting their bits, and have nothing to destroy.
+
+    template <class T, size_t Bits, class...Args>
+    void construct_at(packed_pointer<T, Bits, false> ptr, Args &&...args) noexcept {
+        *ptr = T(std::forward<Args>(args)...);
+    }
+    template <class T, size_t Bits>
+    void destroy_at(packed_pointer<T, Bits, false>) noexcept {}
+    template <class T, size_t Bits>
+    void destroy(packed_pointer<T, Bits, false>, packed_pointer<T, Bits, false>) noexcept {}
+
+    // Constructs an element in each of the 'Count' columns, at the address returned by 'column(index)'
+    // for each std::integral_constant index : from the components, then value-initialized.
+    // If a column throws, the elements already constructed are destroyed.
+    template <size_t Count, size_t I = 0, class Column>
+    void construct_columns(Column const& column) {
+        if constexpr (I < Count) {
+            auto const ptr = column(std::integral_constant<size_t, I>{});
+            detail::construct_at(ptr);
+            try {
+                construct_columns<Count, I + 1>(column);
+            }
+            catch (...) {
+                detail::destroy_at(ptr);
+                throw;
+            }
+        }
+    }
+    template <size_t Count, size_t I = 0, class Column, class T1, class...Ts>
+    void construct_columns(Column const& column, T1&& component, Ts &&...nexts) {
+        auto const ptr = column(std::integral_constant<size_t, I>{});
+        detail::construct_at(ptr, std::forward<T1>(component));
+        try {
+            construct_columns<Count, I + 1>(column, std::forward<Ts>(nexts)...);
+        }
+        catch (...) {
+            detail::destroy_at(ptr);
+            throw;
+        }
+    }
+
+    // Copies 'size' elements of packed columns, which can overlap. The words are moved
+    // with a memmove when both columns start on a word.
+    template <class T, size_t Bits, bool IsConst, class SizeT>
+    void copy_packed(packed_pointer<T, Bits, IsConst> src, packed_pointer<T, Bits, false> dst, SizeT size) noexcept {
+        if (size <= 0) return;
+        constexpr auto per_word = static_cast<std::ptrdiff_t>(packed_traits<Bits>::per_word);
+        auto const n = static_cast<std::ptrdiff_t>(size);
+        // The elements are copied from the first one if the destination is before the source.
+        auto const forward = std::less<void const*>{}(dst.word(), src.word()) ||
+            (dst.word() == src.word() && dst.index() % per_word <= src.index() % per_word);
+
+        if (src.index() % per_word == 0 && dst.index() % per_word == 0) {
+            auto const words = n / per_word;
+            auto const tail = words * per_word;
+            auto const move_words = [&] {
+                std::memmove(dst.word(), src.word(), static_cast<size_t>(words) * sizeof(packed_word));
+            };
+            if (forward) {
+                move_words();
+                std::copy(src + tail, src + n, dst + tail);
+            }
+            else {
+                std::copy_backward(src + tail, src + n, dst + n);
+                move_words();
+            }
+        }
+        else if (forward) std::copy(src, src + n, dst);
+        else std::copy_backward(src, src + n, dst + n);
+    }
+
+    template <class T, size_t Bits, class SizeT>
+    void construct_copy(packed_pointer<T, Bits, true> src, packed_pointer<T, Bits, false> dst, SizeT size) noexcept {
+        detail::copy_packed(src, dst, size);
+    }
+    template <class T, size_t Bits, class SizeT>
+    void construct_copy(T const* src, packed_pointer<T, Bits, false> dst, SizeT size) noexcept {
+        std::copy_n(src, size, dst);
+    }
+    template <class T, size_t Bits, class SizeT>
+    void construct_move(packed_pointer<T, Bits, false> src, packed_pointer<T, Bits, false> dst, SizeT size) noexcept {
+        detail::copy_packed(src, dst, size);
+    }
+    template <class T, size_t Bits, class SizeT>
+    void relocate(packed_pointer<T, Bits, false> src, packed_pointer<T, Bits, false> dst, SizeT size) noexcept {
+        detail::copy_packed(src, dst, size);
+    }
+
+    template <class InputIt, class SizeT, class T, size_t Bits>
+    void uninitialized_copy_n(InputIt src, SizeT n, packed_pointer<T, Bits, false> dst) {
+        for (SizeT i = 0; i < n; ++i, ++src) dst[i] = T(*src);
+    }
+    template <class T, size_t Bits, class SizeT, class U>
+    void uninitialized_fill_n(packed_pointer<T, Bits, false> dst, SizeT n, U const& value) {
+        std::fill_n(dst, n, T(value));
+    }
+    template <class T, size_t Bits, class SizeT>
+    void uninitialized_value_construct_n(packed_pointer<T, Bits, false> dst, SizeT n) noexcept {
+        std::fill_n(dst, n, T{});
+    }
+
+    // Iterator used by soa::vector to return new proxies with references to the elements.
+    // It satisfies the random access iterator requirements, except that it's reference type is a proxy.
+    // It holds a pointer per column, which are advanced together : the columns are not retrieved from
+    // the vector when it's dereferenced. As for std::vector, it is invalidated by reallocations.
+    template <class Vector, bool IsConst>
+    class proxy_iterator {
+        friend Vector;
+        friend class proxy_iterator<Vector, !IsConst>;
+
+        using vector_pointer_type = std::conditional_t<IsConst,
+            Vector const*,
+            Vector *>;
+        using sequence_type = std::make_index_sequence<Vector::components_count>;
+
+        template <size_t...Is>
+        static std::tuple<decltype(std::declval<vector_pointer_type>()->template get_span<Is>().data())...>
+            pointers_of(std::index_sequence<Is...>) noexcept;
+        using pointers_type = decltype(pointers_of(sequence_type{}));
+
+        pointers_type ptrs_;
+
+        template <size_t...Is>
+        static pointers_type make_pointers(vector_pointer_type vec, std::ptrdiff_t index, std::index_sequence<Is...>) noexcept {
+            return pointers_type{ (vec->template get_span<Is>().data() + index)... };
+        }
+
+        proxy_iterator(vector_pointer_type vec, std::ptrdiff_t index) noexcept :
+            ptrs_{ make_pointers(vec, index, sequence_type{}) } {}
+    public:
+        proxy_iterator() noexcept : ptrs_{} {}
+
+        // Conversion from iterator to const_iterator.
+        template <bool C = IsConst, class = std::enable_if_t<C>>
+        proxy_iterator(proxy_iterator<Vector, false> const& it) noexcept :
+            ptrs_{it.ptrs_} {}
+
+        using iterator_category = std::random_access_iterator_tag;
 
         using value_type = std::conditional_t<IsConst,
             typename Vector::const_reference_type,
@@ -392,54 +1455,135 @@ namespace detail {
 
         using reference = value_type;
         using pointer = void;
-        using difference_type = int;
+        using difference_type = std::ptrdiff_t;
     private:
         template <size_t...Is>
-        value_type make_proxy(std::index_sequence<Is...>) const noexcept {
-            return { vec_->template get_span<Is>()[index_] ... };
+        value_type make_proxy(difference_type shift, std::index_sequence<Is...>) const noexcept {
+            return { std::get<Is>(ptrs_)[shift] ... };
         }
+        proxy_iterator& advance(difference_type shift) noexcept {
+            std::apply([shift] (auto&...ptrs) { ((ptrs += shift), ...); }, ptrs_);
+            return *this;
+        }
+        auto first() const noexcept { return std::get<0>(ptrs_); }
     public:
-        value_type operator*() const noexcept { return make_proxy(typename Vector::sequence_type{}); }
+        value_type operator*() const noexcept { return make_proxy(0, sequence_type{}); }
+        value_type operator[](difference_type shift) const noexcept {
+            return make_proxy(shift, sequence_type{});
+        }
 
-        bool operator==(proxy_iterator const& rhs) const noexcept { return index_ == rhs.index_; }
+        bool operator==(proxy_iterator const& rhs) const noexcept { return first() == rhs.first(); }
         bool operator!=(proxy_iterator const& rhs) const noexcept { return !(*this == rhs); }
 
-        bool operator<(proxy_iterator const& rhs) const noexcept { return index_ < rhs.index_; }
+        bool operator<(proxy_iterator const& rhs) const noexcept { return first() < rhs.first(); }
         bool operator>(proxy_iterator const& rhs) const noexcept { return rhs < *this; }
         bool operator<=(proxy_iterator const& rhs) const noexcept { return !(rhs < *this); }
         bool operator>=(proxy_iterator const& rhs) const noexcept { return !(*this < rhs); }
 
-        proxy_iterator & operator++() noexcept { return ++index_, *this; }
-        proxy_iterator & operator--() noexcept { return --index_, *this; }
-        proxy_iterator & operator++(int) noexcept { const auto old = *this; return ++index_, old; }
-        proxy_iterator & operator--(int) noexcept { const auto old = *this; return --index_, old; }
+        proxy_iterator & operator++() noexcept { return advance(1); }
+        proxy_iterator & operator--() noexcept { return advance(-1); }
+        proxy_iterator operator++(int) noexcept { auto const old = *this; advance(1); return old; }
+        proxy_iterator operator--(int) noexcept { auto const old = *this; advance(-1); return old; }
 
-        proxy_iterator & operator+=(int shift) noexcept { return index_ += shift, *this; }
-        proxy_iterator & operator-=(int shift) noexcept { return index_ -= shift, *this; }
+        proxy_iterator & operator+=(difference_type shift) noexcept { return advance(shift); }
+        proxy_iterator & operator-=(difference_type shift) noexcept { return advance(-shift); }
 
-        proxy_iterator operator+(int shift) const noexcept { return { vec_, index_ + shift }; }
-        proxy_iterator operator-(int shift) const noexcept { return { vec_, index_ - shift }; }
-        
-        int operator-(proxy_iterator const& rhs) const noexcept { return index_ - rhs.index_; }
+        proxy_iterator operator+(difference_type shift) const noexcept { auto it = *this; return it.advance(shift); }
+        proxy_iterator operator-(difference_type shift) const noexcept { auto it = *this; return it.advance(-shift); }
+        friend proxy_iterator operator+(difference_type shift, proxy_iterator const& it) noexcept { return it + shift; }
+
+        difference_type operator-(proxy_iterator const& rhs) const noexcept { return first() - rhs.first(); }
+    };
+
+    // Iterator returning proxies on the rows of the containers whose rows aren't in contiguous columns
+    // (soa::paged_vector, soa::tiled_vector) : it holds the container and the row index.
+    template <class Container, bool IsConst>
+    class index_iterator {
+        friend Container;
+        friend class index_iterator<Container, !IsConst>;
+
+        using container_pointer_type = std::conditional_t<IsConst,
+            Container const*,
+            Container *>;
+
+        container_pointer_type container_;
+        std::ptrdiff_t index_;
+
+        index_iterator(container_pointer_type container, std::ptrdiff_t index) noexcept :
+            container_{container}, index_{index} {}
+    public:
+        index_iterator() noexcept : container_{nullptr}, index_{0} {}
+
+        // Conversion from iterator to const_iterator.
+        template <bool C = IsConst, class = std::enable_if_t<C>>
+        index_iterator(index_iterator<Container, false> const& it) noexcept :
+            container_{it.container_}, index_{it.index_} {}
+
+        using iterator_category = std::random_access_iterator_tag;
+
+        using value_type = std::conditional_t<IsConst,
+            typename Container::const_reference_type,
+            typename Container::reference_type>;
+
+        using reference = value_type;
+        using pointer = void;
+        using difference_type = std::ptrdiff_t;
+
+        value_type operator*() const noexcept { return (*container_)[static_cast<size_type>(index_)]; }
+        value_type operator[](difference_type shift) const noexcept {
+            return (*container_)[static_cast<size_type>(index_ + shift)];
+        }
+
+        bool operator==(index_iterator const& rhs) const noexcept { return index_ == rhs.index_; }
+        bool operator!=(index_iterator const& rhs) const noexcept { return !(*this == rhs); }
+
+        bool operator<(index_iterator const& rhs) const noexcept { return index_ < rhs.index_; }
+        bool operator>(index_iterator const& rhs) const noexcept { return rhs < *this; }
+        bool operator<=(index_iterator const& rhs) const noexcept { return !(rhs < *this); }
+        bool operator>=(index_iterator const& rhs) const noexcept { return !(*this < rhs); }
+
+        index_iterator & operator++() noexcept { return ++index_, *this; }
+        index_iterator & operator--() noexcept { return --index_, *this; }
+        index_iterator operator++(int) noexcept { auto const old = *this; ++index_; return old; }
+        index_iterator operator--(int) noexcept { auto const old = *this; --index_; return old; }
+
+        index_iterator & operator+=(difference_type shift) noexcept { return index_ += shift, *this; }
+        index_iterator & operator-=(difference_type shift) noexcept { return index_ -= shift, *this; }
+
+        index_iterator operator+(difference_type shift) const noexcept { return { container_, index_ + shift }; }
+        index_iterator operator-(difference_type shift) const noexcept { return { container_, index_ - shift }; }
+        friend index_iterator operator+(difference_type shift, index_iterator const& it) noexcept { return it + shift; }
+
+        difference_type operator-(index_iterator const& rhs) const noexcept { return index_ - rhs.index_; }
     };
 
 } // ::detail
 
 // Stores components of the aggregate T (given by the specialization soa::member<T>)
-// in successives arrays from an unique continuous allocation.
+// in successives arrays from an unique continuous allocation per column group.
 // It increases the performance when the access patterns are differents for the
 // aggregate's members.
-// Over-aligned types are not supported.
-template <class T, class Allocator>
-class vector : public detail::members_with_size<T> {
+// The columns alignment and padding are given by the Layout policy and the column options.
+template <class T, class Allocator, class Layout, size_t InlineRows, class Growth>
+class vector :
+    public detail::members_with_size<T>,
+    private detail::inline_storage<detail::inline_bytes<T, Layout, InlineRows>(), detail::block_alignment_v<T, Layout>>
+{
 public:
     static_assert(is_defined_v<T>,
         "soa::vector<T> can't be instancied because the required types 'soa::members<T>', "
         "'soa::ref_proxy<T>' or 'soa::cref_proxy<T>' haven't been defined. "
         "Did you forget to call the macro SOA_DEFINE_TYPE(T, members...) ?");
 
-    // The given allocator is reboud to std::byte to store the different member types.
-    using allocator_type = typename std::allocator_traits<Allocator>::template rebind_alloc<std::byte>;
+    // The alignment in bytes of the allocation, which is the strictest column alignment.
+    static constexpr size_t alignment = detail::block_alignment_v<T, Layout>;
+
+    // The given allocator is rebound to a type of 'alignment' bytes to store the different member types,
+    // so over-aligned columns are correctly allocated by std::allocator_traits.
+    using allocator_type = typename std::allocator_traits<Allocator>::template
+        rebind_alloc<detail::aligned_bytes<alignment>>;
+    using layout_type = Layout;
+    using growth_type = Growth;
 
     using value_type           = T;
     using reference_type       = ref_proxy<T>;
@@ -451,23 +1595,48 @@ public:
     // The number of T members.
     static constexpr int components_count = detail::arity_v<members<T>>;
 
+    // The number of allocations, one per column group (see soa::group).
+    static constexpr size_t groups_count = detail::groups_count_v<T>;
+
+    // The number of rows stored inside the object (see soa::small_vector), which is the minimum capacity.
+    static constexpr size_type inline_capacity = static_cast<size_type>(InlineRows);
+
+    // Inline rows are relocated one by one when the vector is moved or swapped.
+    static constexpr bool nothrow_inline_moves =
+        InlineRows == 0 || detail::is_nothrow_relocatable_members_v<T>;
+
     // Constructors.
     vector(Allocator allocator = Allocator{}) noexcept;
-    vector(vector && rhs) noexcept;
+    // Each column group uses it's own allocator.
+    explicit vector(std::array<Allocator, groups_count> const& allocators) noexcept;
+    vector(vector && rhs) noexcept(nothrow_inline_moves);
     vector(vector const& rhs);
+    // Allocator-extended constructors : all the groups use the given allocator.
+    // The elements are moved one by one if the allocators of 'rhs' compare unequal to it.
+    vector(vector && rhs, Allocator const& allocator);
+    vector(vector const& rhs, Allocator const& allocator);
 
     // Assignments.
-    vector& operator=(vector && rhs) noexcept;
+    // Allocators are propagated according to std::allocator_traits. When they are not propagated
+    // on move and compare unequal, the elements are moved one by one.
+    vector& operator=(vector && rhs) noexcept(nothrow_inline_moves && (
+        std::allocator_traits<allocator_type>::propagate_on_container_move_assignment::value ||
+        std::allocator_traits<allocator_type>::is_always_equal::value));
     vector& operator=(vector const& rhs);
 
+    // Swaps the allocators only if they propagate on swap, otherwise they must compare equal.
+    // Inline rows are relocated one by one.
+    void swap(vector& rhs) noexcept(nothrow_inline_moves);
+    friend void swap(vector& lhs, vector& rhs) noexcept(nothrow_inline_moves) { lhs.swap(rhs); }
+
     // Destructor.
     ~vector();
 
     // Size or capacity modifiers.
     void clear() noexcept;
-    void reserve(int capacity);
-    void resize(int size);
-    void resize(int size, T const& value);
+    void reserve(size_type capacity);
+    void resize(size_type size);
+    void resize(size_type size, T const& value);
     void shrink_to_fit();
 
     // Add and remove an element.
@@ -477,21 +1646,66 @@ public:
     void push_back(T && value);
     void pop_back() noexcept;
 
+    // Bulk insertions : the capacity is checked once, then each column is filled in a single loop.
+
+    // Appends the aggregates of the range [first, last). Random access ranges of T with columns which
+    // can't throw when copied are transposed by blocks which stay in the cache.
+    template <class InputIt>
+    void append(InputIt first, InputIt last);
+    // Replaces the rows by the aggregates of the range [first, last), which must not be rows of the vector.
+    // The capacity is reused.
+    template <class InputIt>
+    void assign(InputIt first, InputIt last);
+    // Appends one contiguous range per member (eg. std::vector<float>, soa::vector_span),
+    // all of the same size.
+    template <class...Columns>
+    void append_columns(Columns const&...columns);
+    // Appends 'n' elements constructed from the given components, the others are default-constructed.
+    template <class...Ts>
+    void emplace_back_n(size_type n, Ts const&...components);
+    // Inserts 'n' copies of 'value' before 'pos'. Returns an iterator on the first inserted element.
+    iterator insert(const_iterator pos, size_type n, T const& value);
+    iterator insert(const_iterator pos, T const& value);
+    // Constructs 'n' elements at the end, with 'fill(data, type_tag, index)' called for each column
+    // with the uninitialized destination array, which must be filled with 'n' objects.
+    // If 'fill' throws, it must not leave constructed objects in 'data', and the vector is unchanged.
+    template <class F>
+    void append_rows(size_type n, F && fill);
+
+    // Removals : each column is compacted in it's own pass, with memmove for trivially relocatable types.
+
+    // Removes the elements in [first, last). Returns an iterator on the element following the removed ones.
+    iterator erase(const_iterator first, const_iterator last);
+    iterator erase(const_iterator pos);
+    // Removes the element at 'pos' in O(1) by moving the last element in it's place.
+    // Returns an iterator on 'pos'.
+    iterator swap_erase(const_iterator pos);
+    // Removes the rows i for which 'keep[i]' is false. Returns the number of removed rows.
+    template <class Mask>
+    size_type compact(Mask const& keep);
+
     // Informations.
-    int  size()     const noexcept { return this->size_; }
-    int  capacity() const noexcept { return capacity_; }
+    size_type  size()     const noexcept { return this->size_; }
+    // The maximum number of rows, for which the allocations sizes in bytes fit in size_type.
+    static constexpr size_type max_size() noexcept {
+        return detail::max_rows<T, Layout>(std::make_index_sequence<detail::arity_v<members<T>>>{});
+    }
+    size_type  capacity() const noexcept { return capacity_; }
     bool empty()    const noexcept { return size() == 0; }
 
+    // Returns the allocator of the given column group.
+    allocator_type get_allocator(size_t group = 0) const noexcept { return allocators_[group]; }
+
     // Accessors.
-    reference_type       operator[](int i)       noexcept { return *(begin() + i); } 
-    const_reference_type operator[](int i) const noexcept { return *(begin() + i); }
-    reference_type       at(int i)       { check_at(i); return *(begin() + i); }
-    const_reference_type at(int i) const { check_at(i); return *(begin() + i); }
+    reference_type       operator[](size_type i)       noexcept { return make_proxy(*this, i, sequence_type{}); }
+    const_reference_type operator[](size_type i) const noexcept { return make_proxy(*this, i, sequence_type{}); }
+    reference_type       at(size_type i)       { check_at(i); return (*this)[i]; }
+    const_reference_type at(size_type i) const { check_at(i); return (*this)[i]; }
 
-    reference_type       front()       noexcept { return *begin(); }
-    const_reference_type front() const noexcept { return *begin(); }
-    reference_type       back()       noexcept { return *(end() - 1); }
-    const_reference_type back() const noexcept { return *(end() - 1); }
+    reference_type       front()       noexcept { return (*this)[0]; }
+    const_reference_type front() const noexcept { return (*this)[0]; }
+    reference_type       back()       noexcept { return (*this)[size() - 1]; }
+    const_reference_type back() const noexcept { return (*this)[size() - 1]; }
 
     // Iterators.
     iterator       begin()        noexcept { return { this, 0 }; }
@@ -524,454 +1738,2170 @@ private:
 
     using sequence_type = std::make_index_sequence<components_count>;
 
-    // components_tag = detail::type_tag<Ts...>.
-    template <class Tuple>
-    struct components_tag_impl;
-    template <class...Members>
-    struct components_tag_impl<std::tuple<Members&...>> {
-        using type = detail::type_tag<typename Members::value_type...>;
-    };
-    using components_tag = typename components_tag_impl<decltype(
-        detail::as_tuple(std::declval<members<T>>())
-    )>::type;
+    // The proxies are built from the spans rather than from an iterator, which holds a tuple of pointers.
+    template <class Vector, size_t...Is>
+    static auto make_proxy(Vector& self, size_type i, std::index_sequence<Is...>) noexcept {
+        using proxy = std::conditional_t<std::is_const_v<Vector>, const_reference_type, reference_type>;
+        return proxy{ self.template get_span<Is>().data()[i]... };
+    }
 
     using allocator_traits = std::allocator_traits<allocator_type>;
 
     // Functions implementations.
 
-    void check_at(int index) const;
+    void check_at(size_type index) const;
+    // Throws std::length_error if 'capacity' is greater than max_size().
+    static void check_capacity(size_type capacity, std::string_view function);
+
+    template <size_t...Is>
+    void push_back_copy(T const& value, std::index_sequence<Is...>);
+    template <size_t...Is>
+    void push_back_move(T& value, std::index_sequence<Is...>);
 
-    template <class Tuple, size_t...Is>
-    void push_back_copy(Tuple const& tuple, std::index_sequence<Is...>);
-    template <class Tuple, size_t...Is>
-    void push_back_move(Tuple& tuple, std::index_sequence<Is...>);
+    template <size_t...Is, size_t...Js, class...Ts>
+    void emplace_back_impl(std::index_sequence<Is...>, std::index_sequence<Js...>, Ts&&...components);
 
-    template <size_t I, class...Members, class T1, class...Ts>
-    void emplace_back_impl(std::tuple<Members&...> const& members, T1&& component, Ts&&...nexts);
-    template <size_t I, class...Members>
-    void emplace_back_impl(std::tuple<Members&...> const& members);
+    using bytes_type  = std::array<size_type, groups_count>;
+    using blocks_type = std::array<std::byte*, groups_count>;
+    using groups_mask = std::array<bool, groups_count>;
 
-    // Computes the bytes padding for each component,
-    // assuming we start with a 8-bytes aligned address.
-    template <size_t I, class...Ints>
-    static void update_shift(std::tuple<Ints...>& shifts, int nb, int acc);
+    // Offset of each column in the allocation of it's group, and size in bytes of each allocation.
+    using shift_type = detail::shifts<T>;
+    static constexpr shift_type compute_shifts(size_type nb) noexcept {
+        return detail::compute_shifts<T, Layout>(nb);
+    }
+
+    // Inline storage of the first 'InlineRows' rows.
+    static constexpr shift_type inline_shift = detail::compute_shifts<T, Layout>(static_cast<size_type>(InlineRows));
+    blocks_type inline_blocks() noexcept;
+    bool is_inline(std::byte const* block) const noexcept;
+    bool is_inline() const noexcept;
 
     // Creates vector_spans based on the data allocated
     // and the computed shift for each component.
-    template <class Tuple, size_t...Is>
-    static members<T> create_members(std::byte* ptr, Tuple const& shift, std::index_sequence<Is...>);
+    template <size_t...Is>
+    static members<T> create_members(blocks_type const& blocks, shift_type const& shift, std::index_sequence<Is...>);
+
+    // Retrieves the allocation of each group, which starts with the group first column.
+    template <size_t...Is>
+    static blocks_type get_blocks(members<T> const& mem, std::index_sequence<Is...>) noexcept;
+
+    static constexpr auto column_groups = detail::column_groups<T>(sequence_type{});
+
+    // Groups where all the columns are trivially relocatable.
+    template <size_t...Is>
+    static constexpr groups_mask relocatable_groups(std::index_sequence<Is...>) noexcept;
 
     struct alloc_result {
         members<T> new_members;
-        int nb_bytes;
+        bytes_type nb_bytes;
     };
     // Allocates unitialized array of 'nb' elements.
-    alloc_result allocate(int nb);
-
-    static void construct_copy_array(members<T> const& src, members<T>& dst, int nb);
-    static void construct_move_array(members<T> &      src, members<T>& dst, int nb);
-
-    template <class F>
-    static void apply_on_arrays(members<T> const& mem_src, members<T> & mem_dst, int nb, F && f);
-    template <class F>
-    static void apply_on_arrays(members<T> & mem_src, members<T> & mem_dst, int nb, F && f);
+    alloc_result allocate(size_type nb);
+    // Allocates the 'nb_bytes' of a group.
+    std::byte* allocate(size_t group, size_type nb_bytes);
+
+    // Makes room for at least 'min_capacity' elements, with the capacity given by the growth policy.
+    void grow(size_type min_capacity);
+    // Raises the capacity to the rows which fit in the allocations rounded by the growth policy.
+    static size_type rounded_capacity(size_type capacity) noexcept;
+    // Size in bits of a row in the allocation of each group.
+    static constexpr auto group_row_bits = detail::group_row_bits<T>(
+        std::make_index_sequence<detail::arity_v<members<T>>>{});
+
+    static void construct_copy_array(members<T> const& src, members<T>& dst, size_type nb);
+    static void construct_move_array(members<T> &      src, members<T>& dst, size_type nb);
+
+    // Moves the 'nb' elements of 'src' to 'dst' and destroys them in 'src'.
+    // Columns which can throw when moved are copied first : if an exception is raised,
+    // 'dst' is left empty and 'src' is unchanged.
+    // The columns of 'in_place' groups are trivially relocatable, and moved last inside their
+    // expanded allocation.
+    static void relocate_array(members<T> & src, members<T>& dst, size_type nb, groups_mask const& in_place = {});
+
+    // Changes the capacity, which must be at least size(). The elements are moved to new
+    // allocations (or in place when the allocator can expand them) and the old ones are released.
+    // Gives the strong exception guarantee, unless a column is move-only and throws on move.
+    // The 'cause' is reported to the instrumentation sink.
+    void reallocate(size_type capacity, instrumentation::event_kind cause);
+    // Tries to expand the allocation of a group to 'nb_bytes'.
+    bool expand(size_t group, std::byte* block, size_type nb_bytes) noexcept;
 
     void destroy() noexcept;
-    void destroy(int begin, int end) noexcept;
+    void destroy(size_type begin, size_type end) noexcept;
     void deallocate() noexcept;
+    void deallocate(size_t group, std::byte* block, size_type nb_bytes) noexcept;
 
     // Sets the vector fields (size, capacity, ...) according to an empty vector.
     void to_zero() noexcept;
 
-    int capacity_;
-    allocator_type allocator_;
-    int nb_bytes_;
+    // Instrumentation events, which are not compiled without SOA_INSTRUMENTATION.
+    void notify_allocation(instrumentation::event_kind kind, size_t group, size_type nb_bytes) const noexcept;
+    // The 'rows' are moved or copied in the columns, except in the columns of the 'unmoved' groups.
+    void notify_rows(instrumentation::event_kind kind, size_type old_capacity, size_type rows,
+        groups_mask const& unmoved = {}) const noexcept;
+    template <size_t...Is>
+    static constexpr std::array<size_t, sizeof...(Is)> column_array_bytes(size_type rows, std::index_sequence<Is...>) noexcept {
+        return {{ static_cast<size_t>(detail::column_array_bytes<T, Is>(rows))... }};
+    }
+
+    // Allocators propagation.
+    bool equal_allocators(vector const& rhs) const noexcept;
+    // Takes the allocations of 'rhs', which must be allocated with equal allocators.
+    // The vector must be deallocated. Inline rows of 'rhs' are relocated.
+    void steal(vector& rhs) noexcept(nothrow_inline_moves);
+    // Copy-constructs the elements of 'rhs' in the vector, which must be empty.
+    void copy_elements(vector const& rhs);
+    // Move-constructs the elements of 'rhs' in the vector, which must be empty, then clears 'rhs'.
+    void move_elements(vector& rhs);
+
+    size_type capacity_;
+    std::array<allocator_type, groups_count> allocators_;
+    bytes_type nb_bytes_;
 };
 
 // soa::vector implementation.
 
 // The check function returns an arbitrary value to be executed at compile-time :
 // The msvc version used don't support constexpr void functions.
-template <class T, class Allocator>
-constexpr int vector<T, Allocator>::check_members() {
+template <class T, class Allocator, class Layout, size_t InlineRows, class Growth>
+constexpr int vector<T, Allocator, Layout, InlineRows, Growth>::check_members() {
 
     static_assert(!std::is_empty_v<members<T>>,
         "soa::members<T> must be specialized to hold "
         "an soa::vector_span for each member of T");
     
-    static_assert(detail::arity_v<members<T>> <= detail::max_arity,
-        "soa::members<T> must have less than 'max_arity' members. "
-        "This limit can be increased by writing more overloads of 'as_tuple'.");
+    static_assert(detail::has_contiguous_groups_v<T>,
+        "soa::group indices of soa::members<T> must be contiguous and start from 0.");
     
     return 0;
 }
 
 // Constructors.
 
-template <class T, class Allocator>
-vector<T, Allocator>::vector(Allocator allocator) noexcept :
+template <class T, class Allocator, class Layout, size_t InlineRows, class Growth>
+vector<T, Allocator, Layout, InlineRows, Growth>::vector(Allocator allocator) noexcept :
     detail::members_with_size<T>{},
-    capacity_ { 0 },
-    allocator_{ allocator },
-    nb_bytes_ { 0 }
-{}
-
-template <class T, class Allocator>
-vector<T, Allocator>::vector(vector&& rhs) noexcept :
-    detail::members_with_size<T>{ rhs.base_with_size() },
-    capacity_ { rhs.capacity() },
-    allocator_{ rhs.allocator_ },
-    nb_bytes_ { rhs.nb_bytes_ }
+    capacity_  { 0 },
+    allocators_{ detail::repeat_array<groups_count>(allocator_type{ allocator }) },
+    nb_bytes_  {}
 {
-    rhs.to_zero();
+    to_zero();
 }
 
-template <class T, class Allocator>
-vector<T, Allocator>::vector(vector const& rhs) :
-    detail::members_with_size<T>{ rhs.base_with_size() },
-    capacity_ { rhs.size() },
-    allocator_{ rhs.allocator_ },
-    nb_bytes_ { rhs.nb_bytes_ }
+template <class T, class Allocator, class Layout, size_t InlineRows, class Growth>
+vector<T, Allocator, Layout, InlineRows, Growth>::vector(std::array<Allocator, groups_count> const& allocators) noexcept :
+    detail::members_with_size<T>{},
+    capacity_  { 0 },
+    allocators_{ detail::transform_array(allocators, [] (Allocator const& a) { return allocator_type{ a }; }) },
+    nb_bytes_  {}
 {
-    if (rhs.empty()) return;
+    to_zero();
+}
 
-    auto [new_members, nb_bytes] = allocate(size());
-    construct_copy_array(rhs.base(), new_members, size());
-    base()    = new_members;
-    nb_bytes_ = nb_bytes;
+template <class T, class Allocator, class Layout, size_t InlineRows, class Growth>
+vector<T, Allocator, Layout, InlineRows, Growth>::vector(vector&& rhs) noexcept(nothrow_inline_moves) :
+    detail::members_with_size<T>{},
+    capacity_  { 0 },
+    allocators_{ std::move(rhs.allocators_) },
+    nb_bytes_  {}
+{
+    to_zero();
+    steal(rhs);
+}
+
+template <class T, class Allocator, class Layout, size_t InlineRows, class Growth>
+vector<T, Allocator, Layout, InlineRows, Growth>::vector(vector const& rhs) :
+    detail::members_with_size<T>{},
+    capacity_  { 0 },
+    allocators_{ detail::transform_array(rhs.allocators_, [] (allocator_type const& a) {
+        return allocator_traits::select_on_container_copy_construction(a);
+    }) },
+    nb_bytes_  {}
+{
+    to_zero();
+    copy_elements(rhs);
+    notify_rows(instrumentation::event_kind::copy_construct, inline_capacity, rhs.size());
+}
+
+template <class T, class Allocator, class Layout, size_t InlineRows, class Growth>
+vector<T, Allocator, Layout, InlineRows, Growth>::vector(vector&& rhs, Allocator const& allocator) :
+    vector(allocator)
+{
+    if (equal_allocators(rhs)) steal(rhs);
+    else move_elements(rhs);
+}
+
+template <class T, class Allocator, class Layout, size_t InlineRows, class Growth>
+vector<T, Allocator, Layout, InlineRows, Growth>::vector(vector const& rhs, Allocator const& allocator) :
+    vector(allocator)
+{
+    copy_elements(rhs);
+    notify_rows(instrumentation::event_kind::copy_construct, inline_capacity, rhs.size());
 }
 
 // Assignments.
 
-template <class T, class Allocator>
-vector<T, Allocator>& vector<T, Allocator>::operator=(vector&& rhs) noexcept {
+template <class T, class Allocator, class Layout, size_t InlineRows, class Growth>
+vector<T, Allocator, Layout, InlineRows, Growth>& vector<T, Allocator, Layout, InlineRows, Growth>::operator=(vector&& rhs) noexcept(
+    nothrow_inline_moves && (
+    std::allocator_traits<allocator_type>::propagate_on_container_move_assignment::value ||
+    std::allocator_traits<allocator_type>::is_always_equal::value))
+{
+    if (this == &rhs) return *this;
     destroy();
-    deallocate();
-    base_with_size() = rhs.base_with_size();
-    capacity_  = rhs.capacity();
-    allocator_ = rhs.allocator_;
-    nb_bytes_  = rhs.nb_bytes_;
-    rhs.to_zero();
+    this->set_size(0);
+    if constexpr (allocator_traits::propagate_on_container_move_assignment::value) {
+        deallocate();
+        to_zero();
+        allocators_ = std::move(rhs.allocators_);
+        steal(rhs);
+    }
+    else {
+        if (equal_allocators(rhs)) {
+            deallocate();
+            to_zero();
+            steal(rhs);
+        }
+        else move_elements(rhs);
+    }
     return *this;
 }
-    
-template <class T, class Allocator>
-vector<T, Allocator>& vector<T, Allocator>::operator=(vector const& rhs) {
+
+template <class T, class Allocator, class Layout, size_t InlineRows, class Growth>
+vector<T, Allocator, Layout, InlineRows, Growth>& vector<T, Allocator, Layout, InlineRows, Growth>::operator=(vector const& rhs) {
+    if (this == &rhs) return *this;
+    auto const old_capacity = capacity();
     destroy();
-    this->size_ = rhs.size();
-    if (capacity() < size()) {
-        deallocate();
-        auto [new_members, nb_bytes] = allocate(size());
-        base()    = new_members;
-        nb_bytes_ = nb_bytes;
-        capacity_ = size();
+    this->set_size(0);
+    if constexpr (allocator_traits::propagate_on_container_copy_assignment::value) {
+        if (!equal_allocators(rhs)) {
+            // The memory must be released by the allocators which allocated it.
+            deallocate();
+            to_zero();
+        }
+        allocators_ = rhs.allocators_;
     }
-    construct_copy_array(rhs.base(), base(), size());
+    copy_elements(rhs);
+    notify_rows(instrumentation::event_kind::copy_assign, old_capacity, rhs.size());
     return *this;
 }
 
+template <class T, class Allocator, class Layout, size_t InlineRows, class Growth>
+void vector<T, Allocator, Layout, InlineRows, Growth>::swap(vector& rhs) noexcept(nothrow_inline_moves) {
+    using std::swap;
+    if constexpr (InlineRows > 0) {
+        // The rows are stolen through an empty vector, without the move assignments which could allocate.
+        if (this == &rhs) return;
+        auto tmp = vector{ Allocator{ rhs.allocators_[0] } };
+        tmp.steal(rhs);
+        rhs.steal(*this);
+        steal(tmp);
+        if constexpr (allocator_traits::propagate_on_container_swap::value) {
+            swap(allocators_, rhs.allocators_);
+        }
+        return;
+    }
+    swap(base_with_size(), rhs.base_with_size());
+    swap(capacity_, rhs.capacity_);
+    swap(nb_bytes_, rhs.nb_bytes_);
+    if constexpr (allocator_traits::propagate_on_container_swap::value) {
+        swap(allocators_, rhs.allocators_);
+    }
+}
+
 // Destructor.
-template <class T, class Allocator>
-vector<T, Allocator>::~vector() {
+template <class T, class Allocator, class Layout, size_t InlineRows, class Growth>
+vector<T, Allocator, Layout, InlineRows, Growth>::~vector() {
     destroy();
     deallocate();
 }
 
 // Size & capacity modifiers.
 
-template <class T, class Allocator>
-void vector<T, Allocator>::clear() noexcept {
+template <class T, class Allocator, class Layout, size_t InlineRows, class Growth>
+void vector<T, Allocator, Layout, InlineRows, Growth>::clear() noexcept {
     destroy();
-    this->size_ = 0;
+    this->set_size(0);
 }
 
-template <class T, class Allocator>
-void vector<T, Allocator>::reserve(int capacity) {
+template <class T, class Allocator, class Layout, size_t InlineRows, class Growth>
+void vector<T, Allocator, Layout, InlineRows, Growth>::reserve(size_type capacity) {
+    using namespace std::literals;
     if (capacity <= this->capacity()) return;
-    
-    auto [new_members, nb_bytes] = allocate(capacity);
-    construct_move_array(base(), new_members, size());
-    base()    = new_members;
-    nb_bytes_ = nb_bytes;
-    capacity_ = capacity;
+    check_capacity(capacity, "reserve"sv);
+    reallocate(rounded_capacity(capacity), instrumentation::event_kind::reserve);
 }
 
-template <class T, class Allocator>
-void vector<T, Allocator>::resize(int size) {
+template <class T, class Allocator, class Layout, size_t InlineRows, class Growth>
+void vector<T, Allocator, Layout, InlineRows, Growth>::resize(size_type size) {
     if (size <= this->size()) {
         destroy(size, this->size());
-        this->size_ = size;
+        this->set_size(size);
         return;
     }
     reserve(size);
-    detail::for_each(detail::as_tuple(base()), [this, size] (auto& span, auto tag) {
-        using type = typename decltype(tag)::type;
+    detail::for_each_column(base(), [this, size] (auto& span, auto) {
         auto it = span.begin() + this->size();
         auto const end = span.begin() + size;
         for (; it < end; ++it) {
-            new (it) type();
+            detail::construct_at(it);
         }
     });
-    this->size_ = size;
+    this->set_size(size);
 }
 
-template <class T, class Allocator>
-void vector<T, Allocator>::resize(int size, T const& value) {
+template <class T, class Allocator, class Layout, size_t InlineRows, class Growth>
+void vector<T, Allocator, Layout, InlineRows, Growth>::resize(size_type size, T const& value) {
     if (size <= this->size()) {
         destroy(size, this->size());
-        this->size_ = size;
+        this->set_size(size);
         return;
     }
     reserve(size);
-    auto const tuple = detail::as_tuple<components_count>(value);
-    detail::for_each(detail::as_tuple(base()), tuple, [this, size] (auto& span, auto& val, auto tag) {
-        using type = typename decltype(tag)::type;
+    detail::for_each_column_indexed(base(), [this, size, &value] (auto& span, auto, auto index) {
+        auto const& val = value.*detail::member_pointer_v<T, decltype(index)::value>;
         auto it = span.begin() + this->size();
         auto const end = span.begin() + size;
         while (it < end) {
-            new (it) type(val); ++it;
+            detail::construct_at(it, val); ++it;
         }
     });
-    this->size_ = size;
+    this->set_size(size);
 }
 
-template <class T, class Allocator>
-void vector<T, Allocator>::shrink_to_fit() {
+template <class T, class Allocator, class Layout, size_t InlineRows, class Growth>
+void vector<T, Allocator, Layout, InlineRows, Growth>::shrink_to_fit() {
     if (size() == capacity()) return;
-    reallocate(size());
+    reallocate(size(), instrumentation::event_kind::shrink_to_fit);
 }
 
 // Add and remove an element.
 
-template <class T, class Allocator>
-void vector<T, Allocator>::push_back(T const& value) {
-    auto const tuple = detail::as_tuple<components_count>(value);
-    push_back_copy(tuple, sequence_type{});
+template <class T, class Allocator, class Layout, size_t InlineRows, class Growth>
+void vector<T, Allocator, Layout, InlineRows, Growth>::push_back(T const& value) {
+    push_back_copy(value, sequence_type{});
 }
 
-template <class T, class Allocator>
-void vector<T, Allocator>::push_back(T&& value) {
-    auto tuple = detail::as_tuple<components_count>(value);
-    push_back_move(tuple, sequence_type{});
+template <class T, class Allocator, class Layout, size_t InlineRows, class Growth>
+void vector<T, Allocator, Layout, InlineRows, Growth>::push_back(T&& value) {
+    push_back_move(value, sequence_type{});
 }
 
-template <class T, class Allocator>
+template <class T, class Allocator, class Layout, size_t InlineRows, class Growth>
 template <class...Ts>
-void vector<T, Allocator>::emplace_back(Ts&&...components) {
-    if (size() == capacity()) {
-        auto const new_capacity = size() == 0 ? 1 : capacity() * 2;
-        reserve(new_capacity);
+void vector<T, Allocator, Layout, InlineRows, Growth>::emplace_back(Ts&&...components) {
+    if (size() == capacity()) grow(size() + 1);
+    emplace_back_impl(std::index_sequence_for<Ts...>{},
+        std::make_index_sequence<components_count - sizeof...(Ts)>{}, std::forward<Ts>(components)...);
+    this->set_size(size() + 1);
+}
+
+template <class T, class Allocator, class Layout, size_t InlineRows, class Growth>
+void vector<T, Allocator, Layout, InlineRows, Growth>::pop_back() noexcept {
+    this->set_size(size() - 1);
+    detail::for_each_column(base(), [this] (auto& span, auto) {
+        detail::destroy_at(span.data() + size());
+    });
+}
+
+// Bulk insertions.
+
+template <class T, class Allocator, class Layout, size_t InlineRows, class Growth>
+template <class InputIt>
+void vector<T, Allocator, Layout, InlineRows, Growth>::append(InputIt first, InputIt last) {
+    using category = typename std::iterator_traits<InputIt>::iterator_category;
+    if constexpr (!std::is_base_of_v<std::forward_iterator_tag, category>) {
+        for (; first != last; ++first) push_back(*first);
+    }
+    else if constexpr (std::is_base_of_v<std::random_access_iterator_tag, category> &&
+        std::is_same_v<typename std::iterator_traits<InputIt>::value_type, T> &&
+        detail::is_nothrow_copyable_members_v<T>)
+    {
+        using namespace std::literals;
+        auto const n = static_cast<size_type>(last - first);
+        if (n <= 0) return;
+        if (n > max_size() - size()) check_capacity(max_size() + 1, "append"sv);
+        grow(size() + n);
+
+        // Each block of aggregates is read once from the memory, and the copies can't throw.
+        auto const offset = size();
+        constexpr auto block_rows = detail::transpose_block_rows<T>;
+        for (size_type block = 0; block < n; block += block_rows) {
+            auto const rows = std::min(block_rows, n - block);
+            auto const src = first + block;
+            detail::for_each_column_indexed(base(), [src, rows, offset, block] (auto& span, auto, auto index) {
+                constexpr auto member = members<T>::member_pointer(std::integral_constant<size_t, decltype(index)::value>{});
+                auto const dst = span.data() + offset + block;
+                for (size_type i = 0; i < rows; ++i) detail::construct_at(dst + i, src[i].*member);
+            });
+        }
+        this->set_size(size() + n);
     }
-    emplace_back_impl<0>(detail::as_tuple(base()), std::forward<Ts>(components)...);
-    ++this->size_;
+    else {
+        auto const n = static_cast<size_type>(std::distance(first, last));
+        append_rows(n, [first, n] (auto dst, auto, auto index) {
+            constexpr auto I = decltype(index)::value;
+            auto it = first;
+            size_type i = 0;
+            try {
+                for (; i < n; ++i, ++it) {
+                    detail::construct_at(dst + i, std::get<I>(detail::as_tuple<components_count>(*it)));
+                }
+            }
+            catch (...) {
+                detail::destroy(dst, dst + i);
+                throw;
+            }
+        });
+    }
+}
+
+template <class T, class Allocator, class Layout, size_t InlineRows, class Growth>
+template <class InputIt>
+void vector<T, Allocator, Layout, InlineRows, Growth>::assign(InputIt first, InputIt last) {
+    clear();
+    append(first, last);
+}
+
+template <class T, class Allocator, class Layout, size_t InlineRows, class Growth>
+template <class...Columns>
+void vector<T, Allocator, Layout, InlineRows, Growth>::append_columns(Columns const&...columns) {
+    static_assert(sizeof...(Columns) == components_count,
+        "soa::vector<T>::append_columns must be given one range per member of T");
+
+    auto const n = static_cast<size_type>(std::size(std::get<0>(std::forward_as_tuple(columns...))));
+    if (((static_cast<size_type>(std::size(columns)) != n) || ...)) {
+        using namespace std::literals;
+        throw std::invalid_argument{ detail::concatene(
+            "Columns of different sizes given to "sv, detail::type_name<vector>(), "::append_columns"sv
+        )};
+    }
+    auto const sources = std::forward_as_tuple(columns...);
+    append_rows(n, [&sources, n] (auto dst, auto tag, auto index) {
+        using type = typename decltype(tag)::type;
+        auto const src = std::data(std::get<decltype(index)::value>(sources));
+        if constexpr (std::is_same_v<std::remove_const_t<std::remove_pointer_t<decltype(src)>>, type>) {
+            detail::construct_copy(src, dst, n);
+        }
+        else {
+            detail::uninitialized_copy_n(src, n, dst);
+        }
+    });
+}
+
+template <class T, class Allocator, class Layout, size_t InlineRows, class Growth>
+template <class...Ts>
+void vector<T, Allocator, Layout, InlineRows, Growth>::emplace_back_n(size_type n, Ts const&...components) {
+    static_assert(sizeof...(Ts) <= components_count,
+        "soa::vector<T>::emplace_back_n takes at most one argument per member of T");
+
+    auto const values = std::forward_as_tuple(components...);
+    append_rows(n, [&values, n] (auto dst, auto, auto index) {
+        constexpr auto I = decltype(index)::value;
+        if constexpr (I < sizeof...(Ts)) {
+            detail::uninitialized_fill_n(dst, n, std::get<I>(values));
+        }
+        else {
+            detail::uninitialized_value_construct_n(dst, n);
+        }
+    });
+}
+
+template <class T, class Allocator, class Layout, size_t InlineRows, class Growth>
+typename vector<T, Allocator, Layout, InlineRows, Growth>::iterator
+vector<T, Allocator, Layout, InlineRows, Growth>::insert(const_iterator pos, size_type n, T const& value) {
+    auto const index = static_cast<size_type>(pos - cbegin());
+    if (n <= 0) return begin() + index;
+
+    // 'value' can be an element of the vector, invalidated by the growth.
+    auto const copy = value;
+    auto const old_size = size();
+
+    // Non-trivial columns are appended first, so the vector is unchanged if a copy throws.
+    append_rows(n, [&copy, n] (auto dst, auto tag, auto index) {
+        using type = typename decltype(tag)::type;
+        if constexpr (!std::is_trivially_copyable_v<type>) {
+            std::uninitialized_fill_n(dst, n, copy.*detail::member_pointer_v<T, decltype(index)::value>);
+        }
+    });
+    detail::for_each_column_indexed(base(), [&copy, n, index, old_size] (auto & span, auto tag, auto i) {
+        using type = typename decltype(tag)::type;
+        auto const data = span.data();
+        if constexpr (std::is_trivially_copyable_v<type>) {
+            detail::relocate(data + index, data + index + n, old_size - index);
+            std::fill_n(data + index, n, copy.*detail::member_pointer_v<T, decltype(i)::value>);
+        }
+        else {
+            std::rotate(data + index, data + old_size, data + old_size + n);
+        }
+    });
+    return begin() + index;
 }
 
-template <class T, class Allocator>
-void vector<T, Allocator>::pop_back() noexcept {
-    --this->size_;
-    detail::for_each(detail::as_tuple(base()), [this] (auto& span, auto tag) {
+template <class T, class Allocator, class Layout, size_t InlineRows, class Growth>
+typename vector<T, Allocator, Layout, InlineRows, Growth>::iterator
+vector<T, Allocator, Layout, InlineRows, Growth>::insert(const_iterator pos, T const& value) {
+    return insert(pos, 1, value);
+}
+
+// Removals.
+
+template <class T, class Allocator, class Layout, size_t InlineRows, class Growth>
+typename vector<T, Allocator, Layout, InlineRows, Growth>::iterator
+vector<T, Allocator, Layout, InlineRows, Growth>::erase(const_iterator first, const_iterator last) {
+    auto const begin = static_cast<size_type>(first - cbegin());
+    auto const end = static_cast<size_type>(last - cbegin());
+    if (begin == end) return this->begin() + begin;
+    auto const old_size = size();
+
+    detail::for_each_column(base(), [begin, end, old_size] (auto& span, auto tag) {
+        using type = typename decltype(tag)::type;
+        auto const data = span.data();
+        if constexpr (is_trivially_relocatable_v<type>) {
+            detail::destroy(data + begin, data + end);
+            detail::relocate(data + end, data + begin, old_size - end);
+        }
+        else {
+            std::move(data + end, data + old_size, data + begin);
+            detail::destroy(data + old_size - (end - begin), data + old_size);
+        }
+    });
+    this->set_size(size() - (end - begin));
+    return this->begin() + begin;
+}
+
+template <class T, class Allocator, class Layout, size_t InlineRows, class Growth>
+typename vector<T, Allocator, Layout, InlineRows, Growth>::iterator
+vector<T, Allocator, Layout, InlineRows, Growth>::erase(const_iterator pos) {
+    return erase(pos, pos + 1);
+}
+
+template <class T, class Allocator, class Layout, size_t InlineRows, class Growth>
+typename vector<T, Allocator, Layout, InlineRows, Growth>::iterator
+vector<T, Allocator, Layout, InlineRows, Growth>::swap_erase(const_iterator pos) {
+    auto const index = static_cast<size_type>(pos - cbegin());
+    auto const last = size() - 1;
+
+    detail::for_each_column(base(), [index, last] (auto& span, auto tag) {
         using type = typename decltype(tag)::type;
-        span[size()].~type();
+        auto const data = span.data();
+        if (index != last) {
+            if constexpr (is_trivially_relocatable_v<type>) {
+                detail::destroy_at(data + index);
+                detail::relocate(data + last, data + index, 1);
+                return;
+            }
+            else {
+                data[index] = std::move(data[last]);
+            }
+        }
+        detail::destroy_at(data + last);
     });
+    this->set_size(size() - 1);
+    return begin() + index;
+}
+
+template <class T, class Allocator, class Layout, size_t InlineRows, class Growth>
+template <class Mask>
+size_type vector<T, Allocator, Layout, InlineRows, Growth>::compact(Mask const& keep) {
+    auto const old_size = size();
+    size_type first = 0;
+    while (first < old_size && keep[first]) ++first;
+    if (first == old_size) return 0;
+
+    auto new_size = first;
+    for (size_type i = first; i < old_size; ++i) {
+        if (keep[i]) ++new_size;
+    }
+
+    detail::for_each_column(base(), [&keep, first, old_size] (auto& span, auto tag) {
+        using type = typename decltype(tag)::type;
+        auto const data = span.data();
+        auto dst = first;
+        if constexpr (is_trivially_relocatable_v<type>) {
+            // Removed elements are destroyed, then each run of kept elements is moved with one memmove.
+            if constexpr (!std::is_trivially_destructible_v<type>) {
+                for (size_type i = first; i < old_size; ++i) {
+                    if (!keep[i]) detail::destroy_at(data + i);
+                }
+            }
+            for (size_type i = first; i < old_size;) {
+                while (i < old_size && !keep[i]) ++i;
+                auto const run = i;
+                while (i < old_size && keep[i]) ++i;
+                if (i > run) {
+                    detail::relocate(data + run, data + dst, i - run);
+                    dst += i - run;
+                }
+            }
+        }
+        else {
+            for (size_type i = first + 1; i < old_size; ++i) {
+                if (keep[i]) data[dst++] = std::move(data[i]);
+            }
+            detail::destroy(data + dst, data + old_size);
+        }
+    });
+    this->set_size(new_size);
+    return old_size - new_size;
 }
 
 // Components accessors.
 
-template <class T, class Allocator>
+template <class T, class Allocator, class Layout, size_t InlineRows, class Growth>
 template <size_t I>
-auto& vector<T, Allocator>::get_span() noexcept {
+auto& vector<T, Allocator, Layout, InlineRows, Growth>::get_span() noexcept {
     static_assert(I < components_count);
-    return std::get<I>(detail::as_tuple(base()));
+    return base().*detail::span_pointer_v<T, I>;
 }
 
-template <class T, class Allocator>
+template <class T, class Allocator, class Layout, size_t InlineRows, class Growth>
 template <size_t I>
-auto const& vector<T, Allocator>::get_span() const noexcept {
+auto const& vector<T, Allocator, Layout, InlineRows, Growth>::get_span() const noexcept {
     static_assert(I < components_count);
-    return std::get<I>(detail::as_tuple(base()));
+    return base().*detail::span_pointer_v<T, I>;
 }
 
 // Private functions.
 
-template <class T, class Allocator>
-void vector<T, Allocator>::check_at(int i) const {
-    if (i >= size()) detail::throw_out_of_range<vector<T, Allocator>>(i, size());
+template <class T, class Allocator, class Layout, size_t InlineRows, class Growth>
+void vector<T, Allocator, Layout, InlineRows, Growth>::check_at(size_type i) const {
+    if (i >= size()) detail::throw_out_of_range<vector<T, Allocator, Layout, InlineRows, Growth>>(i, size());
+}
+
+template <class T, class Allocator, class Layout, size_t InlineRows, class Growth>
+void vector<T, Allocator, Layout, InlineRows, Growth>::check_capacity(size_type capacity, std::string_view function) {
+    using namespace std::literals;
+    if (capacity < 0 || capacity > max_size()) throw std::length_error{ detail::concatene(
+        detail::type_name<vector>(), "::"sv, function, " : the capacity "sv, std::to_string(capacity),
+        " exceeds max_size() = "sv, std::to_string(max_size())
+    )};
+}
+
+template <class T, class Allocator, class Layout, size_t InlineRows, class Growth>
+void vector<T, Allocator, Layout, InlineRows, Growth>::grow(size_type min_capacity) {
+    using namespace std::literals;
+    if (min_capacity <= capacity()) return;
+    check_capacity(min_capacity, "grow"sv);
+    auto const next_capacity = std::min(Growth::next_capacity(capacity(), min_capacity), max_size());
+    reallocate(rounded_capacity(next_capacity), instrumentation::event_kind::grow);
+}
+
+template <class T, class Allocator, class Layout, size_t InlineRows, class Growth>
+size_type vector<T, Allocator, Layout, InlineRows, Growth>::rounded_capacity(size_type capacity) noexcept {
+    if (capacity <= inline_capacity) return capacity;
+    auto const shift = compute_shifts(capacity);
+    auto limits = bytes_type{};
+    // Upper bound of the capacity, reached by the rows without padding.
+    auto max_rows = std::numeric_limits<size_type>::max();
+    auto rounded_bytes = false;
+    for (size_t g = 0; g < groups_count; ++g) {
+        auto const rounded = Growth::round_bytes(static_cast<size_t>(shift.nb_bytes[g]));
+        limits[g] = static_cast<size_type>(std::min<size_t>(rounded, std::numeric_limits<size_type>::max()));
+        max_rows = std::min(max_rows, static_cast<size_type>(std::min<size_t>(
+            static_cast<size_t>(limits[g]) * 8 / group_row_bits[g], std::numeric_limits<size_type>::max())));
+        rounded_bytes = rounded_bytes || limits[g] != shift.nb_bytes[g];
+    }
+    // Without rounding, the capacity stays the requested one.
+    if (!rounded_bytes) return capacity;
+    auto const fits = [&limits] (size_type rows) {
+        auto const candidate = compute_shifts(rows);
+        for (size_t g = 0; g < groups_count; ++g) {
+            if (candidate.nb_bytes[g] > limits[g]) return false;
+        }
+        return true;
+    };
+    // Binary search of the greatest capacity fitting in the rounded allocations.
+    auto min_rows = capacity;
+    while (min_rows < max_rows) {
+        auto const rows = min_rows + (max_rows - min_rows + 1) / 2;
+        if (fits(rows)) min_rows = rows;
+        else max_rows = rows - 1;
+    }
+    return min_rows;
+}
+
+template <class T, class Allocator, class Layout, size_t InlineRows, class Growth>
+template <class F>
+void vector<T, Allocator, Layout, InlineRows, Growth>::append_rows(size_type n, F && fill) {
+    using namespace std::literals;
+    if (n <= 0) return;
+    if (n > max_size() - size()) check_capacity(max_size() + 1, "append_rows"sv);
+    grow(size() + n);
+
+    auto filled = 0;
+    try {
+        detail::for_each_column_indexed(base(), [this, &fill, &filled] (auto & span, auto tag, auto index) {
+            fill(span.data() + size(), tag, index);
+            ++filled;
+        });
+    }
+    catch (...) {
+        detail::for_each_column(base(), [this, n, &filled] (auto & span, auto) {
+            if (filled-- > 0) detail::destroy(span.data() + size(), span.data() + size() + n);
+        });
+        throw;
+    }
+    this->set_size(size() + n);
 }
 
-template <class T, class Allocator>
-void vector<T, Allocator>::construct_copy_array(members<T> const& mem_src, members<T>& mem_dst, int nb) {
-    apply_on_arrays(mem_src, mem_dst, nb, [] (auto src, auto & dst) {
-        using type = decltype(src);
-        new (&dst) type(src);
+template <class T, class Allocator, class Layout, size_t InlineRows, class Growth>
+void vector<T, Allocator, Layout, InlineRows, Growth>::construct_copy_array(members<T> const& mem_src, members<T>& mem_dst, size_type nb) {
+    detail::for_each_column(mem_src, mem_dst, [nb] (auto const& span_src, auto & span_dst, auto) {
+        detail::construct_copy(span_src.data(), span_dst.data(), nb);
+    });
+}
+template <class T, class Allocator, class Layout, size_t InlineRows, class Growth>
+void vector<T, Allocator, Layout, InlineRows, Growth>::construct_move_array(members<T> & mem_src, members<T> & mem_dst, size_type nb) {
+    detail::for_each_column(mem_src, mem_dst, [nb] (auto & span_src, auto & span_dst, auto) {
+        detail::construct_move(span_src.data(), span_dst.data(), nb);
     });
 }
-template <class T, class Allocator>
-void vector<T, Allocator>::construct_move_array(members<T> & mem_src, members<T> & mem_dst, int nb) {
-    apply_on_arrays(mem_src, mem_dst, nb, [] (auto & src, auto & dst) {
-        using type = std::remove_reference_t<decltype(src)>;
-        new (&dst) type(std::move(src));
+template <class T, class Allocator, class Layout, size_t InlineRows, class Growth>
+void vector<T, Allocator, Layout, InlineRows, Growth>::relocate_array(members<T> & mem_src, members<T> & mem_dst, size_type nb, groups_mask const& in_place) {
+    // Copies first the columns which could throw, so no source column is modified before.
+    size_type copied = 0;
+    try {
+        detail::for_each_column(mem_src, mem_dst, [nb, &copied] (auto & span_src, auto & span_dst, auto tag) {
+            using type = typename decltype(tag)::type;
+            if constexpr (detail::relocate_by_copy_v<type>) {
+                detail::construct_copy(std::as_const(span_src).data(), span_dst.data(), nb);
+                ++copied;
+            }
+        });
+    }
+    catch (...) {
+        detail::for_each_column(mem_src, mem_dst, [nb, &copied] (auto &, auto & span_dst, auto tag) {
+            using type = typename decltype(tag)::type;
+            if constexpr (detail::relocate_by_copy_v<type>) {
+                if (copied-- > 0) detail::destroy(span_dst.data(), span_dst.data() + nb);
+            }
+        });
+        throw;
+    }
+    auto index = 0;
+    detail::for_each_column(mem_src, mem_dst, [nb, &in_place, &index] (auto & span_src, auto & span_dst, auto tag) {
+        using type = typename decltype(tag)::type;
+        if constexpr (detail::relocate_by_copy_v<type>) {
+            detail::destroy(span_src.data(), span_src.data() + nb);
+        }
+        else if (!in_place[column_groups[index]]) {
+            detail::relocate(span_src.data(), span_dst.data(), nb);
+        }
+        ++index;
+    });
+    // Columns are shifted forward in expanded allocations, so they are moved from the last to the first.
+    index = components_count;
+    detail::for_each_column_reversed(mem_src, mem_dst, [nb, &in_place, &index] (auto & span_src, auto & span_dst, auto) {
+        if (in_place[column_groups[--index]]) {
+            detail::relocate(span_src.data(), span_dst.data(), nb);
+        }
     });
 }
 
-template <class T, class Allocator>
-template <class F>
-void vector<T, Allocator>::apply_on_arrays(members<T> const& mem_src, members<T> & mem_dst, int nb, F && f) {
-    auto const t1 = detail::as_tuple(mem_src);
-    auto const t2 = detail::as_tuple(mem_dst);
-    detail::for_each(t1, t2, [f, nb] (auto const& span_src, auto & span_dst, auto) {
-        detail::apply_two_arrays(span_src.data(), span_dst.data(), nb, f);
+template <class T, class Allocator, class Layout, size_t InlineRows, class Growth>
+void vector<T, Allocator, Layout, InlineRows, Growth>::reallocate(size_type capacity, instrumentation::event_kind cause) {
+    using namespace std::literals;
+    auto const old_capacity = this->capacity();
+    if constexpr (InlineRows > 0) {
+        // The rows fit inside the object : they are moved back in the inline storage.
+        if (capacity <= inline_capacity) {
+            if (is_inline()) return;
+            auto new_members = create_members(inline_blocks(), inline_shift, sequence_type{});
+            relocate_array(base(), new_members, size());
+            deallocate();
+            base()    = new_members;
+            this->set_size(size());
+            capacity_ = inline_capacity;
+            nb_bytes_ = inline_shift.nb_bytes;
+            notify_rows(cause, old_capacity, size());
+            return;
+        }
+    }
+    if (capacity == 0) {
+        deallocate();
+        to_zero();
+        notify_rows(cause, old_capacity, 0);
+        return;
+    }
+    check_capacity(capacity, "reallocate"sv);
+    auto const shift = compute_shifts(capacity);
+    auto const old_blocks = get_blocks(base(), sequence_type{});
+    auto new_blocks = blocks_type{};
+
+    // Tries to expand the allocations in place, then allocates the other groups.
+    auto in_place = groups_mask{};
+    if (capacity > this->capacity()) {
+        for (size_t g = 0; g < groups_count; ++g) {
+            in_place[g] = expand(g, old_blocks[g], shift.nb_bytes[g]);
+            if (in_place[g]) {
+                new_blocks[g] = old_blocks[g];
+                nb_bytes_[g]  = shift.nb_bytes[g];
+            }
+        }
+    }
+    auto const release_new_blocks = [&] (size_t end) noexcept {
+        for (size_t g = 0; g < end; ++g) {
+            if (!in_place[g]) deallocate(g, new_blocks[g], shift.nb_bytes[g]);
+        }
+    };
+    size_t group = 0;
+    try {
+        for (; group < groups_count; ++group) {
+            if (in_place[group]) continue;
+            new_blocks[group] = allocate(group, shift.nb_bytes[group]);
+        }
+    }
+    catch (...) {
+        release_new_blocks(group);
+        throw;
+    }
+    auto new_members = create_members(new_blocks, shift, sequence_type{});
+    try {
+        relocate_array(base(), new_members, size(), in_place);
+    }
+    catch (...) {
+        release_new_blocks(groups_count);
+        throw;
+    }
+    for (size_t g = 0; g < groups_count; ++g) {
+        if (in_place[g]) continue;
+        deallocate(g, old_blocks[g], nb_bytes_[g]);
+        nb_bytes_[g] = shift.nb_bytes[g];
+    }
+    base()    = new_members;
+    this->set_size(size());
+    capacity_ = capacity;
+    notify_rows(cause, old_capacity, size(), in_place);
+}
+
+template <class T, class Allocator, class Layout, size_t InlineRows, class Growth>
+bool vector<T, Allocator, Layout, InlineRows, Growth>::expand(size_t group, std::byte* block, size_type nb_bytes) noexcept {
+    if constexpr (!detail::has_expand_v<allocator_type>) {
+        return false;
+    }
+    else {
+        constexpr auto relocatable = relocatable_groups(sequence_type{});
+        if (nb_bytes_[group] == 0 || !relocatable[group] || is_inline(block)) return false;
+
+        using unit_type = typename allocator_traits::value_type;
+        auto const data = reinterpret_cast<unit_type*>(block);
+        auto const old_units = static_cast<size_t>(nb_bytes_[group]) / alignment;
+        auto const new_units = static_cast<size_t>(nb_bytes) / alignment;
+        return allocators_[group].expand(data, old_units, new_units);
+    }
+}
+
+template <class T, class Allocator, class Layout, size_t InlineRows, class Growth>
+template <size_t...Is>
+void vector<T, Allocator, Layout, InlineRows, Growth>::push_back_copy(T const& value, std::index_sequence<Is...>) {
+    emplace_back(value.*detail::member_pointer_v<T, Is>...);
+}
+template <class T, class Allocator, class Layout, size_t InlineRows, class Growth>
+template <size_t...Is>
+void vector<T, Allocator, Layout, InlineRows, Growth>::push_back_move(T& value, std::index_sequence<Is...>) {
+    emplace_back(std::move(value.*detail::member_pointer_v<T, Is>)...);
+}
+
+template <class T, class Allocator, class Layout, size_t InlineRows, class Growth>
+template <size_t...Is, size_t...Js, class...Ts>
+void vector<T, Allocator, Layout, InlineRows, Growth>::emplace_back_impl(std::index_sequence<Is...>, std::index_sequence<Js...>, Ts&&...components) {
+    // The columns Is are constructed from the components, and the columns after them are value-initialized.
+    (detail::construct_at(get_span<Is>().data() + size(), std::forward<Ts>(components)), ...);
+    (detail::construct_at(get_span<sizeof...(Is) + Js>().data() + size()), ...);
+}
+
+template <class T, class Allocator, class Layout, size_t InlineRows, class Growth>
+template <size_t...Is>
+members<T> vector<T, Allocator, Layout, InlineRows, Growth>::create_members(blocks_type const& blocks, shift_type const& shift, std::index_sequence<Is...>) {
+    return { (blocks[detail::column_group_v<T, Is>] + std::get<Is>(shift.columns))... };
+}
+
+template <class T, class Allocator, class Layout, size_t InlineRows, class Growth>
+template <size_t...Is>
+typename vector<T, Allocator, Layout, InlineRows, Growth>::blocks_type
+vector<T, Allocator, Layout, InlineRows, Growth>::get_blocks(members<T> const& mem, std::index_sequence<Is...>) noexcept {
+    auto blocks = blocks_type{};
+    auto const set_block = [&blocks] (size_t group, void* ptr) {
+        if (!blocks[group]) blocks[group] = static_cast<std::byte*>(ptr);
+    };
+    (set_block(detail::column_group_v<T, Is>, (mem.*detail::span_pointer_v<T, Is>).ptr_), ...);
+    return blocks;
+}
+
+template <class T, class Allocator, class Layout, size_t InlineRows, class Growth>
+template <size_t...Is>
+constexpr typename vector<T, Allocator, Layout, InlineRows, Growth>::groups_mask
+vector<T, Allocator, Layout, InlineRows, Growth>::relocatable_groups(std::index_sequence<Is...>) noexcept {
+    auto mask = groups_mask{};
+    for (auto& relocatable : mask) relocatable = true;
+    ((mask[detail::column_group_v<T, Is>] = mask[detail::column_group_v<T, Is>] &&
+        is_trivially_relocatable_v<detail::member_type_t<T, Is>>), ...);
+    return mask;
+}
+
+template <class T, class Allocator, class Layout, size_t InlineRows, class Growth>
+typename vector<T, Allocator, Layout, InlineRows, Growth>::alloc_result
+vector<T, Allocator, Layout, InlineRows, Growth>::allocate(size_type nb) {
+    using namespace std::literals;
+    check_capacity(nb, "allocate"sv);
+    auto const shift = compute_shifts(nb);
+    auto blocks = blocks_type{};
+    size_t group = 0;
+    try {
+        for (; group < groups_count; ++group) {
+            blocks[group] = allocate(group, shift.nb_bytes[group]);
+        }
+    }
+    catch (...) {
+        while (group-- > 0) deallocate(group, blocks[group], shift.nb_bytes[group]);
+        throw;
+    }
+    return { create_members(blocks, shift, sequence_type{}), shift.nb_bytes };
+}
+
+template <class T, class Allocator, class Layout, size_t InlineRows, class Growth>
+std::byte* vector<T, Allocator, Layout, InlineRows, Growth>::allocate(size_t group, size_type nb_bytes) {
+    using unit_type = typename allocator_traits::value_type;
+    auto const units = static_cast<size_t>(nb_bytes) / alignment;
+    auto const ptr = allocator_traits::allocate(allocators_[group], units);
+    notify_allocation(instrumentation::event_kind::allocate, group, nb_bytes);
+    return reinterpret_cast<std::byte*>(static_cast<unit_type*>(ptr));
+}
+
+template <class T, class Allocator, class Layout, size_t InlineRows, class Growth>
+void vector<T, Allocator, Layout, InlineRows, Growth>::destroy() noexcept {
+    detail::for_each_column(base(), [] (auto& span, auto) {
+        detail::destroy(span.begin(), span.end());
     });
 }
-template <class T, class Allocator>
-template <class F>
-void vector<T, Allocator>::apply_on_arrays(members<T> & mem_src, members<T> & mem_dst, int nb, F && f) {
-    auto const t1 = detail::as_tuple(mem_src);
-    auto const t2 = detail::as_tuple(mem_dst);
-    detail::for_each(t1, t2, [f, nb] (auto & span_src, auto & span_dst, auto) {
-        detail::apply_two_arrays(span_src.data(), span_dst.data(), nb, f);
+
+template <class T, class Allocator, class Layout, size_t InlineRows, class Growth>
+void vector<T, Allocator, Layout, InlineRows, Growth>::destroy(size_type begin, size_type end) noexcept {
+    detail::for_each_column(base(), [min = begin, max = end] (auto& span, auto) {
+        detail::destroy(span.begin() + min, span.begin() + max);
     });
 }
 
-template <class T, class Allocator>
-template <class Tuple, size_t...Is>
-void vector<T, Allocator>::push_back_copy(Tuple const& tuple, std::index_sequence<Is...>) {
-    emplace_back(std::get<Is>(tuple)...);
+template <class T, class Allocator, class Layout, size_t InlineRows, class Growth>
+void vector<T, Allocator, Layout, InlineRows, Growth>::deallocate() noexcept {
+    auto const blocks = get_blocks(base(), sequence_type{});
+    for (size_t g = 0; g < groups_count; ++g) {
+        deallocate(g, blocks[g], nb_bytes_[g]);
+    }
 }
-template <class T, class Allocator>
-template <class Tuple, size_t...Is>
-void vector<T, Allocator>::push_back_move(Tuple& tuple, std::index_sequence<Is...>) {
-    emplace_back(std::move(std::get<Is>(tuple))...);
+
+template <class T, class Allocator, class Layout, size_t InlineRows, class Growth>
+void vector<T, Allocator, Layout, InlineRows, Growth>::deallocate(size_t group, std::byte* block, size_type nb_bytes) noexcept {
+    if (nb_bytes == 0 || is_inline(block)) return;
+    using unit_type = typename allocator_traits::value_type;
+    auto const data = reinterpret_cast<unit_type*>(block);
+    allocator_traits::deallocate(allocators_[group], data, static_cast<size_t>(nb_bytes) / alignment);
+    notify_allocation(instrumentation::event_kind::deallocate, group, nb_bytes);
 }
 
-template <class T, class Allocator>
-template <size_t I, class...Members, class T1, class...Ts>
-void vector<T, Allocator>::emplace_back_impl(std::tuple<Members&...> const& tuple, T1&& component, Ts&&...nexts) {
-    if constexpr (I < sizeof...(Members)) {
-        using type = typename components_tag::template get<I>;
-        auto const it = std::get<I>(tuple).ptr_ + size();
-        new (it) type(std::forward<T1>(component));
-        emplace_back_impl<I + 1>(tuple, std::forward<Ts>(nexts)...);
+template <class T, class Allocator, class Layout, size_t InlineRows, class Growth>
+void vector<T, Allocator, Layout, InlineRows, Growth>::to_zero() noexcept {
+    base_with_size() = {};
+    if constexpr (InlineRows > 0) {
+        base()    = create_members(inline_blocks(), inline_shift, sequence_type{});
+        capacity_ = inline_capacity;
+        nb_bytes_ = inline_shift.nb_bytes;
+    }
+    else {
+        capacity_ = 0;
+        nb_bytes_ = {};
+    }
+}
+
+template <class T, class Allocator, class Layout, size_t InlineRows, class Growth>
+void vector<T, Allocator, Layout, InlineRows, Growth>::notify_allocation(
+    instrumentation::event_kind kind, size_t group, size_type nb_bytes) const noexcept
+{
+    if constexpr (instrumentation::enabled) {
+        static auto const name = detail::type_name<T>();
+        instrumentation::emit({ kind, name, this, capacity(), capacity(), group, 0,
+            static_cast<size_t>(nb_bytes), nullptr, 0 });
+    }
+}
+
+template <class T, class Allocator, class Layout, size_t InlineRows, class Growth>
+void vector<T, Allocator, Layout, InlineRows, Growth>::notify_rows(
+    instrumentation::event_kind kind, size_type old_capacity, size_type rows, groups_mask const& unmoved) const noexcept
+{
+    if constexpr (instrumentation::enabled) {
+        static auto const name = detail::type_name<T>();
+        auto column_bytes = column_array_bytes(rows, sequence_type{});
+        auto bytes = size_t{ 0 };
+        for (size_t i = 0; i < column_bytes.size(); ++i) {
+            if (unmoved[column_groups[i]]) column_bytes[i] = 0;
+            bytes += column_bytes[i];
+        }
+        instrumentation::emit({ kind, name, this, old_capacity, capacity(), 0, rows,
+            bytes, column_bytes.data(), column_bytes.size() });
     }
 }
-template <class T, class Allocator>
-template <size_t I, class...Members>
-void vector<T, Allocator>::emplace_back_impl(std::tuple<Members&...> const& tuple) {
-    if constexpr (I < sizeof...(Members)) {
-        using type = typename components_tag::template get<I>;
-        auto const it = std::get<I>(tuple).ptr_ + size();
-        new (it) type();
-        emplace_back_impl<I + 1>(tuple);
+
+template <class T, class Allocator, class Layout, size_t InlineRows, class Growth>
+typename vector<T, Allocator, Layout, InlineRows, Growth>::blocks_type
+vector<T, Allocator, Layout, InlineRows, Growth>::inline_blocks() noexcept {
+    auto blocks = blocks_type{};
+    auto data = this->inline_data();
+    for (size_t g = 0; g < groups_count; ++g) {
+        blocks[g] = data;
+        data += inline_shift.nb_bytes[g];
     }
+    return blocks;
 }
 
-template <class T, class Allocator>
-template <size_t I, class...Ints>
-void vector<T, Allocator>::update_shift(std::tuple<Ints...>& tuple, int nb, int shift) {
-    using prev = typename components_tag::template get<I - 1>;
-    if constexpr (I == sizeof...(Ints) - 1) {
-        std::get<I>(tuple) = shift + nb * sizeof(prev);
+template <class T, class Allocator, class Layout, size_t InlineRows, class Growth>
+bool vector<T, Allocator, Layout, InlineRows, Growth>::is_inline(std::byte const* block) const noexcept {
+    if constexpr (InlineRows == 0) {
+        return false;
     }
     else {
-        using type = typename components_tag::template get<I>;
-        constexpr auto align = alignof(type) - 1;
-        shift += (nb * sizeof(prev) + align) & ~align;
-        std::get<I>(tuple) = shift;
-        update_shift<I + 1>(tuple, nb, shift);
+        constexpr auto bytes = detail::inline_bytes<T, Layout, InlineRows>();
+        auto const less = std::less<std::byte const*>{};
+        return !less(block, this->inline_data()) && less(block, this->inline_data() + bytes);
     }
 }
 
-template <class T, class Allocator>
-template <class Tuple, size_t...Is>
-members<T> vector<T, Allocator>::create_members(std::byte* ptr, Tuple const& shift, std::index_sequence<Is...>) {
-    return { (ptr + std::get<Is>(shift))... };
+template <class T, class Allocator, class Layout, size_t InlineRows, class Growth>
+bool vector<T, Allocator, Layout, InlineRows, Growth>::is_inline() const noexcept {
+    return is_inline(get_blocks(base(), sequence_type{})[0]);
 }
 
-template <class T, class Allocator>
-typename vector<T, Allocator>::alloc_result
-vector<T, Allocator>::allocate(int nb) {
-    constexpr int arity = detail::arity_v<members<T>>;
-    auto shift = detail::repeat_tuple_t<int, arity + 1>{};
-    update_shift<1>(shift, nb, 0);
+template <class T, class Allocator, class Layout, size_t InlineRows, class Growth>
+bool vector<T, Allocator, Layout, InlineRows, Growth>::equal_allocators(vector const& rhs) const noexcept {
+    if constexpr (allocator_traits::is_always_equal::value) {
+        return true;
+    }
+    else {
+        for (size_t g = 0; g < groups_count; ++g) {
+            if (!(allocators_[g] == rhs.allocators_[g])) return false;
+        }
+        return true;
+    }
+}
 
-    auto const nb_bytes = std::get<arity>(shift);
-    auto const ptr = allocator_traits::allocate(allocator_, nb_bytes);
-    return { create_members(ptr, shift, sequence_type{}), nb_bytes };
+template <class T, class Allocator, class Layout, size_t InlineRows, class Growth>
+void vector<T, Allocator, Layout, InlineRows, Growth>::steal(vector& rhs) noexcept(nothrow_inline_moves) {
+    if constexpr (InlineRows > 0) {
+        if (rhs.is_inline()) {
+            relocate_array(rhs.base(), base(), rhs.size());
+            this->set_size(rhs.size());
+            rhs.set_size(0);
+            return;
+        }
+    }
+    base_with_size() = rhs.base_with_size();
+    capacity_ = rhs.capacity();
+    nb_bytes_ = rhs.nb_bytes_;
+    rhs.to_zero();
 }
 
-template <class T, class Allocator>
-void vector<T, Allocator>::destroy() noexcept {
-    detail::for_each(detail::as_tuple(base()), [] (auto& span, auto tag) {
-        using type = typename decltype(tag)::type;
-        for (auto& val : span) val.~type();
-    });
+template <class T, class Allocator, class Layout, size_t InlineRows, class Growth>
+void vector<T, Allocator, Layout, InlineRows, Growth>::copy_elements(vector const& rhs) {
+    if (rhs.empty()) return;
+    if (capacity() < rhs.size()) {
+        deallocate();
+        to_zero();
+        auto [new_members, nb_bytes] = allocate(rhs.size());
+        base()    = new_members;
+        nb_bytes_ = nb_bytes;
+        capacity_ = rhs.size();
+    }
+    construct_copy_array(rhs.base(), base(), rhs.size());
+    this->set_size(rhs.size());
 }
 
-template <class T, class Allocator>
-void vector<T, Allocator>::destroy(int begin, int end) noexcept {
-    detail::for_each(detail::as_tuple(base()), [min = begin, max = end] (auto& span, auto tag) {
-        using type = typename decltype(tag)::type;
-        auto it = span.begin() + min;
-        auto const end = span.begin() + max;
-        for (; it < end; ++it) it->~type();
+template <class T, class Allocator, class Layout, size_t InlineRows, class Growth>
+void vector<T, Allocator, Layout, InlineRows, Growth>::move_elements(vector& rhs) {
+    if (rhs.empty()) return;
+    if (capacity() < rhs.size()) {
+        deallocate();
+        to_zero();
+        auto [new_members, nb_bytes] = allocate(rhs.size());
+        base()    = new_members;
+        nb_bytes_ = nb_bytes;
+        capacity_ = rhs.size();
+    }
+    construct_move_array(rhs.base(), base(), rhs.size());
+    this->set_size(rhs.size());
+    rhs.clear();
+}
+
+// Zip views.
+
+namespace detail {
+    // Random access iterator on a subset of columns, which holds a pointer per column.
+    // It is dereferenced to a tuple of references.
+    template <class...Ts>
+    class zip_iterator {
+        template <class...>
+        friend class ::soa::zip_view;
+
+        std::tuple<Ts*...> ptrs_;
+
+        template <size_t...Is>
+        void advance(std::ptrdiff_t shift, std::index_sequence<Is...>) noexcept {
+            ((std::get<Is>(ptrs_) += shift), ...);
+        }
+        template <size_t...Is>
+        auto get(std::ptrdiff_t shift, std::index_sequence<Is...>) const noexcept {
+            return std::tuple<Ts&...>{ std::get<Is>(ptrs_)[shift]... };
+        }
+        using sequence_type = std::index_sequence_for<Ts...>;
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type        = std::tuple<std::remove_const_t<Ts>...>;
+        using reference         = std::tuple<Ts&...>;
+        using pointer           = void;
+        using difference_type   = std::ptrdiff_t;
+
+        zip_iterator() noexcept = default;
+        explicit zip_iterator(Ts*...ptrs) noexcept : ptrs_{ ptrs... } {}
+
+        // Pointers on the current element of each column.
+        std::tuple<Ts*...> const& pointers() const noexcept { return ptrs_; }
+
+        reference operator*() const noexcept { return get(0, sequence_type{}); }
+        reference operator[](difference_type i) const noexcept { return get(i, sequence_type{}); }
+
+        bool operator==(zip_iterator const& rhs) const noexcept { return std::get<0>(ptrs_) == std::get<0>(rhs.ptrs_); }
+        bool operator!=(zip_iterator const& rhs) const noexcept { return !(*this == rhs); }
+
+        bool operator<(zip_iterator const& rhs) const noexcept { return std::get<0>(ptrs_) < std::get<0>(rhs.ptrs_); }
+        bool operator>(zip_iterator const& rhs) const noexcept { return rhs < *this; }
+        bool operator<=(zip_iterator const& rhs) const noexcept { return !(rhs < *this); }
+        bool operator>=(zip_iterator const& rhs) const noexcept { return !(*this < rhs); }
+
+        zip_iterator & operator++() noexcept { advance(1, sequence_type{}); return *this; }
+        zip_iterator & operator--() noexcept { advance(-1, sequence_type{}); return *this; }
+        zip_iterator operator++(int) noexcept { auto const old = *this; ++*this; return old; }
+        zip_iterator operator--(int) noexcept { auto const old = *this; --*this; return old; }
+
+        zip_iterator & operator+=(difference_type shift) noexcept { advance(shift, sequence_type{}); return *this; }
+        zip_iterator & operator-=(difference_type shift) noexcept { advance(-shift, sequence_type{}); return *this; }
+
+        zip_iterator operator+(difference_type shift) const noexcept { auto it = *this; return it += shift; }
+        zip_iterator operator-(difference_type shift) const noexcept { auto it = *this; return it -= shift; }
+        friend zip_iterator operator+(difference_type shift, zip_iterator const& it) noexcept { return it + shift; }
+
+        difference_type operator-(zip_iterator const& rhs) const noexcept {
+            return std::get<0>(ptrs_) - std::get<0>(rhs.ptrs_);
+        }
+    };
+
+    // Returns the data of the column given by a pointer to a member of T.
+    template <size_t I, class Vector, class M, class T, class Pointer>
+    void find_column(Vector & vec, M T::* member, Pointer & result) noexcept {
+        using member_type = member_type_t<T, I>;
+        if constexpr (std::is_same_v<member_type, std::remove_const_t<M>> && !is_packed_column_v<T, I>) {
+            if (members<T>::member_pointer(std::integral_constant<size_t, I>{}) == member) {
+                result = vec.template get_span<I>().data();
+            }
+        }
+    }
+    template <class Vector, class M, class T, size_t...Is>
+    auto column_data(Vector & vec, M T::* member, std::index_sequence<Is...>) noexcept {
+        using pointer = std::conditional_t<std::is_const_v<Vector>, M const*, M*>;
+        auto result = static_cast<pointer>(nullptr);
+        (detail::find_column<Is>(vec, member, result), ...);
+        return result;
+    }
+}
+
+// Range over a subset of the columns of a soa::vector, created with soa::view.
+// The iterators hold a pointer per column, so loops only touch the selected arrays.
+template <class...Ts>
+class zip_view {
+public:
+    using iterator   = detail::zip_iterator<Ts...>;
+    using value_type = typename iterator::value_type;
+    using reference  = typename iterator::reference;
+
+    zip_view(size_type size, Ts*...ptrs) noexcept : begin_{ ptrs... }, size_{ size } {}
+
+    size_type  size()  const noexcept { return size_; }
+    bool empty() const noexcept { return size_ == 0; }
+
+    reference operator[](size_type i) const noexcept { return begin_[i]; }
+
+    iterator begin() const noexcept { return begin_; }
+    iterator end()   const noexcept { return begin_ + size_; }
+private:
+    iterator begin_;
+    size_type size_;
+};
+
+// Creates a zip_view on the columns 'Is...' of the vector.
+template <size_t...Is, class Vector>
+auto view(Vector & vec) noexcept {
+    static_assert((std::is_pointer_v<decltype(vec.template get_span<Is>().data())> && ...),
+        "soa::view doesn't support soa::packed columns");
+    return zip_view<std::remove_pointer_t<decltype(vec.template get_span<Is>().data())>...> {
+        vec.size(), vec.template get_span<Is>().data()...
+    };
+}
+
+// Creates a zip_view on the columns of the given T members, eg. 'soa::view(vec, &T::pos, &T::speed)'.
+// The members must be given to SOA_DEFINE_TYPE, and not be soa::packed.
+template <class Vector, class...Ms, class T = typename std::remove_const_t<Vector>::value_type>
+auto view(Vector & vec, Ms T::*...members) noexcept {
+    using sequence = std::make_index_sequence<std::remove_const_t<Vector>::components_count>;
+    return zip_view<std::remove_pointer_t<decltype(detail::column_data(vec, members, sequence{}))>...> {
+        vec.size(), detail::column_data(vec, members, sequence{})...
+    };
+}
+
+// Removes the rows for which 'pred(row)' is true, where 'row' is a const proxy.
+// The predicate is called once per row to build a keep mask, then each column is compacted in one pass.
+// Returns the number of removed rows.
+template <class Vector, class Pred>
+size_type erase_if(Vector& vec, Pred pred) {
+    auto keep = std::vector<char>(static_cast<size_t>(vec.size()));
+    auto const& cvec = vec;
+    for (size_type i = 0; i < cvec.size(); ++i) keep[i] = !pred(cvec[i]);
+    return vec.compact(keep);
+}
+
+namespace detail {
+    // Scratch buffer reused by the columns permutations, aligned for all the trivially copyable columns.
+    template <class...Ts>
+    class permutation_buffer {
+        static constexpr size_t alignment = std::max({ size_t{ 1 }, (
+            std::is_trivially_copyable_v<Ts> ? alignof(Ts) : size_t{ 1 })... });
+        static constexpr size_t element_size = std::max({ size_t{ 0 }, (
+            std::is_trivially_copyable_v<Ts> ? sizeof(Ts) : size_t{ 0 })... });
+
+        std::vector<aligned_bytes<alignment>> buffer_;
+    public:
+        explicit permutation_buffer(size_type size) :
+            buffer_((static_cast<size_t>(size) * element_size + alignment - 1) / alignment) {}
+
+        template <class T>
+        T* data() noexcept { return reinterpret_cast<T*>(buffer_.data()); }
+    };
+
+    // Reorders column so the new element i is the old element order[i].
+    // Trivially copyable columns are gathered in the scratch buffer then copied back,
+    // the others are moved in place by following the permutation cycles.
+    template <class T, class Index, class Buffer>
+    void permute_column(T* column, Index const* order, size_type size, Buffer& buffer, std::vector<bool>& visited) {
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            auto const scratch = buffer.template data<T>();
+            for (size_type i = 0; i < size; ++i) scratch[i] = column[order[i]];
+            if (size > 0) std::memcpy(static_cast<void*>(column), static_cast<void const*>(scratch), size * sizeof(T));
+        }
+        else {
+            visited.assign(static_cast<size_t>(size), false);
+            for (size_type start = 0; start < size; ++start) {
+                if (visited[start] || order[start] == start) continue;
+                auto tmp = std::move(column[start]);
+                for (size_type i = start;;) {
+                    visited[i] = true;
+                    auto const next = order[i];
+                    if (next == start) {
+                        column[i] = std::move(tmp);
+                        break;
+                    }
+                    column[i] = std::move(column[next]);
+                    i = next;
+                }
+            }
+        }
+    }
+
+    // Packed columns are gathered in the scratch buffer as values.
+    template <class T, size_t Bits, class Index, class Buffer>
+    void permute_column(packed_pointer<T, Bits, false> column, Index const* order, size_type size, Buffer& buffer, std::vector<bool>&) {
+        auto const scratch = buffer.template data<T>();
+        for (size_type i = 0; i < size; ++i) scratch[i] = column[order[i]];
+        std::copy_n(scratch, size, column);
+    }
+
+    template <class Vector, class Index, size_t...Is>
+    void permute(Vector& vec, Index const* order, std::index_sequence<Is...>) {
+        using buffer_type = permutation_buffer<typename std::remove_reference_t<
+            decltype(vec.template get_span<Is>())>::value_type...>;
+        auto buffer = buffer_type{ vec.size() };
+        auto visited = std::vector<bool>{};
+        (permute_column(vec.template get_span<Is>().data(), order, vec.size(), buffer, visited), ...);
+    }
+
+    // Sorts the indices of the rows by their key. Trivially copyable keys are sorted
+    // with their index, so the comparisons don't access the key column randomly.
+    template <size_t I, class Vector, class Compare, class Sort>
+    void sort_by(Vector& vec, Compare& cmp, Sort&& sort) {
+        auto const keys = vec.template get_span<I>().data();
+        auto const size = static_cast<size_t>(vec.size());
+        auto order = std::vector<size_type>(size);
+
+        using key_type = typename std::iterator_traits<std::remove_const_t<decltype(keys)>>::value_type;
+        if constexpr (std::is_trivially_copyable_v<key_type>) {
+            auto pairs = std::vector<std::pair<key_type, size_type>>(size);
+            for (size_t i = 0; i < size; ++i) pairs[i] = { keys[i], static_cast<size_type>(i) };
+            sort(pairs.begin(), pairs.end(), [&cmp] (auto const& lhs, auto const& rhs) {
+                return cmp(lhs.first, rhs.first);
+            });
+            for (size_t i = 0; i < size; ++i) order[i] = pairs[i].second;
+        }
+        else {
+            std::iota(order.begin(), order.end(), 0);
+            sort(order.begin(), order.end(), [keys, &cmp] (size_type lhs, size_type rhs) {
+                return cmp(keys[lhs], keys[rhs]);
+            });
+        }
+        detail::permute(vec, order.data(), std::make_index_sequence<Vector::components_count>{});
+    }
+
+    // Calls f(std::integral_constant<size_t, I>) where I is the column of the given T member.
+    template <class M, class T, class F, size_t...Is>
+    void dispatch_column(M T::* member, std::index_sequence<Is...>, F&& f) {
+        auto const call = [member, &f] (auto index) {
+            if constexpr (std::is_same_v<member_type_t<T, decltype(index)::value>, std::remove_const_t<M>>) {
+                if (members<T>::member_pointer(index) == member) f(index);
+            }
+        };
+        (call(std::integral_constant<size_t, Is>{}), ...);
+    }
+
+    // Copies the given members between the columns of 'vec' and the random access range of aggregates 'rows',
+    // from the aggregates to the columns or the opposite. The rows are transposed by blocks which stay in the cache,
+    // with a loop per member which the compiler vectorizes for small trivially copyable members.
+    template <bool ToColumns, class Vector, class RandomIt, class...Ms, class T>
+    void transpose_members(Vector& vec, RandomIt rows, Ms T::*...pointers) {
+        using sequence = std::make_index_sequence<std::remove_const_t<Vector>::components_count>;
+        constexpr auto block_rows = transpose_block_rows<T>;
+        auto const n = vec.size();
+        for (size_type first = 0; first < n; first += block_rows) {
+            auto const last = std::min(n, first + block_rows);
+            (detail::dispatch_column(pointers, sequence{}, [&vec, rows, first, last] (auto index) {
+                constexpr auto I = decltype(index)::value;
+                constexpr auto member = members<T>::member_pointer(std::integral_constant<size_t, I>{});
+                auto const column = vec.template get_span<I>().data();
+                for (auto i = first; i < last; ++i) {
+                    if constexpr (ToColumns) column[i] = rows[i].*member;
+                    else rows[i].*member = column[i];
+                }
+            }), ...);
+        }
+    }
+    template <bool ToColumns, class Vector, class RandomIt, size_t...Is>
+    void transpose_columns(Vector& vec, RandomIt rows, std::index_sequence<Is...>) {
+        using T = typename std::remove_const_t<Vector>::value_type;
+        detail::transpose_members<ToColumns>(vec, rows, members<T>::member_pointer(std::integral_constant<size_t, Is>{})...);
+    }
+}
+
+// Reorders the rows of the vector so the new row i is the old row order[i].
+// 'order' is a contiguous range of integers, which must be a permutation of [0, vec.size()).
+// Each column is permuted in turn, so each pass streams through one array.
+template <class Vector, class Order>
+void permute(Vector& vec, Order const& order) {
+    if (static_cast<size_type>(std::size(order)) != vec.size()) {
+        using namespace std::literals;
+        throw std::invalid_argument{ detail::concatene(
+            "Permutation of a different size given to soa::permute<"sv, detail::type_name<Vector>(), ">"sv
+        )};
+    }
+    detail::permute(vec, std::data(order), std::make_index_sequence<Vector::components_count>{});
+}
+
+// Sorts the rows by the column I : an index array is sorted from the keys only,
+// then the permutation is applied to each column. Moves of throwing columns give the basic guarantee.
+template <size_t I, class Vector, class Compare = std::less<>>
+void sort_by(Vector& vec, Compare cmp = {}) {
+    detail::sort_by<I>(vec, cmp, [] (auto first, auto last, auto compare) { std::sort(first, last, compare); });
+}
+
+// Same as sort_by, but the rows with equivalent keys keep their order.
+template <size_t I, class Vector, class Compare = std::less<>>
+void stable_sort_by(Vector& vec, Compare cmp = {}) {
+    detail::sort_by<I>(vec, cmp, [] (auto first, auto last, auto compare) { std::stable_sort(first, last, compare); });
+}
+
+// Overloads taking the key member, eg. 'soa::sort_by(vec, &T::timestamp)'.
+template <class Vector, class M, class T, class Compare = std::less<>>
+void sort_by(Vector& vec, M T::* member, Compare cmp = {}) {
+    using sequence = std::make_index_sequence<Vector::components_count>;
+    detail::dispatch_column(member, sequence{}, [&vec, &cmp] (auto index) {
+        soa::sort_by<decltype(index)::value>(vec, cmp);
+    });
+}
+template <class Vector, class M, class T, class Compare = std::less<>>
+void stable_sort_by(Vector& vec, M T::* member, Compare cmp = {}) {
+    using sequence = std::make_index_sequence<Vector::components_count>;
+    detail::dispatch_column(member, sequence{}, [&vec, &cmp] (auto index) {
+        soa::stable_sort_by<decltype(index)::value>(vec, cmp);
     });
 }
 
-template <class T, class Allocator>
-void vector<T, Allocator>::deallocate() noexcept {
-    if (capacity() == 0) return;
-    auto const data = reinterpret_cast<std::byte*>(get_span<0>().ptr_);
-    allocator_traits::deallocate(allocator_, data, nb_bytes_);
+// Conversions with arrays of aggregates (AoS), eg. a std::vector<T> given to code which doesn't use columns.
+
+// Creates a soa::vector from a range of aggregates, with one allocation.
+// The aggregates of contiguous ranges are transposed by blocks which stay in the cache (see soa::vector::append).
+template <class Range>
+auto from_aos(Range const& rows) {
+    using value_type = std::remove_cv_t<std::remove_reference_t<decltype(*std::begin(rows))>>;
+    auto vec = vector<value_type>{};
+    vec.append(std::begin(rows), std::end(rows));
+    return vec;
 }
 
-template <class T, class Allocator>
-void vector<T, Allocator>::to_zero() noexcept {
-    base_with_size() = {};
-    capacity_ = 0;
-    nb_bytes_ = 0;
+// Copies the given members of the aggregates to the columns of the existing rows of 'vec', which must have
+// the same size as 'rows' (eg. 'soa::from_aos(particles, vec, &particle::pos, &particle::id)').
+// The other columns are unchanged.
+template <class Range, class Vector, class M, class T, class...Ms>
+void from_aos(Range const& rows, Vector& vec, M T::* member, Ms T::*...others) {
+    if (static_cast<size_type>(std::size(rows)) != vec.size()) {
+        using namespace std::literals;
+        throw std::invalid_argument{ detail::concatene(
+            "Range of a different size given to soa::from_aos<"sv, detail::type_name<Vector>(), ">"sv
+        )};
+    }
+    detail::transpose_members<true>(vec, std::begin(rows), member, others...);
+}
+
+// Writes the rows of 'vec' as aggregates from 'out', and returns the end of the written range.
+// If 'out' is a random access iterator on T, it must point to vec.size() existing aggregates
+// (eg. the begin of a resized std::vector<T>) : they are assigned by blocks which stay in the cache.
+// Otherwise (eg. with std::back_inserter), the rows are converted to T one by one.
+template <class Vector, class OutputIt>
+OutputIt to_aos(Vector const& vec, OutputIt out) {
+    using T = typename Vector::value_type;
+    using traits = std::iterator_traits<OutputIt>;
+    if constexpr (std::is_base_of_v<std::random_access_iterator_tag, typename traits::iterator_category> &&
+        std::is_same_v<typename traits::reference, T&>)
+    {
+        detail::transpose_columns<false>(vec, out, std::make_index_sequence<Vector::components_count>{});
+        return out + vec.size();
+    }
+    else {
+        for (auto const row : vec) *out++ = static_cast<T>(row);
+        return out;
+    }
+}
+
+// Copies the given columns of 'vec' to the members of the existing aggregates of the random access range
+// starting at 'out', and returns the end of the range (eg. 'soa::to_aos(vec, particles.begin(), &particle::pos)').
+// The other members of the aggregates are unchanged.
+template <class Vector, class RandomIt, class M, class T, class...Ms>
+RandomIt to_aos(Vector const& vec, RandomIt out, M T::* member, Ms T::*...others) {
+    detail::transpose_members<false>(vec, out, member, others...);
+    return out + vec.size();
+}
+
+// Fixed-size arrays.
+
+// Stores N rows of the aggregate T as one std::array per member, accessed by name (eg. 'table.age[i]').
+// It's an aggregate initialized column by column, or from rows with soa::to_array.
+// The loops on a column have a compile-time trip count.
+template <class T, size_t N>
+struct array : array_members<T, N> {
+    static_assert(is_defined_v<T> && !std::is_empty_v<array_members<T, N>>,
+        "soa::array<T, N> can't be instancied because the required types haven't been defined. "
+        "Did you forget to call the macro SOA_DEFINE_TYPE(T, members...) ?");
+    // The proxies of packed columns refer to bits, while the array columns are std::arrays.
+    static_assert(!detail::has_packed_columns_v<T>, "soa::array doesn't support soa::packed columns");
+
+    using value_type           = T;
+    using reference_type       = ref_proxy<T>;
+    using const_reference_type = cref_proxy<T>;
+
+    using iterator       = detail::proxy_iterator<array, false>;
+    using const_iterator = detail::proxy_iterator<array, true>;
+
+    // The number of T members.
+    static constexpr int components_count = detail::arity_v<members<T>>;
+
+    // Informations.
+    static constexpr size_type  size()  noexcept { return static_cast<size_type>(N); }
+    static constexpr bool empty() noexcept { return N == 0; }
+
+    // Accessors.
+    constexpr reference_type       operator[](size_type i)       noexcept { return make_proxy(*this, i, sequence_type{}); }
+    constexpr const_reference_type operator[](size_type i) const noexcept { return make_proxy(*this, i, sequence_type{}); }
+    reference_type       at(size_type i)       { check_at(i); return (*this)[i]; }
+    const_reference_type at(size_type i) const { check_at(i); return (*this)[i]; }
+
+    // Iterators.
+    iterator       begin()        noexcept { return { this, 0 }; }
+    const_iterator begin()  const noexcept { return { this, 0 }; }
+    const_iterator cbegin() const noexcept { return begin(); }
+    iterator       end()        noexcept { return { this, size() }; }
+    const_iterator end()  const noexcept { return { this, size() }; }
+    const_iterator cend() const noexcept { return end(); }
+
+    // Components accessors.
+    template <size_t I>
+    constexpr auto & get_span() noexcept {
+        return this->*array_members<T, N>::column_pointer(std::integral_constant<size_t, I>{});
+    }
+    template <size_t I>
+    constexpr auto const & get_span() const noexcept {
+        return this->*array_members<T, N>::column_pointer(std::integral_constant<size_t, I>{});
+    }
+private:
+    friend iterator;
+    friend const_iterator;
+
+    using sequence_type = std::make_index_sequence<components_count>;
+
+    template <class Array, size_t...Is>
+    static constexpr auto make_proxy(Array& self, size_type i, std::index_sequence<Is...>) noexcept {
+        using proxy = std::conditional_t<std::is_const_v<Array>, const_reference_type, reference_type>;
+        return proxy{ self.template get_span<Is>()[static_cast<size_t>(i)]... };
+    }
+
+    void check_at(size_type i) const {
+        if (i < 0 || i >= size()) detail::throw_out_of_range<array>(i, size());
+    }
+};
+
+namespace detail {
+    // Column I of the given rows.
+    template <size_t I, class T, size_t N, size_t...Js>
+    constexpr auto array_column(T const (&rows)[N], std::index_sequence<Js...>) {
+        constexpr auto member = members<T>::member_pointer(std::integral_constant<size_t, I>{});
+        return std::array<member_type_t<T, I>, N>{{ (rows[Js].*member)... }};
+    }
+    template <class T, size_t N, size_t...Is>
+    constexpr array<T, N> to_array(T const (&rows)[N], std::index_sequence<Is...>) {
+        return { { detail::array_column<Is>(rows, std::make_index_sequence<N>{})... } };
+    }
+}
+
+// Creates a soa::array from rows, eg. 'constexpr auto table = soa::to_array<user::item>({ {...}, {...} })'.
+template <class T, size_t N>
+constexpr array<T, N> to_array(T const (&rows)[N]) {
+    return detail::to_array(rows, std::make_index_sequence<detail::arity_v<members<T>>>{});
 }
 
 } // namespace soa
 
 // Private macros.
 
-#define SOA_PP_EMPTY
 #define SOA_PP_EMPTY_ARGS(...)
 
+// SOA_PP_APPLY(m, (args...)) expands 'm (args...)', with an extra scan for MSVC
+// which would otherwise pass __VA_ARGS__ as a single argument.
 #define SOA_PP_EVAL0(...) __VA_ARGS__
-#define SOA_PP_EVAL1(...) SOA_PP_EVAL0 (SOA_PP_EVAL0 (SOA_PP_EVAL0 (__VA_ARGS__)))
-#define SOA_PP_EVAL2(...) SOA_PP_EVAL1 (SOA_PP_EVAL1 (SOA_PP_EVAL1 (__VA_ARGS__)))
-#define SOA_PP_EVAL3(...) SOA_PP_EVAL2 (SOA_PP_EVAL2 (SOA_PP_EVAL2 (__VA_ARGS__)))
-#define SOA_PP_EVAL4(...) SOA_PP_EVAL3 (SOA_PP_EVAL3 (SOA_PP_EVAL3 (__VA_ARGS__)))
-#define SOA_PP_EVAL(...)  SOA_PP_EVAL4 (SOA_PP_EVAL4 (SOA_PP_EVAL4 (__VA_ARGS__)))
-
-#define SOA_PP_MAP_GET_END() 0, SOA_PP_EMPTY_ARGS
+#if defined(_MSC_VER)
+#define SOA_PP_APPLY(m, args) SOA_PP_EVAL0(m args)
+#else
+#define SOA_PP_APPLY(m, args) m args
+#endif
 
-#define SOA_PP_MAP_NEXT0(item, next, ...) next SOA_PP_EMPTY
+// SOA_PP_COUNT(...) expands to the number of arguments, from 1 to 254.
+#define SOA_PP_COUNT_N( \
+    _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, \
+    _22, _23, _24, _25, _26, _27, _28, _29, _30, _31, _32, _33, _34, _35, _36, _37, _38, _39, _40, \
+    _41, _42, _43, _44, _45, _46, _47, _48, _49, _50, _51, _52, _53, _54, _55, _56, _57, _58, _59, \
+    _60, _61, _62, _63, _64, _65, _66, _67, _68, _69, _70, _71, _72, _73, _74, _75, _76, _77, _78, \
+    _79, _80, _81, _82, _83, _84, _85, _86, _87, _88, _89, _90, _91, _92, _93, _94, _95, _96, _97, \
+    _98, _99, _100, _101, _102, _103, _104, _105, _106, _107, _108, _109, _110, _111, _112, _113, \
+    _114, _115, _116, _117, _118, _119, _120, _121, _122, _123, _124, _125, _126, _127, _128, _129, \
+    _130, _131, _132, _133, _134, _135, _136, _137, _138, _139, _140, _141, _142, _143, _144, _145, \
+    _146, _147, _148, _149, _150, _151, _152, _153, _154, _155, _156, _157, _158, _159, _160, _161, \
+    _162, _163, _164, _165, _166, _167, _168, _169, _170, _171, _172, _173, _174, _175, _176, _177, \
+    _178, _179, _180, _181, _182, _183, _184, _185, _186, _187, _188, _189, _190, _191, _192, _193, \
+    _194, _195, _196, _197, _198, _199, _200, _201, _202, _203, _204, _205, _206, _207, _208, _209, \
+    _210, _211, _212, _213, _214, _215, _216, _217, _218, _219, _220, _221, _222, _223, _224, _225, \
+    _226, _227, _228, _229, _230, _231, _232, _233, _234, _235, _236, _237, _238, _239, _240, _241, \
+    _242, _243, _244, _245, _246, _247, _248, _249, _250, _251, _252, _253, _254, n, ...) n
+#define SOA_PP_COUNT(...) SOA_PP_APPLY(SOA_PP_COUNT_N, (__VA_ARGS__, SOA_PP_COUNT_TABLE))
+#define SOA_PP_COUNT_TABLE \
+    254, 253, 252, 251, 250, 249, 248, 247, 246, 245, 244, 243, 242, 241, 240, 239, 238, 237, 236, \
+    235, 234, 233, 232, 231, 230, 229, 228, 227, 226, 225, 224, 223, 222, 221, 220, 219, 218, 217, \
+    216, 215, 214, 213, 212, 211, 210, 209, 208, 207, 206, 205, 204, 203, 202, 201, 200, 199, 198, \
+    197, 196, 195, 194, 193, 192, 191, 190, 189, 188, 187, 186, 185, 184, 183, 182, 181, 180, 179, \
+    178, 177, 176, 175, 174, 173, 172, 171, 170, 169, 168, 167, 166, 165, 164, 163, 162, 161, 160, \
+    159, 158, 157, 156, 155, 154, 153, 152, 151, 150, 149, 148, 147, 146, 145, 144, 143, 142, 141, \
+    140, 139, 138, 137, 136, 135, 134, 133, 132, 131, 130, 129, 128, 127, 126, 125, 124, 123, 122, \
+    121, 120, 119, 118, 117, 116, 115, 114, 113, 112, 111, 110, 109, 108, 107, 106, 105, 104, 103, \
+    102, 101, 100, 99, 98, 97, 96, 95, 94, 93, 92, 91, 90, 89, 88, 87, 86, 85, 84, 83, 82, 81, 80, \
+    79, 78, 77, 76, 75, 74, 73, 72, 71, 70, 69, 68, 67, 66, 65, 64, 63, 62, 61, 60, 59, 58, 57, 56, \
+    55, 54, 53, 52, 51, 50, 49, 48, 47, 46, 45, 44, 43, 42, 41, 40, 39, 38, 37, 36, 35, 34, 33, 32, \
+    31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, \
+    6, 5, 4, 3, 2, 1
+
+#define SOA_PP_CAT(a, ...) SOA_PP_CAT_I(a, __VA_ARGS__)
+#define SOA_PP_CAT_I(a, ...) a ## __VA_ARGS__
+
+#define SOA_PP_FIRST(x, ...) x
+#define SOA_PP_REST(x, ...) __VA_ARGS__
+
+#define SOA_PP_STRING(x) SOA_PP_STRING_I(x)
+#define SOA_PP_STRING_I(x) #x
+
+// SOA_PP_IS_PAREN(x) expands to 1 if x is parenthesized, to 0 otherwise.
+#define SOA_PP_PROBE(...) ~, 1,
+#define SOA_PP_CHECK_N(x, n, ...) n
 #if defined(_MSC_VER)
-#define SOA_PP_MAP_NEXT1(item, next) SOA_PP_EVAL0(SOA_PP_MAP_NEXT0 (item, next, 0))
+#define SOA_PP_CHECK(...) SOA_PP_EVAL0(SOA_PP_CHECK_N (__VA_ARGS__, 0, ))
 #else
-#define SOA_PP_MAP_NEXT1(item, next) SOA_PP_MAP_NEXT0 (item, next, 0)
+#define SOA_PP_CHECK(...) SOA_PP_CHECK_N (__VA_ARGS__, 0, )
 #endif
-#define SOA_PP_MAP_NEXT(item, next)  SOA_PP_MAP_NEXT1 (SOA_PP_MAP_GET_END item, next)
+#define SOA_PP_IS_PAREN(x) SOA_PP_CHECK (SOA_PP_PROBE x)
+
+#define SOA_PP_IIF(c) SOA_PP_CAT (SOA_PP_IIF_, c)
+#define SOA_PP_IIF_0(t, f) f
+#define SOA_PP_IIF_1(t, f) t
+
+// SOA_PP_MAP(f, t, items...) expands to 'f(0, t, item0) f(1, t, item1) ...'. Each item is expanded once,
+// by the map of the items count, and the indices are literals given by SOA_PP_INC.
+#define SOA_PP_MAP(f, t, ...) SOA_PP_APPLY(SOA_PP_CAT (SOA_PP_MAP_, SOA_PP_COUNT (__VA_ARGS__)), (f, 0, t, __VA_ARGS__))
+
+#define SOA_PP_INC(n) SOA_PP_CAT (SOA_PP_INC_, n)
+#define SOA_PP_INC_0 1
+#define SOA_PP_INC_1 2
+#define SOA_PP_INC_2 3
+#define SOA_PP_INC_3 4
+#define SOA_PP_INC_4 5
+#define SOA_PP_INC_5 6
+#define SOA_PP_INC_6 7
+#define SOA_PP_INC_7 8
+#define SOA_PP_INC_8 9
+#define SOA_PP_INC_9 10
+#define SOA_PP_INC_10 11
+#define SOA_PP_INC_11 12
+#define SOA_PP_INC_12 13
+#define SOA_PP_INC_13 14
+#define SOA_PP_INC_14 15
+#define SOA_PP_INC_15 16
+#define SOA_PP_INC_16 17
+#define SOA_PP_INC_17 18
+#define SOA_PP_INC_18 19
+#define SOA_PP_INC_19 20
+#define SOA_PP_INC_20 21
+#define SOA_PP_INC_21 22
+#define SOA_PP_INC_22 23
+#define SOA_PP_INC_23 24
+#define SOA_PP_INC_24 25
+#define SOA_PP_INC_25 26
+#define SOA_PP_INC_26 27
+#define SOA_PP_INC_27 28
+#define SOA_PP_INC_28 29
+#define SOA_PP_INC_29 30
+#define SOA_PP_INC_30 31
+#define SOA_PP_INC_31 32
+#define SOA_PP_INC_32 33
+#define SOA_PP_INC_33 34
+#define SOA_PP_INC_34 35
+#define SOA_PP_INC_35 36
+#define SOA_PP_INC_36 37
+#define SOA_PP_INC_37 38
+#define SOA_PP_INC_38 39
+#define SOA_PP_INC_39 40
+#define SOA_PP_INC_40 41
+#define SOA_PP_INC_41 42
+#define SOA_PP_INC_42 43
+#define SOA_PP_INC_43 44
+#define SOA_PP_INC_44 45
+#define SOA_PP_INC_45 46
+#define SOA_PP_INC_46 47
+#define SOA_PP_INC_47 48
+#define SOA_PP_INC_48 49
+#define SOA_PP_INC_49 50
+#define SOA_PP_INC_50 51
+#define SOA_PP_INC_51 52
+#define SOA_PP_INC_52 53
+#define SOA_PP_INC_53 54
+#define SOA_PP_INC_54 55
+#define SOA_PP_INC_55 56
+#define SOA_PP_INC_56 57
+#define SOA_PP_INC_57 58
+#define SOA_PP_INC_58 59
+#define SOA_PP_INC_59 60
+#define SOA_PP_INC_60 61
+#define SOA_PP_INC_61 62
+#define SOA_PP_INC_62 63
+#define SOA_PP_INC_63 64
+#define SOA_PP_INC_64 65
+#define SOA_PP_INC_65 66
+#define SOA_PP_INC_66 67
+#define SOA_PP_INC_67 68
+#define SOA_PP_INC_68 69
+#define SOA_PP_INC_69 70
+#define SOA_PP_INC_70 71
+#define SOA_PP_INC_71 72
+#define SOA_PP_INC_72 73
+#define SOA_PP_INC_73 74
+#define SOA_PP_INC_74 75
+#define SOA_PP_INC_75 76
+#define SOA_PP_INC_76 77
+#define SOA_PP_INC_77 78
+#define SOA_PP_INC_78 79
+#define SOA_PP_INC_79 80
+#define SOA_PP_INC_80 81
+#define SOA_PP_INC_81 82
+#define SOA_PP_INC_82 83
+#define SOA_PP_INC_83 84
+#define SOA_PP_INC_84 85
+#define SOA_PP_INC_85 86
+#define SOA_PP_INC_86 87
+#define SOA_PP_INC_87 88
+#define SOA_PP_INC_88 89
+#define SOA_PP_INC_89 90
+#define SOA_PP_INC_90 91
+#define SOA_PP_INC_91 92
+#define SOA_PP_INC_92 93
+#define SOA_PP_INC_93 94
+#define SOA_PP_INC_94 95
+#define SOA_PP_INC_95 96
+#define SOA_PP_INC_96 97
+#define SOA_PP_INC_97 98
+#define SOA_PP_INC_98 99
+#define SOA_PP_INC_99 100
+#define SOA_PP_INC_100 101
+#define SOA_PP_INC_101 102
+#define SOA_PP_INC_102 103
+#define SOA_PP_INC_103 104
+#define SOA_PP_INC_104 105
+#define SOA_PP_INC_105 106
+#define SOA_PP_INC_106 107
+#define SOA_PP_INC_107 108
+#define SOA_PP_INC_108 109
+#define SOA_PP_INC_109 110
+#define SOA_PP_INC_110 111
+#define SOA_PP_INC_111 112
+#define SOA_PP_INC_112 113
+#define SOA_PP_INC_113 114
+#define SOA_PP_INC_114 115
+#define SOA_PP_INC_115 116
+#define SOA_PP_INC_116 117
+#define SOA_PP_INC_117 118
+#define SOA_PP_INC_118 119
+#define SOA_PP_INC_119 120
+#define SOA_PP_INC_120 121
+#define SOA_PP_INC_121 122
+#define SOA_PP_INC_122 123
+#define SOA_PP_INC_123 124
+#define SOA_PP_INC_124 125
+#define SOA_PP_INC_125 126
+#define SOA_PP_INC_126 127
+#define SOA_PP_INC_127 128
+#define SOA_PP_INC_128 129
+#define SOA_PP_INC_129 130
+#define SOA_PP_INC_130 131
+#define SOA_PP_INC_131 132
+#define SOA_PP_INC_132 133
+#define SOA_PP_INC_133 134
+#define SOA_PP_INC_134 135
+#define SOA_PP_INC_135 136
+#define SOA_PP_INC_136 137
+#define SOA_PP_INC_137 138
+#define SOA_PP_INC_138 139
+#define SOA_PP_INC_139 140
+#define SOA_PP_INC_140 141
+#define SOA_PP_INC_141 142
+#define SOA_PP_INC_142 143
+#define SOA_PP_INC_143 144
+#define SOA_PP_INC_144 145
+#define SOA_PP_INC_145 146
+#define SOA_PP_INC_146 147
+#define SOA_PP_INC_147 148
+#define SOA_PP_INC_148 149
+#define SOA_PP_INC_149 150
+#define SOA_PP_INC_150 151
+#define SOA_PP_INC_151 152
+#define SOA_PP_INC_152 153
+#define SOA_PP_INC_153 154
+#define SOA_PP_INC_154 155
+#define SOA_PP_INC_155 156
+#define SOA_PP_INC_156 157
+#define SOA_PP_INC_157 158
+#define SOA_PP_INC_158 159
+#define SOA_PP_INC_159 160
+#define SOA_PP_INC_160 161
+#define SOA_PP_INC_161 162
+#define SOA_PP_INC_162 163
+#define SOA_PP_INC_163 164
+#define SOA_PP_INC_164 165
+#define SOA_PP_INC_165 166
+#define SOA_PP_INC_166 167
+#define SOA_PP_INC_167 168
+#define SOA_PP_INC_168 169
+#define SOA_PP_INC_169 170
+#define SOA_PP_INC_170 171
+#define SOA_PP_INC_171 172
+#define SOA_PP_INC_172 173
+#define SOA_PP_INC_173 174
+#define SOA_PP_INC_174 175
+#define SOA_PP_INC_175 176
+#define SOA_PP_INC_176 177
+#define SOA_PP_INC_177 178
+#define SOA_PP_INC_178 179
+#define SOA_PP_INC_179 180
+#define SOA_PP_INC_180 181
+#define SOA_PP_INC_181 182
+#define SOA_PP_INC_182 183
+#define SOA_PP_INC_183 184
+#define SOA_PP_INC_184 185
+#define SOA_PP_INC_185 186
+#define SOA_PP_INC_186 187
+#define SOA_PP_INC_187 188
+#define SOA_PP_INC_188 189
+#define SOA_PP_INC_189 190
+#define SOA_PP_INC_190 191
+#define SOA_PP_INC_191 192
+#define SOA_PP_INC_192 193
+#define SOA_PP_INC_193 194
+#define SOA_PP_INC_194 195
+#define SOA_PP_INC_195 196
+#define SOA_PP_INC_196 197
+#define SOA_PP_INC_197 198
+#define SOA_PP_INC_198 199
+#define SOA_PP_INC_199 200
+#define SOA_PP_INC_200 201
+#define SOA_PP_INC_201 202
+#define SOA_PP_INC_202 203
+#define SOA_PP_INC_203 204
+#define SOA_PP_INC_204 205
+#define SOA_PP_INC_205 206
+#define SOA_PP_INC_206 207
+#define SOA_PP_INC_207 208
+#define SOA_PP_INC_208 209
+#define SOA_PP_INC_209 210
+#define SOA_PP_INC_210 211
+#define SOA_PP_INC_211 212
+#define SOA_PP_INC_212 213
+#define SOA_PP_INC_213 214
+#define SOA_PP_INC_214 215
+#define SOA_PP_INC_215 216
+#define SOA_PP_INC_216 217
+#define SOA_PP_INC_217 218
+#define SOA_PP_INC_218 219
+#define SOA_PP_INC_219 220
+#define SOA_PP_INC_220 221
+#define SOA_PP_INC_221 222
+#define SOA_PP_INC_222 223
+#define SOA_PP_INC_223 224
+#define SOA_PP_INC_224 225
+#define SOA_PP_INC_225 226
+#define SOA_PP_INC_226 227
+#define SOA_PP_INC_227 228
+#define SOA_PP_INC_228 229
+#define SOA_PP_INC_229 230
+#define SOA_PP_INC_230 231
+#define SOA_PP_INC_231 232
+#define SOA_PP_INC_232 233
+#define SOA_PP_INC_233 234
+#define SOA_PP_INC_234 235
+#define SOA_PP_INC_235 236
+#define SOA_PP_INC_236 237
+#define SOA_PP_INC_237 238
+#define SOA_PP_INC_238 239
+#define SOA_PP_INC_239 240
+#define SOA_PP_INC_240 241
+#define SOA_PP_INC_241 242
+#define SOA_PP_INC_242 243
+#define SOA_PP_INC_243 244
+#define SOA_PP_INC_244 245
+#define SOA_PP_INC_245 246
+#define SOA_PP_INC_246 247
+#define SOA_PP_INC_247 248
+#define SOA_PP_INC_248 249
+#define SOA_PP_INC_249 250
+#define SOA_PP_INC_250 251
+#define SOA_PP_INC_251 252
+#define SOA_PP_INC_252 253
+#define SOA_PP_INC_253 254
+
+#define SOA_PP_MAP_1(f, n, t, x) f(n, t, x)
+#define SOA_PP_MAP_2(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_1 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_3(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_2 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_4(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_3 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_5(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_4 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_6(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_5 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_7(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_6 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_8(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_7 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_9(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_8 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_10(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_9 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_11(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_10 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_12(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_11 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_13(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_12 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_14(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_13 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_15(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_14 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_16(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_15 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_17(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_16 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_18(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_17 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_19(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_18 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_20(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_19 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_21(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_20 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_22(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_21 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_23(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_22 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_24(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_23 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_25(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_24 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_26(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_25 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_27(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_26 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_28(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_27 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_29(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_28 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_30(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_29 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_31(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_30 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_32(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_31 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_33(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_32 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_34(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_33 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_35(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_34 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_36(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_35 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_37(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_36 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_38(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_37 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_39(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_38 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_40(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_39 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_41(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_40 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_42(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_41 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_43(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_42 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_44(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_43 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_45(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_44 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_46(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_45 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_47(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_46 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_48(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_47 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_49(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_48 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_50(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_49 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_51(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_50 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_52(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_51 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_53(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_52 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_54(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_53 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_55(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_54 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_56(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_55 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_57(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_56 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_58(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_57 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_59(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_58 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_60(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_59 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_61(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_60 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_62(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_61 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_63(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_62 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_64(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_63 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_65(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_64 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_66(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_65 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_67(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_66 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_68(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_67 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_69(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_68 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_70(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_69 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_71(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_70 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_72(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_71 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_73(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_72 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_74(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_73 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_75(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_74 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_76(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_75 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_77(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_76 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_78(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_77 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_79(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_78 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_80(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_79 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_81(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_80 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_82(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_81 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_83(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_82 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_84(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_83 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_85(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_84 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_86(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_85 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_87(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_86 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_88(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_87 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_89(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_88 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_90(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_89 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_91(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_90 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_92(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_91 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_93(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_92 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_94(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_93 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_95(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_94 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_96(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_95 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_97(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_96 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_98(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_97 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_99(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_98 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_100(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_99 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_101(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_100 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_102(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_101 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_103(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_102 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_104(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_103 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_105(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_104 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_106(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_105 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_107(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_106 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_108(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_107 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_109(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_108 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_110(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_109 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_111(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_110 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_112(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_111 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_113(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_112 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_114(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_113 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_115(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_114 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_116(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_115 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_117(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_116 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_118(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_117 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_119(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_118 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_120(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_119 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_121(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_120 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_122(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_121 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_123(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_122 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_124(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_123 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_125(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_124 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_126(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_125 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_127(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_126 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_128(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_127 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_129(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_128 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_130(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_129 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_131(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_130 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_132(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_131 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_133(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_132 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_134(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_133 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_135(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_134 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_136(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_135 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_137(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_136 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_138(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_137 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_139(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_138 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_140(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_139 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_141(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_140 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_142(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_141 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_143(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_142 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_144(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_143 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_145(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_144 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_146(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_145 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_147(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_146 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_148(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_147 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_149(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_148 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_150(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_149 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_151(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_150 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_152(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_151 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_153(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_152 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_154(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_153 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_155(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_154 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_156(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_155 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_157(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_156 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_158(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_157 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_159(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_158 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_160(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_159 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_161(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_160 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_162(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_161 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_163(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_162 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_164(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_163 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_165(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_164 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_166(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_165 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_167(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_166 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_168(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_167 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_169(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_168 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_170(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_169 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_171(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_170 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_172(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_171 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_173(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_172 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_174(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_173 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_175(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_174 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_176(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_175 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_177(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_176 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_178(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_177 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_179(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_178 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_180(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_179 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_181(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_180 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_182(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_181 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_183(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_182 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_184(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_183 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_185(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_184 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_186(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_185 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_187(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_186 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_188(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_187 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_189(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_188 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_190(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_189 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_191(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_190 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_192(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_191 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_193(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_192 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_194(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_193 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_195(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_194 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_196(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_195 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_197(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_196 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_198(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_197 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_199(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_198 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_200(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_199 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_201(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_200 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_202(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_201 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_203(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_202 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_204(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_203 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_205(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_204 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_206(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_205 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_207(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_206 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_208(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_207 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_209(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_208 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_210(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_209 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_211(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_210 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_212(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_211 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_213(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_212 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_214(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_213 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_215(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_214 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_216(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_215 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_217(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_216 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_218(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_217 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_219(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_218 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_220(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_219 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_221(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_220 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_222(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_221 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_223(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_222 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_224(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_223 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_225(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_224 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_226(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_225 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_227(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_226 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_228(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_227 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_229(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_228 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_230(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_229 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_231(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_230 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_232(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_231 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_233(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_232 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_234(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_233 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_235(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_234 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_236(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_235 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_237(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_236 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_238(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_237 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_239(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_238 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_240(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_239 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_241(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_240 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_242(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_241 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_243(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_242 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_244(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_243 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_245(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_244 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_246(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_245 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_247(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_246 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_248(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_247 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_249(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_248 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_250(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_249 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_251(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_250 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_252(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_251 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_253(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_252 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+#define SOA_PP_MAP_254(f, n, t, x, ...) f(n, t, x) SOA_PP_EVAL0(SOA_PP_MAP_253 (f, SOA_PP_INC(n), t, __VA_ARGS__))
+
+// A member is given either by it's name, or by '(name, options...)'.
+#define SOA_PP_NAME_PAREN(x) SOA_PP_FIRST x
+#define SOA_PP_NAME_ID(x) x
+#define SOA_PP_NAME(x) SOA_PP_IIF (SOA_PP_IS_PAREN (x)) (SOA_PP_NAME_PAREN, SOA_PP_NAME_ID) (x)
+
+#define SOA_PP_OPTIONS_PAREN(x) SOA_PP_REST x
+#define SOA_PP_OPTIONS(x) SOA_PP_IIF (SOA_PP_IS_PAREN (x)) (SOA_PP_OPTIONS_PAREN, SOA_PP_EMPTY_ARGS) (x)
+
+#define SOA_PP_MEMBER(nb, type, x) \
+    detail::column_span_t<nb, type, decltype(std::declval<type>().SOA_PP_NAME(x)), \
+        detail::column_options<SOA_PP_OPTIONS(x)>> SOA_PP_NAME(x); \
+    static detail::column_options<SOA_PP_OPTIONS(x)> column_options(std::integral_constant<size_t, nb>); \
+    static constexpr auto member_pointer(std::integral_constant<size_t, nb>) noexcept { return &type::SOA_PP_NAME(x); } \
+    static constexpr char const* member_name(std::integral_constant<size_t, nb>) noexcept { return SOA_PP_STRING(SOA_PP_NAME(x)); } \
+    static constexpr auto span_pointer(std::integral_constant<size_t, nb>) noexcept { return &members::SOA_PP_NAME(x); }
+    
+#define SOA_PP_ARRAY_MEMBER(nb, type, x) \
+    std::array<decltype(std::declval<type>().SOA_PP_NAME(x)), N> SOA_PP_NAME(x); \
+    static constexpr auto column_pointer(std::integral_constant<size_t, nb>) noexcept { return &array_members::SOA_PP_NAME(x); }
 
-#define SOA_PP_MAP0(f, n, t, x, peek, ...) f(n, t, x) SOA_PP_MAP_NEXT (peek, SOA_PP_MAP1) (f, n+1, t, peek, __VA_ARGS__)
-#define SOA_PP_MAP1(f, n, t, x, peek, ...) f(n, t, x) SOA_PP_MAP_NEXT (peek, SOA_PP_MAP0) (f, n+1, t, peek, __VA_ARGS__)
-#define SOA_PP_MAP(f, t, ...) SOA_PP_EVAL (SOA_PP_MAP1 (f, 0, t, __VA_ARGS__, (), 0))
+#define SOA_PP_REF(nb, type, x) \
+    decltype(members<type>::SOA_PP_NAME(x))::reference SOA_PP_NAME(x); \
+    constexpr decltype(auto) member_ref(std::integral_constant<size_t, nb>) const noexcept { return (SOA_PP_NAME(x)); }
 
-#define SOA_PP_MEMBER(nb, type, name) \
-    vector_span<nb, type, decltype(std::declval<type>().name)> name;
-    
-#define SOA_PP_REF(nb, type, name) \
-    decltype(std::declval<type>().name) & name;
+#define SOA_PP_CREF(nb, type, x) \
+    decltype(members<type>::SOA_PP_NAME(x))::const_reference SOA_PP_NAME(x); \
+    constexpr decltype(auto) member_ref(std::integral_constant<size_t, nb>) const noexcept { return (SOA_PP_NAME(x)); }
 
-#define SOA_PP_CREF(nb, type, name) \
-    decltype(std::declval<type>().name) const& name;
+#define SOA_PP_COPY(nb, type, x) \
+    SOA_PP_NAME(x) = rhs.SOA_PP_NAME(x);
 
-#define SOA_PP_COPY(nb, type, name) \
-    name = rhs.name;
+#define SOA_PP_MOVE(nb, type, x) \
+    SOA_PP_NAME(x) = std::move(rhs.SOA_PP_NAME(x));
 
-#define SOA_PP_MOVE(nb, type, name) \
-    name = std::move(rhs.name);
+#define SOA_PP_INIT(nb, type, x) \
+    SOA_PP_NAME(x),
 
 #define SOA_PP_ENABLE_FOR_COPYABLE(type, alias) \
     template <class alias, class = std::enable_if_t< \
@@ -981,6 +3911,7 @@ void vector<T, Allocator>::to_zero() noexcept {
 
 // Shortcut to specialize soa::member<my_type>, by listing all the members
 // in their declaration order. It must be used in the global namespace.
+// Members can be given with column options, such as '(name, soa::align<64>)' or '(alive, soa::packed<>)'.
 // Usage exemple :
 // 
 // namespace user {
@@ -992,7 +3923,7 @@ void vector<T, Allocator>::to_zero() noexcept {
 //
 // SOA_DEFINE_TYPE(user::person, name, age);
 //
-// This is equivalent to typing :
+// This is equivalent to typing (without the static functions giving the options, names and pointers of the members) :
 //
 // namespace soa {
 //     template <>
@@ -1000,6 +3931,11 @@ void vector<T, Allocator>::to_zero() noexcept {
 //         vector_span<0, user::person, std::string> name;
 //         vector_span<1, user::person, int> age;
 //     };
+//     template <size_t N>
+//     struct array_members<user::person, N> {
+//         std::array<std::string, N> name;
+//         std::array<int, N> age;
+//     };
 //     template <>
 //     struct ref_proxy<user::person> {
 //         std::string & name;
@@ -1036,6 +3972,10 @@ namespace soa { \
     struct members<::type> { \
         SOA_PP_MAP(SOA_PP_MEMBER, ::type, __VA_ARGS__) \
     }; \
+    template <size_t N> \
+    struct array_members<::type, N> { \
+        SOA_PP_MAP(SOA_PP_ARRAY_MEMBER, ::type, __VA_ARGS__) \
+    }; \
     template <> \
     struct ref_proxy<::type> { \
         SOA_PP_MAP(SOA_PP_REF, ::type, __VA_ARGS__) \
@@ -1050,8 +3990,8 @@ namespace soa { \
             return *this; \
         } \
         SOA_PP_ENABLE_FOR_COPYABLE(::type, _type) \
-        operator _type() const { \
-            return { __VA_ARGS__ }; \
+        constexpr operator _type() const { \
+            return { SOA_PP_MAP(SOA_PP_INIT, ::type, __VA_ARGS__) }; \
         } \
         \
     }; \
@@ -1060,8 +4000,8 @@ namespace soa { \
         SOA_PP_MAP(SOA_PP_CREF, ::type, __VA_ARGS__) \
         \
         SOA_PP_ENABLE_FOR_COPYABLE(::type, _type) \
-        operator _type() const { \
-            return { __VA_ARGS__ }; \
+        constexpr operator _type() const { \
+            return { SOA_PP_MAP(SOA_PP_INIT, ::type, __VA_ARGS__) }; \
         } \
     }; \
 } \
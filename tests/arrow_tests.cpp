@@ -0,0 +1,164 @@
+
+#include "catch.hpp"
+#include "../soa_arrow.hpp"
+#include "test_rows.hpp"
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+namespace arrow_user {
+    enum class direction : std::uint8_t { buy, sell };
+
+    struct trade {
+        std::int64_t id;
+        double       price;
+        direction    side;
+    };
+
+    struct fill {
+        std::int32_t quantity;
+        bool         partial;
+    };
+}
+SOA_DEFINE_TYPE(arrow_user::trade, id, price, side);
+SOA_DEFINE_TYPE(arrow_user::fill, (quantity, soa::align<64>), (partial, soa::packed<>));
+
+namespace {
+    using trade_vector = soa::vector<arrow_user::trade>;
+
+    arrow_user::trade trade_row(int i) {
+        return { i, 0.5 * i, i % 3 == 0 ? arrow_user::direction::sell : arrow_user::direction::buy };
+    }
+}
+
+TEST_CASE("vectors are exported to Arrow arrays without copies", "[arrow]") {
+    static_assert(std::string_view{ soa::detail::member_name_v<arrow_user::fill, 1> } == "partial");
+
+    auto trades = soa_tests::make_rows<trade_vector>(100, trade_row);
+    auto const prices = trades.price.data();
+    auto array = ArrowArray{};
+    auto schema = ArrowSchema{};
+    soa::export_arrow(std::move(trades), &array, &schema);
+
+    REQUIRE(std::strcmp(schema.format, "+s") == 0);
+    REQUIRE(schema.n_children == 3);
+    REQUIRE(std::strcmp(schema.children[0]->name, "id") == 0);
+    REQUIRE(std::strcmp(schema.children[0]->format, "l") == 0);
+    REQUIRE(std::strcmp(schema.children[1]->format, "g") == 0);
+    REQUIRE(std::strcmp(schema.children[2]->name, "side") == 0);
+    REQUIRE(std::strcmp(schema.children[2]->format, "C") == 0);
+
+    REQUIRE(array.length == 100);
+    REQUIRE(array.n_children == 3);
+    REQUIRE(array.children[1]->n_buffers == 2);
+    REQUIRE(array.children[1]->buffers[0] == nullptr);
+    REQUIRE(array.children[1]->buffers[1] == prices);
+    REQUIRE(static_cast<double const*>(array.children[1]->buffers[1])[99] == 49.5);
+
+    // A child moved by the consumer keeps the columns alive after the struct array is released.
+    auto price = *array.children[1];
+    array.children[1]->release = nullptr;
+    array.release(&array);
+    REQUIRE(array.release == nullptr);
+    REQUIRE(static_cast<double const*>(price.buffers[1])[10] == 5.);
+    price.release(&price);
+    schema.release(&schema);
+    REQUIRE(schema.release == nullptr);
+
+    // The packed bools are Arrow booleans.
+    auto fills = soa::vector<arrow_user::fill>{};
+    for (int i = 0; i < 70; ++i) fills.push_back({ i, i % 4 == 1 });
+    auto const shared = std::make_shared<soa::vector<arrow_user::fill> const>(std::move(fills));
+    soa::export_arrow(shared, &array, &schema);
+    REQUIRE(std::strcmp(schema.children[1]->format, "b") == 0);
+    REQUIRE(shared.use_count() == 4);
+    auto const bits = static_cast<std::uint8_t const*>(array.children[1]->buffers[1]);
+    REQUIRE(bits[0] == 0b00100010);
+    REQUIRE(((bits[8] >> 5) & 1) == 1);
+    array.release(&array);
+    schema.release(&schema);
+    REQUIRE(shared.use_count() == 1);
+
+    soa::export_arrow(soa::vector<arrow_user::trade>{}, &array, &schema);
+    REQUIRE(array.length == 0);
+    REQUIRE(array.children[0]->buffers[1] != nullptr);
+    array.release(&array);
+    schema.release(&schema);
+}
+
+TEST_CASE("Arrow arrays are imported in views without copies", "[arrow]") {
+    auto array = ArrowArray{};
+    auto schema = ArrowSchema{};
+    soa::export_arrow(soa_tests::make_rows<trade_vector>(100, trade_row), &array, &schema);
+    auto const ids = array.children[0]->buffers[1];
+
+    auto view = soa::import_arrow<arrow_user::trade>(&array, &schema);
+    REQUIRE(array.release == nullptr);
+    REQUIRE(view.size() == 100);
+    REQUIRE(view->id.data() == ids);
+    REQUIRE(view[30].price == 15.);
+    REQUIRE(view.at(99).side == arrow_user::direction::sell);
+    REQUIRE_THROWS_AS(view.at(100), std::out_of_range);
+
+    auto moved = std::move(view);
+    REQUIRE(view.empty());
+    REQUIRE(moved.get_span<0>()[42] == 42);
+    schema.release(&schema);
+
+    // An array from another producer : the children are found by name and the offsets are applied.
+    std::int64_t id_values[] = { -1, 10, 11, 12, 13 };
+    double price_values[] = { 0., 0., 1., 2., 3. };
+    std::uint8_t side_values[] = { 0, 0, 1, 0, 1 };
+    void const* id_buffers[] = { nullptr, id_values };
+    void const* price_buffers[] = { nullptr, price_values };
+    void const* side_buffers[] = { nullptr, side_values };
+    void const* struct_buffers[] = { nullptr };
+    auto released = 0;
+    auto const release = [] (ArrowArray* a) { ++*static_cast<int*>(a->private_data); a->release = nullptr; };
+
+    ArrowArray children[] = {
+        { 4, 0, 1, 2, 0, price_buffers, nullptr, nullptr, release, &released },
+        { 4, 0, 1, 2, 0, side_buffers, nullptr, nullptr, release, &released },
+        { 5, 0, 0, 2, 0, id_buffers, nullptr, nullptr, release, &released }
+    };
+    ArrowArray* children_pointers[] = { &children[0], &children[1], &children[2] };
+    auto field = [] (char const* format, char const* name) {
+        return ArrowSchema{ format, name, nullptr, 0, 0, nullptr, nullptr, [] (ArrowSchema* s) { s->release = nullptr; }, nullptr };
+    };
+    ArrowSchema fields[] = { field("g", "price"), field("C", "side"), field("l", "id") };
+    ArrowSchema* fields_pointers[] = { &fields[0], &fields[1], &fields[2] };
+    auto const external = ArrowArray{ 3, 0, 1, 1, 3, struct_buffers, children_pointers, nullptr, release, &released };
+    auto external_schema = ArrowSchema{ "+s", "", nullptr, 0, 3, fields_pointers, nullptr, fields[0].release, nullptr };
+
+    {
+        auto copy = external;
+        auto const trades = soa::arrow_view<arrow_user::trade>{ &copy, &external_schema };
+        REQUIRE(trades.size() == 3);
+        REQUIRE(trades[0].id == 10);
+        REQUIRE(trades[0].price == 1.);
+        REQUIRE(trades[2].side == arrow_user::direction::sell);
+    }
+    REQUIRE(released == 1);
+
+    // The arrays which don't match the aggregate are not taken.
+    auto copy = external;
+    fields[1].format = "c";
+    CHECK_THROWS_AS(soa::import_arrow<arrow_user::trade>(&copy, &external_schema), std::invalid_argument);
+    fields[1].format = "C";
+    fields[2].name = "identifier";
+    CHECK_THROWS_AS(soa::import_arrow<arrow_user::trade>(&copy, &external_schema), std::invalid_argument);
+    fields[2].name = "id";
+    children[2].length = 3;
+    CHECK_THROWS_AS(soa::import_arrow<arrow_user::trade>(&copy, &external_schema), std::invalid_argument);
+    children[2].length = 5;
+    std::uint8_t validity[] = { 0xFF };
+    price_buffers[0] = validity;
+    children[0].null_count = 1;
+    CHECK_THROWS_AS(soa::import_arrow<arrow_user::trade>(&copy, &external_schema), std::invalid_argument);
+    price_buffers[0] = nullptr;
+    price_buffers[1] = reinterpret_cast<std::byte const*>(price_values) + 1;
+    CHECK_THROWS_AS(soa::import_arrow<arrow_user::trade>(&copy, &external_schema), std::invalid_argument);
+    REQUIRE(copy.release != nullptr);
+    REQUIRE(released == 1);
+}
@@ -0,0 +1,107 @@
+
+#include "catch.hpp"
+#include "../soa_concurrent.hpp"
+#include <numeric>
+#include <thread>
+
+namespace concurrent_user {
+    struct tick {
+        double      price;
+        int         producer;
+        int         sequence;
+        std::string venue;
+    };
+}
+SOA_DEFINE_TYPE(concurrent_user::tick, price, producer, sequence, venue);
+
+namespace {
+    using ticks = soa::concurrent_vector<concurrent_user::tick, 64>;
+}
+
+TEST_CASE("concurrent vectors reserve and commit ranges of rows", "[concurrent]") {
+    auto v = ticks{ 1000 };
+    REQUIRE(v.empty());
+    REQUIRE(v.max_rows() == 1000);
+
+    auto first = v.reserve_slots(50);
+    auto second = v.reserve_slots(100);
+    REQUIRE(first.first() == 0);
+    REQUIRE(second.first() == 50);
+    REQUIRE(second.last() == 150);
+    REQUIRE(v.reserved_size() == 150);
+
+    for (int i = 0; i < 100; ++i) second.emplace_back(1. * i, 2, i, "xnas");
+    REQUIRE(second.constructed() == 100);
+    // The second range waits for the first one : it's committed from another thread.
+    auto committer = std::thread{ [&second] { second.commit(); } };
+    for (int i = 0; i < 50; ++i) first.push_back({ -1. * i, 1, i, "xpar" });
+    REQUIRE(v.size() == 0);
+    first.commit();
+    committer.join();
+    REQUIRE(v.size() == 150);
+
+    REQUIRE(v[10].producer == 1);
+    REQUIRE(v[60].sequence == 10);
+    REQUIRE(v.at(149).venue == "xnas");
+    REQUIRE_THROWS_AS(v.at(150), std::out_of_range);
+
+    // The pages hold the committed rows in contiguous columns.
+    REQUIRE(v.pages_count() == 3);
+    REQUIRE(v.page(1).sequence.size() == 64);
+    REQUIRE(v.page(1).sequence[0] == 14);
+    REQUIRE(v.page(2).price.size() == 150 - 128);
+
+    // The rows which aren't constructed are value-initialized when their slots are destroyed.
+    {
+        auto partial = v.reserve_slots(3);
+        partial.emplace_back(5., 3);
+    }
+    REQUIRE(v.size() == 153);
+    REQUIRE(v[150].sequence == 0);
+    REQUIRE(v[151].venue.empty());
+
+    REQUIRE(v.push_back({ 1., 4, 0, "xlon" }) == 153);
+    auto const empty = v.reserve_slots(0);
+    REQUIRE(empty.size() == 0);
+    REQUIRE_THROWS_AS(v.reserve_slots(1000), std::length_error);
+    REQUIRE(v.reserved_size() == 154);
+    REQUIRE_THROWS_AS(ticks{ -1 }, std::length_error);
+}
+
+TEST_CASE("concurrent vectors are appended by several producers", "[concurrent]") {
+    constexpr int producers = 8;
+    constexpr int batches   = 200;
+    constexpr int batch     = 25;
+    auto v = ticks{ producers * batches * batch };
+
+    auto threads = std::vector<std::thread>{};
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&v, p] {
+            for (int b = 0; b < batches; ++b) {
+                if (b % 2 == 0) {
+                    auto slots = v.reserve_slots(batch);
+                    for (int i = 0; i < batch; ++i) slots.emplace_back(1. * p, p, b * batch + i, "xnas");
+                    slots.commit();
+                }
+                else {
+                    for (int i = 0; i < batch; ++i) v.emplace_back(1. * p, p, b * batch + i, "xnas");
+                }
+            }
+        });
+    }
+    // The readers only see fully constructed rows.
+    auto seen = soa::size_type{ 0 };
+    while (seen < producers * batches * batch) {
+        auto const size = v.size();
+        for (; seen < size; ++seen) REQUIRE(v[seen].venue == "xnas");
+    }
+    for (auto& thread : threads) thread.join();
+
+    // Each producer wrote all it's sequence numbers, in order.
+    auto next = std::vector<int>(producers, 0);
+    for (soa::size_type i = 0; i < v.size(); ++i) {
+        auto const row = v[i];
+        REQUIRE(row.sequence == next[static_cast<size_t>(row.producer)]++);
+    }
+    for (auto n : next) REQUIRE(n == batches * batch);
+}
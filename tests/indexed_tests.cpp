@@ -0,0 +1,151 @@
+
+#include "catch.hpp"
+#include "../soa_indexed.hpp"
+#include "test_rows.hpp"
+#include <string>
+
+namespace indexed_user {
+    struct account {
+        int         id;
+        std::string owner;
+        double      balance;
+    };
+}
+SOA_DEFINE_TYPE(indexed_user::account, id, owner, balance);
+
+namespace {
+    using accounts = soa::indexed_vector<indexed_user::account, &indexed_user::account::id>;
+
+    // Gives the same hash to all the keys of a group of 10, so the probe sequences collide.
+    struct colliding_hash {
+        size_t operator()(int key) const noexcept { return static_cast<size_t>(key / 10); }
+    };
+    using colliding_accounts = soa::indexed_vector<indexed_user::account, &indexed_user::account::id, colliding_hash>;
+
+    using account_vector = soa::vector<indexed_user::account>;
+
+    indexed_user::account account_row(int i) {
+        return { i * 3, "owner " + std::to_string(i), 1. * i };
+    }
+
+    // Each row is found from it's key.
+    template <class Indexed>
+    void check_index(Indexed const& vec) {
+        for (soa::size_type i = 0; i < vec.size(); ++i)
+            REQUIRE(vec.find(vec.rows().id[i]) == i);
+        REQUIRE(vec.slots_count() / 4 * 3 >= vec.size());
+    }
+}
+
+TEST_CASE("indexed vectors find the rows from their key", "[indexed]") {
+    static_assert(accounts::key_index == 0);
+    static_assert(std::is_same_v<accounts::key_type, int>);
+    static_assert(soa::indexed_vector<indexed_user::account, &indexed_user::account::owner>::key_index == 1);
+
+    auto vec = accounts{};
+    REQUIRE(vec.find(3) == 0);
+    for (int i = 0; i < 100; ++i) vec.push_back({ i * 3, "owner", 0. });
+    vec.emplace_back(1000, "emplaced");
+    REQUIRE(vec.size() == 101);
+    REQUIRE(vec.find(1000) == 100);
+    REQUIRE(vec.find(42) == 14);
+    REQUIRE(vec.find(43) == vec.size());
+    REQUIRE(vec.contains(297));
+    REQUIRE_FALSE(vec.contains(300));
+    check_index(vec);
+
+    // Duplicated keys are rejected.
+    CHECK_THROWS_AS(vec.push_back({ 42, "duplicate", 0. }), std::invalid_argument);
+    CHECK_THROWS_AS(vec.emplace_back(1000), std::invalid_argument);
+    REQUIRE(vec.size() == 101);
+
+    // The capacities below the current one are ignored.
+    vec.reserve(-1);
+    vec.reserve(10);
+    vec.reserve(1000);
+    REQUIRE(vec.capacity() >= 1000);
+    check_index(vec);
+    REQUIRE(vec.back().owner == "emplaced");
+
+    // The other columns are modified through their spans.
+    vec.get_span<2>()[14] = 10.;
+    REQUIRE(vec[vec.find(42)].balance == 10.);
+    static_assert(std::is_const_v<std::remove_reference_t<decltype(vec.get_span<0>())>>);
+
+    vec.set_key(14, 43);
+    REQUIRE(vec.find(43) == 14);
+    REQUIRE_FALSE(vec.contains(42));
+    CHECK_THROWS_AS(vec.set_key(14, 0), std::invalid_argument);
+
+    auto copy = vec;
+    auto moved = std::move(vec);
+    REQUIRE(vec.empty());
+    REQUIRE_FALSE(vec.contains(43));
+    vec = moved;
+    REQUIRE(vec.find(43) == 14);
+    check_index(copy);
+
+    auto const rows = moved.extract();
+    REQUIRE(moved.empty());
+    REQUIRE(rows.size() == 101);
+    moved.push_back({ 42, "new", 0. });
+    REQUIRE(moved.find(42) == 0);
+}
+
+TEST_CASE("indexed vectors keep the index in sync on removals", "[indexed]") {
+    auto vec = colliding_accounts{ soa_tests::make_rows<account_vector>(200, account_row) };
+    check_index(vec);
+
+    // Removes rows in the middle of the probe sequences.
+    vec.swap_erase(vec.begin() + vec.find(30));
+    REQUIRE(vec.size() == 199);
+    REQUIRE_FALSE(vec.contains(30));
+    REQUIRE(vec.find(597) == 10);
+    REQUIRE(vec.erase(33));
+    REQUIRE_FALSE(vec.erase(33));
+    vec.pop_back();
+    REQUIRE_FALSE(vec.contains(591));
+    check_index(vec);
+
+    auto const removed = soa::erase_if(vec, [] (auto const& row) { return row.id % 2 == 0; });
+    REQUIRE(removed == 99);
+    REQUIRE(vec.size() == 98);
+    REQUIRE_FALSE(vec.contains(36));
+    REQUIRE(vec.contains(39));
+    check_index(vec);
+
+    vec.clear();
+    REQUIRE_FALSE(vec.contains(39));
+    vec.push_back({ 39, "again", 0. });
+    REQUIRE(vec.find(39) == 0);
+}
+
+TEST_CASE("indexed vectors are sorted and built in parallel", "[indexed]") {
+    auto vec = accounts{ soa::execution::par.with_workers(3).with_chunk_rows(1000), soa_tests::make_rows<account_vector>(10000, account_row) };
+    REQUIRE(vec.size() == 10000);
+    check_index(vec);
+
+    soa::sort_by(vec, &indexed_user::account::balance, std::greater<>{});
+    REQUIRE(vec[0].id == 9999 * 3);
+    REQUIRE(vec.find(0) == 9999);
+    soa::stable_sort_by<0>(vec);
+    REQUIRE(vec.find(30) == 10);
+    auto order = std::vector<soa::size_type>(10000);
+    for (int i = 0; i < 10000; ++i) order[i] = 9999 - i;
+    soa::permute(vec, order);
+    REQUIRE(vec.find(0) == 9999);
+    check_index(vec);
+
+    auto duplicates = soa_tests::make_rows<account_vector>(100, account_row);
+    duplicates.push_back({ 3, "duplicate", 0. });
+    CHECK_THROWS_AS(accounts(soa::execution::par.with_workers(2), duplicates), std::invalid_argument);
+    CHECK_THROWS_AS(accounts(duplicates), std::invalid_argument);
+
+    // String keys are reindexed when their rows are sorted.
+    auto by_owner = soa::indexed_vector<indexed_user::account, &indexed_user::account::owner>{ soa_tests::make_rows<account_vector>(20, account_row) };
+    REQUIRE(by_owner.find("owner 12") == 12);
+    soa::sort_by<1>(by_owner);
+    REQUIRE(by_owner.find("owner 12") == 4);
+    REQUIRE(by_owner[4].id == 36);
+    REQUIRE(by_owner.find("nobody") == by_owner.size());
+}
@@ -0,0 +1,135 @@
+
+#include "catch.hpp"
+#include "../soa_instrumentation.hpp"
+#include <algorithm>
+#include <sstream>
+
+// Built in the 'tests_instrumentation' target, with SOA_INSTRUMENTATION defined.
+
+namespace instrumentation_user {
+    struct point {
+        double x;
+        float  y;
+        char   tag;
+    };
+    struct id {
+        int value;
+    };
+}
+SOA_DEFINE_TYPE(instrumentation_user::point, x, y, tag);
+SOA_DEFINE_TYPE(instrumentation_user::id, value);
+
+namespace {
+    using point = instrumentation_user::point;
+    using soa::instrumentation::event_kind;
+
+    struct recorded_event {
+        event_kind kind;
+        std::string type;
+        void const* vector;
+        soa::size_type old_capacity;
+        soa::size_type new_capacity;
+        soa::size_type rows;
+        size_t bytes;
+        std::vector<size_t> column_bytes;
+    };
+    std::vector<recorded_event> events;
+
+    void record(soa::instrumentation::event const& e) noexcept {
+        events.push_back({ e.kind, std::string{ e.type }, e.vector, e.old_capacity, e.new_capacity, e.rows, e.bytes,
+            std::vector<size_t>(e.column_bytes, e.column_bytes + e.columns_count) });
+    }
+
+    // Records the events emitted in it's scope.
+    struct recording {
+        recording() { events.clear(); previous = soa::instrumentation::set_sink(record); }
+        ~recording() { soa::instrumentation::set_sink(previous); }
+        soa::instrumentation::sink_type previous;
+    };
+
+    size_t count(event_kind kind) {
+        return static_cast<size_t>(std::count_if(events.begin(), events.end(), [kind] (auto const& e) {
+            return e.kind == kind;
+        }));
+    }
+}
+
+TEST_CASE("instrumentation reports the reallocations", "[instrumentation]") {
+    static_assert(soa::instrumentation::enabled);
+    auto const scope = recording{};
+    auto v = soa::vector<point>{};
+
+    v.reserve(10);
+    REQUIRE(events.size() == 2);
+    REQUIRE(events[0].kind == event_kind::allocate);
+    REQUIRE(events[0].vector == &v);
+    REQUIRE(events[0].bytes > 0);
+    REQUIRE(events[1].kind == event_kind::reserve);
+    REQUIRE(events[1].type == soa::detail::type_name<point>());
+    REQUIRE(events[1].old_capacity == 0);
+    REQUIRE(events[1].new_capacity == 10);
+    REQUIRE(events[1].rows == 0);
+
+    for (int i = 0; i < 11; ++i) v.push_back({ 1. * i, 2.f, 'a' });
+    auto const& grow = events.back();
+    REQUIRE(grow.kind == event_kind::grow);
+    REQUIRE(grow.old_capacity == 10);
+    REQUIRE(grow.new_capacity == 20);
+    REQUIRE(grow.rows == 10);
+    REQUIRE(grow.column_bytes == std::vector<size_t>{ 10 * sizeof(double), 10 * sizeof(float), 10 });
+    REQUIRE(grow.bytes == 10 * (sizeof(double) + sizeof(float) + 1));
+    REQUIRE(count(event_kind::allocate) == 2);
+    REQUIRE(count(event_kind::deallocate) == 1);
+
+    v.shrink_to_fit();
+    REQUIRE(events.back().kind == event_kind::shrink_to_fit);
+    REQUIRE(events.back().old_capacity == 20);
+    REQUIRE(events.back().new_capacity == 11);
+    REQUIRE(events.back().rows == 11);
+
+    events.clear();
+    auto copy = v;
+    REQUIRE(events.back().kind == event_kind::copy_construct);
+    REQUIRE(events.back().vector == &copy);
+    REQUIRE(events.back().rows == 11);
+    REQUIRE(count(event_kind::allocate) == 1);
+
+    copy = soa::vector<point>{};
+    events.clear();
+    copy = v;
+    REQUIRE(events.back().kind == event_kind::copy_assign);
+    REQUIRE(events.back().old_capacity == 0);
+    REQUIRE(events.back().new_capacity == 11);
+}
+
+TEST_CASE("instrumentation stats aggregate the events per type", "[instrumentation]") {
+    auto const previous = soa::instrumentation::set_sink(soa::instrumentation::global_sink);
+    soa::instrumentation::global_stats().clear();
+    {
+        auto v = soa::vector<point>{};
+        for (int i = 0; i < 100; ++i) v.push_back({ 1. * i, 2.f, 'a' });
+        auto const copy = v;
+        auto w = soa::vector<instrumentation_user::id>{};
+        w.reserve(8);
+    }
+    soa::instrumentation::set_sink(previous);
+
+    auto const snapshot = soa::instrumentation::global_stats().snapshot();
+    REQUIRE(snapshot.size() == 2);
+    auto const& s = snapshot.at(soa::detail::type_name<point>());
+    // Capacities 1, 2, 4, ... 128 : 8 allocations and the copy.
+    REQUIRE(s.grows == 8);
+    REQUIRE(s.allocations == 9);
+    REQUIRE(s.deallocations == 9);
+    REQUIRE(s.allocated_bytes == s.deallocated_bytes);
+    REQUIRE(s.moved_rows == 1 + 2 + 4 + 8 + 16 + 32 + 64);
+    REQUIRE(s.moved_column_bytes[0] == s.moved_rows * static_cast<long long>(sizeof(double)));
+    REQUIRE(s.copies == 1);
+    REQUIRE(s.copied_rows == 100);
+    REQUIRE(s.max_capacity == 128);
+    REQUIRE(snapshot.at(soa::detail::type_name<instrumentation_user::id>()).reserves == 1);
+
+    auto os = std::ostringstream{};
+    soa::instrumentation::global_stats().dump(os);
+    REQUIRE(os.str().find("8 grows") != std::string::npos);
+}
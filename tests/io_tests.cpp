@@ -0,0 +1,269 @@
+
+#include "catch.hpp"
+#include "../soa_io.hpp"
+#include "test_rows.hpp"
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace io_user {
+    struct tick {
+        double price;
+        int    volume;
+        char   side;
+    };
+    struct other {
+        double price;
+        float  volume;
+        char   side;
+    };
+}
+SOA_DEFINE_TYPE(io_user::tick, price, (volume, soa::align<128>), side);
+SOA_DEFINE_TYPE(io_user::other, price, volume, side);
+
+namespace {
+    // Temporary file removed at the end of the test.
+    struct temp_file {
+        std::string path;
+        explicit temp_file(char const* name) :
+            path{ (std::filesystem::temp_directory_path() / name).string() } {}
+        ~temp_file() { std::filesystem::remove(path); }
+    };
+
+    using ticks_vector = soa::vector<io_user::tick>;
+
+    io_user::tick tick_row(int i) {
+        return { 100. + i, i * 10, i % 2 ? 'b' : 's' };
+    }
+}
+
+#if defined(SOA_IO_HAS_MMAP)
+
+TEST_CASE("mapped views read the saved columns in place", "[io]") {
+    auto const file = temp_file{ "soa_io_ticks.soa" };
+    auto const ticks = soa_tests::make_rows<ticks_vector>(1000, tick_row);
+    soa::save(ticks, file.path);
+
+    auto const view = soa::mapped_view<io_user::tick>{ file.path };
+    REQUIRE(view.size() == 1000);
+    REQUIRE(view->price.size() == 1000);
+    REQUIRE(reinterpret_cast<uintptr_t>(view->price.data()) % soa::io::file_alignment == 0);
+    REQUIRE(reinterpret_cast<uintptr_t>(view->volume.data()) % 128 == 0);
+    for (int i = 0; i < 1000; ++i) {
+        REQUIRE(view->price[i] == ticks.price[i]);
+        REQUIRE(view.columns().volume[i] == ticks.volume[i]);
+        REQUIRE(view[i].side == ticks.side[i]);
+    }
+    io_user::tick const t = view.at(7);
+    REQUIRE(t.volume == 70);
+    REQUIRE_THROWS_AS(view.at(1000), std::out_of_range);
+
+    auto sum = 0;
+    for (auto row : view) sum += row.volume;
+    REQUIRE(sum == 10 * 999 * 1000 / 2);
+
+    auto moved = std::move(const_cast<soa::mapped_view<io_user::tick>&>(view));
+    REQUIRE(view.empty());
+    REQUIRE(moved->side[1] == 'b');
+}
+
+TEST_CASE("mapped views of empty vectors", "[io]") {
+    auto const file = temp_file{ "soa_io_empty.soa" };
+    soa::save(soa::vector<io_user::tick>{}, file.path);
+    auto const view = soa::mapped_view<io_user::tick>{ file.path };
+    REQUIRE(view.empty());
+    REQUIRE(view.begin() == view.end());
+}
+
+TEST_CASE("mapped views reject invalid files", "[io]") {
+    auto const file = temp_file{ "soa_io_invalid.soa" };
+    REQUIRE_THROWS_AS(soa::mapped_view<io_user::tick>{ file.path }, std::system_error);
+
+    soa::save(soa_tests::make_rows<ticks_vector>(10, tick_row), file.path);
+    REQUIRE_THROWS_AS(soa::mapped_view<io_user::other>{ file.path }, std::runtime_error);
+
+    // Truncated file.
+    std::filesystem::resize_file(file.path, 300);
+    REQUIRE_THROWS_AS(soa::mapped_view<io_user::tick>{ file.path }, std::runtime_error);
+
+    // Rows count for which the size of the prices column wraps to its real size in 64 bits.
+    soa::save(soa_tests::make_rows<ticks_vector>(10, tick_row), file.path);
+    {
+        auto out = std::fstream{ file.path, std::ios::binary | std::ios::in | std::ios::out };
+        auto const rows = (uint64_t{ 1 } << 61) + 10;
+        out.seekp(offsetof(soa::io::file_header, rows_count));
+        out.write(reinterpret_cast<char const*>(&rows), sizeof(rows));
+    }
+    REQUIRE_THROWS_AS(soa::mapped_view<io_user::tick>{ file.path }, std::runtime_error);
+
+    {
+        auto out = std::ofstream{ file.path, std::ios::binary | std::ios::trunc };
+        out << "not a table, but long enough to hold a header";
+    }
+    REQUIRE_THROWS_AS(soa::mapped_view<io_user::tick>{ file.path }, std::runtime_error);
+}
+
+#endif
+
+namespace io_user {
+    struct order {
+        std::string client;
+        double      price;
+        int         quantity;
+    };
+}
+SOA_DEFINE_TYPE(io_user::order, client, price, quantity);
+
+namespace {
+    // Sink and source counting the calls, over a buffer.
+    struct buffer_stream {
+        std::string bytes;
+        size_t position = 0;
+        int writes = 0;
+
+        void write(void const* data, size_t size) {
+            bytes.append(static_cast<char const*>(data), size);
+            ++writes;
+        }
+        void read(void* data, size_t size) {
+            if (position + size > bytes.size()) throw std::runtime_error{ "end of buffer" };
+            std::memcpy(data, bytes.data() + position, size);
+            position += size;
+        }
+    };
+
+    // Encodes the quantity column as 16 bits integers.
+    struct short_codec {
+        template <class Sink>
+        static void encode(Sink& sink, int const* data, int n) {
+            for (int i = 0; i < n; ++i) {
+                auto const value = static_cast<int16_t>(data[i]);
+                sink.write(&value, sizeof(value));
+            }
+        }
+        template <class Source>
+        static void decode(Source& source, int* data, int n) {
+            for (int i = 0; i < n; ++i) {
+                auto value = int16_t{};
+                source.read(&value, sizeof(value));
+                data[i] = value;
+            }
+        }
+    };
+}
+template <>
+struct soa::column_codec<io_user::order, 2> : short_codec {};
+
+TEST_CASE("streams write each column of the chunks", "[io]") {
+    auto const ticks = soa_tests::make_rows<ticks_vector>(1000, tick_row);
+    auto stream = buffer_stream{};
+    {
+        auto encoder = soa::stream_encoder<io_user::tick, buffer_stream>{ stream, 1000, 300 };
+        encoder.write(ticks);
+        encoder.finish();
+    }
+    // Header, then 4 chunks of 3 columns, then the end marker.
+    REQUIRE(stream.writes == 1 + 4 * 4 + 1);
+    REQUIRE(stream.bytes.size() == sizeof(soa::io::stream_header) + 4 * 4 + 1000 * 13 + 4);
+
+    auto decoder = soa::stream_decoder<io_user::tick, buffer_stream>{ stream };
+    REQUIRE(decoder.rows_count() == 1000u);
+    REQUIRE(decoder.chunk_rows() == 300);
+    auto result = soa::vector<io_user::tick>{};
+    REQUIRE(decoder.read_chunk(result) == 300);
+    REQUIRE(result.size() == 300);
+    decoder.read_all(result);
+    REQUIRE(decoder.finished());
+    REQUIRE(result.size() == 1000);
+    for (int i = 0; i < 1000; ++i) {
+        REQUIRE(result.price[i] == ticks.price[i]);
+        REQUIRE(result.volume[i] == ticks.volume[i]);
+        REQUIRE(result.side[i] == ticks.side[i]);
+    }
+}
+
+TEST_CASE("streams use codecs for the other columns", "[io]") {
+    auto orders = soa::vector<io_user::order>{};
+    for (int i = 0; i < 50; ++i) orders.push_back({ std::string(static_cast<size_t>(i), 'x'), 1.5 * i, i });
+
+    auto stream = std::stringstream{};
+    soa::encode(stream, orders);
+    auto const result = soa::decode<io_user::order>(stream);
+    REQUIRE(result.size() == 50);
+    for (int i = 0; i < 50; ++i) {
+        REQUIRE(result.client[i] == orders.client[i]);
+        REQUIRE(result.price[i] == orders.price[i]);
+        REQUIRE(result.quantity[i] == i);
+    }
+
+    // Streams larger than memory are read chunk by chunk in a bounded vector.
+    auto chunked = buffer_stream{};
+    auto encoder = soa::stream_encoder<io_user::order, buffer_stream>{ chunked, soa::io::unknown_rows, 8 };
+    for (int i = 0; i < 5; ++i) encoder.write(orders, i * 10, i * 10 + 10);
+    encoder.finish();
+
+    auto decoder = soa::stream_decoder<io_user::order, buffer_stream>{ chunked };
+    REQUIRE(!decoder.rows_count());
+    auto window = soa::vector<io_user::order>{};
+    auto total = 0;
+    while (decoder.read_chunk(window) > 0) {
+        REQUIRE(window.size() <= 8);
+        for (int i = 0; i < window.size(); ++i) REQUIRE(window.client[i].size() == static_cast<size_t>(total + i));
+        total += window.size();
+        window.clear();
+    }
+    REQUIRE(total == 50);
+}
+
+TEST_CASE("stream decoders reject invalid streams", "[io]") {
+    auto stream = buffer_stream{};
+    auto encoder = soa::stream_encoder<io_user::tick, buffer_stream>{ stream };
+    encoder.write(soa_tests::make_rows<ticks_vector>(10, tick_row));
+    encoder.finish();
+
+    using other_decoder = soa::stream_decoder<io_user::other, buffer_stream>;
+    REQUIRE_THROWS_AS(other_decoder{ stream }, std::runtime_error);
+
+    // The vector is unchanged when a chunk is truncated.
+    stream.position = 0;
+    stream.bytes.resize(stream.bytes.size() - 20);
+    auto decoder = soa::stream_decoder<io_user::tick, buffer_stream>{ stream };
+    auto ticks = soa_tests::make_rows<ticks_vector>(3, tick_row);
+    REQUIRE_THROWS_AS(decoder.read_all(ticks), std::runtime_error);
+    REQUIRE(ticks.size() == 3);
+
+    // The rows count of the header must match the chunks, and is reserved up to a chunk.
+    for (uint64_t announced : { 5, 1'000'000'000 }) {
+        auto wrong = buffer_stream{};
+        auto wrong_encoder = soa::stream_encoder<io_user::tick, buffer_stream>{ wrong, announced, 4 };
+        wrong_encoder.write(soa_tests::make_rows<ticks_vector>(10, tick_row));
+        wrong_encoder.finish();
+        auto wrong_decoder = soa::stream_decoder<io_user::tick, buffer_stream>{ wrong };
+        auto rows = ticks_vector{};
+        REQUIRE_THROWS_AS(wrong_decoder.read_all(rows), std::runtime_error);
+        REQUIRE(rows.capacity() < 100);
+    }
+}
+
+#if defined(SOA_IO_HAS_MMAP)
+TEST_CASE("streams through file descriptors", "[io]") {
+    auto const file = temp_file{ "soa_io_stream.soa" };
+    auto ticks = soa_tests::make_rows<ticks_vector>(100, tick_row);
+    {
+        auto const fd = ::open(file.path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+        REQUIRE(fd >= 0);
+        auto sink = soa::io::fd_sink{ fd };
+        soa::encode(sink, ticks);
+        ::close(fd);
+    }
+    auto const fd = ::open(file.path.c_str(), O_RDONLY);
+    REQUIRE(fd >= 0);
+    auto source = soa::io::fd_source{ fd };
+    auto const result = soa::decode<io_user::tick>(source);
+    ::close(fd);
+    REQUIRE(result.size() == 100);
+    REQUIRE(result.volume[99] == 990);
+}
+#endif
@@ -0,0 +1,138 @@
+
+#include "catch.hpp"
+#include "../soa_paged.hpp"
+#include "../soa_simd.hpp"
+#include "test_rows.hpp"
+#include <numeric>
+
+namespace paged_user {
+    struct sample {
+        float  value;
+        double weight;
+        int    id;
+    };
+}
+SOA_DEFINE_TYPE(paged_user::sample, value, weight, id);
+
+namespace {
+    using samples = soa::paged_vector<paged_user::sample, 64>;
+
+    paged_user::sample sample_row(int i) {
+        return { 1.f * i, 0.5 * i, i };
+    }
+}
+
+TEST_CASE("paged vectors append rows without moving the previous ones", "[paged]") {
+    auto v = samples{};
+    REQUIRE(v.empty());
+    v.push_back({ 1.f, 2., 0 });
+    auto const first_values = v.page(0).value.data();
+    auto const first_ids = v.page(0).id.data();
+    REQUIRE(v.capacity() == 64);
+
+    for (int i = 1; i < 1000; ++i) v.emplace_back(1.f * i, 0.5 * i, i);
+    REQUIRE(v.size() == 1000);
+    REQUIRE(v.pages_count() == 16);
+    REQUIRE(v.page(0).value.data() == first_values);
+    REQUIRE(v.page(0).id.data() == first_ids);
+
+    // All the pages are full except the last one, and each column has it's own contiguous array.
+    for (soa::size_type p = 0; p < 15; ++p) REQUIRE(v.page(p).id.size() == 64);
+    REQUIRE(v.page(15).id.size() == 1000 - 15 * 64);
+    REQUIRE(v.page(3).id[5] == 3 * 64 + 5);
+
+    REQUIRE(v[700].id == 700);
+    REQUIRE(v.at(999).value == 999.f);
+    REQUIRE_THROWS_AS(v.at(1000), std::out_of_range);
+    REQUIRE(v.front().id == 0);
+    REQUIRE(v.back().id == 999);
+
+    auto sum = 0;
+    for (auto row : v) sum += row.id;
+    REQUIRE(sum == 999 * 1000 / 2);
+    REQUIRE(v.end() - v.begin() == 1000);
+
+    v[10].weight = -1.;
+    REQUIRE(v.page(0).weight[10] == -1.);
+
+    // Bulk appends fill the last page, then the new ones.
+    auto const rows = std::vector<paged_user::sample>(100, { 3.f, 4., 5 });
+    v.append(rows.begin(), rows.end());
+    REQUIRE(v.size() == 1100);
+    REQUIRE(v.pages_count() == 18);
+    REQUIRE(v[1099].id == 5);
+    REQUIRE(v[999].id == 999);
+}
+
+TEST_CASE("paged vectors release their first pages", "[paged]") {
+    auto v = soa_tests::make_rows<samples>(200, sample_row);
+    auto const released = v.page(0).value.data();
+    auto const second = v.page(1).value.data();
+
+    v.pop_front_page();
+    REQUIRE(v.size() == 136);
+    REQUIRE(v[0].id == 64);
+    REQUIRE(v.page(0).value.data() == second);
+
+    // The released page is reused by the next page.
+    for (int i = 200; i < 256 + 1; ++i) v.push_back({ 1.f * i, 0.5 * i, i });
+    REQUIRE(v.pages_count() == 4);
+    REQUIRE(v.page(3).value.data() == released);
+    REQUIRE(v.back().id == 256);
+
+    // Sliding window of at most 3 pages.
+    for (int i = 257; i < 2000; ++i) {
+        v.push_back({ 1.f * i, 0.5 * i, i });
+        if (v.pages_count() > 3) v.pop_front_page();
+    }
+    REQUIRE(v.pages_count() == 3);
+    REQUIRE(v.back().id == 1999);
+    REQUIRE(v.front().id == 1999 / 64 * 64 - 128);
+
+    while (!v.empty()) v.pop_back();
+    REQUIRE(v.size() == 0);
+    REQUIRE(v.pages_count() == 0);
+
+    v = soa_tests::make_rows<samples>(130, sample_row);
+    v.clear();
+    REQUIRE(v.empty());
+    v.push_back({ 1.f, 2., 3 });
+    REQUIRE(v.size() == 1);
+    v.shrink_to_fit();
+    REQUIRE(v[0].id == 3);
+}
+
+TEST_CASE("paged vectors copies keep full pages", "[paged]") {
+    auto const v = soa_tests::make_rows<samples>(100, sample_row);
+    auto copy = v;
+    REQUIRE(copy.size() == 100);
+    REQUIRE(copy.capacity() == 128);
+    REQUIRE(copy.page(1).id[0] == 64);
+    REQUIRE(copy.page(0).id.data() != v.page(0).id.data());
+
+    // Appending to the copied last page doesn't move it.
+    auto const last = copy.page(1).id.data();
+    for (int i = 0; i < 28; ++i) copy.push_back({ 0.f, 0., -1 });
+    REQUIRE(copy.page(1).id.data() == last);
+    REQUIRE(copy.pages_count() == 2);
+
+    copy = v;
+    REQUIRE(copy.size() == 100);
+    REQUIRE(copy[99].id == 99);
+}
+
+TEST_CASE("paged vectors pages run SIMD kernels and parallel algorithms", "[paged]") {
+    auto v = soa_tests::make_rows<samples>(1000, sample_row);
+
+    soa::for_each_page(soa::execution::par.with_workers(3), v, [] (auto& page, soa::size_type) {
+        soa::simd_transform(page.value, [] (auto value) { return value * 2.f; }, page.value);
+    });
+    for (int i = 0; i < 1000; ++i) REQUIRE(v[i].value == 2.f * i);
+
+    auto firsts = std::vector<soa::size_type>(v.pages_count(), -1);
+    soa::for_each_page(soa::execution::seq, std::as_const(v), [&firsts] (auto const& page, soa::size_type first) {
+        REQUIRE(page.id[0] == first);
+        firsts[static_cast<size_t>(first / samples::page_rows)] = first;
+    });
+    for (size_t p = 0; p < firsts.size(); ++p) REQUIRE(firsts[p] == static_cast<soa::size_type>(p) * 64);
+}
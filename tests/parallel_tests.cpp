@@ -0,0 +1,204 @@
+
+#include "catch.hpp"
+#define SOA_STD_EXECUTION
+#include "../soa_parallel.hpp"
+#include "test_rows.hpp"
+#include <functional>
+#include <deque>
+#include <set>
+
+namespace parallel_user {
+    struct body {
+        float  pos;
+        float  speed;
+        double mass;
+        int    id;
+    };
+}
+SOA_DEFINE_TYPE(parallel_user::body, pos, speed, mass, id);
+
+namespace parallel_user {
+    struct flagged {
+        float value;
+        bool  selected;
+    };
+}
+SOA_DEFINE_TYPE(parallel_user::flagged, value, (selected, soa::packed<>));
+
+namespace {
+    // Minimal thread pool used to check that the algorithms run on user executors.
+    class thread_pool {
+        std::vector<std::thread> threads_;
+        std::deque<std::function<void()>> tasks_;
+        std::mutex mutex_;
+        std::condition_variable ready_;
+        bool stopped_ = false;
+    public:
+        int submitted = 0;
+
+        explicit thread_pool(int nb) {
+            for (int i = 0; i < nb; ++i) threads_.emplace_back([this] {
+                for (;;) {
+                    auto lock = std::unique_lock<std::mutex>{ mutex_ };
+                    ready_.wait(lock, [this] { return stopped_ || !tasks_.empty(); });
+                    if (tasks_.empty()) return;
+                    auto task = std::move(tasks_.front());
+                    tasks_.pop_front();
+                    lock.unlock();
+                    task();
+                }
+            });
+        }
+        ~thread_pool() {
+            {
+                std::lock_guard<std::mutex> lock{ mutex_ };
+                stopped_ = true;
+            }
+            ready_.notify_all();
+            for (auto& thread : threads_) thread.join();
+        }
+
+        template <class Task>
+        void execute(Task task) {
+            {
+                std::lock_guard<std::mutex> lock{ mutex_ };
+                tasks_.emplace_back(std::move(task));
+                ++submitted;
+            }
+            ready_.notify_one();
+        }
+        int concurrency() const noexcept { return static_cast<int>(threads_.size()); }
+    };
+
+    parallel_user::body body_row(int i) {
+        return { static_cast<float>(i), 2.f, 1., i };
+    }
+}
+
+TEST_CASE("chunk boundaries are aligned on cache lines", "[parallel]") {
+    auto vec = soa_tests::make_rows<soa::vector<parallel_user::body, std::allocator<parallel_user::body>, soa::layout<64>>>(1000, body_row);
+
+    auto const columns = std::array<soa::detail::column_bytes, 2>{
+        soa::detail::make_column_bytes(vec.pos.data()),
+        soa::detail::make_column_bytes(vec.mass.data())
+    };
+    auto const chunks = soa::detail::make_chunking(vec.size(), 4, 10, columns);
+    REQUIRE(chunks.chunk_rows == 16);
+    REQUIRE(chunks.offset == 0);
+    for (int c = 1; c < chunks.count; ++c) {
+        auto const row = chunks.first(c);
+        REQUIRE(reinterpret_cast<std::uintptr_t>(vec.pos.data() + row) % 64 == 0);
+        REQUIRE(reinterpret_cast<std::uintptr_t>(vec.mass.data() + row) % 64 == 0);
+    }
+    REQUIRE(chunks.last(chunks.count - 1) == 1000);
+
+    // Unaligned columns : the boundaries are aligned on the lines of the first one.
+    auto const shifted = std::array<soa::detail::column_bytes, 1>{
+        soa::detail::make_column_bytes(vec.pos.data() + 3)
+    };
+    auto const shifted_chunks = soa::detail::make_chunking(997, 4, 16, shifted);
+    REQUIRE(shifted_chunks.offset == 13);
+    REQUIRE(shifted_chunks.last(shifted_chunks.count - 1) == 997);
+}
+
+TEST_CASE("chunk boundaries fall on the words of packed columns", "[parallel]") {
+    auto vec = soa::vector<parallel_user::flagged>{};
+    for (int i = 0; i < 5000; ++i) vec.push_back({ static_cast<float>(i), false });
+
+    auto const columns = std::array<soa::detail::column_bytes, 2>{
+        soa::detail::make_column_bytes(vec.value.data() + 3),
+        soa::detail::make_column_bytes(vec.selected.data())
+    };
+    // A cache line holds 8 words of 64 flags.
+    auto const chunks = soa::detail::make_chunking(vec.size(), 4, 100, columns);
+    REQUIRE(chunks.chunk_rows == 512);
+    REQUIRE(chunks.offset % 64 == 0);
+
+    auto pool = thread_pool{ 3 };
+    soa::for_each(soa::execution::par.on(pool).with_chunk_rows(64), vec, [] (auto row) {
+        row.selected = static_cast<int>(row.value) % 5 == 0;
+    });
+    REQUIRE(vec.selected.count() == 1000);
+    soa::for_each(soa::execution::par.on(pool).with_chunk_rows(100), vec.selected, [] (auto flag) { flag = !flag; });
+    REQUIRE(vec.selected.count() == 4000);
+    REQUIRE(soa::reduce(soa::execution::par, vec.selected, 0, std::plus<>{}, [] (bool flag) { return flag ? 1 : 0; }) == 4000);
+}
+
+TEST_CASE("parallel for_each on rows and columns", "[parallel]") {
+    auto vec = soa_tests::make_rows<soa::vector<parallel_user::body>>(10'000, body_row);
+    auto pool = thread_pool{ 3 };
+    auto const policy = soa::execution::par.on(pool).with_chunk_rows(100);
+
+    soa::for_each(policy, vec, [] (auto p) { p.pos += p.speed; });
+    soa::for_each(policy, vec.mass, [] (double& mass) { mass *= 2.; });
+    soa::for_each(policy, soa::view(vec, &parallel_user::body::id, &parallel_user::body::speed), [] (int& id, float& speed) {
+        speed = static_cast<float>(id);
+    });
+
+    for (int i = 0; i < vec.size(); ++i) {
+        REQUIRE(vec.pos[i] == static_cast<float>(i) + 2.f);
+        REQUIRE(vec.mass[i] == 2.);
+        REQUIRE(vec.speed[i] == static_cast<float>(i));
+    }
+    REQUIRE(pool.submitted > 0);
+
+    soa::for_each(soa::execution::seq, vec.pos, [] (float& pos) { pos = 0.f; });
+    REQUIRE(std::all_of(vec.pos.begin(), vec.pos.end(), [] (float pos) { return pos == 0.f; }));
+}
+
+TEST_CASE("parallel transform and reduce", "[parallel]") {
+    auto vec = soa::vector<parallel_user::body>{};
+    auto const policy = soa::execution::par.with_workers(4).with_chunk_rows(64);
+
+    for (int nb : { 0, 1, 63, 5'000 }) {
+        vec = soa_tests::make_rows<decltype(vec)>(nb, body_row);
+        soa::transform(policy, vec.pos, [] (float pos, float speed) { return pos + speed; }, vec.pos, vec.speed);
+        for (int i = 0; i < nb; ++i)
+            REQUIRE(vec.pos[i] == static_cast<float>(i) + 2.f);
+
+        auto const sum = soa::reduce(policy, vec.id, 0LL, std::plus<>{}, [] (int id) { return id; });
+        REQUIRE(sum == static_cast<long long>(nb) * (nb - 1) / 2);
+
+        auto const max = soa::reduce(policy, vec, -1, [] (int a, int b) { return std::max(a, b); }, [] (auto p) {
+            return p.id;
+        });
+        REQUIRE(max == nb - 1);
+    }
+
+    REQUIRE_THROWS_AS(soa::transform(policy, vec.pos, [] (float pos, float) { return pos; }, vec.speed, soa::vector<parallel_user::body>{}.pos),
+        std::invalid_argument);
+}
+
+TEST_CASE("soa::execution::par runs the tasks on shared threads", "[parallel]") {
+    auto vec = soa_tests::make_rows<soa::vector<parallel_user::body>>(10'000, body_row);
+    auto const policy = soa::execution::par.with_workers(4).with_chunk_rows(16);
+
+    auto mutex = std::mutex{};
+    auto threads = std::set<std::thread::id>{};
+    for (int i = 0; i < 20; ++i) {
+        soa::for_each(policy, vec.id, [&] (int&) {
+            std::lock_guard<std::mutex> lock{ mutex };
+            threads.insert(std::this_thread::get_id());
+        });
+    }
+    REQUIRE(threads.size() <= std::max(1u, std::thread::hardware_concurrency()));
+}
+
+TEST_CASE("parallel algorithms propagate exceptions", "[parallel]") {
+    auto vec = soa_tests::make_rows<soa::vector<parallel_user::body>>(4'000, body_row);
+    auto pool = thread_pool{ 2 };
+    auto const policy = soa::execution::par.on(pool).with_workers(3).with_chunk_rows(16);
+
+    REQUIRE_THROWS_AS(soa::for_each(policy, vec.id, [] (int id) {
+        if (id == 1234) throw std::runtime_error{ "failure" };
+    }), std::runtime_error);
+}
+
+#if defined(__cpp_lib_execution)
+TEST_CASE("standard execution policies are accepted", "[parallel]") {
+    auto vec = soa_tests::make_rows<soa::vector<parallel_user::body>>(3'000, body_row);
+    soa::for_each(std::execution::par, vec.speed, [] (float& speed) { speed = 1.f; });
+    auto const sum = soa::reduce(std::execution::seq, vec.speed, 0.f, std::plus<>{}, [] (float speed) { return speed; });
+    REQUIRE(sum == 3'000.f);
+}
+#endif
@@ -0,0 +1,116 @@
+
+#define SOA_SIMD_RUNTIME_DISPATCH
+#include "catch.hpp"
+#include "../soa_query.hpp"
+#include "test_rows.hpp"
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace query_user {
+    struct order {
+        float       price;
+        int         quantity;
+        bool        paid;
+        std::string client;
+    };
+}
+SOA_DEFINE_TYPE(query_user::order, price, quantity, (paid, soa::packed<>), client);
+
+namespace {
+    // Not a multiple of the 64 rows of the mask words.
+    constexpr int orders_count = 1000;
+
+    query_user::order order_row(int i) {
+        return { static_cast<float>(i % 100), i % 7, i % 2 == 0, std::to_string(i) };
+    }
+
+    template <class Pred>
+    soa::selection expected_rows(Pred&& pred) {
+        auto result = soa::selection{};
+        for (int i = 0; i < orders_count; ++i) {
+            if (pred(i)) result.push_back(i);
+        }
+        return result;
+    }
+}
+
+TEST_CASE("selections of rows from predicates on columns", "[query]") {
+    auto const orders = soa_tests::make_rows<soa::vector<query_user::order>>(orders_count, order_row);
+    auto const expensive = [] (int i) { return i % 100 >= 90; };
+
+    for (auto set : { soa::simd::isa::scalar, soa::simd::detect_isa() }) {
+        soa::simd::set_isa(set);
+
+        auto const rows = soa::select([] (float price) { return price >= 90.f; }, orders.price);
+        REQUIRE(rows == expected_rows(expensive));
+
+        // The predicates can combine several columns, including packed ones.
+        auto const big = soa::select([] (float price, int quantity, bool paid) {
+            return price >= 90.f && quantity > 3 && !paid;
+        }, orders.price, orders.quantity, orders.paid);
+        REQUIRE(big == expected_rows([&] (int i) { return expensive(i) && i % 7 > 3 && i % 2 != 0; }));
+
+        auto const mask = soa::select_mask([] (float price) { return price >= 90.f; }, orders.price);
+        REQUIRE(mask.size() == orders_count);
+        REQUIRE(mask.count() == static_cast<soa::size_type>(rows.size()));
+        REQUIRE(mask.indices() == rows);
+        REQUIRE(mask[999]);
+        REQUIRE_FALSE(mask[989]);
+    }
+    soa::simd::set_isa(soa::simd::detect_isa());
+
+    REQUIRE(soa::select([] (int) { return false; }, orders.quantity).empty());
+    REQUIRE(soa::select([] (int) { return true; }, orders.quantity).size() == orders_count);
+    REQUIRE(soa::select([] (int) { return true; }, std::vector<int>{}).empty());
+    auto const prices = std::vector<float>(10);
+    CHECK_THROWS_AS(soa::select([] (float, int) { return true; }, prices, orders.quantity), std::invalid_argument);
+}
+
+TEST_CASE("row masks are combined and refined", "[query]") {
+    auto const orders = soa_tests::make_rows<soa::vector<query_user::order>>(orders_count, order_row);
+    auto const cheap = soa::select_mask([] (float price) { return price < 10.f; }, orders.price);
+    auto const paid = soa::select_mask([] (bool paid) { return paid; }, orders.paid);
+
+    REQUIRE((cheap & paid).indices() == expected_rows([] (int i) { return i % 100 < 10 && i % 2 == 0; }));
+    REQUIRE((cheap | paid).count() == 550);
+    auto const unpaid = ~paid;
+    REQUIRE(unpaid.count() == 500);
+    REQUIRE(unpaid.words()[unpaid.words_count() - 1] >> (orders_count % 64) == 0);
+
+    auto mask = soa::row_mask{ 70, true };
+    REQUIRE(mask.count() == 70);
+    mask.set(3, false);
+    REQUIRE_FALSE(mask[3]);
+    REQUIRE(mask.count() == 69);
+    CHECK_THROWS_AS(mask &= cheap, std::invalid_argument);
+
+    // Refining reads only the selected rows.
+    auto const rows = cheap.indices();
+    auto const refined = soa::refine(rows, [] (int quantity, std::string const& client) {
+        return quantity == 0 && client.size() == 3;
+    }, orders.quantity, orders.client);
+    REQUIRE(refined == expected_rows([] (int i) { return i % 100 < 10 && i % 7 == 0 && i >= 100; }));
+}
+
+TEST_CASE("gathers and reductions on the selected rows", "[query]") {
+    auto const orders = soa_tests::make_rows<soa::vector<query_user::order>>(orders_count, order_row);
+    auto const rows = soa::select([] (int quantity) { return quantity == 6; }, orders.quantity);
+    auto const mask = soa::select_mask([] (int quantity) { return quantity == 6; }, orders.quantity);
+
+    auto const clients = soa::gather(orders.client, rows);
+    REQUIRE(clients.size() == rows.size());
+    REQUIRE(clients[0] == "6");
+    REQUIRE(clients[1] == "13");
+    REQUIRE(soa::gather(orders.client, mask) == clients);
+    auto prices = std::vector<float>(rows.size());
+    REQUIRE(soa::gather(orders.price, rows, prices.begin()) == prices.end());
+    REQUIRE(prices[2] == 20.f);
+
+    auto expected = 0.;
+    for (auto const i : rows) expected += orders.price[i] * orders.quantity[i];
+    auto const total = [] (float price, int quantity) { return static_cast<double>(price) * quantity; };
+    REQUIRE(soa::reduce_selected(rows, 0., std::plus<>{}, total, orders.price, orders.quantity) == expected);
+    REQUIRE(soa::reduce_selected(mask, 0., std::plus<>{}, total, orders.price, orders.quantity) == expected);
+    REQUIRE(soa::reduce_selected(soa::selection{}, 1, std::plus<>{}, [] (int q) { return q; }, orders.quantity) == 1);
+}
@@ -0,0 +1,120 @@
+
+#define SOA_SIMD_RUNTIME_DISPATCH
+#include "catch.hpp"
+#include "../soa_simd.hpp"
+#include "test_rows.hpp"
+#include <functional>
+#include <vector>
+
+namespace simd_user {
+    struct body {
+        float  pos;
+        float  speed;
+        double mass;
+        int    id;
+    };
+}
+SOA_DEFINE_TYPE(simd_user::body, pos, speed, mass, id);
+
+namespace {
+    // Instruction sets supported by the CPU, for which the kernels are tested.
+    std::vector<soa::simd::isa> supported_isas() {
+        using soa::simd::isa;
+        auto result = std::vector<isa>{ isa::scalar };
+        auto const best = soa::simd::detect_isa();
+        if (best == isa::neon) result.push_back(isa::neon);
+        for (auto set : { isa::sse2, isa::avx2, isa::avx512 }) {
+            if (best != isa::neon && set <= best) result.push_back(set);
+        }
+        return result;
+    }
+
+    simd_user::body body_row(int i) {
+        return { static_cast<float>(i), 2.f, static_cast<double>(i % 7), i };
+    }
+}
+
+TEST_CASE("simd_transform updates a column with batches and scalars", "[simd]") {
+    auto vec = soa::vector<simd_user::body>{};
+    auto const previous = soa::simd::active_isa();
+
+    for (auto set : supported_isas()) {
+        soa::simd::set_isa(set);
+        for (int nb : { 0, 1, 3, 17, 100 }) {
+            vec = soa_tests::make_rows<decltype(vec)>(nb, body_row);
+            soa::simd_transform(vec.pos, [] (auto pos, auto speed) {
+                return pos + speed * 0.5f;
+            }, vec.pos, vec.speed);
+
+            for (int i = 0; i < nb; ++i)
+                REQUIRE(vec.pos[i] == static_cast<float>(i) + 1.f);
+        }
+    }
+    soa::simd::set_isa(previous);
+}
+
+TEST_CASE("simd_transform takes columns of different types", "[simd]") {
+    auto vec = soa_tests::make_rows<soa::vector<simd_user::body>>(45, body_row);
+    auto const previous = soa::simd::active_isa();
+
+    for (auto set : supported_isas()) {
+        soa::simd::set_isa(set);
+        soa::simd_transform(vec.mass, [] (auto mass, auto id) {
+            return mass * 2. + soa::simd::cast<double>(id);
+        }, vec.mass, vec.id);
+        soa::simd_transform(vec.mass, [] (auto mass, auto id) {
+            return (mass - soa::simd::cast<double>(id)) / 2.;
+        }, vec.mass, vec.id);
+    }
+    soa::simd::set_isa(previous);
+
+    for (int i = 0; i < 45; ++i)
+        REQUIRE(vec.mass[i] == static_cast<double>(i % 7));
+}
+
+TEST_CASE("simd_transform uses aligned columns of simd layouts", "[simd]") {
+    auto vec = soa_tests::make_rows<soa::vector<simd_user::body, std::allocator<simd_user::body>, soa::simd_layout<64>>>(33, body_row);
+
+    REQUIRE(soa::simd::detail::aligned_head<16>(vec.pos.data(), vec.speed.data()) == 0);
+    REQUIRE(soa::simd::detail::aligned_head<8>(vec.pos.data(), vec.mass.data()) == 0);
+
+    soa::simd_transform(vec.speed, [] (auto speed) { return -speed; }, vec.speed);
+    for (auto speed : vec.speed)
+        REQUIRE(speed == -2.f);
+}
+
+TEST_CASE("simd_reduce reduces batches then lanes", "[simd]") {
+    auto vec = soa::vector<simd_user::body>{};
+    auto const previous = soa::simd::active_isa();
+
+    for (auto set : supported_isas()) {
+        soa::simd::set_isa(set);
+        for (int nb : { 0, 2, 31, 64, 99 }) {
+            vec = soa_tests::make_rows<decltype(vec)>(nb, body_row);
+            auto const sum = soa::simd_reduce(0, std::plus<>{}, [] (auto id) { return id; }, vec.id);
+            REQUIRE(sum == nb * (nb - 1) / 2);
+
+            auto const dot = soa::simd_reduce(0.f, std::plus<>{}, [] (auto pos, auto speed) {
+                return pos * speed;
+            }, vec.pos, vec.speed);
+            REQUIRE(dot == static_cast<float>(nb * (nb - 1)));
+
+            auto const max = soa::simd_reduce(-1., [] (auto lhs, auto rhs) {
+                return soa::simd::max(lhs, rhs);
+            }, [] (auto mass) { return mass; }, vec.mass);
+            REQUIRE(max == (nb == 0 ? -1. : static_cast<double>(std::min(nb - 1, 6))));
+        }
+    }
+    soa::simd::set_isa(previous);
+}
+
+TEST_CASE("simd kernels reject spans of different sizes", "[simd]") {
+    auto vec = soa_tests::make_rows<soa::vector<simd_user::body>>(5, body_row);
+    auto other = soa_tests::make_rows<soa::vector<simd_user::body>>(4, body_row);
+
+    REQUIRE_THROWS_AS(soa::simd_transform(vec.pos, [] (auto pos) { return pos; }, other.pos),
+        std::invalid_argument);
+    REQUIRE_THROWS_AS(soa::simd_reduce(0.f, std::plus<>{}, [] (auto pos, auto speed) {
+        return pos + speed;
+    }, vec.pos, other.speed), std::invalid_argument);
+}
@@ -0,0 +1,152 @@
+
+#include "catch.hpp"
+#include "../soa_snapshot.hpp"
+#include "test_rows.hpp"
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace snapshot_user {
+    struct quote {
+        double      price;
+        int         volume;
+        std::string name;
+    };
+}
+SOA_DEFINE_TYPE(snapshot_user::quote, price, volume, name);
+
+namespace {
+    using quotes = soa::cow_vector<snapshot_user::quote, 64>;
+
+    snapshot_user::quote quote_row(int i) {
+        return { 1. * i, i, "quote " + std::to_string(i) };
+    }
+}
+
+TEST_CASE("cow vectors store their rows in column pages", "[snapshot]") {
+    auto vec = soa_tests::make_rows<quotes>(150, quote_row);
+    REQUIRE(vec.size() == 150);
+    REQUIRE(vec.pages_count() == 3);
+    REQUIRE(vec[70].volume == 70);
+    REQUIRE(vec.at(149).name == "quote 149");
+    REQUIRE_THROWS_AS(vec.at(150), std::out_of_range);
+    REQUIRE(vec.get<0>(3) == 3.);
+    REQUIRE(vec.page<1>(2).size() == 150 - 128);
+    REQUIRE(vec.page<1>(1)[0] == 64);
+
+    auto sum = 0;
+    for (auto const q : vec) sum += q.volume;
+    REQUIRE(sum == 149 * 150 / 2);
+
+    vec.get_mutable<1>(5) = -5;
+    vec.get_mutable(6, &snapshot_user::quote::name) = "six";
+    for (auto& price : vec.mutable_page<0>(2)) price = 0.;
+    REQUIRE(vec[5].volume == -5);
+    REQUIRE(vec[6].name == "six");
+    REQUIRE(vec.back().price == 0.);
+
+    vec.emplace_back(1.);
+    REQUIRE(vec.back().name.empty());
+    vec.pop_back();
+    vec.pop_back();
+    REQUIRE(vec.size() == 149);
+    REQUIRE(vec.back().name == "quote 148");
+
+    vec.clear();
+    REQUIRE(vec.empty());
+    vec.push_back({ 1., 2, "again" });
+    REQUIRE(vec.front().name == "again");
+}
+
+TEST_CASE("cow vectors copy only the modified pages of the snapshots", "[snapshot]") {
+    auto vec = soa_tests::make_rows<quotes>(150, quote_row);
+    auto const snap = vec.snapshot();
+    REQUIRE(snap.size() == 150);
+    REQUIRE(snap.page<0>(1).data() == vec.page<0>(1).data());
+
+    // Modifying a price copies it's page, but not the other pages or columns.
+    vec.get_mutable<0>(70) = -1.;
+    REQUIRE(snap[70].price == 70.);
+    REQUIRE(vec[70].price == -1.);
+    REQUIRE(snap.page<0>(1).data() != vec.page<0>(1).data());
+    REQUIRE(snap.page<0>(0).data() == vec.page<0>(0).data());
+    REQUIRE(snap.page<1>(1).data() == vec.page<1>(1).data());
+    REQUIRE(snap.page<2>(1).data() == vec.page<2>(1).data());
+
+    // The page is modified in place once it's copied.
+    auto const page = vec.page<0>(1).data();
+    vec.get_mutable<0>(71) = -1.;
+    REQUIRE(vec.page<0>(1).data() == page);
+
+    // The rows added and removed are not seen by the snapshot.
+    vec.pop_back();
+    vec.push_back({ 0., 0, "new" });
+    vec.push_back({ 0., 0, "new" });
+    REQUIRE(snap.size() == 150);
+    REQUIRE(snap.back().name == "quote 149");
+    REQUIRE(vec.size() == 151);
+
+    // The copies share the pages as the snapshots.
+    auto copy = vec;
+    copy.get_mutable<2>(0) = "copy";
+    REQUIRE(vec[0].name == "quote 0");
+    REQUIRE(copy.page<2>(1).data() == vec.page<2>(1).data());
+
+    // The snapshots keep their pages after the vector is cleared.
+    auto const second = vec.snapshot();
+    vec.clear();
+    copy = quotes{};
+    REQUIRE(second.size() == 151);
+    REQUIRE(second[70].price == -1.);
+    REQUIRE(second.at(150).name == "new");
+    REQUIRE(snap[150 - 1].volume == 149);
+
+    auto empty = quotes::snapshot_type{};
+    REQUIRE(empty.empty());
+    REQUIRE(empty.begin() == empty.end());
+}
+
+TEST_CASE("cow vectors snapshots are read from other threads", "[snapshot]") {
+    constexpr int rows = 300;
+    constexpr int versions = 200;
+    auto vec = quotes{};
+    for (int i = 0; i < rows; ++i) vec.push_back({ 0., 0, "name" });
+
+    // The writer publishes a snapshot for each version, in which all the rows have the same version.
+    auto mutex = std::mutex{};
+    auto published = vec.snapshot();
+    auto errors = std::atomic<int>{ 0 };
+    auto const read = [&] {
+        for (auto last = 0; last < versions;) {
+            auto snap = quotes::snapshot_type{};
+            {
+                auto lock = std::lock_guard<std::mutex>{ mutex };
+                snap = published;
+            }
+            auto const version = snap[0].volume;
+            for (soa::size_type p = 0; p < snap.pages_count(); ++p) {
+                for (auto const volume : snap.page<1>(p)) errors += volume != version;
+                for (auto const price : snap.page<0>(p)) errors += price != 2. * version;
+            }
+            errors += version < last;
+            last = version;
+        }
+    };
+    auto readers = std::vector<std::thread>{};
+    for (int i = 0; i < 2; ++i) readers.emplace_back(read);
+
+    for (int version = 1; version <= versions; ++version) {
+        for (soa::size_type p = 0; p < vec.pages_count(); ++p) {
+            for (auto& volume : vec.mutable_page<1>(p)) volume = version;
+            for (auto& price : vec.mutable_page<0>(p)) price = 2. * version;
+        }
+        auto snap = vec.snapshot();
+        auto lock = std::lock_guard<std::mutex>{ mutex };
+        published.swap(snap);
+    }
+    for (auto& reader : readers) reader.join();
+    REQUIRE(errors == 0);
+    REQUIRE(published.page<2>(4).data() == vec.page<2>(4).data());
+}
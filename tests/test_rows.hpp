@@ -0,0 +1,15 @@
+
+#pragma once
+
+// Rows generation shared by the tests of the containers.
+namespace soa_tests {
+
+    // Container holding the rows 'make_row(0)' to 'make_row(nb - 1)'.
+    template <class Container, class F>
+    Container make_rows(int nb, F&& make_row) {
+        auto result = Container{};
+        for (int i = 0; i < nb; ++i) result.push_back(make_row(i));
+        return result;
+    }
+
+}
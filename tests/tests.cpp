@@ -1,7 +1,9 @@
 
 #define CATCH_CONFIG_MAIN
+#define CATCH_CONFIG_NO_POSIX_SIGNALS
 #include "catch.hpp"
 #include "../soa_vector.hpp"
+#include "../soa_memory.hpp"
 
 // Utility functions.
 // Scroll to the bottom to have friendly code.
@@ -121,6 +123,54 @@ struct movable {
 };
 SOA_DEFINE_TYPE(movable, ptr);
 
+// More members than the overloads of the previous 'as_tuple' implementation.
+struct wide {
+    int a0, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11;
+    double b0, b1, b2, b3, b4, b5, b6, b7, b8, b9, b10;
+    std::string name;
+};
+SOA_DEFINE_TYPE(wide, a0, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11,
+    (b0, soa::align<64>), b1, b2, b3, b4, b5, b6, b7, b8, b9, b10, name);
+
+// The maximum number of members of SOA_DEFINE_TYPE.
+struct widest {
+    int
+        m0, m1, m2, m3, m4, m5, m6, m7, m8, m9, m10, m11, m12, m13, m14, m15, m16, m17, m18, m19, m20, m21,
+        m22, m23, m24, m25, m26, m27, m28, m29, m30, m31, m32, m33, m34, m35, m36, m37, m38, m39, m40, m41,
+        m42, m43, m44, m45, m46, m47, m48, m49, m50, m51, m52, m53, m54, m55, m56, m57, m58, m59, m60, m61,
+        m62, m63, m64, m65, m66, m67, m68, m69, m70, m71, m72, m73, m74, m75, m76, m77, m78, m79, m80, m81,
+        m82, m83, m84, m85, m86, m87, m88, m89, m90, m91, m92, m93, m94, m95, m96, m97, m98, m99, m100, m101,
+        m102, m103, m104, m105, m106, m107, m108, m109, m110, m111, m112, m113, m114, m115, m116, m117, m118,
+        m119, m120, m121, m122, m123, m124, m125, m126, m127, m128, m129, m130, m131, m132, m133, m134, m135,
+        m136, m137, m138, m139, m140, m141, m142, m143, m144, m145, m146, m147, m148, m149, m150, m151, m152,
+        m153, m154, m155, m156, m157, m158, m159, m160, m161, m162, m163, m164, m165, m166, m167, m168, m169,
+        m170, m171, m172, m173, m174, m175, m176, m177, m178, m179, m180, m181, m182, m183, m184, m185, m186,
+        m187, m188, m189, m190, m191, m192, m193, m194, m195, m196, m197, m198, m199, m200, m201, m202, m203,
+        m204, m205, m206, m207, m208, m209, m210, m211, m212, m213, m214, m215, m216, m217, m218, m219, m220,
+        m221, m222, m223, m224, m225, m226, m227, m228, m229, m230, m231, m232, m233, m234, m235, m236, m237,
+        m238, m239, m240, m241, m242, m243, m244, m245, m246, m247, m248, m249, m250, m251, m252, m253;
+};
+SOA_DEFINE_TYPE(widest,
+    m0, m1, m2, m3, m4, m5, m6, m7, m8, m9, m10, m11, m12, m13, m14, m15, m16, m17, m18, m19, m20, m21, m22,
+    m23, m24, m25, m26, m27, m28, m29, m30, m31, m32, m33, m34, m35, m36, m37, m38, m39, m40, m41, m42, m43,
+    m44, m45, m46, m47, m48, m49, m50, m51, m52, m53, m54, m55, m56, m57, m58, m59, m60, m61, m62, m63, m64,
+    m65, m66, m67, m68, m69, m70, m71, m72, m73, m74, m75, m76, m77, m78, m79, m80, m81, m82, m83, m84, m85,
+    m86, m87, m88, m89, m90, m91, m92, m93, m94, m95, m96, m97, m98, m99, m100, m101, m102, m103, m104, m105,
+    m106, m107, m108, m109, m110, m111, m112, m113, m114, m115, m116, m117, m118, m119, m120, m121, m122,
+    m123, m124, m125, m126, m127, m128, m129, m130, m131, m132, m133, m134, m135, m136, m137, m138, m139,
+    m140, m141, m142, m143, m144, m145, m146, m147, m148, m149, m150, m151, m152, m153, m154, m155, m156,
+    m157, m158, m159, m160, m161, m162, m163, m164, m165, m166, m167, m168, m169, m170, m171, m172, m173,
+    m174, m175, m176, m177, m178, m179, m180, m181, m182, m183, m184, m185, m186, m187, m188, m189, m190,
+    m191, m192, m193, m194, m195, m196, m197, m198, m199, m200, m201, m202, m203, m204, m205, m206, m207,
+    m208, m209, m210, m211, m212, m213, m214, m215, m216, m217, m218, m219, m220, m221, m222, m223, m224,
+    m225, m226, m227, m228, m229, m230, m231, m232, m233, m234, m235, m236, m237, m238, m239, m240, m241,
+    m242, m243, m244, m245, m246, m247, m248, m249, m250, m251, m252, m253);
+
+struct byte_row {
+    char value;
+};
+SOA_DEFINE_TYPE(byte_row, value);
+
 // Tests
 
 TEST_CASE("generic comparisons against std::vector") {
@@ -128,6 +178,47 @@ TEST_CASE("generic comparisons against std::vector") {
     test_vector(person{ "Sid", 22, true });
 }
 
+TEST_CASE("aggregates with many members") {
+    static_assert(soa::vector<wide>::components_count == 24);
+    test_vector(wide{ 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 0.5, 1.5, 2.5, 3.5, 4.5, 5.5, 6.5, 7.5, 8.5, 9.5, 10.5, "wide" });
+
+    auto v = soa::vector<wide>{};
+    v.emplace_back(1, 2, 3);
+    v.emplace_back(4);
+    REQUIRE(v.a2[0] == 3);
+    REQUIRE(v.a2[1] == 0);
+    REQUIRE(v.b10[0] == 0.);
+    REQUIRE(v.name[1].empty());
+    REQUIRE(reinterpret_cast<std::uintptr_t>(v.b0.data()) % 64 == 0);
+
+    v[1].b10 = 42.;
+    v[1].name = "name";
+    auto const row = static_cast<wide>(v[1]);
+    REQUIRE(row.a0 == 4);
+    REQUIRE(row.b10 == 42.);
+    REQUIRE(row.name == "name");
+    REQUIRE(std::get<23>(soa::detail::as_tuple<24>(row)) == "name");
+}
+
+TEST_CASE("aggregates with the maximum number of members") {
+    static_assert(soa::vector<widest>::components_count == 254);
+    auto v = soa::vector<widest>{};
+    v.emplace_back(1, 2);
+    auto row = widest{};
+    row.m0 = 3;
+    row.m253 = 4;
+    v.push_back(row);
+    REQUIRE(v.m1[0] == 2);
+    REQUIRE(v.m253[0] == 0);
+    REQUIRE(v.m253[1] == 4);
+
+    v[0].m200 = 5;
+    auto const copy = static_cast<widest>(v[0]);
+    REQUIRE(copy.m0 == 1);
+    REQUIRE(copy.m200 == 5);
+    REQUIRE(soa::detail::member_name_v<widest, 253> == std::string_view{ "m253" });
+}
+
 TEST_CASE("move-only types") {
     auto v2 = soa::vector<movable>{};
     auto v1 = std::move(v2);
@@ -190,6 +281,30 @@ TEST_CASE("iteration on proxies") {
     REQUIRE(ages == ages_3);
 }
 
+TEST_CASE("proxy iterators are random access") {
+    auto vec = soa::vector<user::physics>{};
+    for (int i = 0; i < 5; ++i) vec.push_back({ 0.f, 0.f, 0.f, i });
+
+    using iterator = decltype(vec)::iterator;
+    static_assert(std::is_same_v<std::iterator_traits<iterator>::difference_type, std::ptrdiff_t>);
+    static_assert(std::is_same_v<std::iterator_traits<iterator>::iterator_category, std::random_access_iterator_tag>);
+
+    auto it = vec.begin();
+    auto const old = it++;
+    REQUIRE(old == vec.begin());
+    REQUIRE(it - old == 1);
+    REQUIRE((*it--).id == 1);
+    REQUIRE(it == vec.begin());
+
+    REQUIRE(it[3].id == 3);
+    REQUIRE((*(2 + it)).id == 2);
+    REQUIRE(std::distance(vec.cbegin(), vec.cend()) == 5);
+    REQUIRE(std::find_if(vec.begin(), vec.end(), [] (auto p) { return p.id == 4; }) - vec.begin() == 4);
+
+    auto const empty = iterator{};
+    REQUIRE(empty == iterator{});
+}
+
 TEST_CASE("'at(index)' throws correctly") {
     auto persons = soa::vector<person>{};
     persons.emplace_back("Bob", 12);
@@ -232,3 +347,1236 @@ TEST_CASE("conditions not covered previously") {
     REQUIRE(v1.size() == 2);
     REQUIRE(v1.capacity() == 3);
 }
+
+// Allocator counting the bytes currently allocated by all its rebinds.
+inline long allocated_bytes = 0;
+
+template <class T>
+struct counting_allocator {
+    using value_type = T;
+
+    counting_allocator() = default;
+    template <class U>
+    counting_allocator(counting_allocator<U> const&) noexcept {}
+
+    T* allocate(size_t n) {
+        allocated_bytes += static_cast<long>(n * sizeof(T));
+        return std::allocator<T>{}.allocate(n);
+    }
+    void deallocate(T* ptr, size_t n) noexcept {
+        allocated_bytes -= static_cast<long>(n * sizeof(T));
+        std::allocator<T>{}.deallocate(ptr, n);
+    }
+    bool operator==(counting_allocator const&) const noexcept { return true; }
+    bool operator!=(counting_allocator const&) const noexcept { return false; }
+};
+
+// Allocator using a static buffer, which can grow the last allocation in place.
+namespace arena {
+    alignas(std::max_align_t) inline std::byte buffer[1024];
+    inline size_t used = 0;
+    inline std::byte* last = nullptr;
+}
+
+template <class T>
+struct arena_allocator {
+    using value_type = T;
+
+    arena_allocator() = default;
+    template <class U>
+    arena_allocator(arena_allocator<U> const&) noexcept {}
+
+    T* allocate(size_t n) {
+        using namespace arena;
+        used = (used + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+        if (used + n * sizeof(T) > sizeof(buffer)) throw std::bad_alloc{};
+        last = buffer + used;
+        used += n * sizeof(T);
+        return reinterpret_cast<T*>(last);
+    }
+    void deallocate(T*, size_t) noexcept {}
+    bool expand(T* ptr, size_t n, size_t new_n) noexcept {
+        using namespace arena;
+        auto const bytes = reinterpret_cast<std::byte*>(ptr);
+        if (bytes != last || bytes + new_n * sizeof(T) > buffer + sizeof(buffer)) return false;
+        used += (new_n - n) * sizeof(T);
+        return true;
+    }
+    bool operator==(arena_allocator const&) const noexcept { return true; }
+    bool operator!=(arena_allocator const&) const noexcept { return false; }
+};
+
+// Copy constructor throws when 'copies_left' reaches zero, move constructor can throw.
+struct fragile_int {
+    static inline int copies_left = -1;
+    int value;
+
+    fragile_int(int v = 0) : value{ v } {}
+    fragile_int(fragile_int const& rhs) : value{ rhs.value } {
+        if (copies_left-- == 0) throw std::runtime_error{ "copy failed" };
+    }
+    fragile_int(fragile_int && rhs) : value{ rhs.value } {}
+    fragile_int& operator=(fragile_int const&) = default;
+};
+
+struct fragile {
+    std::string name;
+    fragile_int number;
+};
+SOA_DEFINE_TYPE(fragile, name, number);
+
+TEST_CASE("growth releases the previous allocation") {
+    using allocator = counting_allocator<person>;
+    {
+        auto persons = soa::vector<person, allocator>{};
+        for (int i = 0; i < 100; ++i) {
+            persons.emplace_back(std::to_string(i), i);
+        }
+        auto const bytes = allocated_bytes;
+        REQUIRE(bytes > 0);
+
+        persons.reserve(200);
+        REQUIRE(allocated_bytes > bytes);
+
+        persons.resize(10);
+        persons.shrink_to_fit();
+        REQUIRE(persons.capacity() == 10);
+        REQUIRE(allocated_bytes < bytes);
+        for (int i = 0; i < 10; ++i) {
+            REQUIRE(persons.name[i] == std::to_string(i));
+            REQUIRE(persons.age[i] == i);
+        }
+
+        persons.clear();
+        persons.shrink_to_fit();
+        REQUIRE(persons.capacity() == 0);
+        REQUIRE(allocated_bytes == 0);
+
+        persons.emplace_back("Bob", 12);
+    }
+    REQUIRE(allocated_bytes == 0);
+}
+
+TEST_CASE("growth gives the strong exception guarantee") {
+    auto v = soa::vector<fragile>{};
+    v.reserve(4);
+    for (int i = 0; i < 4; ++i) {
+        v.emplace_back(std::to_string(i), i);
+    }
+    auto const name_ptr = v.name.data();
+
+    fragile_int::copies_left = 2;
+    CHECK_THROWS_AS(v.reserve(8), std::runtime_error);
+    fragile_int::copies_left = -1;
+
+    REQUIRE(v.size() == 4);
+    REQUIRE(v.capacity() == 4);
+    REQUIRE(v.name.data() == name_ptr);
+    for (int i = 0; i < 4; ++i) {
+        REQUIRE(v.name[i] == std::to_string(i));
+        REQUIRE(v.number[i].value == i);
+    }
+
+    v.reserve(8);
+    REQUIRE(v.capacity() == 8);
+    REQUIRE(v.name[3] == "3");
+    REQUIRE(v.number[3].value == 3);
+}
+
+// Counts the live objects and the constructions, with a trivially relocatable variant.
+inline int counted_live = 0;
+inline int counted_constructions = 0;
+
+template <bool Relocatable>
+struct counted {
+    int value;
+    counted(int value = 0) noexcept : value{ value } { ++counted_live; ++counted_constructions; }
+    counted(counted const& rhs) noexcept : counted{ rhs.value } {}
+    counted(counted&& rhs) noexcept : counted{ rhs.value } {}
+    counted& operator=(counted const&) = default;
+    ~counted() { --counted_live; }
+};
+template <>
+struct soa::is_trivially_relocatable<counted<true>> : std::true_type {};
+
+struct relocated {
+    counted<true> c;
+};
+SOA_DEFINE_TYPE(relocated, c);
+
+struct moved {
+    counted<false> c;
+};
+SOA_DEFINE_TYPE(moved, c);
+
+TEST_CASE("growth relocates the trivially relocatable columns") {
+    static_assert(soa::is_trivially_relocatable_v<std::unique_ptr<int>>);
+    static_assert(!std::is_trivially_copyable_v<counted<true>>);
+    counted_constructions = 0;
+    {
+        // The objects are memmoved instead of being moved then destroyed.
+        auto v = soa::vector<relocated>{};
+        for (int i = 0; i < 100; ++i) v.emplace_back(i);
+        v.reserve(1000);
+        v.resize(50);
+        v.shrink_to_fit();
+        REQUIRE(v.capacity() == 50);
+        REQUIRE(counted_live == 50);
+        REQUIRE(counted_constructions == 100);
+        for (int i = 0; i < 50; ++i) REQUIRE(v.c[i].value == i);
+
+        auto const copy = v;
+        REQUIRE(counted_live == 100);
+        REQUIRE(copy.c[49].value == 49);
+    }
+    REQUIRE(counted_live == 0);
+
+    counted_constructions = 0;
+    {
+        // The other objects are destroyed after being moved.
+        auto v = soa::vector<moved>{};
+        for (int i = 0; i < 100; ++i) v.emplace_back(i);
+        v.reserve(1000);
+        REQUIRE(counted_live == 100);
+        REQUIRE(counted_constructions > 200);
+        for (int i = 0; i < 100; ++i) REQUIRE(v.c[i].value == i);
+    }
+    REQUIRE(counted_live == 0);
+
+    {
+        // Move-only columns survive the relocations.
+        auto v = soa::vector<movable>{};
+        for (int i = 0; i < 10; ++i) v.emplace_back(std::make_unique<int>(i));
+        auto const first = v.ptr[0].get();
+        v.reserve(100);
+        REQUIRE(v.ptr[0].get() == first);
+        v.shrink_to_fit();
+        REQUIRE(v.capacity() == 10);
+        auto moved_to = std::move(v);
+        REQUIRE(moved_to.ptr[0].get() == first);
+        for (int i = 0; i < 10; ++i) REQUIRE(*moved_to.ptr[i] == i);
+    }
+}
+
+TEST_CASE("growth expands in place when the allocator supports it") {
+    auto v = soa::vector<user::physics, arena_allocator<user::physics>>{};
+    v.reserve(4);
+    for (int i = 0; i < 4; ++i) {
+        v.push_back({ 1.f * i, 2.f * i, 3.f * i, i });
+    }
+    auto const data = v.pos.data();
+
+    v.reserve(16);
+    REQUIRE(v.capacity() == 16);
+    REQUIRE(v.pos.data() == data);
+    for (int i = 0; i < 4; ++i) {
+        REQUIRE(v.pos[i]   == 1.f * i);
+        REQUIRE(v.speed[i] == 2.f * i);
+        REQUIRE(v.acc[i]   == 3.f * i);
+        REQUIRE(v.id[i]    == i);
+    }
+}
+
+TEST_CASE("growth policies") {
+    auto v = soa::vector<user::physics, std::allocator<user::physics>, soa::layout<>, 0, soa::growth::one_and_half>{};
+    auto capacities = std::vector<int>{};
+    for (int i = 0; i < 20; ++i) {
+        v.push_back({ 1.f * i, 2.f, 3.f, i });
+        if (capacities.empty() || capacities.back() != v.capacity()) capacities.push_back(v.capacity());
+    }
+    REQUIRE(capacities == std::vector<int>{ 1, 2, 3, 4, 6, 9, 13, 19, 28 });
+    REQUIRE(v.id[19] == 19);
+
+    // The rows fitting in the last page are used.
+    using paged = soa::vector<user::physics, std::allocator<user::physics>, soa::layout<>, 0, soa::growth::pages_4k>;
+    auto p = paged{};
+    p.push_back({ 1.f, 2.f, 3.f, 4 });
+    REQUIRE(p.capacity() == 4096 / sizeof(user::physics));
+    p.reserve(300);
+    REQUIRE(p.capacity() == 8192 / sizeof(user::physics));
+    for (int i = 0; i < 1000; ++i) p.push_back({ 1.f, 2.f, 3.f, i });
+    REQUIRE((p.capacity() * sizeof(user::physics)) % 4096 == 0);
+    REQUIRE(p.id[500] == 499);
+
+    // With padded columns : 4 columns of 256 floats per page.
+    using padded = soa::vector<user::physics, std::allocator<user::physics>, soa::simd_layout<64>, 0, soa::growth::pages_4k>;
+    auto q = padded{};
+    q.push_back({ 1.f, 2.f, 3.f, 4 });
+    REQUIRE(q.capacity() == 256);
+    REQUIRE(q.id[0] == 4);
+}
+
+TEST_CASE("huge page allocator adaptor") {
+    using allocator = soa::huge_page_allocator<float>;
+    static_assert(!allocator::uses_huge_pages(1000));
+    static_assert(allocator::uses_huge_pages(soa::huge_page_size / sizeof(float)));
+
+    auto v = soa::vector<user::physics, soa::huge_page_allocator<user::physics>, soa::layout<>, 0, soa::growth::huge_pages>{};
+    v.push_back({ 1.f, 2.f, 3.f, 4 });
+    REQUIRE(v.capacity() == static_cast<int>(soa::huge_page_size / sizeof(user::physics)));
+    REQUIRE(reinterpret_cast<uintptr_t>(v.pos.data()) % soa::huge_page_size == 0);
+    v.resize(v.capacity() + 1);
+    REQUIRE(reinterpret_cast<uintptr_t>(v.pos.data()) % soa::huge_page_size == 0);
+    v.resize(10);
+    v.shrink_to_fit();
+    REQUIRE(v.capacity() == 10);
+    REQUIRE(v.pos[0] == 1.f);
+
+    // The sizes are checked before being rounded.
+    static_assert(allocator::uses_huge_pages(std::numeric_limits<size_t>::max() / 2));
+    REQUIRE_THROWS_AS(allocator{}.allocate(std::numeric_limits<size_t>::max() / 2), std::bad_array_new_length);
+}
+
+TEST_CASE("capacities beyond max_size are rejected") {
+    auto v = soa::vector<user::physics>{};
+    auto const max = v.max_size();
+    REQUIRE(max > 0);
+    REQUIRE(static_cast<uint64_t>(max) * sizeof(user::physics) <= std::numeric_limits<size_t>::max());
+
+    REQUIRE_THROWS_AS(v.reserve(max + 1), std::length_error);
+    REQUIRE_THROWS_AS(v.resize(max + 1), std::length_error);
+    REQUIRE(v.capacity() == 0);
+
+    // The byte count of the padded columns overflows before the rows count.
+    using padded = soa::vector<user::physics, std::allocator<user::physics>, soa::simd_layout<64>>;
+    auto p = padded{};
+    REQUIRE(p.max_size() <= max);
+    REQUIRE_THROWS_AS(p.reserve(std::numeric_limits<soa::size_type>::max()), std::length_error);
+
+    p.push_back({ 1.f, 2.f, 3.f, 4 });
+    REQUIRE_THROWS_AS(p.resize(std::numeric_limits<soa::size_type>::max()), std::length_error);
+    REQUIRE(p.size() == 1);
+    REQUIRE(p.id[0] == 4);
+}
+
+struct alignas(32) float8 {
+    float values[8];
+};
+
+namespace user {
+    struct particle {
+        float8 pos;
+        char   tag;
+        double mass;
+    };
+    struct aligned_physics {
+        float pos;
+        float speed;
+        float acc;
+        int   id;
+    };
+}
+SOA_DEFINE_TYPE(user::particle, pos, tag, mass);
+SOA_DEFINE_TYPE(user::aligned_physics, (pos, soa::align<128>), speed, (acc, soa::align<16>), id);
+
+template <class Span>
+bool is_aligned(Span const& span, size_t alignment) {
+    return reinterpret_cast<std::uintptr_t>(span.data()) % alignment == 0;
+}
+
+TEST_CASE("over-aligned member types") {
+    auto v = soa::vector<user::particle>{};
+    for (int i = 1; i < 20; ++i) {
+        v.emplace_back(float8{}, 'a', 1.0 * i);
+        REQUIRE(is_aligned(v.pos, 32));
+        REQUIRE(is_aligned(v.mass, alignof(double)));
+    }
+    REQUIRE(soa::vector<user::particle>::alignment == 32);
+    REQUIRE(v.mass[18] == 19.0);
+}
+
+TEST_CASE("layout policies align and pad the columns") {
+    using vector = soa::vector<user::physics, std::allocator<user::physics>, soa::simd_layout<64>>;
+    REQUIRE(vector::alignment == 64);
+
+    auto v = vector{};
+    for (int i = 0; i < 37; ++i) {
+        v.push_back({ 1.f * i, 2.f * i, 3.f * i, i });
+        REQUIRE(is_aligned(v.pos, 64));
+        REQUIRE(is_aligned(v.speed, 64));
+        REQUIRE(is_aligned(v.acc, 64));
+        REQUIRE(is_aligned(v.id, 64));
+    }
+    // Columns are padded to the vector width.
+    REQUIRE(v.speed.data() - v.pos.data() >= 16);
+    REQUIRE((v.speed.data() - v.pos.data()) % 16 == 0);
+
+    auto const copy = v;
+    REQUIRE(is_aligned(copy.acc, 64));
+    REQUIRE(copy.acc[36] == 3.f * 36);
+    REQUIRE(copy.id[36] == 36);
+}
+
+TEST_CASE("member options in SOA_DEFINE_TYPE") {
+    auto v = soa::vector<user::aligned_physics>{};
+    REQUIRE(soa::vector<user::aligned_physics>::alignment == 128);
+    for (int i = 0; i < 9; ++i) {
+        v.push_back({ 1.f * i, 2.f * i, 3.f * i, i });
+        REQUIRE(is_aligned(v.pos, 128));
+        REQUIRE(is_aligned(v.acc, 16));
+    }
+    user::aligned_physics const p = v[8];
+    REQUIRE(p.pos == 8.f);
+    REQUIRE(p.acc == 24.f);
+    REQUIRE(p.id == 8);
+}
+
+// Allocator counting the live allocations made with each id.
+inline int live_blocks[2] = {};
+
+template <class T>
+struct tagged_allocator {
+    using value_type = T;
+    int id = 0;
+
+    tagged_allocator() = default;
+    tagged_allocator(int id) noexcept : id{ id } {}
+    template <class U>
+    tagged_allocator(tagged_allocator<U> const& rhs) noexcept : id{ rhs.id } {}
+
+    T* allocate(size_t n) {
+        ++live_blocks[id];
+        return std::allocator<T>{}.allocate(n);
+    }
+    void deallocate(T* ptr, size_t n) noexcept {
+        --live_blocks[id];
+        std::allocator<T>{}.deallocate(ptr, n);
+    }
+    bool operator==(tagged_allocator const& rhs) const noexcept { return id == rhs.id; }
+    bool operator!=(tagged_allocator const& rhs) const noexcept { return id != rhs.id; }
+};
+
+TEST_CASE("huge page allocations are made by the base allocator") {
+    using allocator = soa::huge_page_allocator<float, tagged_allocator<float>>;
+    auto const a = allocator{ tagged_allocator<float>{ 1 } };
+    {
+        auto v = soa::vector<user::physics, allocator, soa::layout<>, 0, soa::growth::huge_pages>{ a };
+        v.push_back({ 1.f, 2.f, 3.f, 4 });
+        REQUIRE(live_blocks[1] == 1);
+        REQUIRE(reinterpret_cast<uintptr_t>(v.pos.data()) % soa::huge_page_size == 0);
+        v.resize(10);
+        v.shrink_to_fit();
+        REQUIRE(live_blocks[1] == 1);
+        REQUIRE(live_blocks[0] == 0);
+    }
+    REQUIRE(live_blocks[1] == 0);
+}
+
+namespace user {
+    struct entity {
+        float pos;
+        float speed;
+        std::string name;
+        int id;
+    };
+}
+SOA_DEFINE_TYPE(user::entity, pos, speed, (name, soa::group<1>), (id, soa::group<1>));
+
+TEST_CASE("column groups have their own allocation") {
+    using allocator = tagged_allocator<user::entity>;
+    using vector = soa::vector<user::entity, allocator>;
+    REQUIRE(vector::groups_count == 2);
+    REQUIRE(soa::vector<person>::groups_count == 1);
+    {
+        auto v = vector{{ allocator{ 0 }, allocator{ 1 } }};
+        REQUIRE(v.get_allocator(0).id == 0);
+        REQUIRE(v.get_allocator(1).id == 1);
+
+        for (int i = 0; i < 50; ++i) {
+            v.push_back({ 1.f * i, 2.f * i, std::to_string(i), i });
+            REQUIRE(live_blocks[0] == 1);
+            REQUIRE(live_blocks[1] == 1);
+        }
+        // Each group starts it's own allocation.
+        auto const hot_end  = reinterpret_cast<std::byte const*>(v.speed.data() + v.capacity());
+        auto const cold_ptr = reinterpret_cast<std::byte const*>(v.name.data());
+        REQUIRE(v.speed.data() - v.pos.data() == v.capacity());
+        REQUIRE((cold_ptr < reinterpret_cast<std::byte const*>(v.pos.data()) || cold_ptr >= hot_end));
+
+        for (int i = 0; i < 50; ++i) {
+            REQUIRE(v.pos[i]  == 1.f * i);
+            REQUIRE(v.name[i] == std::to_string(i));
+            REQUIRE(v.id[i]   == i);
+        }
+        user::entity const e = v[42];
+        REQUIRE(e.name == "42");
+        REQUIRE(e.speed == 84.f);
+
+        auto const copy = v;
+        REQUIRE(live_blocks[0] == 2);
+        REQUIRE(live_blocks[1] == 2);
+        REQUIRE(copy.name[49] == "49");
+
+        v.clear();
+        v.shrink_to_fit();
+        REQUIRE(live_blocks[0] == 1);
+        REQUIRE(live_blocks[1] == 1);
+    }
+    REQUIRE(live_blocks[0] == 0);
+    REQUIRE(live_blocks[1] == 0);
+}
+
+TEST_CASE("bulk append from aggregates and columns") {
+    auto const aos = std::vector<person>{
+        { "Bob", 12, true }, { "Alice", 13, false }, { "Chuck", 14, true }
+    };
+    auto persons = soa::vector<person>{};
+    persons.append(aos.begin(), aos.end());
+    REQUIRE(persons.size() == 3);
+    REQUIRE(persons.capacity() == 3);
+
+    auto const names = std::vector<std::string>{ "Dan", "Eve" };
+    auto const ages  = std::vector<int>{ 15, 16 };
+    bool const likes[] = { false, true };
+    persons.append_columns(names, ages, likes);
+    REQUIRE(persons.size() == 5);
+
+    auto const expected = std::vector<person>{
+        { "Bob", 12, true }, { "Alice", 13, false }, { "Chuck", 14, true },
+        { "Dan", 15, false }, { "Eve", 16, true }
+    };
+    for (int i = 0; i < 5; ++i) {
+        REQUIRE(persons.name[i]      == expected[i].name);
+        REQUIRE(persons.age[i]       == expected[i].age);
+        REQUIRE(persons.likes_cpp[i] == expected[i].likes_cpp);
+    }
+
+    auto const short_ages = std::vector<int>{ 1 };
+    CHECK_THROWS_AS(persons.append_columns(names, short_ages, likes), std::invalid_argument);
+    REQUIRE(persons.size() == 5);
+
+    // Appending from an other soa::vector uses the proxies.
+    auto copy = soa::vector<person>{};
+    copy.append(persons.cbegin(), persons.cend());
+    REQUIRE(copy.size() == 5);
+    REQUIRE(copy.name[4] == "Eve");
+    REQUIRE(copy.age[3] == 15);
+}
+
+TEST_CASE("conversions from and to arrays of aggregates") {
+    // More rows than a transposed block.
+    auto const nb = static_cast<int>(soa::detail::transpose_block_rows<user::physics>) * 2 + 10;
+    auto aos = std::vector<user::physics>{};
+    for (int i = 0; i < nb; ++i) aos.push_back({ 1.f * i, 2.f * i, 3.f * i, i });
+
+    auto vec = soa::from_aos(aos);
+    static_assert(std::is_same_v<decltype(vec), soa::vector<user::physics>>);
+    REQUIRE(vec.size() == nb);
+    REQUIRE(vec.capacity() == nb);
+    for (int i = 0; i < nb; ++i) {
+        REQUIRE(vec.pos[i] == 1.f * i);
+        REQUIRE(vec.acc[i] == 3.f * i);
+        REQUIRE(vec.id[i] == i);
+    }
+
+    auto out = std::vector<user::physics>(static_cast<size_t>(nb));
+    REQUIRE(soa::to_aos(vec, out.begin()) == out.end());
+    for (int i = 0; i < nb; ++i) {
+        REQUIRE(out[i].speed == 2.f * i);
+        REQUIRE(out[i].id == i);
+    }
+
+    // Only the selected members are copied.
+    for (auto& row : out) row = { -1.f, -1.f, -1.f, -1 };
+    soa::to_aos(vec, out.data(), &user::physics::pos, &user::physics::id);
+    REQUIRE(out[7].pos == 7.f);
+    REQUIRE(out[7].speed == -1.f);
+    REQUIRE(out[nb - 1].id == nb - 1);
+    soa::from_aos(out, vec, &user::physics::speed);
+    REQUIRE(vec.speed[9] == -1.f);
+    REQUIRE(vec.pos[9] == 9.f);
+    out.pop_back();
+    CHECK_THROWS_AS(soa::from_aos(out, vec, &user::physics::speed), std::invalid_argument);
+
+    // Other output iterators get the rows one by one.
+    auto persons = soa::from_aos(std::vector<person>{ { "Bob", 12, true }, { "Alice", 13, false } });
+    auto copies = std::vector<person>{};
+    soa::to_aos(persons, std::back_inserter(copies));
+    REQUIRE(copies.size() == 2);
+    REQUIRE(copies[1].name == "Alice");
+    soa::to_aos(persons, copies.begin(), &person::age);
+    REQUIRE(copies[0].age == 12);
+
+    // Assignments reuse the capacity.
+    auto const data = vec.pos.data();
+    vec.assign(aos.begin(), aos.begin() + 5);
+    REQUIRE(vec.size() == 5);
+    REQUIRE(vec.pos.data() == data);
+    REQUIRE(vec.speed[4] == 8.f);
+    persons.assign(copies.rbegin(), copies.rend());
+    REQUIRE(persons.name[0] == "Alice");
+}
+
+TEST_CASE("bulk emplace_back_n and insert") {
+    auto v = soa::vector<user::physics>{};
+    v.emplace_back_n(4, 1.f, 2.f);
+    REQUIRE(v.size() == 4);
+    for (int i = 0; i < 4; ++i) {
+        REQUIRE(v.pos[i] == 1.f);
+        REQUIRE(v.speed[i] == 2.f);
+        REQUIRE(v.acc[i] == 0.f);
+        REQUIRE(v.id[i] == 0);
+    }
+
+    for (int i = 0; i < 4; ++i) v.id[i] = i;
+    auto const it = v.insert(v.begin() + 2, 3, { 5.f, 6.f, 7.f, 42 });
+    REQUIRE(it == v.begin() + 2);
+    REQUIRE(v.size() == 7);
+    auto const ids = std::vector<int>{ 0, 1, 42, 42, 42, 2, 3 };
+    for (int i = 0; i < 7; ++i) {
+        REQUIRE(v.id[i] == ids[i]);
+        REQUIRE(v.acc[i] == (ids[i] == 42 ? 7.f : 0.f));
+    }
+
+    auto persons = soa::vector<person>{};
+    persons.emplace_back("Bob", 12);
+    persons.emplace_back("Alice", 13);
+    persons.insert(persons.begin(), persons[1]);
+    persons.insert(persons.end(), 2, { "Chuck", 14, true });
+    auto const names = std::vector<std::string>{ "Alice", "Bob", "Alice", "Chuck", "Chuck" };
+    REQUIRE(persons.size() == 5);
+    for (int i = 0; i < 5; ++i) {
+        REQUIRE(persons.name[i] == names[i]);
+    }
+    REQUIRE(persons.age[0] == 13);
+    REQUIRE(persons.likes_cpp[4]);
+}
+
+TEST_CASE("iterators and spans hold the column pointers") {
+    auto v = soa::vector<user::physics>{};
+    auto const empty = std::as_const(v).begin();
+    REQUIRE(empty == v.end());
+    REQUIRE(v.pos.begin() == v.pos.end());
+
+    for (int i = 0; i < 10; ++i) v.push_back({ 1.f * i, 2.f * i, 3.f, i });
+    auto it = v.begin() + 3;
+    REQUIRE(&(*it).pos == v.pos.data() + 3);
+    REQUIRE(&it[2].id == v.id.data() + 5);
+    REQUIRE(it - v.begin() == 3);
+
+    soa::vector<user::physics>::const_iterator cit = it;
+    ++cit;
+    REQUIRE((*cit).speed == 8.f);
+    REQUIRE(cit > it);
+    REQUIRE(v.cend() - cit == 6);
+    REQUIRE((--cit) == it);
+
+    // The spans ends follow the size.
+    REQUIRE(v.speed.end() == v.speed.data() + 10);
+    v.erase(v.begin() + 2, v.begin() + 4);
+    REQUIRE(v.id.size() == 8);
+    REQUIRE(v.id.back() == 9);
+    v.resize(20);
+    REQUIRE(v.acc.end() - v.acc.begin() == 20);
+    v.pop_back();
+    v.shrink_to_fit();
+    REQUIRE(v.pos.end() == v.pos.data() + 19);
+    REQUIRE(v.end() - v.begin() == 19);
+
+    auto moved = std::move(v);
+    REQUIRE(moved.id.size() == 19);
+    REQUIRE(v.id.size() == 0);
+    v = moved;
+    REQUIRE(v.pos.end() == v.pos.data() + 19);
+    v.clear();
+    REQUIRE(v.speed.size() == 0);
+}
+
+TEST_CASE("zip views on a subset of columns") {
+    auto v = soa::vector<user::physics>{};
+    for (int i = 0; i < 10; ++i) {
+        v.push_back({ 1.f * i, 2.f, 3.f, i });
+    }
+    for (auto [pos, speed] : soa::view(v, &user::physics::pos, &user::physics::speed)) {
+        pos += speed;
+    }
+    for (auto [acc, id] : soa::view<2, 3>(v)) {
+        acc += static_cast<float>(id);
+    }
+    for (int i = 0; i < 10; ++i) {
+        REQUIRE(v.pos[i] == 1.f * i + 2.f);
+        REQUIRE(v.acc[i] == 3.f + i);
+    }
+
+    auto const& cv = v;
+    auto const speeds = soa::view(cv, &user::physics::speed, &user::physics::id);
+    REQUIRE(speeds.size() == 10);
+    static_assert(std::is_same_v<decltype(speeds)::reference, std::tuple<float const&, int const&>>);
+
+    // Usable with the standard algorithms.
+    auto const it = std::find_if(speeds.begin(), speeds.end(), [] (auto const& t) {
+        return std::get<1>(t) == 7;
+    });
+    REQUIRE(it - speeds.begin() == 7);
+    REQUIRE(std::get<0>(*it) == 2.f);
+    REQUIRE(std::count_if(speeds.begin(), speeds.end(), [] (auto const& t) { return std::get<1>(t) % 2; }) == 5);
+
+    auto ids = std::vector<int>(10);
+    std::transform(speeds.begin(), speeds.end(), ids.begin(), [] (auto const& t) { return std::get<1>(t) * 2; });
+    REQUIRE(ids[9] == 18);
+
+    auto persons = soa::vector<person>{};
+    persons.emplace_back("Bob", 12);
+    auto const names = soa::view(persons, &person::name);
+    REQUIRE(std::get<0>(names[0]) == "Bob");
+}
+
+TEST_CASE("sort by a column with a single permutation") {
+    auto v = soa::vector<user::physics>{};
+    for (int i = 0; i < 100; ++i) {
+        v.push_back({ static_cast<float>((i * 37) % 100), 1.f * i, 3.f, i });
+    }
+    soa::sort_by<0>(v);
+    for (int i = 0; i < 100; ++i) {
+        REQUIRE(v.pos[i] == 1.f * i);
+        REQUIRE(v.id[i] == static_cast<int>(v.speed[i]));
+        REQUIRE((v.id[i] * 37) % 100 == i);
+    }
+    soa::sort_by(v, &user::physics::id, std::greater<>{});
+    for (int i = 0; i < 100; ++i) {
+        REQUIRE(v.id[i] == 99 - i);
+    }
+
+    // Non-trivially copyable columns are permuted in place.
+    auto persons = soa::vector<person>{};
+    persons.push_back({ "Carl", 30, true });
+    persons.push_back({ "Alice", 20, false });
+    persons.push_back({ "Bob", 30, false });
+    persons.push_back({ "Dan", 20, true });
+    soa::stable_sort_by(persons, &person::age);
+    REQUIRE(persons.name[0] == "Alice");
+    REQUIRE(persons.name[1] == "Dan");
+    REQUIRE(persons.name[2] == "Carl");
+    REQUIRE(persons.name[3] == "Bob");
+    REQUIRE(persons.likes_cpp[1]);
+
+    soa::sort_by<0>(persons);
+    REQUIRE(persons.name[0] == "Alice");
+    REQUIRE(persons.age[3] == 20);
+
+    // The scratch buffer is aligned for over-aligned columns.
+    auto particles = soa::vector<user::particle>{};
+    for (int i = 0; i < 10; ++i) {
+        particles.push_back({ float8{}, static_cast<char>('a' + i), 10. - i });
+    }
+    soa::sort_by<2>(particles);
+    REQUIRE(particles.tag[0] == 'j');
+    REQUIRE(particles.mass[9] == 10.);
+
+    REQUIRE_THROWS_AS(soa::permute(v, std::vector<int>(3)), std::invalid_argument);
+    soa::permute(persons, std::vector<int>{ 3, 2, 1, 0 });
+    REQUIRE(persons.name[0] == "Dan");
+    REQUIRE(persons.name[3] == "Alice");
+}
+
+TEST_CASE("erase, swap_erase and erase_if") {
+    auto v = soa::vector<user::physics>{};
+    for (int i = 0; i < 10; ++i) {
+        v.push_back({ 1.f * i, 2.f, 3.f, i });
+    }
+    auto it = v.erase(v.begin() + 2, v.begin() + 4);
+    REQUIRE(v.size() == 8);
+    REQUIRE((*it).id == 4);
+    REQUIRE(v.id[1] == 1);
+    REQUIRE(v.pos[7] == 9.f);
+
+    it = v.erase(v.cbegin());
+    REQUIRE((*it).id == 1);
+    it = v.erase(v.end() - 1);
+    REQUIRE(it == v.end());
+    REQUIRE(v.size() == 6);
+    REQUIRE(v.erase(v.begin(), v.begin()) == v.begin());
+
+    it = v.swap_erase(v.begin() + 1);
+    REQUIRE(v.size() == 5);
+    REQUIRE((*it).id == 8);
+    REQUIRE(v.pos[1] == 8.f);
+    v.swap_erase(v.end() - 1);
+    REQUIRE(v.size() == 4);
+    REQUIRE(v.id[3] == 6);
+
+    // ids : 1, 8, 5, 6
+    REQUIRE(soa::erase_if(v, [] (auto const& p) { return p.id > 5; }) == 2);
+    REQUIRE(v.size() == 2);
+    REQUIRE(v.id[0] == 1);
+    REQUIRE(v.id[1] == 5);
+    REQUIRE(soa::erase_if(v, [] (auto const&) { return false; }) == 0);
+
+    // Non-trivially relocatable columns.
+    auto persons = soa::vector<person>{};
+    for (auto name : { "A", "B", "C", "D", "E", "F" }) {
+        persons.push_back({ name, 20, true });
+    }
+    persons.erase(persons.begin() + 1);
+    persons.swap_erase(persons.begin());
+    REQUIRE(persons.name[0] == "F");
+    REQUIRE(persons.name[1] == "C");
+    REQUIRE(soa::erase_if(persons, [] (auto const& p) { return p.name == "C" || p.name == "E"; }) == 2);
+    REQUIRE(persons.size() == 2);
+    REQUIRE(persons.name[0] == "F");
+    REQUIRE(persons.name[1] == "D");
+
+    // Trivially relocatable but non-trivially destructible columns.
+    auto ptrs = soa::vector<movable>{};
+    for (int i = 0; i < 6; ++i) {
+        ptrs.emplace_back(std::make_unique<int>(i));
+    }
+    REQUIRE(soa::erase_if(ptrs, [] (auto const& p) { return *p.ptr % 2 == 0; }) == 3);
+    REQUIRE(*ptrs.ptr[0] == 1);
+    REQUIRE(*ptrs.ptr[2] == 5);
+    ptrs.swap_erase(ptrs.begin());
+    REQUIRE(*ptrs.ptr[0] == 5);
+    ptrs.erase(ptrs.begin(), ptrs.end());
+    REQUIRE(ptrs.empty());
+}
+
+#if defined(SOA_64_BIT_SIZE)
+// Allocates about 4 GiB, so it only runs when asked with its tag.
+TEST_CASE("erase_if beyond 2^31 rows", "[.][large]") {
+    static_assert(sizeof(soa::size_type) == 8);
+    auto const nb = soa::size_type{ 1 } << 31;
+    auto v = soa::vector<byte_row>{};
+    v.resize(nb + 8);
+    v.value[nb + 2] = 1;
+    v.value[nb + 5] = 2;
+    REQUIRE(soa::erase_if(v, [] (auto const& row) { return row.value == 1; }) == 1);
+    REQUIRE(v.size() == nb + 7);
+    REQUIRE(v.value[nb + 4] == 2);
+    REQUIRE(v.value[nb + 2] == 0);
+}
+#endif
+
+namespace user {
+    enum class state : unsigned char { idle, running, blocked, done };
+    struct task {
+        int   id;
+        bool  alive;
+        state status;
+        int   priority;
+        std::string name;
+    };
+}
+SOA_DEFINE_TYPE(user::task, id, (alive, soa::packed<>), (status, soa::packed<2>), (priority, soa::packed<3>), name);
+
+namespace {
+    user::task make_task(int i) {
+        return { i, i % 3 == 0, static_cast<user::state>(i % 4), i % 7, std::to_string(i) };
+    }
+
+    // Compares the columns with the std::vector of the same rows.
+    void check_tasks(soa::vector<user::task> const& v, std::vector<user::task> const& rows) {
+        REQUIRE(v.size() == static_cast<soa::size_type>(rows.size()));
+        for (soa::size_type i = 0; i < v.size(); ++i) {
+            auto const& row = rows[static_cast<size_t>(i)];
+            REQUIRE(v.id[i] == row.id);
+            REQUIRE(v.alive[i] == row.alive);
+            REQUIRE(v.status[i] == row.status);
+            REQUIRE(v.priority[i] == row.priority);
+            REQUIRE(v.name[i] == row.name);
+        }
+    }
+}
+
+TEST_CASE("packed columns store bools and small enums in bits") {
+    using vector = soa::vector<user::task>;
+    static_assert(std::is_same_v<decltype(vector::alive), soa::packed_span<1, user::task, bool, 1>>);
+    static_assert(std::is_same_v<decltype(soa::ref_proxy<user::task>::status), soa::detail::packed_reference<user::state, 2>>);
+    static_assert(std::is_same_v<decltype(soa::cref_proxy<user::task>::alive), bool>);
+    static_assert(vector::components_count == 5);
+    static_assert(decltype(vector::priority)::per_word == 21);
+
+    auto v = vector{};
+    auto rows = std::vector<user::task>{};
+    for (int i = 0; i < 200; ++i) {
+        v.push_back(make_task(i));
+        rows.push_back(make_task(i));
+    }
+    check_tasks(v, rows);
+    // 200 flags fit in 4 words.
+    REQUIRE(v.alive.words_count() == 4);
+    REQUIRE(v.priority.words_count() == 10);
+
+    // Proxies and iterators.
+    v[1].alive = true;
+    v[1].status = user::state::done;
+    rows[1].alive = true;
+    rows[1].status = user::state::done;
+    REQUIRE(v.alive[1]);
+    user::task const t = v[1];
+    REQUIRE(t.status == user::state::done);
+    REQUIRE(t.name == "1");
+    auto const& cv = v;
+    REQUIRE(cv[3].alive);
+    REQUIRE(std::count(cv.alive.begin(), cv.alive.end(), true) == 68);
+    REQUIRE(*(v.priority.begin() + 20) == 6);
+    REQUIRE(v.priority.end() - v.priority.begin() == 200);
+    REQUIRE_THROWS_AS(v.alive.at(200), std::out_of_range);
+    check_tasks(v, rows);
+
+    // Copies, growth and resizes.
+    auto copy = v;
+    check_tasks(copy, rows);
+    v.reserve(1000);
+    v.resize(250, make_task(3));
+    rows.resize(250, make_task(3));
+    v.emplace_back(250, true, user::state::blocked, 5);
+    rows.push_back({ 250, true, user::state::blocked, 5, "" });
+    v.shrink_to_fit();
+    check_tasks(v, rows);
+    v.resize(10);
+    rows.resize(10);
+    check_tasks(v, rows);
+    v = copy;
+    v.pop_back();
+    rows.assign(copy.begin(), copy.end() - 1);
+    check_tasks(v, rows);
+
+    // Bulk insertions and removals.
+    v.append(rows.begin(), rows.begin() + 30);
+    rows.insert(rows.end(), rows.begin(), rows.begin() + 30);
+    v.emplace_back_n(5, 7, true);
+    for (int i = 0; i < 5; ++i) rows.push_back({ 7, true, user::state::idle, 0, "" });
+    v.insert(v.begin() + 65, 70, make_task(9));
+    rows.insert(rows.begin() + 65, 70, make_task(9));
+    check_tasks(v, rows);
+    v.erase(v.begin() + 3, v.begin() + 100);
+    rows.erase(rows.begin() + 3, rows.begin() + 100);
+    v.swap_erase(v.begin() + 5);
+    rows[5] = rows.back();
+    rows.pop_back();
+    check_tasks(v, rows);
+    auto const removed = soa::erase_if(v, [] (auto const& row) { return row.alive; });
+    REQUIRE(removed == static_cast<soa::size_type>(std::count_if(rows.begin(), rows.end(), [] (auto const& row) { return row.alive; })));
+    rows.erase(std::remove_if(rows.begin(), rows.end(), [] (auto const& row) { return row.alive; }), rows.end());
+    check_tasks(v, rows);
+
+    // Sorts by a packed key, and permutes the packed columns.
+    soa::stable_sort_by(v, &user::task::priority);
+    std::stable_sort(rows.begin(), rows.end(), [] (auto const& lhs, auto const& rhs) { return lhs.priority < rhs.priority; });
+    check_tasks(v, rows);
+    soa::sort_by(v, &user::task::id, std::greater<>{});
+    std::sort(rows.begin(), rows.end(), [] (auto const& lhs, auto const& rhs) { return lhs.id > rhs.id; });
+    check_tasks(v, rows);
+
+    // Converts the packed columns from and to the rows.
+    check_tasks(soa::from_aos(rows), rows);
+    soa::to_aos(v, rows.begin(), &user::task::alive, &user::task::status);
+    for (auto& row : rows) row.priority = 1;
+    soa::from_aos(rows, v, &user::task::priority);
+    check_tasks(v, rows);
+
+    auto small = soa::small_vector<user::task, 70>{};
+    for (int i = 0; i < 100; ++i) small.push_back(make_task(i));
+    small.resize(65);
+    small.shrink_to_fit();
+    REQUIRE(small.status[62] == user::state::blocked);
+    REQUIRE(small.alive.count() == 22);
+}
+
+TEST_CASE("packed spans have bulk operations on words") {
+    auto v = soa::vector<user::task>{};
+    for (int i = 0; i < 1000; ++i) v.push_back(make_task(i));
+
+    REQUIRE(v.alive.count() == 334);
+    REQUIRE(v.alive.count(false) == 666);
+    REQUIRE(v.status.count(user::state::done) == 250);
+    REQUIRE(v.status.count() == 750);
+    REQUIRE(v.priority.count(6) == 142);
+    REQUIRE(v.alive.find_first(true) == 0);
+    REQUIRE(v.alive.find_first(true, 1) == 3);
+    REQUIRE(v.alive.find_first(true, 999) == 999);
+    REQUIRE(v.status.find_first(user::state::blocked, 500) == 502);
+    REQUIRE(v.priority.find_first(6, 21) == 27);
+
+    // The bits after the last element are ignored.
+    v.resize(10);
+    REQUIRE(v.alive.count() == 4);
+    REQUIRE(v.priority.find_first(6, 7) == 10);
+    v.alive.flip();
+    REQUIRE(v.alive.count() == 6);
+    REQUIRE(v.alive.find_first(false) == 0);
+
+    auto mask = soa::vector<user::task>{};
+    for (int i = 0; i < 10; ++i) mask.push_back({ i, i < 5, user::state::idle, 0, "" });
+    v.alive &= mask.alive;
+    REQUIRE(v.alive.count() == 3);
+    v.alive |= mask.alive;
+    REQUIRE(v.alive.count() == 5);
+    v.alive ^= mask.alive;
+    REQUIRE(v.alive.count() == 0);
+    v.status.fill(user::state::running);
+    REQUIRE(v.status.count(user::state::running) == 10);
+    REQUIRE(v[9].status == user::state::running);
+}
+
+template <class T>
+struct propagating_allocator : tagged_allocator<T> {
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap            = std::true_type;
+
+    using tagged_allocator<T>::tagged_allocator;
+    template <class U>
+    propagating_allocator(propagating_allocator<U> const& rhs) noexcept : tagged_allocator<T>{ rhs.id } {}
+};
+
+TEST_CASE("allocators are propagated according to their traits") {
+    {
+        using allocator = tagged_allocator<user::physics>;
+        using vector = soa::vector<user::physics, allocator>;
+        static_assert(!std::is_nothrow_move_assignable_v<vector>);
+
+        auto a = vector{ allocator{ 0 } };
+        auto b = vector{ allocator{ 1 } };
+        for (int i = 0; i < 10; ++i) a.push_back({ 1.f * i, 2.f, 3.f, i });
+
+        // Unequal allocators which don't propagate : the elements are moved one by one.
+        b = std::move(a);
+        REQUIRE(b.get_allocator().id == 1);
+        REQUIRE(b.size() == 10);
+        REQUIRE(b.id[9] == 9);
+        REQUIRE(a.empty());
+        REQUIRE(live_blocks[1] == 1);
+
+        auto const c = vector{ b, allocator{ 0 } };
+        REQUIRE(c.get_allocator().id == 0);
+        REQUIRE(c.pos[4] == 4.f);
+
+        // Equal allocators : the allocation is taken.
+        auto const d = vector{ std::move(b), allocator{ 1 } };
+        REQUIRE(b.empty());
+        REQUIRE(d.size() == 10);
+        REQUIRE(live_blocks[1] == 1);
+        auto const e = vector{ std::move(a), allocator{ 1 } };
+        REQUIRE(e.empty());
+
+        b = c;
+        REQUIRE(b.get_allocator().id == 1);
+        REQUIRE(b.id[3] == 3);
+    }
+    REQUIRE(live_blocks[0] == 0);
+    REQUIRE(live_blocks[1] == 0);
+    {
+        using allocator = propagating_allocator<user::physics>;
+        using vector = soa::vector<user::physics, allocator>;
+        static_assert(std::is_nothrow_move_assignable_v<vector>);
+
+        auto a = vector{ allocator{ 0 } };
+        auto b = vector{ allocator{ 1 } };
+        for (int i = 0; i < 10; ++i) a.push_back({ 1.f * i, 2.f, 3.f, i });
+        b.push_back({});
+
+        b = a;
+        REQUIRE(b.get_allocator().id == 0);
+        REQUIRE(b.id[9] == 9);
+        REQUIRE(live_blocks[1] == 0);
+
+        auto c = vector{ allocator{ 1 } };
+        c = std::move(a);
+        REQUIRE(c.get_allocator().id == 0);
+        REQUIRE(c.size() == 10);
+        REQUIRE(a.empty());
+
+        auto d = vector{ allocator{ 1 } };
+        d.push_back({});
+        swap(c, d);
+        REQUIRE(c.get_allocator().id == 1);
+        REQUIRE(c.size() == 1);
+        REQUIRE(d.get_allocator().id == 0);
+        REQUIRE(d.size() == 10);
+    }
+    REQUIRE(live_blocks[0] == 0);
+    REQUIRE(live_blocks[1] == 0);
+    {
+        // Small vectors swap their inline rows without allocating, and propagate the allocators.
+        using allocator = propagating_allocator<user::physics>;
+        using vector = soa::small_vector<user::physics, 4, allocator>;
+        static_assert(std::is_nothrow_swappable_v<vector>);
+
+        auto a = vector{ allocator{ 0 } };
+        auto b = vector{ allocator{ 1 } };
+        for (int i = 0; i < 10; ++i) a.push_back({ 1.f * i, 2.f, 3.f, i });
+        b.push_back({ 0.f, 0.f, 0.f, 42 });
+        REQUIRE(live_blocks[0] == 1);
+        REQUIRE(live_blocks[1] == 0);
+
+        swap(a, b);
+        REQUIRE(a.get_allocator().id == 1);
+        REQUIRE(a.size() == 1);
+        REQUIRE(a.id[0] == 42);
+        REQUIRE(b.get_allocator().id == 0);
+        REQUIRE(b.size() == 10);
+        REQUIRE(b.id[9] == 9);
+        REQUIRE(live_blocks[0] == 1);
+
+        a.swap(b);
+        REQUIRE(a.size() == 10);
+        REQUIRE(a.get_allocator().id == 0);
+        REQUIRE(b.id[0] == 42);
+    }
+    REQUIRE(live_blocks[0] == 0);
+    REQUIRE(live_blocks[1] == 0);
+}
+
+#if defined(__cpp_lib_memory_resource)
+TEST_CASE("polymorphic allocators") {
+    static std::byte buffer[1 << 16];
+    auto arena = std::pmr::monotonic_buffer_resource{ buffer, sizeof(buffer), std::pmr::null_memory_resource() };
+
+    auto v = soa::pmr::vector<person>{ &arena };
+    for (int i = 0; i < 20; ++i) v.push_back({ std::to_string(i), i, true });
+    REQUIRE(v.get_allocator().resource() == &arena);
+    auto const in_arena = [] (void const* ptr) {
+        return ptr >= static_cast<void const*>(buffer) && ptr < static_cast<void const*>(buffer + sizeof(buffer));
+    };
+    REQUIRE(in_arena(v.name.data()));
+    REQUIRE(in_arena(v.likes_cpp.data()));
+
+    // Copies use the default resource.
+    auto const copy = v;
+    REQUIRE(copy.get_allocator().resource() == std::pmr::get_default_resource());
+    REQUIRE(!in_arena(copy.age.data()));
+    REQUIRE(copy.name[19] == "19");
+
+    auto other = soa::pmr::vector<person>{};
+    other = std::move(v);
+    REQUIRE(other.get_allocator().resource() == std::pmr::get_default_resource());
+    REQUIRE(other.size() == 20);
+    REQUIRE(other.name[7] == "7");
+
+    auto aligned = soa::pmr::vector<user::aligned_physics>{ &arena };
+    for (int i = 0; i < 20; ++i) aligned.push_back({ 1.f * i, 2.f, 3.f, i });
+    REQUIRE(in_arena(aligned.pos.data()));
+    REQUIRE(is_aligned(aligned.pos, 128));
+    REQUIRE(is_aligned(aligned.acc, 16));
+}
+#endif
+
+TEST_CASE("small vectors store their first rows inline") {
+    using allocator = counting_allocator<person>;
+    using vector = soa::small_vector<person, 8, allocator>;
+    REQUIRE(vector::inline_capacity == 8);
+    {
+        auto v = vector{};
+        REQUIRE(v.capacity() == 8);
+        for (int i = 0; i < 8; ++i) v.push_back({ std::to_string(i), i, i % 2 == 0 });
+        REQUIRE(allocated_bytes == 0);
+        auto const self = reinterpret_cast<std::byte const*>(&v);
+        auto const name = reinterpret_cast<std::byte const*>(v.name.data());
+        REQUIRE((name >= self && name < self + sizeof(v)));
+
+        // Spills to the allocator beyond the inline rows.
+        v.push_back({ "8", 8, true });
+        REQUIRE(allocated_bytes > 0);
+        REQUIRE(v.capacity() > 8);
+        for (int i = 0; i < 9; ++i) {
+            REQUIRE(v.name[i] == std::to_string(i));
+            REQUIRE(v.age[i] == i);
+        }
+
+        // Comes back inline when shrinking.
+        v.resize(5);
+        v.shrink_to_fit();
+        REQUIRE(allocated_bytes == 0);
+        REQUIRE(v.capacity() == 8);
+        REQUIRE(v.name[4] == "4");
+
+        // Inline rows are moved one by one.
+        auto moved = std::move(v);
+        REQUIRE(v.empty());
+        REQUIRE(moved.size() == 5);
+        REQUIRE(moved.name[3] == "3");
+        REQUIRE(moved.likes_cpp[2]);
+
+        auto copy = moved;
+        copy.push_back({ "Bob", 42, false });
+        REQUIRE(allocated_bytes == 0);
+        REQUIRE(copy.size() == 6);
+        REQUIRE(moved.size() == 5);
+
+        auto big = vector{};
+        for (int i = 0; i < 20; ++i) big.emplace_back(std::to_string(i), i);
+        swap(big, copy);
+        REQUIRE(copy.size() == 20);
+        REQUIRE(copy.name[19] == "19");
+        REQUIRE(big.size() == 6);
+        REQUIRE(big.name[5] == "Bob");
+
+        big = copy;
+        REQUIRE(big.size() == 20);
+        REQUIRE(big.age[10] == 10);
+        big.clear();
+        big.shrink_to_fit();
+        copy = std::move(big);
+        REQUIRE(copy.empty());
+        REQUIRE(copy.capacity() == 8);
+    }
+    REQUIRE(allocated_bytes == 0);
+}
+
+TEST_CASE("small vectors align their inline columns") {
+    auto v = soa::small_vector<user::aligned_physics, 4>{};
+    for (int i = 0; i < 4; ++i) v.push_back({ 1.f * i, 2.f, 3.f, i });
+    REQUIRE(is_aligned(v.pos, 128));
+    REQUIRE(is_aligned(v.acc, 16));
+    REQUIRE(alignof(decltype(v)) == 128);
+
+    auto entities = soa::small_vector<user::entity, 3>{};
+    for (int i = 0; i < 3; ++i) entities.push_back({ 1.f * i, 2.f, std::to_string(i), i });
+    auto const moved = std::move(entities);
+    REQUIRE(moved.name[2] == "2");
+    REQUIRE(moved.speed[1] == 2.f);
+    REQUIRE(moved.id[0] == 0);
+}
+
+namespace {
+    constexpr auto physics_table = soa::to_array<user::physics>({
+        { 0.f, 1.f, 2.f, 10 },
+        { 3.f, 4.f, 5.f, 20 },
+        { 6.f, 7.f, 8.f, 30 }
+    });
+
+    constexpr int sum_ids() {
+        int sum = 0;
+        for (auto id : physics_table.id) sum += id;
+        return sum;
+    }
+
+    constexpr soa::array<user::physics, 2> square_ids() {
+        auto table = soa::array<user::physics, 2>{};
+        for (int i = 0; i < table.size(); ++i) table.id[i] = i * i + 1;
+        return table;
+    }
+}
+
+TEST_CASE("fixed-size arrays") {
+    static_assert(physics_table.size() == 3);
+    static_assert(physics_table.speed[1] == 4.f);
+    static_assert(physics_table[2].acc == 8.f);
+    static_assert(sum_ids() == 60);
+    static_assert(square_ids().id[1] == 2);
+    static_assert(std::is_aggregate_v<soa::array<user::physics, 4>>);
+    static_assert(sizeof(soa::array<user::physics, 4>) == sizeof(user::physics) * 4);
+
+    user::physics const p = physics_table[1];
+    REQUIRE(p.pos == 3.f);
+    REQUIRE(p.id == 20);
+    REQUIRE_THROWS_AS(physics_table.at(3), std::out_of_range);
+
+    auto persons = soa::to_array<person>({ { "Jack", 35, true }, { "Sam", 21, false } });
+    persons[1].age += 1;
+    persons.name[0] += "!";
+    REQUIRE(persons.age[1] == 22);
+    REQUIRE(persons[0].name == "Jack!");
+
+    auto ages = 0;
+    for (auto row : persons) ages += row.age;
+    REQUIRE(ages == 57);
+    REQUIRE(std::count_if(persons.begin(), persons.end(), [] (auto row) { return row.likes_cpp; }) == 1);
+
+    // Column by column aggregate initialization.
+    static soa::array<user::physics, 2> columns = {{ {{ 1.f, 2.f }}, {}, {}, {{ 7, 8 }} }};
+    REQUIRE(columns.pos[1] == 2.f);
+    REQUIRE(columns.speed[0] == 0.f);
+    REQUIRE(columns[1].id == 8);
+}
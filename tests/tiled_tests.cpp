@@ -0,0 +1,141 @@
+
+#include "catch.hpp"
+#include "../soa_tiled.hpp"
+#include "../soa_simd.hpp"
+#include "test_rows.hpp"
+#include <atomic>
+#include <cstdint>
+
+namespace tiled_user {
+    struct particle {
+        float       x;
+        double      mass;
+        char        kind;
+        std::string name;
+    };
+}
+SOA_DEFINE_TYPE(tiled_user::particle, x, mass, kind, name);
+
+namespace {
+    using particles = soa::tiled_vector<tiled_user::particle, 8>;
+
+    tiled_user::particle particle_row(int i) {
+        return { 1.f * i, 0.5 * i, 'a', std::to_string(i) };
+    }
+
+    bool is_aligned(void const* ptr, size_t alignment) {
+        return reinterpret_cast<std::uintptr_t>(ptr) % alignment == 0;
+    }
+}
+
+TEST_CASE("tiled vectors store blocks with a tile per column", "[tiled]") {
+    // Each tile is aligned on it's size, up to a cache line.
+    static_assert(particles::alignment == 64);
+    static_assert(particles::block_bytes % 64 == 0);
+    static_assert(particles::block_bytes >= 8 * (sizeof(float) + sizeof(double) + 1 + sizeof(std::string)));
+
+    auto v = soa_tests::make_rows<particles>(20, particle_row);
+    REQUIRE(v.size() == 20);
+    REQUIRE(v.capacity() == 32);
+    REQUIRE(v.blocks_count() == 3);
+
+    auto const tile = v.tile(1);
+    REQUIRE(tile.size() == 8);
+    REQUIRE(tile.x.size() == 8);
+    REQUIRE(tile.mass[3] == 0.5 * 11);
+    REQUIRE(tile.name.back() == "15");
+    REQUIRE(is_aligned(tile.x.data(), 32));
+    REQUIRE(is_aligned(tile.mass.data(), 64));
+    REQUIRE(v.tile(2).size() == 4);
+
+    // The members of a row are in the same block.
+    auto const block = reinterpret_cast<std::byte const*>(v.tile(0).x.data());
+    REQUIRE(reinterpret_cast<std::byte const*>(v.tile(1).x.data()) - block == particles::block_bytes);
+    REQUIRE(reinterpret_cast<std::byte const*>(&v[7].kind) - block < static_cast<std::ptrdiff_t>(particles::block_bytes));
+
+    REQUIRE(v[13].x == 13.f);
+    REQUIRE(v.at(19).name == "19");
+    REQUIRE_THROWS_AS(v.at(20), std::out_of_range);
+    REQUIRE(v.front().mass == 0.);
+    REQUIRE(v.back().name == "19");
+
+    v[9].kind = 'b';
+    REQUIRE(v.tile(1).kind[1] == 'b');
+    v[10] = tiled_user::particle{ -1.f, -1., 'c', "ten" };
+    REQUIRE(v.tile(1).name[2] == "ten");
+
+    auto sum = 0.f;
+    for (auto row : v) sum += row.x;
+    REQUIRE(sum == (19.f * 20.f / 2 - 10.f) - 1.f);
+    REQUIRE(v.end() - v.begin() == 20);
+    tiled_user::particle const p = *(v.cbegin() + 3);
+    REQUIRE(p.name == "3");
+}
+
+TEST_CASE("tiled vectors are modified and copied as vectors", "[tiled]") {
+    auto v = soa_tests::make_rows<particles>(50, particle_row);
+    v.pop_back();
+    v.emplace_back(7.f, 1.);
+    REQUIRE(v.size() == 50);
+    REQUIRE(v[49].x == 7.f);
+    REQUIRE(v[49].kind == '\0');
+    REQUIRE(v[49].name.empty());
+
+    auto copy = v;
+    REQUIRE(copy.size() == 50);
+    REQUIRE(copy.capacity() == 56);
+    REQUIRE(copy[30].name == "30");
+    REQUIRE(copy.tile(0).x.data() != v.tile(0).x.data());
+
+    auto moved = std::move(copy);
+    REQUIRE(copy.empty());
+    REQUIRE(moved[48].name == "48");
+    copy = moved;
+    REQUIRE(copy[48].name == "48");
+    moved = std::move(copy);
+    REQUIRE(moved.size() == 50);
+    swap(moved, v);
+    REQUIRE(v[49].x == 7.f);
+
+    v.resize(70);
+    REQUIRE(v.size() == 70);
+    REQUIRE(v[69].name.empty());
+    REQUIRE(v[48].name == "48");
+    v.resize(9);
+    REQUIRE(v.size() == 9);
+    REQUIRE(v.tile(1).size() == 1);
+    v.shrink_to_fit();
+    REQUIRE(v.capacity() == 16);
+    REQUIRE(v[8].name == "8");
+
+    v.reserve(100);
+    REQUIRE(v.capacity() == 104);
+    REQUIRE_THROWS_AS(v.reserve(particles::max_size() + 1), std::length_error);
+    v.clear();
+    REQUIRE(v.empty());
+    REQUIRE(v.blocks_count() == 0);
+    v.shrink_to_fit();
+    REQUIRE(v.capacity() == 0);
+}
+
+TEST_CASE("tiled vectors tiles run SIMD kernels and parallel algorithms", "[tiled]") {
+    auto v = soa_tests::make_rows<particles>(1000, particle_row);
+
+    soa::for_each_tile(soa::execution::par.with_workers(3).with_chunk_rows(100), v, [] (auto& tile, soa::size_type) {
+        soa::simd_transform(tile.x, [] (auto x, auto mass) { return x + soa::simd::cast<float>(mass); }, tile.x, tile.mass);
+    });
+    for (int i = 0; i < 1000; ++i) REQUIRE(v[i].x == 1.5f * i);
+
+    // Each block is visited once, by a single worker.
+    auto blocks = std::vector<std::atomic<int>>(static_cast<size_t>(v.blocks_count()));
+    auto mismatches = std::atomic<int>{ 0 };
+    soa::for_each_tile(soa::execution::par.with_workers(3), std::as_const(v), [&] (auto const& tile, soa::size_type first) {
+        if (tile.name[0] != std::to_string(first)) ++mismatches;
+        ++blocks[static_cast<size_t>(first / particles::lanes)];
+    });
+    REQUIRE(mismatches == 0);
+    for (auto const& block : blocks) REQUIRE(block == 1);
+
+    soa::for_each(soa::execution::par.with_workers(3), v, [] (auto row) { row.kind = 'z'; });
+    for (auto row : std::as_const(v)) REQUIRE(row.kind == 'z');
+}